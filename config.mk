@@ -73,6 +73,20 @@ MAX_CPUS ?= 64
 # Log level (0=debug, 1=info, 2=warn, 3=error, 4=fatal, 5=none)
 LOG_LEVEL ?= 0
 
+# Per-callsite RUN_ELEVATED counters and cycle histograms in
+# /dev/sysinfo/elevate (0=off, 1=on). Adds a counter update to every site.
+ELEVATE_STATS ?= 0
+
+# Per-syscall counters and latency histograms in /dev/sysinfo/syscalls,
+# plus per-task syscall counts (0=off, 1=on). Adds two clock reads and a
+# few counter updates to every syscall.
+SYSCALL_STATS ?= 0
+
+# Lock contention statistics per lock class and call site in
+# /dev/sysinfo/locks (0=off, 1=on). Moves spin_lock out of line and adds
+# cycle counter reads and counter updates to every lock operation.
+LOCKSTAT ?= 0
+
 # Build epoch (Unix timestamp for RTC fallback on platforms without hardware RTC)
 STLX_BUILD_EPOCH ?= $(shell date +%s)
 
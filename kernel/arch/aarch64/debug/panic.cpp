@@ -5,6 +5,7 @@
 #include "debug/dwarf_line.h"
 #include "debug/stacktrace.h"
 #include "common/logging.h"
+#include "kmsg/kmsg.h"
 #include "hw/cpu.h"
 #include "sched/sched.h"
 #include "sched/task.h"
@@ -148,6 +149,9 @@ static void print_registers(const aarch64::trap_frame* tf) {
 [[noreturn]] __PRIVILEGED_CODE void on_trap(aarch64::trap_frame* tf, const char* kind) {
     cpu::irq_disable();
 
+    // Lines still queued for klogd come out before the panic report
+    kmsg::emergency_flush();
+
     uint64_t esr = tf->esr;
     uint8_t ec = static_cast<uint8_t>((esr >> aarch64::ESR_EC_SHIFT) & aarch64::ESR_EC_MASK);
 
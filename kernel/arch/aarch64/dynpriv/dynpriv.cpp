@@ -2,6 +2,7 @@
 #include "syscall/syscall.h"
 #include "sched/task_exec_core.h"
 #include "percpu/percpu.h"
+#include "hwtimer/hwtimer_arch.h"
 #include "defs/exception.h"
 #include "common/types.h"
 #include "common/logging.h"
@@ -14,7 +15,7 @@ void elevate() {
         "svc #0"
         :
         : "r"(static_cast<uint64_t>(syscall::SYS_ELEVATE))
-        : "x8", "memory"
+        : "x0", "x8", "memory"
     );
 }
 
@@ -59,4 +60,8 @@ bool is_elevated() {
     return this_cpu(percpu_is_elevated);
 }
 
+uint64_t read_cycles() {
+    return hwtimer::read_cntvct();
+}
+
 } // namespace dynpriv
@@ -34,6 +34,16 @@ __PRIVILEGED_CODE inline void irq_enable() {
     asm volatile("msr daifclr, #0xf" ::: "memory");
 }
 
+/**
+ * @brief true if IRQs are unmasked on this CPU.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline bool irqs_enabled() {
+    uint64_t daif;
+    asm volatile("mrs %0, daif" : "=r"(daif) :: "memory");
+    return (daif & (1ull << 7)) == 0; // DAIF.I
+}
+
 /**
  * @note Privilege: **required**
  */
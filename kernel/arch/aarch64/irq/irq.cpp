@@ -4,6 +4,7 @@
 #include "hw/mmio.h"
 #include "mm/vmm.h"
 #include "mm/paging_types.h"
+#include "percpu/percpu.h"
 #include "common/logging.h"
 
 namespace irq {
@@ -13,11 +14,32 @@ __PRIVILEGED_BSS static uintptr_t g_gicd_base_kva;
 __PRIVILEGED_BSS static uintptr_t g_gicc_va;
 __PRIVILEGED_BSS static uintptr_t g_gicc_base_kva;
 
+// GICv2 CPU interface bit of each CPU, as used by GICD_SGIR target lists
+static DEFINE_PER_CPU(uint8_t, gic_cpu_mask);
+
+// Raw IAR of the SGI being handled, GICC_EOIR needs its source CPU field
+static DEFINE_PER_CPU(uint32_t, gic_sgi_iar);
+
+/**
+ * Record this CPU's interface bit and enable the reschedule SGI. The
+ * first GICD_ITARGETSR word is banked and reads back the current CPU.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void init_cpu_sgi() {
+    this_cpu(gic_cpu_mask) = mmio::read8(g_gicd_va + GICD_ITARGETSR);
+    unmask(RESCHED_SGI);
+}
+
 /**
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE uint32_t acknowledge() {
-    return mmio::read32(g_gicc_va + GICC_IAR) & GIC_INTID_MASK;
+    uint32_t iar = mmio::read32(g_gicc_va + GICC_IAR);
+    uint32_t intid = iar & GIC_INTID_MASK;
+    if (intid < GIC_SGI_COUNT) {
+        this_cpu(gic_sgi_iar) = iar;
+    }
+    return intid;
 }
 
 /**
@@ -69,6 +91,8 @@ __PRIVILEGED_CODE int32_t init() {
     // Enable distributor (groups 0 and 1)
     mmio::write32(g_gicd_va + GICD_CTLR, 0x3);
 
+    init_cpu_sgi();
+
     log::info("irq: GICv%u initialized (GICD=0x%lx GICC=0x%lx)",
               static_cast<uint32_t>(madt.gic_version),
               madt.gicd_base,
@@ -81,6 +105,10 @@ __PRIVILEGED_CODE int32_t init() {
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void eoi(uint32_t irq) {
+    // An SGI is only completed by the full IAR value, source CPU included
+    if (irq < GIC_SGI_COUNT) {
+        irq = this_cpu(gic_sgi_iar);
+    }
     mmio::write32(g_gicc_va + GICC_EOIR, irq);
 }
 
@@ -158,7 +186,21 @@ __PRIVILEGED_CODE void set_edge_triggered(uint32_t irq) {
 __PRIVILEGED_CODE int32_t init_ap() {
     mmio::write32(g_gicc_va + GICC_PMR, 0xFF);
     mmio::write32(g_gicc_va + GICC_CTLR, 0x1);
+    init_cpu_sgi();
     return OK;
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void send_resched_ipi(uint32_t cpu_id) {
+    uint8_t target = per_cpu_on(gic_cpu_mask, cpu_id);
+    if (!target) {
+        return;
+    }
+    // TargetListFilter 0: deliver to the CPUs named in the target list
+    mmio::write32(g_gicd_va + GICD_SGIR,
+                  (static_cast<uint32_t>(target) << 16) | RESCHED_SGI);
+}
+
 } // namespace irq
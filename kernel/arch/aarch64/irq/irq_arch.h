@@ -14,6 +14,7 @@ constexpr uint32_t GICD_IGROUPR    = 0x080;
 constexpr uint32_t GICD_IPRIORITYR = 0x400;
 constexpr uint32_t GICD_ITARGETSR  = 0x800;
 constexpr uint32_t GICD_ICFGR      = 0xC00;
+constexpr uint32_t GICD_SGIR       = 0xF00;
 
 // GICC (CPU Interface) register offsets
 constexpr uint32_t GICC_CTLR       = 0x000;
@@ -23,6 +24,10 @@ constexpr uint32_t GICC_EOIR       = 0x010;
 
 constexpr uint32_t GIC_SPURIOUS_ID = 1023;
 constexpr uint32_t GIC_INTID_MASK  = 0x3FF;
+constexpr uint32_t GIC_SGI_COUNT   = 16;
+
+// SGI used as the reschedule IPI (pulls a tickless idle CPU back into the scheduler)
+constexpr uint32_t RESCHED_SGI     = 0;
 
 /**
  * @brief Read GICC_IAR to acknowledge the current interrupt.
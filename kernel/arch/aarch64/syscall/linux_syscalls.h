@@ -50,6 +50,7 @@ constexpr uint64_t RT_SIGRETURN     = 139;
 constexpr uint64_t SETPGID          = 154;
 constexpr uint64_t GETPGID          = 155;
 constexpr uint64_t UNAME            = 160;
+constexpr uint64_t GETRUSAGE        = 165;
 constexpr uint64_t GETTIMEOFDAY     = 169;
 constexpr uint64_t GETPID           = 172;
 constexpr uint64_t GETUID           = 174;
@@ -76,8 +77,10 @@ constexpr uint64_t CLONE            = 220;
 constexpr uint64_t MMAP             = 222;
 constexpr uint64_t MPROTECT         = 226;
 constexpr uint64_t MADVISE          = 233;
+constexpr uint64_t WAIT4            = 260;
 constexpr uint64_t GETRANDOM        = 278;
 constexpr uint64_t MEMFD_CREATE     = 279;
+constexpr uint64_t FUTEX_WAITV      = 449;
 
 } // namespace syscall::linux_nr
 
@@ -1,5 +1,8 @@
 #include "syscall/syscall.h"
 #include "trap/trap_frame.h"
+#include "sched/task_exec_core.h"
+#include "dynpriv/dynpriv.h"
+#include "percpu/percpu.h"
 #include "defs/exception.h"
 #include "common/types.h"
 #include "common/logging.h"
@@ -26,6 +29,23 @@ void stlx_aarch64_syscall_dispatch(aarch64::trap_frame* tf) {
         return;
     }
 
+    // Short SYS_ELEVATE path for an authorized task coming from EL0:
+    // no generic dispatch and no signal checks. Anything else about it
+    // (unauthorized, already elevated) goes through the handler below.
+    if (syscall_num == syscall::SYS_ELEVATE) {
+        sched::task_exec_core* task = this_cpu(current_task_exec);
+        uint32_t flags = task->flags;
+        if ((flags & (sched::TASK_FLAG_CAN_ELEVATE | sched::TASK_FLAG_ELEVATED)) ==
+                sched::TASK_FLAG_CAN_ELEVATE &&
+            (tf->spsr & aarch64::SPSR_MODE_MASK) == aarch64::SPSR_EL0T) {
+            task->flags = flags | sched::TASK_FLAG_ELEVATED;
+            this_cpu(percpu_is_elevated) = true;
+            tf->x[0] = 0;
+            tf->spsr = (tf->spsr & ~aarch64::SPSR_MODE_MASK) | aarch64::SPSR_EL1T;
+            return;
+        }
+    }
+
     int64_t result = stlx_syscall_handler(
         syscall_num,
         tf->x[0], tf->x[1], tf->x[2],
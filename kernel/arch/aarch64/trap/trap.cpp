@@ -15,6 +15,8 @@
 #include "sched/task.h"
 #include "signals/signal.h"
 #include "mm/mm.h"
+#include "profile/profile.h"
+#include "trace/trace.h"
 
 // Forward declaration of syscall dispatch
 extern "C" void stlx_aarch64_syscall_dispatch(aarch64::trap_frame* tf);
@@ -103,7 +105,10 @@ void stlx_aarch64_el0_sync_handler(aarch64::trap_frame* tf) {
             pf_flags |= mm::PF_FLAG_INSTRUCTION;
         }
 
-        if (mm::handle_user_pf(guard.task_core->mm_ctx, fault_addr, pf_flags)) {
+        bool resolved = mm::handle_user_pf(guard.task_core->mm_ctx, fault_addr, pf_flags);
+        TRACE(PAGE_FAULT, fault_addr, tf->elr,
+              pf_flags | (resolved ? trace::PF_RESOLVED : 0));
+        if (resolved) {
             // Fault has been handled successfully, restart instruction
             restore_post_trap_elevation_state();
             return;
@@ -133,9 +138,14 @@ void stlx_aarch64_el0_irq_handler(aarch64::trap_frame* tf) {
     irq_task_core->flags |= sched::TASK_FLAG_IN_IRQ;
 
     uint32_t irq_id = irq::acknowledge();
+    trace::irq_scope irq_trace(irq_id);
     if (irq_id == hwtimer::TIMER_PPI) {
         bool tick = timer::on_interrupt();
         irq::eoi(irq_id);
+        // Lowered kernel tasks also trap from EL0
+        profile::on_timer_interrupt(tf->elr, tf->x[29],
+                                    !(irq_task_core->flags & sched::TASK_FLAG_KERNEL),
+                                    (irq_task_core->flags & sched::TASK_FLAG_ELEVATED) != 0);
         if (tick) {
             sched::on_tick(tf);
         }
@@ -144,6 +154,15 @@ void stlx_aarch64_el0_irq_handler(aarch64::trap_frame* tf) {
         return;
     }
 
+    if (irq_id == irq::RESCHED_SGI) {
+        irq::eoi(irq_id);
+        // A task was made runnable here while this CPU was idle
+        sched::on_tick(tf);
+        irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
+        restore_post_trap_elevation_state();
+        return;
+    }
+
     if (irq_id == serial::irq_id()) {
         serial::on_rx_irq();
         irq::eoi(irq_id);
@@ -211,9 +230,12 @@ void stlx_aarch64_el1_irq_handler(aarch64::trap_frame* tf) {
     irq_task_core->flags |= sched::TASK_FLAG_IN_IRQ;
 
     uint32_t irq_id = irq::acknowledge();
+    trace::irq_scope irq_trace(irq_id);
     if (irq_id == hwtimer::TIMER_PPI) {
         bool tick = timer::on_interrupt();
         irq::eoi(irq_id);
+        profile::on_timer_interrupt(tf->elr, tf->x[29], false,
+                                    (irq_task_core->flags & sched::TASK_FLAG_ELEVATED) != 0);
         if (tick) {
             sched::on_tick(tf);
         }
@@ -222,6 +244,15 @@ void stlx_aarch64_el1_irq_handler(aarch64::trap_frame* tf) {
         return;
     }
 
+    if (irq_id == irq::RESCHED_SGI) {
+        irq::eoi(irq_id);
+        // A task was made runnable here while this CPU was idle
+        sched::on_tick(tf);
+        irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
+        restore_post_trap_elevation_state();
+        return;
+    }
+
     if (irq_id == serial::irq_id()) {
         serial::on_rx_irq();
         irq::eoi(irq_id);
@@ -1,5 +1,6 @@
 #include "cpu/features.h"
 #include "hw/msr.h"
+#include "sched/fpu_state.h"
 
 namespace cpu {
 
@@ -48,6 +49,13 @@ constexpr uint32_t CPUID_EXT7_EDX_INVARIANT_TSC = 1 << 8;
 // CPUID leaf 7 ECX bits
 constexpr uint32_t CPUID_7_ECX_LA57 = 1 << 16;
 
+// CPUID leaf 0xD subleaf 1 EAX bits
+constexpr uint32_t CPUID_D1_EAX_XSAVEOPT = 1 << 0;
+constexpr uint32_t CPUID_D1_EAX_XSAVES   = 1 << 3;
+
+// CR4 bits
+constexpr uint64_t CR4_OSXSAVE = 1ULL << 18;
+
 // Detect CPU features via CPUID and populate g_features
 __PRIVILEGED_CODE static void detect() {
     uint32_t eax, ebx, ecx, edx;
@@ -109,6 +117,16 @@ __PRIVILEGED_CODE static void detect() {
         if (ecx & CPUID_7_ECX_LA57)     g_features.flags |= LA57;
     }
 
+    // Leaf 0xD subleaf 1: XSAVE instruction variants
+    if (max_leaf >= 0xD && (g_features.flags & XSAVE)) {
+        cpuid(0xD, 1, &eax, &ebx, &ecx, &edx);
+
+        if (eax & CPUID_D1_EAX_XSAVEOPT) g_features.flags |= XSAVEOPT;
+        if (eax & CPUID_D1_EAX_XSAVES)   g_features.flags |= XSAVES;
+    } else {
+        g_features.flags &= ~XSAVE;
+    }
+
     // Extended leaf 0x80000001: AMD features and NX
     cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx);
     uint32_t max_ext_leaf = eax;
@@ -180,6 +198,47 @@ __PRIVILEGED_CODE static void enable_fpu_sse() {
     asm volatile("ldmxcsr %0" :: "m"(mxcsr));
 }
 
+// Enable XSAVE via CR4.OSXSAVE and program XCR0 with the user state
+// components the per-task FPU area has room for
+__PRIVILEGED_CODE static void enable_xsave() {
+    g_features.xcr0 = 0;
+    g_features.xsave_size = 0;
+    if (!(g_features.flags & XSAVE)) {
+        // AVX state cannot be saved across a context switch
+        g_features.flags &= ~(AVX | AVX2 | XSAVEOPT | XSAVES);
+        return;
+    }
+
+    uint64_t cr4;
+    asm volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= CR4_OSXSAVE;
+    asm volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");
+
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(0xD, 0, &eax, &ebx, &ecx, &edx);
+    uint64_t supported = eax | (static_cast<uint64_t>(edx) << 32);
+
+    uint64_t xcr0 = XFEATURE_X87 | XFEATURE_SSE;
+    if ((g_features.flags & AVX) && (supported & XFEATURE_AVX)) {
+        // Subleaf 2: EAX = YMM_Hi128 size, EBX = its standard-format offset
+        cpuid(0xD, 2, &eax, &ebx, &ecx, &edx);
+        if (static_cast<size_t>(ebx) + eax <= sizeof(sched::fpu_state)) {
+            xcr0 |= XFEATURE_AVX;
+        }
+    }
+    if (!(xcr0 & XFEATURE_AVX)) {
+        g_features.flags &= ~(AVX | AVX2);
+    }
+
+    asm volatile("xsetbv" :: "c"(0), "a"(static_cast<uint32_t>(xcr0)),
+                 "d"(static_cast<uint32_t>(xcr0 >> 32)) : "memory");
+
+    // Subleaf 0 EBX now reports the area size for the enabled components
+    cpuid(0xD, 0, &eax, &ebx, &ecx, &edx);
+    g_features.xcr0 = xcr0;
+    g_features.xsave_size = ebx;
+}
+
 __PRIVILEGED_CODE int32_t init() {
     detect();
 
@@ -191,6 +250,7 @@ __PRIVILEGED_CODE int32_t init() {
     enable_fsgsbase();
     init_pat();
     enable_fpu_sse();
+    enable_xsave();
 
     return OK;
 }
@@ -28,6 +28,13 @@ constexpr uint64_t INVARIANT_TSC = 1ULL << 17; // Invariant TSC (constant rate a
 constexpr uint64_t RDTSCP     = 1ULL << 18;  // RDTSCP instruction
 constexpr uint64_t RDRAND     = 1ULL << 19;  // RDRAND instruction (hardware RNG)
 constexpr uint64_t RDSEED     = 1ULL << 20;  // RDSEED instruction (hardware entropy)
+constexpr uint64_t XSAVEOPT   = 1ULL << 21;  // XSAVEOPT instruction
+constexpr uint64_t XSAVES     = 1ULL << 22;  // XSAVES/XRSTORS (compacted format)
+
+// XCR0 state-component bits
+constexpr uint64_t XFEATURE_X87 = 1ULL << 0;
+constexpr uint64_t XFEATURE_SSE = 1ULL << 1;
+constexpr uint64_t XFEATURE_AVX = 1ULL << 2;
 
 // Features required for Stellux to boot
 constexpr uint64_t REQUIRED = FSGSBASE | NX | APIC | PAT;
@@ -37,6 +44,8 @@ struct features {
     uint8_t family;
     uint8_t model;
     uint8_t stepping;
+    uint64_t xcr0;       // enabled XSAVE components, 0 when FXSAVE is used
+    uint32_t xsave_size; // XSAVE area bytes for xcr0 (standard format)
 };
 
 __PRIVILEGED_DATA extern features g_features;
@@ -45,7 +54,9 @@ constexpr int32_t OK = 0;
 constexpr int32_t ERR_REQUIRED_FEATURE = -1;
 
 /**
- * Initialize CPU features: detect via CPUID, enable FSGSBASE and PAT.
+ * Initialize CPU features: detect via CPUID, enable FSGSBASE and PAT,
+ * enable the FPU and program XCR0. AVX and AVX2 stay set in flags only
+ * when XCR0 enabled their state.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t init();
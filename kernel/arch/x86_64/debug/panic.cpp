@@ -5,6 +5,7 @@
 #include "debug/dwarf_line.h"
 #include "debug/stacktrace.h"
 #include "common/logging.h"
+#include "kmsg/kmsg.h"
 #include "hw/cpu.h"
 #include "sched/sched.h"
 #include "sched/task.h"
@@ -109,6 +110,9 @@ static void print_registers(const x86::trap_frame* tf, uint64_t cr2) {
 [[noreturn]] __PRIVILEGED_CODE void on_trap(x86::trap_frame* tf) {
     cpu::irq_disable();
 
+    // Lines still queued for klogd come out before the panic report
+    kmsg::emergency_flush();
+
     uint64_t cr2 = 0;
     if (tf->vector == x86::EXC_PAGE_FAULT) cr2 = x86::read_cr2();
 
@@ -2,15 +2,19 @@
 #include "syscall/syscall.h"
 #include "sched/task_exec_core.h"
 #include "percpu/percpu.h"
+#include "hw/tsc.h"
 #include "common/logging.h"
 
 namespace dynpriv {
 
 void elevate() {
+    // Taken by the short SYS_ELEVATE path in syscall_entry.S, which
+    // returns 0 in RAX and clobbers only RCX/R11 like any SYSCALL
+    uint64_t nr = syscall::SYS_ELEVATE;
     asm volatile(
         "syscall"
+        : "+a"(nr)
         :
-        : "a"(syscall::SYS_ELEVATE)
         : "rcx", "r11", "memory"
     );
 }
@@ -51,4 +55,8 @@ bool is_elevated() {
     return this_cpu(percpu_is_elevated);
 }
 
+uint64_t read_cycles() {
+    return tsc::rdtsc();
+}
+
 } // namespace dynpriv
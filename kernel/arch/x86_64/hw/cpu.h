@@ -33,6 +33,16 @@ __PRIVILEGED_CODE inline void irq_enable() {
     asm volatile("sti" ::: "memory");
 }
 
+/**
+ * @brief true if maskable interrupts are enabled on this CPU.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline bool irqs_enabled() {
+    uint64_t flags;
+    asm volatile("pushfq; pop %0" : "=r"(flags) :: "memory");
+    return (flags & (1ull << 9)) != 0; // RFLAGS.IF
+}
+
 /**
  * @note Privilege: **required**
  */
@@ -7,10 +7,19 @@
 #include "hw/mmio.h"
 #include "mm/vmm.h"
 #include "mm/paging_types.h"
+#include "smp/smp.h"
+#include "percpu/percpu.h"
+#include "hw/cpu.h"
 #include "common/logging.h"
 
 namespace irq {
 
+// LAPIC ICR command bits for fixed-delivery IPIs
+constexpr uint32_t ICR_DELIVERY_BUSY = (1 << 12);
+constexpr uint32_t ICR_LEVEL_ASSERT  = (1 << 14);
+constexpr uint32_t ICR_DEST_SELF     = (1 << 18);
+constexpr uint32_t ICR_DEST_SHIFT    = 24;
+
 __PRIVILEGED_BSS static uintptr_t g_lapic_va;
 __PRIVILEGED_BSS static uintptr_t g_lapic_base_kva;
 
@@ -90,6 +99,39 @@ __PRIVILEGED_CODE void eoi(uint32_t) {
     mmio::write32(g_lapic_va + LAPIC_EOI, 0);
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void send_resched_ipi(uint32_t cpu_id) {
+    if (!g_lapic_va) {
+        return;
+    }
+
+    // The self shorthand needs no APIC ID, so it also works before
+    // smp::init() has enumerated the CPUs
+    uint32_t dest = 0;
+    uint32_t shorthand = ICR_DEST_SELF;
+    if (cpu_id != percpu::current_cpu_id()) {
+        smp::cpu_info* info = smp::get_cpu_info(cpu_id);
+        if (!info) {
+            return;
+        }
+        dest = static_cast<uint32_t>(info->hw_id) << ICR_DEST_SHIFT;
+        shorthand = 0;
+    }
+
+    // ICR_HIGH and ICR_LOW must be written back to back, an interrupt
+    // that sends its own IPI in between would retarget this one
+    uint64_t flags = cpu::irq_save();
+    while (mmio::read32(g_lapic_va + LAPIC_ICR_LOW) & ICR_DELIVERY_BUSY) {
+        cpu::relax();
+    }
+    mmio::write32(g_lapic_va + LAPIC_ICR_HIGH, dest);
+    mmio::write32(g_lapic_va + LAPIC_ICR_LOW,
+                  shorthand | ICR_LEVEL_ASSERT | x86::VEC_RESCHED);
+    cpu::irq_restore(flags);
+}
+
 /**
  * @note Privilege: **required**
  */
@@ -2,6 +2,7 @@
 #define STELLUX_ARCH_X86_64_SCHED_FPU_H
 
 #include "sched/fpu_state.h"
+#include "cpu/features.h"
 
 namespace fpu {
 
@@ -12,34 +13,122 @@ constexpr size_t MXCSR_MASK_OFFSET = 28;
 // Architectural fallback when the CPU reports no mask, DAZ excluded
 constexpr uint32_t MXCSR_DEFAULT_MASK = 0xFFBF;
 
+// XSAVE header: components present in the image, and for XSAVES the
+// compacted-format flag plus the components laid out
+constexpr size_t   XSTATE_BV_OFFSET   = sched::FPU_LEGACY_SIZE;
+constexpr size_t   XCOMP_BV_OFFSET    = sched::FPU_LEGACY_SIZE + 8;
+constexpr uint64_t XCOMP_BV_COMPACTED = 1ULL << 63;
+
+/*
+ * Two image formats are in use. A task's own fpu_ctx is only ever
+ * written by save() and read by restore() on a context switch, so it
+ * uses the fastest instruction the CPU has: XSAVES (compacted, init and
+ * modified optimizations), XSAVEOPT (init and modified optimizations),
+ * XSAVE, or FXSAVE without XSAVE support. Images that cross the user
+ * boundary (signal frames) go through save_user()/restore_user(), which
+ * always use the standard format so user code can parse them.
+ */
+
 /**
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE inline void save(sched::fpu_state* state) {
-    asm volatile("fxsave64 %0" : "=m"(state->fxsave_area) :: "memory");
+    uint64_t mask = cpu::g_features.xcr0;
+    uint32_t lo = static_cast<uint32_t>(mask);
+    uint32_t hi = static_cast<uint32_t>(mask >> 32);
+    if (!mask) {
+        asm volatile("fxsave64 %0" : "=m"(state->fxsave_area) :: "memory");
+    } else if (cpu::has(cpu::XSAVES)) {
+        asm volatile("xsaves64 %0" : "+m"(*state) : "a"(lo), "d"(hi) : "memory");
+    } else if (cpu::has(cpu::XSAVEOPT)) {
+        asm volatile("xsaveopt64 %0" : "+m"(*state) : "a"(lo), "d"(hi) : "memory");
+    } else {
+        asm volatile("xsave64 %0" : "+m"(*state) : "a"(lo), "d"(hi) : "memory");
+    }
 }
 
 /**
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE inline void restore(const sched::fpu_state* state) {
-    asm volatile("fxrstor64 %0" :: "m"(state->fxsave_area) : "memory");
+    uint64_t mask = cpu::g_features.xcr0;
+    uint32_t lo = static_cast<uint32_t>(mask);
+    uint32_t hi = static_cast<uint32_t>(mask >> 32);
+    if (!mask) {
+        asm volatile("fxrstor64 %0" :: "m"(state->fxsave_area) : "memory");
+    } else if (cpu::has(cpu::XSAVES)) {
+        asm volatile("xrstors64 %0" :: "m"(*state), "a"(lo), "d"(hi) : "memory");
+    } else {
+        asm volatile("xrstor64 %0" :: "m"(*state), "a"(lo), "d"(hi) : "memory");
+    }
+}
+
+/**
+ * @brief Save the live FP state as a standard-format image for user
+ * memory. Every byte is defined: the area is zeroed first and XSAVE
+ * writes each enabled component, including ones in their init state.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline void save_user(sched::fpu_state* state) {
+    auto* bytes = reinterpret_cast<uint8_t*>(state);
+    for (size_t i = 0; i < sizeof(sched::fpu_state); i++) {
+        bytes[i] = 0;
+    }
+
+    uint64_t mask = cpu::g_features.xcr0;
+    if (!mask) {
+        asm volatile("fxsave64 %0" : "=m"(state->fxsave_area) :: "memory");
+    } else {
+        asm volatile("xsave64 %0" : "+m"(*state)
+                     : "a"(static_cast<uint32_t>(mask)),
+                       "d"(static_cast<uint32_t>(mask >> 32))
+                     : "memory");
+    }
+}
+
+/**
+ * @brief Load a standard-format image. An image from user memory must
+ * pass through sanitize_user_state() first.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline void restore_user(const sched::fpu_state* state) {
+    uint64_t mask = cpu::g_features.xcr0;
+    if (!mask) {
+        asm volatile("fxrstor64 %0" :: "m"(state->fxsave_area) : "memory");
+    } else {
+        asm volatile("xrstor64 %0" :: "m"(*state),
+                     "a"(static_cast<uint32_t>(mask)),
+                     "d"(static_cast<uint32_t>(mask >> 32))
+                     : "memory");
+    }
 }
 
 /**
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE inline void init_state(sched::fpu_state* state) {
-    auto* area = state->fxsave_area;
-    for (size_t i = 0; i < 512; i++) {
-        area[i] = 0;
+    auto* bytes = reinterpret_cast<uint8_t*>(state);
+    for (size_t i = 0; i < sizeof(sched::fpu_state); i++) {
+        bytes[i] = 0;
     }
+    auto* area = state->fxsave_area;
     // FCW (offset 0): 0x037F - mask all x87 exceptions, 64-bit precision, round-to-nearest
     area[0] = 0x7F;
     area[1] = 0x03;
     // MXCSR: 0x1F80 - mask all SSE exceptions, round-to-nearest
     area[MXCSR_OFFSET]     = 0x80;
     area[MXCSR_OFFSET + 1] = 0x1F;
+
+    uint64_t mask = cpu::g_features.xcr0;
+    if (mask) {
+        // x87 and SSE load from the image, AVX starts in its init state
+        *reinterpret_cast<uint64_t*>(&bytes[XSTATE_BV_OFFSET]) =
+            cpu::XFEATURE_X87 | cpu::XFEATURE_SSE;
+        if (cpu::has(cpu::XSAVES)) {
+            *reinterpret_cast<uint64_t*>(&bytes[XCOMP_BV_OFFSET]) =
+                XCOMP_BV_COMPACTED | mask;
+        }
+    }
 }
 
 /**
@@ -50,7 +139,7 @@ __PRIVILEGED_CODE inline void init_state(sched::fpu_state* state) {
  */
 __PRIVILEGED_CODE inline void sanitize_user_mxcsr(sched::fpu_state* state) {
     sched::fpu_state probe;
-    save(&probe);
+    save_user(&probe);
 
     uint32_t mask =
         *reinterpret_cast<const uint32_t*>(&probe.fxsave_area[MXCSR_MASK_OFFSET]);
@@ -61,6 +150,26 @@ __PRIVILEGED_CODE inline void sanitize_user_mxcsr(sched::fpu_state* state) {
     *reinterpret_cast<uint32_t*>(&state->fxsave_area[MXCSR_OFFSET]) &= mask;
 }
 
+/**
+ * @brief Make an untrusted standard-format image safe for restore_user().
+ * Besides MXCSR, XRSTOR raises #GP on components outside XCR0, on a
+ * compacted-format flag and on nonzero reserved header bytes.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline void sanitize_user_state(sched::fpu_state* state) {
+    sanitize_user_mxcsr(state);
+
+    uint64_t mask = cpu::g_features.xcr0;
+    if (!mask) {
+        return;
+    }
+    auto* header = state->xsave_header;
+    *reinterpret_cast<uint64_t*>(&header[0]) &= mask;
+    for (size_t i = 8; i < sched::FPU_XSAVE_HEADER_SIZE; i++) {
+        header[i] = 0;
+    }
+}
+
 } // namespace fpu
 
 #endif // STELLUX_ARCH_X86_64_SCHED_FPU_H
@@ -5,10 +5,23 @@
 
 namespace sched {
 
-struct alignas(16) fpu_state {
-    uint8_t fxsave_area[512];
+// XSAVE area layout: the legacy FXSAVE region, the XSAVE header, then
+// the extended components. XCR0 only enables components that fit, so
+// the area holds x87, SSE and the AVX upper halves (YMM_Hi128).
+constexpr size_t FPU_LEGACY_SIZE       = 512;
+constexpr size_t FPU_XSAVE_HEADER_SIZE = 64;
+constexpr size_t FPU_EXT_SIZE          = 256;
+constexpr size_t FPU_AREA_SIZE = FPU_LEGACY_SIZE + FPU_XSAVE_HEADER_SIZE + FPU_EXT_SIZE;
+
+// XSAVE/XRSTOR fault on an area that is not 64-byte aligned
+struct alignas(64) fpu_state {
+    uint8_t fxsave_area[FPU_LEGACY_SIZE];
+    uint8_t xsave_header[FPU_XSAVE_HEADER_SIZE];
+    uint8_t ext_area[FPU_EXT_SIZE];
 };
 
+static_assert(sizeof(fpu_state) == FPU_AREA_SIZE);
+
 } // namespace sched
 
 #endif // STELLUX_ARCH_X86_64_SCHED_FPU_STATE_H
@@ -14,6 +14,7 @@
 #include "gdt/gdt.h"
 #include "hw/cpu.h"
 #include "mm/paging.h"
+#include "rc/rcu.h"
 #include "common/logging.h"
 
 extern "C" char stack_top[];
@@ -34,10 +35,10 @@ static task_exec_core g_boot_exec = {
     .pt_root = 0,
     .user_pt_root = 0,
     .mm_ctx = nullptr,
-    .fpu_ctx = {},
     .tls_base = 0,
     .iret_pending = 0,
     .iret_ctx = {},
+    .fpu_ctx = {},
 };
 
 /**
@@ -164,6 +165,8 @@ __PRIVILEGED_CODE void on_yield(x86::trap_frame* tf) {
     task* prev = current();
     // Advance per-CPU sync epoch so stack reclaim can wait for a post-switch TLB-safe point.
     advance_cpu_tlb_sync_epoch();
+    // Read-side sections mask IRQs and never yield, none spans this trap
+    rc::rcu::note_quiescent_state();
     // Publish prior switched-out task as off-CPU before we start a new scheduling decision.
     finalize_pending_off_cpu();
 
@@ -207,6 +210,8 @@ __PRIVILEGED_CODE void on_tick(x86::trap_frame* tf) {
     task* prev = current();
     // Each scheduler trap is a synchronization checkpoint for deferred reclaim logic.
     advance_cpu_tlb_sync_epoch();
+    // Read-side sections mask IRQs and never yield, none spans this trap
+    rc::rcu::note_quiescent_state();
     // Finish prior off-CPU publication before handling this tick's switch.
     finalize_pending_off_cpu();
     record_cpu_tick(prev);
@@ -103,10 +103,10 @@ __PRIVILEGED_CODE int32_t build_signal_frame(syscall_frame* ctx, uint32_t sig,
         return -1;
     }
 
-    // FXSAVE image above the frame, frame base at RSP % 16 == 8 so the
+    // FP image above the frame (64-byte aligned for XSAVE), frame base at RSP % 16 == 8 so the
     // handler entry sees the ABI-required alignment after its return slot.
     uint64_t sp = ctx->rsp - RED_ZONE;
-    uint64_t fpstate = align_down(sp - sizeof(sched::fpu_state), 16);
+    uint64_t fpstate = align_down(sp - sizeof(sched::fpu_state), alignof(sched::fpu_state));
     uint64_t frame_addr = align_down(fpstate - sizeof(rt_sigframe), 16) - 8;
 
     rt_sigframe* frame = heap::kalloc_new<rt_sigframe>();
@@ -118,7 +118,7 @@ __PRIVILEGED_CODE int32_t build_signal_frame(syscall_frame* ctx, uint32_t sig,
     frame->pretcode = act->restorer;
 
     sched::fpu_state fp;
-    fpu::save(&fp);
+    fpu::save_user(&fp);
 
     int32_t rc = mm::uaccess::copy_to_user(
         reinterpret_cast<void*>(frame_addr), frame, sizeof(*frame));
@@ -176,15 +176,15 @@ __PRIVILEGED_CODE int64_t restore_signal_frame(syscall_frame* ctx) {
     int64_t resume = full ? 0
         : static_cast<int64_t>(frame->uc.uc_mcontext.rax);
     if (fpstate) {
-        // A bad FXSAVE pointer is a corrupt frame, kill like the other paths
+        // A bad FP image pointer is a corrupt frame, kill like the other paths
         sched::fpu_state fp;
         if (mm::uaccess::copy_from_user(
                 &fp, reinterpret_cast<void*>(fpstate), sizeof(fp)) != mm::uaccess::OK) {
             heap::kfree_delete(frame);
             signals::die_from_signal(signals::SIGSEGV);
         }
-        fpu::sanitize_user_mxcsr(&fp);
-        fpu::restore(&fp);
+        fpu::sanitize_user_state(&fp);
+        fpu::restore_user(&fp);
     }
 
     if (full) {
@@ -285,7 +285,7 @@ __PRIVILEGED_CODE static int32_t build_signal_frame_async(
     }
 
     uint64_t sp = tf->rsp - RED_ZONE;
-    uint64_t fpstate = align_down(sp - sizeof(sched::fpu_state), 16);
+    uint64_t fpstate = align_down(sp - sizeof(sched::fpu_state), alignof(sched::fpu_state));
     uint64_t frame_addr = align_down(fpstate - sizeof(rt_sigframe), 16) - 8;
 
     rt_sigframe* frame = heap::kalloc_new<rt_sigframe>();
@@ -297,7 +297,7 @@ __PRIVILEGED_CODE static int32_t build_signal_frame_async(
     frame->pretcode = act->restorer;
 
     sched::fpu_state fp;
-    fpu::save(&fp);
+    fpu::save_user(&fp);
 
     int32_t rc = mm::uaccess::copy_to_user_nonblock(
         reinterpret_cast<void*>(frame_addr), frame, sizeof(*frame));
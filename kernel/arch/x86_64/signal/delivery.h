@@ -13,7 +13,7 @@ namespace x86 {
 /**
  * @brief Fill a zeroed kernel-local signal frame from interrupted state.
  * Pure register marshaling with no user access, so it is unit-testable.
- * user_fpstate is the user address the FXSAVE image will occupy, and the
+ * user_fpstate is the user address the FP image will occupy, and the
  * caller must have zeroed the frame so no kernel stack data leaks out.
  * @note Privilege: **required**
  */
@@ -40,7 +40,7 @@ struct sigcontext {
     uint64_t eflags; // gregs[17]
     uint16_t cs, gs, fs, ss; // gregs[18], packed as csgsfs
     uint64_t err, trapno, oldmask, cr2; // gregs[19..22]
-    uint64_t fpstate; // address of a 512-byte FXSAVE image, 0 if none
+    uint64_t fpstate; // address of an FXSAVE/XSAVE image (sched::fpu_state), 0 if none
     uint64_t __reserved1[8];
 };
 
@@ -66,7 +66,7 @@ static_assert(__builtin_offsetof(ucontext, uc_mcontext) == 0x28);
 static_assert(__builtin_offsetof(ucontext, uc_sigmask) == 0x128);
 static_assert(sizeof(ucontext) == 304);
 
-// Written to the user stack at delivery. The FXSAVE image sits separately
+// Written to the user stack at delivery. The FP image sits separately
 // above the frame, which needs stricter alignment than the frame base.
 struct rt_sigframe {
     uint64_t pretcode; // restorer address, the handler's return address
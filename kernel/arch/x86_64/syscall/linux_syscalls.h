@@ -48,6 +48,7 @@ constexpr uint64_t SETSOCKOPT       = 54;
 constexpr uint64_t GETSOCKOPT       = 55;
 constexpr uint64_t CLONE            = 56;
 constexpr uint64_t EXIT             = 60;
+constexpr uint64_t WAIT4            = 61;
 constexpr uint64_t KILL             = 62;
 constexpr uint64_t UNAME            = 63;
 constexpr uint64_t FCNTL            = 72;
@@ -62,6 +63,7 @@ constexpr uint64_t RMDIR            = 84;
 constexpr uint64_t UNLINK           = 87;
 constexpr uint64_t READLINK         = 89;
 constexpr uint64_t GETTIMEOFDAY     = 96;
+constexpr uint64_t GETRUSAGE        = 98;
 constexpr uint64_t GETUID           = 102;
 constexpr uint64_t GETGID           = 104;
 constexpr uint64_t GETEUID          = 107;
@@ -92,6 +94,7 @@ constexpr uint64_t DUP3             = 292;
 constexpr uint64_t PIPE2            = 293;
 constexpr uint64_t GETRANDOM        = 318;
 constexpr uint64_t MEMFD_CREATE     = 319;
+constexpr uint64_t FUTEX_WAITV      = 449;
 
 } // namespace syscall::linux_nr
 
@@ -1,34 +1,18 @@
 #include "timer/timer.h"
-#include "sched/task.h"
-#include "sched/sched.h"
-#include "clock/clock.h"
+#include "timer/timer_internal.h"
 #include "irq/irq.h"
 #include "irq/irq_arch.h"
 #include "defs/vectors.h"
 #include "hw/portio.h"
 #include "hw/mmio.h"
 #include "hw/cpu.h"
-#include "percpu/percpu.h"
-#include "sync/spinlock.h"
-#include "common/list.h"
 #include "common/logging.h"
 
 namespace timer {
 
 constexpr uint64_t NS_PER_SEC = 1000000000ULL;
 
-struct timer_cpu_state {
-    sync::spinlock lock;
-    uint64_t tick_interval_ns;
-    uint64_t next_tick_ns;
-    uint64_t programmed_ns;
-    list::head<sched::task, &sched::task::timer_link> sleep_queue;
-};
-
-static DEFINE_PER_CPU(timer_cpu_state, cpu_timer_state);
-
 __PRIVILEGED_BSS static uint64_t g_lapic_freq;
-__PRIVILEGED_BSS static uint32_t g_tick_hz;
 __PRIVILEGED_BSS static uint64_t g_inv_mult;
 __PRIVILEGED_BSS static uint32_t g_inv_shift;
 
@@ -98,26 +82,10 @@ __PRIVILEGED_CODE static uint64_t ns_to_lapic_ticks(uint64_t ns) {
     );
 }
 
-/**
- * Program LAPIC one-shot timer for the given absolute deadline.
- * @note Privilege: **required**
- */
-__PRIVILEGED_CODE static void program_oneshot(uint64_t deadline_ns) {
-    uint64_t now = clock::now_ns();
-    uint64_t delta_ns = (deadline_ns > now) ? (deadline_ns - now) : 0;
-
-    uint64_t ticks = ns_to_lapic_ticks(delta_ns);
-    uint32_t count = (ticks > 0xFFFFFFFF) ? 0xFFFFFFFF : static_cast<uint32_t>(ticks);
-    if (count == 0) count = 1;
-
-    uintptr_t lapic = irq::get_lapic_va();
-    mmio::write32(lapic + irq::LAPIC_TIMER_ICR, count);
-}
-
 /**
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE int32_t init(uint32_t hz) {
+__PRIVILEGED_CODE int32_t arch_init(uint32_t hz) {
     uintptr_t lapic = irq::get_lapic_va();
     if (!lapic) {
         log::error("timer: LAPIC not initialized");
@@ -137,21 +105,6 @@ __PRIVILEGED_CODE int32_t init(uint32_t hz) {
                   irq::LVT_MASKED | x86::VEC_TIMER);
     mmio::write32(lapic + irq::LAPIC_TIMER_DCR, 0x7);
 
-    // Initialize per-CPU timer state
-    timer_cpu_state& state = this_cpu(cpu_timer_state);
-    state.lock = sync::SPINLOCK_INIT;
-    state.tick_interval_ns = NS_PER_SEC / hz;
-    state.next_tick_ns = clock::now_ns() + state.tick_interval_ns;
-    state.programmed_ns = state.next_tick_ns;
-    state.sleep_queue.init();
-
-    // Program first tick and unmask
-    g_tick_hz = hz;
-    program_oneshot(state.next_tick_ns);
-    mmio::write32(lapic + irq::LAPIC_LVT_TIMER, x86::VEC_TIMER);
-
-    cpu::irq_enable();
-
     log::info("timer: LAPIC freq=%lu Hz, one-shot at %u Hz", g_lapic_freq, hz);
 
     return OK;
@@ -160,14 +113,7 @@ __PRIVILEGED_CODE int32_t init(uint32_t hz) {
 /**
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE uint32_t tick_hz() {
-    return g_tick_hz;
-}
-
-/**
- * @note Privilege: **required**
- */
-__PRIVILEGED_CODE int32_t init_ap(uint32_t hz) {
+__PRIVILEGED_CODE int32_t arch_init_ap() {
     uintptr_t lapic = irq::get_lapic_va();
     if (!lapic || g_lapic_freq == 0) {
         return ERR;
@@ -177,115 +123,49 @@ __PRIVILEGED_CODE int32_t init_ap(uint32_t hz) {
                   irq::LVT_MASKED | x86::VEC_TIMER);
     mmio::write32(lapic + irq::LAPIC_TIMER_DCR, 0x7);
 
-    timer_cpu_state& state = this_cpu(cpu_timer_state);
-    state.lock = sync::SPINLOCK_INIT;
-    state.tick_interval_ns = NS_PER_SEC / hz;
-    state.next_tick_ns = clock::now_ns() + state.tick_interval_ns;
-    state.programmed_ns = state.next_tick_ns;
-    state.sleep_queue.init();
-
-    program_oneshot(state.next_tick_ns);
-    mmio::write32(lapic + irq::LAPIC_LVT_TIMER, x86::VEC_TIMER);
-
-    cpu::irq_enable();
-
     return OK;
 }
 
 /**
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void stop() {
+__PRIVILEGED_CODE void arch_start() {
     uintptr_t lapic = irq::get_lapic_va();
-    if (!lapic) return;
-
-    uint32_t lvt = mmio::read32(lapic + irq::LAPIC_LVT_TIMER);
-    mmio::write32(lapic + irq::LAPIC_LVT_TIMER, lvt | irq::LVT_MASKED);
-    mmio::write32(lapic + irq::LAPIC_TIMER_ICR, 0);
+    mmio::write32(lapic + irq::LAPIC_LVT_TIMER, x86::VEC_TIMER);
 }
 
 /**
+ * Program the LAPIC one-shot timer delta_ns from now.
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE bool on_interrupt() {
-    timer_cpu_state& state = this_cpu(cpu_timer_state);
-    sync::irq_state irq = sync::spin_lock_irqsave(state.lock);
-
-    uint64_t now = clock::now_ns();
-
-    if (now == 0) {
-        uint64_t ticks = ns_to_lapic_ticks(state.tick_interval_ns);
-        uint32_t count = (ticks > 0xFFFFFFFF) ? 0xFFFFFFFF
-                       : (ticks == 0)         ? 1
-                       : static_cast<uint32_t>(ticks);
-        uintptr_t lapic = irq::get_lapic_va();
-        mmio::write32(lapic + irq::LAPIC_TIMER_ICR, count);
-        sync::spin_unlock_irqrestore(state.lock, irq);
-        return true;
-    }
-
-    while (!state.sleep_queue.empty()) {
-        sched::task* t = state.sleep_queue.front();
-        if (t->timer_deadline > now) break;
-        state.sleep_queue.pop_front();
-        t->timer_deadline = 0;
-        sched::wake(t);
-    }
-
-    bool tick_expired = (now >= state.next_tick_ns);
-    if (tick_expired) {
-        state.next_tick_ns += state.tick_interval_ns;
-        if (state.next_tick_ns <= now) {
-            state.next_tick_ns = now + state.tick_interval_ns;
-        }
-    }
-
-    uint64_t next_event = state.next_tick_ns;
-    if (!state.sleep_queue.empty()) {
-        uint64_t front_deadline = state.sleep_queue.front()->timer_deadline;
-        if (front_deadline < next_event) {
-            next_event = front_deadline;
-        }
-    }
-
-    state.programmed_ns = next_event;
-    program_oneshot(next_event);
-
-    sync::spin_unlock_irqrestore(state.lock, irq);
+__PRIVILEGED_CODE void arch_program(uint64_t delta_ns) {
+    uint64_t ticks = ns_to_lapic_ticks(delta_ns);
+    uint32_t count = (ticks > 0xFFFFFFFF) ? 0xFFFFFFFF : static_cast<uint32_t>(ticks);
+    if (count == 0) count = 1;
 
-    return tick_expired;
+    uintptr_t lapic = irq::get_lapic_va();
+    mmio::write32(lapic + irq::LAPIC_TIMER_ICR, count);
 }
 
 /**
+ * Disarm the LAPIC one-shot timer, writing a zero initial count stops it.
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void schedule_sleep(sched::task* t, uint64_t deadline_ns) {
-    timer_cpu_state& state = this_cpu(cpu_timer_state);
-    sync::irq_state irq = sync::spin_lock_irqsave(state.lock);
-
-    t->timer_deadline = deadline_ns;
-    state.sleep_queue.insert_sorted(t,
-        [](sched::task* a, sched::task* b) {
-            return a->timer_deadline < b->timer_deadline;
-        });
-
-    if (deadline_ns < state.programmed_ns) {
-        state.programmed_ns = deadline_ns;
-        program_oneshot(deadline_ns);
-    }
-
-    sync::spin_unlock_irqrestore(state.lock, irq);
+__PRIVILEGED_CODE void arch_disarm() {
+    uintptr_t lapic = irq::get_lapic_va();
+    mmio::write32(lapic + irq::LAPIC_TIMER_ICR, 0);
 }
 
-__PRIVILEGED_CODE void cancel_sleep(sched::task* t) {
-    uint32_t cpu = __atomic_load_n(&t->exec.cpu, __ATOMIC_RELAXED);
-    timer_cpu_state& state = per_cpu_on(cpu_timer_state, cpu);
-    sync::irq_state irq = sync::spin_lock_irqsave(state.lock);
-    if (t->timer_link.is_linked()) {
-        state.sleep_queue.remove(t);
-        t->timer_deadline = 0;
-    }
-    sync::spin_unlock_irqrestore(state.lock, irq);
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void stop() {
+    uintptr_t lapic = irq::get_lapic_va();
+    if (!lapic) return;
+
+    uint32_t lvt = mmio::read32(lapic + irq::LAPIC_LVT_TIMER);
+    mmio::write32(lapic + irq::LAPIC_LVT_TIMER, lvt | irq::LVT_MASKED);
+    mmio::write32(lapic + irq::LAPIC_TIMER_ICR, 0);
 }
 
 } // namespace timer
@@ -12,6 +12,8 @@
 #include "sched/task.h"
 #include "signals/signal.h"
 #include "mm/mm.h"
+#include "profile/profile.h"
+#include "trace/trace.h"
 
 namespace sched {
 __PRIVILEGED_CODE void on_yield(x86::trap_frame* tf);
@@ -68,8 +70,11 @@ extern "C" __PRIVILEGED_CODE void stlx_x86_64_trap_handler(x86::trap_frame* tf)
     }
 
     if (tf->vector == x86::VEC_TIMER) {
+        trace::irq_scope irq_trace(tf->vector);
         irq::eoi(0);
         bool tick = timer::on_interrupt();
+        profile::on_timer_interrupt(tf->rip, tf->rbp, in_user_code,
+                                    (irq_task_core->flags & sched::TASK_FLAG_ELEVATED) != 0);
         if (tick) {
             sched::on_tick(tf);
         }
@@ -79,7 +84,18 @@ extern "C" __PRIVILEGED_CODE void stlx_x86_64_trap_handler(x86::trap_frame* tf)
         return;
     }
 
+    if (tf->vector == x86::VEC_RESCHED) {
+        trace::irq_scope irq_trace(tf->vector);
+        irq::eoi(0);
+        // A task was made runnable here while this CPU was idle
+        sched::on_tick(tf);
+        irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
+        restore_post_trap_elevation_state();
+        return;
+    }
+
     if (tf->vector == x86::VEC_SERIAL) {
+        trace::irq_scope irq_trace(tf->vector);
         irq::eoi(0);
         serial::on_rx_irq();
         irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
@@ -89,6 +105,7 @@ extern "C" __PRIVILEGED_CODE void stlx_x86_64_trap_handler(x86::trap_frame* tf)
 
     if (tf->vector >= x86::VEC_MSI_BASE &&
         tf->vector < x86::VEC_MSI_BASE + msi::capacity()) {
+        trace::irq_scope irq_trace(tf->vector);
         irq::eoi(0);
         msi::dispatch(static_cast<uint32_t>(tf->vector - x86::VEC_MSI_BASE));
         irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
@@ -105,7 +122,10 @@ extern "C" __PRIVILEGED_CODE void stlx_x86_64_trap_handler(x86::trap_frame* tf)
         if (ec & 0x2)  pf_flags |= mm::PF_FLAG_WRITE;
         if (ec & 0x10) pf_flags |= mm::PF_FLAG_INSTRUCTION;
 
-        if (mm::handle_user_pf(irq_task_core->mm_ctx, fault_addr, pf_flags)) {
+        bool resolved = mm::handle_user_pf(irq_task_core->mm_ctx, fault_addr, pf_flags);
+        TRACE(PAGE_FAULT, fault_addr, tf->rip,
+              pf_flags | (resolved ? trace::PF_RESOLVED : 0));
+        if (resolved) {
             // Fault has been handled successfully, restart instruction
             irq_task_core->flags &= ~sched::TASK_FLAG_IN_IRQ;
             restore_post_trap_elevation_state();
@@ -11,11 +11,13 @@
 #include "sched/sched.h"
 #include "rc/reaper.h"
 #include "smp/smp.h"
+#include "workqueue/workqueue.h"
 #include "debug/debug.h"
 #include "sched/task.h"
 #include "fs/fs.h"
 #include "exec/elf.h"
 #include "syscall/syscall_table.h"
+#include "syscall/syscall_stats.h"
 #include "terminal/terminal.h"
 #include "hw/rtc.h"
 #include "pci/pci.h"
@@ -28,10 +30,15 @@
 #include "net/net.h"
 #include "random/random.h"
 #include "sysstat/sysstat.h"
+#include "profile/profile.h"
+#include "trace/trace.h"
+#include "strace/strace.h"
+#include "kmsg/kmsg.h"
 #include "sync/futex.h"
 
 #ifdef STLX_UNIT_TESTS_ENABLED
 #include "runner.h"
+#include "bench_runner.h"
 #endif
 
 /**
@@ -123,6 +130,18 @@ extern "C" __PRIVILEGED_CODE void stlx_init() {
         log::warn("sysstat::init failed, /dev/sysinfo unavailable");
     }
 
+    if (profile::init() != profile::OK) {
+        log::warn("profile::init failed, /dev/profile unavailable");
+    }
+
+    if (trace::init() != trace::OK) {
+        log::warn("trace::init failed, /dev/trace unavailable");
+    }
+
+    if (strace::init() != strace::OK) {
+        log::warn("strace::init failed, /dev/strace unavailable");
+    }
+
     if (terminal::init() != terminal::OK) {
         log::warn("terminal::init failed");
     }
@@ -149,12 +168,30 @@ extern "C" __PRIVILEGED_CODE void stlx_init() {
         log::warn("smp::init failed, continuing with single CPU");
     }
 
+#ifdef STLX_SYSCALL_STATS
+    if (syscall::init_stats() != syscall::OK) {
+        log::warn("syscall::init_stats failed, syscalls are not counted");
+    }
+#endif
+
+    if (workqueue::init() != workqueue::OK) {
+        log::fatal("workqueue::init failed");
+    }
+
+    if (kmsg::init() != kmsg::OK) {
+        log::warn("kmsg::init failed, logging stays synchronous");
+    }
+
     if (net::init() != net::OK) {
         log::warn("net::init failed, networking unavailable");
     }
 
 #ifdef STLX_UNIT_TESTS_ENABLED
+#ifdef STLX_BENCH_ENABLED
+    stlx_bench::run_all();
+#else
     stlx_test::run_all();
+#endif
     while (true) {
         cpu::halt();
     }
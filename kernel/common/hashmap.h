@@ -28,7 +28,8 @@
  *   table.insert(&item);
  *   my_item* found = table.find(42);
  *
- * Thread safety: none. Caller must synchronize concurrent access.
+ * Thread safety: none. Caller must synchronize concurrent access, or use
+ * the *_rcu operations for lock-free readers (see rc/rcu.h).
  */
 
 #ifndef STELLUX_COMMON_HASHMAP_H
@@ -126,6 +127,60 @@ public:
         --m_count;
     }
 
+    // RCU variants: writers still serialize among themselves, readers
+    // use find_rcu/for_each_rcu with no lock. insert_rcu publishes the
+    // node with release ordering; remove_rcu keeps the removed node's
+    // next pointer so a reader standing on it can finish its walk, the
+    // node must outlive a grace period before it is reused or freed.
+    void insert_rcu(T* entry) {
+        if (!m_buckets) return;
+        node* n = to_node(entry);
+        uint64_t h = KeyOps::hash(KeyOps::key_of(*entry));
+        uint32_t idx = static_cast<uint32_t>(h) & m_mask;
+        bucket& b = m_buckets[idx];
+
+        n->next = b.first;
+        n->pprev = &b.first;
+        if (b.first) b.first->pprev = &n->next;
+        __atomic_store_n(&b.first, n, __ATOMIC_RELEASE);
+        ++m_count;
+    }
+
+    void remove_rcu(T& entry) {
+        node* n = to_node(entry);
+        __atomic_store_n(n->pprev, n->next, __ATOMIC_RELEASE);
+        if (n->next) n->next->pprev = n->pprev;
+        n->pprev = nullptr;
+        --m_count;
+    }
+
+    [[nodiscard]] T* find_rcu(const key_type& key) const {
+        if (!m_buckets) return nullptr;
+        uint64_t h = KeyOps::hash(key);
+        uint32_t idx = static_cast<uint32_t>(h) & m_mask;
+        node* cur = __atomic_load_n(&m_buckets[idx].first, __ATOMIC_ACQUIRE);
+        while (cur) {
+            T* entry = to_entry(cur);
+            if (KeyOps::equal(KeyOps::key_of(*entry), key)) {
+                return entry;
+            }
+            cur = __atomic_load_n(&cur->next, __ATOMIC_ACQUIRE);
+        }
+        return nullptr;
+    }
+
+    template<typename Fn>
+    void for_each_rcu(Fn fn) const {
+        if (!m_buckets) return;
+        for (uint32_t i = 0; i <= m_mask; ++i) {
+            node* cur = __atomic_load_n(&m_buckets[i].first, __ATOMIC_ACQUIRE);
+            while (cur) {
+                fn(*to_entry(cur));
+                cur = __atomic_load_n(&cur->next, __ATOMIC_ACQUIRE);
+            }
+        }
+    }
+
     // Unlink all entries without freeing (entries are caller-owned).
     void clear() {
         if (!m_buckets) return;
@@ -5,6 +5,7 @@
 #include "hw/cpu.h"
 #include "sync/spinlock.h"
 #include "dynpriv/dynpriv.h"
+#include "kmsg/kmsg.h"
 
 namespace log {
 
@@ -38,25 +39,57 @@ static void output(const char* str, size_t len) {
     }
 }
 
-static void output_char(char c) {
-    output(&c, 1);
-}
-
 static void output_str(const char* s) {
     output(s, string::strlen(s));
 }
 
-// Number to string conversion buffer
-// NOTE: Not thread-safe - will need per-CPU buffers or stack allocation for SMP
-static char num_buffer[65]; // Enough for 64-bit binary + null
+/**
+ * Formatting target: a bounded line buffer, or the backend itself when
+ * buf is null. Output past cap is dropped, truncating the line.
+ */
+struct sink {
+    char*  buf;
+    size_t len;
+    size_t cap;
+};
+
+static void put(sink& s, const char* str, size_t len) {
+    if (!s.buf) {
+        output(str, len);
+        return;
+    }
+    size_t room = s.cap - s.len;
+    if (len > room) {
+        len = room;
+    }
+    string::memcpy(s.buf + s.len, str, len);
+    s.len += len;
+}
+
+static void put_char(sink& s, char c) {
+    put(s, &c, 1);
+}
+
+static void put_str(sink& s, const char* str) {
+    put(s, str, string::strlen(str));
+}
+
+// Digits are built from the end of a caller buffer, so concurrent
+// formatters never share one
+constexpr size_t NUM_BUFFER_SIZE = 66; // 64 binary digits, sign, null
 
 // Convert unsigned integer to string with given base
-static const char* utoa(uint64_t value, int base, bool uppercase, int width, char pad) {
+static const char* utoa(char* buf, uint64_t value, int base, bool uppercase, int width, char pad) {
     static const char digits_lower[] = "0123456789abcdef";
     static const char digits_upper[] = "0123456789ABCDEF";
     const char* digits = uppercase ? digits_upper : digits_lower;
-    
-    char* p = num_buffer + sizeof(num_buffer) - 1;
+
+    // Leave room for a sign in front of the padded digits
+    if (width > static_cast<int>(NUM_BUFFER_SIZE) - 2) {
+        width = static_cast<int>(NUM_BUFFER_SIZE) - 2;
+    }
+
+    char* p = buf + NUM_BUFFER_SIZE - 1;
     *p = '\0';
     
     int digit_count = 0;
@@ -76,11 +109,12 @@ static const char* utoa(uint64_t value, int base, bool uppercase, int width, cha
 }
 
 // Convert signed integer to string
-static const char* itoa(int64_t value, int width, char pad) {
+static const char* itoa(char* buf, int64_t value, int width, char pad) {
     bool negative = value < 0;
     uint64_t abs_value = negative ? -static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
     
-    const char* str = utoa(abs_value, 10, false, negative ? (width > 0 ? width - 1 : 0) : width, pad);
+    const char* str = utoa(buf, abs_value, 10, false,
+                           negative ? (width > 0 ? width - 1 : 0) : width, pad);
     
     if (negative) {
         // Find start of string and prepend minus
@@ -92,11 +126,12 @@ static const char* itoa(int64_t value, int width, char pad) {
     return str;
 }
 
-// Core format engine -- processes format string and outputs via output()/output_char()
-static void vformat(const char* fmt, va_list args) {
+// Core format engine -- processes format string and writes it to out
+static void vformat(sink& out, const char* fmt, va_list args) {
+    char num[NUM_BUFFER_SIZE];
     while (*fmt) {
         if (*fmt != '%') {
-            output_char(*fmt);
+            put_char(out, *fmt);
             fmt++;
             continue;
         }
@@ -150,7 +185,7 @@ static void vformat(const char* fmt, va_list args) {
                 } else {
                     val = va_arg(args, int);
                 }
-                output_str(itoa(val, width, pad));
+                put_str(out, itoa(num, val, width, pad));
                 break;
             }
 
@@ -163,7 +198,7 @@ static void vformat(const char* fmt, va_list args) {
                 } else {
                     val = va_arg(args, unsigned int);
                 }
-                output_str(utoa(val, 10, false, width, pad));
+                put_str(out, utoa(num, val, 10, false, width, pad));
                 break;
             }
 
@@ -177,14 +212,14 @@ static void vformat(const char* fmt, va_list args) {
                 } else {
                     val = va_arg(args, unsigned int);
                 }
-                output_str(utoa(val, 16, *fmt == 'X', width, pad));
+                put_str(out, utoa(num, val, 16, *fmt == 'X', width, pad));
                 break;
             }
 
             case 'p': {
                 uintptr_t val = reinterpret_cast<uintptr_t>(va_arg(args, void*));
-                output_str("0x");
-                output_str(utoa(val, 16, false, sizeof(void*) * 2, '0'));
+                put_str(out, "0x");
+                put_str(out, utoa(num, val, 16, false, sizeof(void*) * 2, '0'));
                 break;
             }
 
@@ -199,16 +234,16 @@ static void vformat(const char* fmt, va_list args) {
                 }
                 // Pad with spaces if width specified
                 while (width > 0 && static_cast<int>(len) < width) {
-                    output_char(' ');
+                    put_char(out, ' ');
                     width--;
                 }
-                output(s, len);
+                put(out, s, len);
                 break;
             }
 
             case 'c': {
                 char c = static_cast<char>(va_arg(args, int));
-                output_char(c);
+                put_char(out, c);
                 break;
             }
 
@@ -219,17 +254,17 @@ static void vformat(const char* fmt, va_list args) {
                 } else {
                     val = va_arg(args, unsigned int);
                 }
-                output_str(utoa(val, 2, false, width, pad));
+                put_str(out, utoa(num, val, 2, false, width, pad));
                 break;
             }
 
             case '%':
-                output_char('%');
+                put_char(out, '%');
                 break;
 
             default:
-                output_char('%');
-                output_char(*fmt);
+                put_char(out, '%');
+                put_char(out, *fmt);
                 break;
         }
 
@@ -237,13 +272,35 @@ static void vformat(const char* fmt, va_list args) {
     }
 }
 
+/**
+ * Format one line. Once kmsg is up the line is formatted straight into a
+ * slot of this CPU's ring for klogd to write out, before that it goes to
+ * the backend under the log lock. level::none lines have no prefix.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void vlog_elevated(level lvl, const char* fmt, va_list args) {
+    if (kmsg::ready()) {
+        char* text = nullptr;
+        void* handle = kmsg::reserve(static_cast<uint8_t>(lvl), &text);
+        if (handle) {
+            sink line = {text, 0, kmsg::LINE_MAX};
+            vformat(line, fmt, args);
+            kmsg::commit(handle, line.len);
+        }
+        return;
+    }
+
+    sync::irq_lock_guard guard(g_log_lock);
+    sink direct = {nullptr, 0, 0};
+    if (lvl != level::none) {
+        put_str(direct, level_prefixes[static_cast<int>(lvl)]);
+    }
+    vformat(direct, fmt, args);
+    put_str(direct, "\r\n");
+}
+
 static void vlog(level lvl, const char* fmt, va_list args) {
-    RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_log_lock);
-        output_str(level_prefixes[static_cast<int>(lvl)]);
-        vformat(fmt, args);
-        output_str("\r\n");
-    });
+    RUN_ELEVATED(vlog_elevated(lvl, fmt, args));
 }
 
 void debug(const char* fmt, ...) {
@@ -274,7 +331,7 @@ void error(const char* fmt, ...) {
     va_end(args);
 }
 
-// Emergency serial output for fatal() — bypasses log_lock and num_buffer.
+// Emergency serial output for fatal() — bypasses log_lock and kmsg.
 // Uses stack-local buffer to avoid races with concurrent formatters.
 static void fatal_serial_char(char c) {
     serial::write(&c, 1);
@@ -364,6 +421,9 @@ static void fatal_vformat(const char* fmt, va_list args) {
     }
     cpu::irq_disable();
 
+    // Lines still queued for klogd come out before the fatal one
+    kmsg::emergency_flush();
+
     fatal_serial_str("[FATAL] ");
     va_list args;
     va_start(args, fmt);
@@ -377,24 +437,38 @@ static void fatal_vformat(const char* fmt, va_list args) {
 }
 
 void raw(const char* fmt, ...) {
-    RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_log_lock);
-        va_list args;
-        va_start(args, fmt);
-        vformat(fmt, args);
-        output_str("\r\n");
-        va_end(args);
-    });
+    va_list args;
+    va_start(args, fmt);
+    vlog(level::none, fmt, args);
+    va_end(args);
 }
 
 void vraw(const char* fmt, va_list args) {
+    vlog(level::none, fmt, args);
+}
+
+void write_line(level lvl, const char* text, size_t len) {
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_log_lock);
-        vformat(fmt, args);
+        // Once logging is asynchronous only klogd and set_backend() take
+        // the lock, so IRQs stay enabled while the line goes out
+        sync::spin_lock(g_log_lock);
+        if (lvl < level::none) {
+            output_str(level_prefixes[static_cast<int>(lvl)]);
+        }
+        output(text, len);
         output_str("\r\n");
+        sync::spin_unlock(g_log_lock);
     });
 }
 
+void emergency_write_line(level lvl, const char* text, size_t len) {
+    if (lvl < level::none) {
+        fatal_serial_str(level_prefixes[static_cast<int>(lvl)]);
+    }
+    serial::write(text, len);
+    fatal_serial_str("\r\n");
+}
+
 void panic_write(const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
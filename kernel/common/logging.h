@@ -51,13 +51,15 @@ void warn(const char* fmt, ...);
 void error(const char* fmt, ...);
 
 /**
- * @brief Log a fatal error and halt the system.
+ * @brief Log a fatal error and halt the system. Always synchronous:
+ * flushes lines still queued in kmsg, then writes straight to serial.
  */
 [[noreturn]] void fatal(const char* fmt, ...);
 
 /**
  * @brief Write formatted output without level prefix. Appends \r\n.
- * Uses current backend (or serial if none set).
+ * Uses current backend (or serial if none set), through klogd once
+ * kmsg::init() has run.
  */
 void raw(const char* fmt, ...);
 
@@ -66,6 +68,18 @@ void raw(const char* fmt, ...);
  */
 void vraw(const char* fmt, va_list args);
 
+/**
+ * @brief Write one already formatted line to the backend with its level
+ * prefix (none for level::none) and \r\n. Used by klogd.
+ */
+void write_line(level lvl, const char* text, size_t len);
+
+/**
+ * @brief write_line() straight to serial, bypassing locks. For crash
+ * paths only, like panic_write().
+ */
+void emergency_write_line(level lvl, const char* text, size_t len);
+
 /**
  * @brief Write formatted output directly to serial, bypassing locks.
  * For use in crash/panic paths only. Caller must have already
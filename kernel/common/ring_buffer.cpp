@@ -80,7 +80,7 @@ __PRIVILEGED_CODE ssize_t ring_buffer_read(ring_buffer* rb, uint8_t* buf, size_t
             return RB_ERR_AGAIN;
         }
         while (readable_bytes(rb) == 0 && !rb->writer_closed && !signals::interrupt_pending(sched::current())) {
-            irq = sync::wait(rb->read_wq, rb->lock, irq);
+            irq = sync::wait_exclusive(rb->read_wq, rb->lock, irq);
         }
     }
 
@@ -106,9 +106,14 @@ __PRIVILEGED_CODE ssize_t ring_buffer_read(ring_buffer* rb, uint8_t* buf, size_t
     }
 
     rb->tail += to_read;
+    // Readers wait exclusively, pass leftover data on to the next one
+    bool more = readable_bytes(rb) != 0;
 
     sync::spin_unlock_irqrestore(rb->lock, irq);
     sync::wake_one(rb->write_wq);
+    if (more) {
+        sync::wake_one(rb->read_wq);
+    }
 
     return static_cast<ssize_t>(to_read);
 }
@@ -129,7 +134,7 @@ __PRIVILEGED_CODE ssize_t ring_buffer_write(ring_buffer* rb, const uint8_t* buf,
             return RB_ERR_AGAIN;
         }
         while (writable_bytes(rb) == 0 && !rb->reader_closed && !signals::interrupt_pending(sched::current())) {
-            irq = sync::wait(rb->write_wq, rb->lock, irq);
+            irq = sync::wait_exclusive(rb->write_wq, rb->lock, irq);
         }
     }
 
@@ -159,9 +164,14 @@ __PRIVILEGED_CODE ssize_t ring_buffer_write(ring_buffer* rb, const uint8_t* buf,
     }
 
     rb->head += to_write;
+    // Writers wait exclusively, pass leftover space on to the next one
+    bool more = writable_bytes(rb) != 0;
 
     sync::spin_unlock_irqrestore(rb->lock, irq);
     sync::wake_one(rb->read_wq);
+    if (more) {
+        sync::wake_one(rb->write_wq);
+    }
 
     return static_cast<ssize_t>(to_write);
 }
@@ -219,9 +229,13 @@ __PRIVILEGED_CODE ssize_t ring_buffer_write_all(ring_buffer* rb, const uint8_t*
     }
 
     rb->head += len;
+    bool more = writable_bytes(rb) != 0;
 
     sync::spin_unlock_irqrestore(rb->lock, irq);
     sync::wake_one(rb->read_wq);
+    if (more) {
+        sync::wake_one(rb->write_wq);
+    }
 
     return static_cast<ssize_t>(len);
 }
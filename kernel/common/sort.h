@@ -0,0 +1,89 @@
+/*
+ * In-place sorting and binary search over plain arrays.
+ *
+ * heap_sort is O(n log n) in the worst case, needs no extra memory and
+ * never recurses, so it is safe on large tables built during boot. It
+ * is not stable; callers that care about ties break them in `less`.
+ *
+ * Usage:
+ *   sort::heap_sort(entries, count, [](const entry& a, const entry& b) {
+ *       return a.addr < b.addr;
+ *   });
+ *   size_t i = sort::upper_bound(entries, count, [&](const entry& e) {
+ *       return addr < e.addr;
+ *   });
+ */
+
+#ifndef STELLUX_COMMON_SORT_H
+#define STELLUX_COMMON_SORT_H
+
+#include "types.h"
+
+namespace sort {
+
+namespace detail {
+
+template <typename T, typename Less>
+void sift_down(T* data, size_t root, size_t count, Less& less) {
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1 < count && less(data[child], data[child + 1])) {
+            child++;
+        }
+        if (!less(data[root], data[child])) {
+            return;
+        }
+        T tmp = data[root];
+        data[root] = data[child];
+        data[child] = tmp;
+        root = child;
+    }
+}
+
+} // namespace detail
+
+/**
+ * Sort data[0..count) ascending by the strict weak ordering less(a, b).
+ */
+template <typename T, typename Less>
+void heap_sort(T* data, size_t count, Less less) {
+    if (count < 2) {
+        return;
+    }
+    for (size_t i = count / 2; i-- > 0;) {
+        detail::sift_down(data, i, count, less);
+    }
+    for (size_t end = count - 1; end > 0; end--) {
+        T tmp = data[0];
+        data[0] = data[end];
+        data[end] = tmp;
+        detail::sift_down(data, 0, end, less);
+    }
+}
+
+/**
+ * Index of the first element of the sorted data[0..count) for which
+ * before(elem) holds, i.e. for which the searched key sorts before the
+ * element. Returns count if there is none.
+ */
+template <typename T, typename Pred>
+size_t upper_bound(const T* data, size_t count, Pred before) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (before(data[mid])) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+} // namespace sort
+
+#endif // STELLUX_COMMON_SORT_H
@@ -1,6 +1,7 @@
 #include "debug/dwarf_line.h"
 #include "debug/leb128.h"
 #include "common/string.h"
+#include "common/sort.h"
 #include "common/logging.h"
 #include "mm/heap.h"
 
@@ -31,15 +32,31 @@ constexpr uint64_t DW_FORM_line_strp = 0x1f;
 constexpr uint64_t DW_FORM_udata     = 0x0f;
 constexpr uint64_t DW_FORM_strp      = 0x11;
 
+/**
+ * One row of the address-ordered line index: addresses from addr up to
+ * the next entry map to file:line. An entry with file == NO_FILE ends a
+ * sequence and maps its range to nothing.
+ */
+struct line_entry {
+    uint64_t addr;
+    uint32_t file; // index into g_files
+    uint32_t line;
+};
+
+constexpr uint32_t NO_FILE = 0xFFFFFFFF;
+
 static const uint8_t* g_debug_line      = nullptr;
 static uint64_t       g_debug_line_size = 0;
 static const char*    g_line_str        = nullptr;
 static uint64_t       g_line_str_size   = 0;
+static line_entry*    g_entries         = nullptr;
+static uint64_t       g_entry_count     = 0;
+static const char**   g_files           = nullptr; // file names of every unit, back to back
+static uint64_t       g_file_count      = 0;
 static bool           g_available       = false;
 
 constexpr uint64_t MAX_FILES = 512;
 constexpr uint64_t MAX_DIRS  = 64;
-constexpr uint64_t MAX_WALK_BYTES = 256 * 1024;
 
 struct format_entry { uint64_t content_type; uint64_t form; };
 
@@ -206,27 +223,65 @@ static bool parse_unit_header(const uint8_t*& p, const uint8_t* unit_end,
     return true;
 }
 
-static const char* get_file_name(const line_unit_context& ctx, uint64_t idx) {
-    if (idx >= ctx.file_count) return nullptr;
-    return ctx.file_names[idx];
-}
+/**
+ * Collects the rows of the line programs. Runs twice over .debug_line,
+ * first with out == nullptr to size the index, then to fill it, so both
+ * passes must make the same decisions. Consecutive rows with the same
+ * file:line merge, and a later row at the same address replaces the
+ * earlier one, as the on-demand walk used to resolve it.
+ */
+struct index_builder {
+    line_entry* out;
+    uint64_t    count;
+    line_entry  last;
+    bool        has_last; // last is a row of the open sequence
+
+    void append(const line_entry& e) {
+        if (out) out[count] = e;
+        count++;
+    }
+
+    void row(uint64_t addr, uint32_t file, uint32_t line) {
+        if (has_last && last.addr == addr) {
+            last.file = file;
+            last.line = line;
+            if (out) out[count - 1] = last;
+            return;
+        }
+        if (has_last && last.file == file && last.line == line) {
+            return;
+        }
+        last = { addr, file, line };
+        has_last = true;
+        append(last);
+    }
 
-static bool run_line_program(const uint8_t* prog, const uint8_t* end,
+    void end(uint64_t addr) {
+        if (has_last) {
+            append({ addr, NO_FILE, 0 });
+        }
+        has_last = false;
+    }
+};
+
+static void run_line_program(const uint8_t* prog, const uint8_t* end,
                              const line_unit_context& ctx,
-                             uint64_t target, resolve_result* out) {
+                             uint64_t file_base, index_builder& b) {
     uint64_t address = 0;
     int64_t  line    = 1;
     uint64_t file    = 0;
-    uint64_t prev_addr = 0;
-    int64_t  prev_line = 1;
-    uint64_t prev_file = 0;
-    bool     has_prev  = false;
+    // Sequences of discarded sections are relocated to address 0
+    bool     live    = false;
 
-    const uint8_t* p = prog;
-    const uint8_t* limit = prog + MAX_WALK_BYTES;
-    if (limit > end) limit = end;
+    auto emit_row = [&]() {
+        if (!live) return;
+        uint32_t idx = file < ctx.file_count && ctx.file_names[file]
+            ? static_cast<uint32_t>(file_base + file) : NO_FILE;
+        b.row(address, idx, static_cast<uint32_t>(line));
+    };
 
-    while (p < end && p < limit) {
+    const uint8_t* p = prog;
+    while (p < end) {
         uint8_t op = read_u8(p, end);
 
         if (op == 0) {
@@ -237,18 +292,16 @@ static bool run_line_program(const uint8_t* prog, const uint8_t* end,
 
             switch (ext_op) {
                 case DW_LNE_end_sequence:
-                    if (has_prev && prev_addr <= target && target < address) {
-                        out->file = get_file_name(ctx, prev_file);
-                        out->line = static_cast<uint32_t>(prev_line);
-                        return out->file != nullptr;
-                    }
+                    if (live) b.end(address);
+                    b.has_last = false;
                     address = 0; line = 1; file = 0;
-                    has_prev = false;
+                    live = false;
                     break;
                 case DW_LNE_set_address:
                     address = (ctx.address_size == 8)
                         ? read_u64(p, ext_end)
                         : read_u32(p, ext_end);
+                    live = address != 0;
                     break;
                 case DW_LNE_set_discriminator:
                     leb128::read_uleb128(p, ext_end);
@@ -260,15 +313,7 @@ static bool run_line_program(const uint8_t* prog, const uint8_t* end,
         } else if (op < ctx.opcode_base) {
             switch (op) {
                 case DW_LNS_copy:
-                    if (has_prev && prev_addr <= target && target < address) {
-                        out->file = get_file_name(ctx, prev_file);
-                        out->line = static_cast<uint32_t>(prev_line);
-                        return out->file != nullptr;
-                    }
-                    prev_addr = address;
-                    prev_line = line;
-                    prev_file = file;
-                    has_prev  = true;
+                    emit_row();
                     break;
                 case DW_LNS_advance_pc:
                     address += ctx.min_inst_length * leb128::read_uleb128(p, end);
@@ -305,27 +350,52 @@ static bool run_line_program(const uint8_t* prog, const uint8_t* end,
             uint64_t addr_adv = adjusted / ctx.line_range;
             int64_t  line_adv = ctx.line_base + (adjusted % ctx.line_range);
 
-            if (has_prev && prev_addr <= target && target < address) {
-                out->file = get_file_name(ctx, prev_file);
-                out->line = static_cast<uint32_t>(prev_line);
-                return out->file != nullptr;
-            }
-            prev_addr = address;
-            prev_line = line;
-            prev_file = file;
-            has_prev  = true;
-
             address += ctx.min_inst_length * addr_adv;
             line    += line_adv;
+            emit_row();
         }
     }
+    // A unit without a final end_sequence leaves its last row open-ended
+    b.has_last = false;
+}
+
+/**
+ * Walk every unit of .debug_line once. With files == nullptr only
+ * counts rows and file slots.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void build_index(index_builder& b, const char** files,
+                                          uint64_t* file_count) {
+    const uint8_t* p   = g_debug_line;
+    const uint8_t* end = g_debug_line + g_debug_line_size;
+
+    uint64_t file_base = 0;
 
-    if (has_prev && prev_addr <= target) {
-        out->file = get_file_name(ctx, prev_file);
-        out->line = static_cast<uint32_t>(prev_line);
-        return out->file != nullptr;
+    while (p < end) {
+        uint32_t unit_length = read_u32(p, end);
+        if (unit_length == 0) break;
+
+        const uint8_t* unit_end = p + unit_length;
+        if (unit_end > end) unit_end = end;
+
+        line_unit_context ctx;
+        string::memset(&ctx, 0, sizeof(ctx));
+
+        if (!parse_unit_header(p, unit_end, ctx)) {
+            p = unit_end;
+            continue;
+        }
+
+        if (files) {
+            for (uint64_t i = 0; i < ctx.file_count; i++)
+                files[file_base + i] = ctx.file_names[i];
+        }
+
+        run_line_program(p, unit_end, ctx, file_base, b);
+        file_base += ctx.file_count;
+        p = unit_end;
     }
-    return false;
+    *file_count = file_base;
 }
 
 __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf) {
@@ -350,43 +420,61 @@ __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf) {
             string::memcpy(str_copy, elf.base + str_shdr->sh_offset, str_size);
     }
 
+    // File names point into these copies, so both stay for the index's lifetime
     g_debug_line      = line_copy;
     g_debug_line_size = line_size;
     g_line_str        = str_copy;
     g_line_str_size   = str_size;
-    g_available       = true;
 
-    log::info("dwarf_line: loaded .debug_line (%lu bytes)", line_size);
+    index_builder counter = {};
+    uint64_t file_count = 0;
+    build_index(counter, nullptr, &file_count);
+
+    auto* entries = reinterpret_cast<line_entry*>(
+        heap::kalloc((counter.count ? counter.count : 1) * sizeof(line_entry)));
+    auto* files = reinterpret_cast<const char**>(
+        heap::kalloc((file_count ? file_count : 1) * sizeof(const char*)));
+    if (!entries || !files) {
+        if (entries) heap::kfree(entries);
+        if (files) heap::kfree(files);
+        return ERR_NO_MEMORY;
+    }
+
+    index_builder filler = {};
+    filler.out = entries;
+    build_index(filler, files, &file_count);
+
+    // Units need not be in address order. At equal addresses a sequence
+    // end sorts first, so the row that starts the next sequence wins.
+    sort::heap_sort(entries, filler.count, [](const line_entry& a, const line_entry& b) {
+        if (a.addr != b.addr) return a.addr < b.addr;
+        return a.file == NO_FILE && b.file != NO_FILE;
+    });
+
+    g_entries     = entries;
+    g_entry_count = filler.count;
+    g_files       = files;
+    g_file_count  = file_count;
+    g_available   = true;
+
+    log::info("dwarf_line: indexed %lu rows from .debug_line (%lu bytes)",
+              filler.count, line_size);
     return OK;
 }
 
 bool resolve(uint64_t addr, resolve_result* out) {
     if (!g_available || !out) return false;
 
-    const uint8_t* p   = g_debug_line;
-    const uint8_t* end = g_debug_line + g_debug_line_size;
-
-    while (p < end) {
-        uint32_t unit_length = read_u32(p, end);
-        if (unit_length == 0) break;
-
-        const uint8_t* unit_end = p + unit_length;
-        if (unit_end > end) unit_end = end;
-
-        line_unit_context ctx;
-        string::memset(&ctx, 0, sizeof(ctx));
-
-        if (!parse_unit_header(p, unit_end, ctx)) {
-            p = unit_end;
-            continue;
-        }
-
-        if (run_line_program(p, unit_end, ctx, addr, out))
-            return true;
+    size_t i = sort::upper_bound(g_entries, g_entry_count, [addr](const line_entry& e) {
+        return addr < e.addr;
+    });
+    if (i == 0) return false;
 
-        p = unit_end;
-    }
-    return false;
+    const line_entry& e = g_entries[i - 1];
+    if (e.file == NO_FILE || e.file >= g_file_count) return false;
+    out->file = g_files[e.file];
+    out->line = e.line;
+    return out->file != nullptr;
 }
 
 } // namespace dwarf_line
@@ -17,14 +17,16 @@ struct resolve_result {
 };
 
 /**
- * @brief Copy .debug_line and .debug_line_str from the kernel ELF into heap.
+ * @brief Copy .debug_line and .debug_line_str from the kernel ELF into heap
+ * and decode every line program once into an address-sorted row index.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf);
 
 /**
- * @brief Resolve an instruction address to file:line by walking the
- * DWARF5 line program on demand. Safe for use in panic paths.
+ * @brief Resolve an instruction address to file:line with a binary search
+ * of the row index. O(log n) and allocation free, so safe for use in
+ * panic paths and in interrupt context.
  */
 bool resolve(uint64_t addr, resolve_result* out);
 
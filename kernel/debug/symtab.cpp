@@ -1,17 +1,35 @@
 #include "debug/symtab.h"
 #include "exec/elf64.h"
 #include "common/string.h"
+#include "common/sort.h"
 #include "common/logging.h"
 #include "mm/heap.h"
 
 namespace symtab {
 
-static elf64::Sym* g_symtab      = nullptr;
+/**
+ * One function symbol of the address-ordered lookup index. Aliases that
+ * share an address collapse into the entry of the first in .symtab order.
+ */
+struct sym_entry {
+    uint64_t addr;
+    uint64_t size;
+    uint32_t name;  // offset into g_strtab
+    uint32_t index; // position in .symtab, orders aliases
+};
+
+static sym_entry*  g_syms        = nullptr;
 static const char* g_strtab      = nullptr;
 static uint64_t    g_sym_count   = 0;
-static uint64_t    g_strtab_size = 0;
 static bool        g_available   = false;
 
+static bool indexable(const elf64::Sym* sym, uint64_t strtab_size) {
+    if (elf64::sym_type(sym) != elf64::STT_FUNC) return false;
+    if (sym->st_shndx == elf64::SHN_UNDEF) return false;
+    if (sym->st_value == 0) return false;
+    return sym->st_name < strtab_size;
+}
+
 __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf) {
     const elf64::Shdr* symtab_shdr = nullptr;
     for (uint16_t i = 0; i < elf.shnum; i++) {
@@ -47,48 +65,74 @@ __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf) {
         return ERR_BAD_ELF;
     }
 
-    auto* sym_copy = reinterpret_cast<elf64::Sym*>(heap::kalloc(symtab_size));
-    if (!sym_copy) {
-        log::warn("symtab: failed to allocate for symbol table");
+    const auto* elf_syms = reinterpret_cast<const elf64::Sym*>(
+        elf.base + symtab_shdr->sh_offset);
+    uint64_t func_count = 0;
+    for (uint64_t i = 0; i < sym_count; i++) {
+        if (indexable(&elf_syms[i], strtab_size)) func_count++;
+    }
+
+    auto* syms = reinterpret_cast<sym_entry*>(
+        heap::kalloc((func_count ? func_count : 1) * sizeof(sym_entry)));
+    if (!syms) {
+        log::warn("symtab: failed to allocate symbol index");
         return ERR_NO_MEMORY;
     }
 
     auto* str_copy = reinterpret_cast<char*>(heap::kalloc(strtab_size));
     if (!str_copy) {
-        heap::kfree(sym_copy);
+        heap::kfree(syms);
         log::warn("symtab: failed to allocate for string table");
         return ERR_NO_MEMORY;
     }
-
-    string::memcpy(sym_copy, elf.base + symtab_shdr->sh_offset, symtab_size);
     string::memcpy(str_copy, elf.base + strtab_shdr->sh_offset, strtab_size);
 
-    g_symtab      = sym_copy;
-    g_strtab      = str_copy;
-    g_sym_count   = sym_count;
-    g_strtab_size = strtab_size;
-    g_available   = true;
+    uint64_t n = 0;
+    for (uint64_t i = 0; i < sym_count; i++) {
+        const elf64::Sym* sym = &elf_syms[i];
+        if (!indexable(sym, strtab_size)) continue;
+        syms[n].addr  = sym->st_value;
+        syms[n].size  = sym->st_size;
+        syms[n].name  = sym->st_name;
+        syms[n].index = static_cast<uint32_t>(i);
+        n++;
+    }
 
-    log::info("symtab: loaded %lu symbols", sym_count);
+    sort::heap_sort(syms, n, [](const sym_entry& a, const sym_entry& b) {
+        return a.addr < b.addr || (a.addr == b.addr && a.index < b.index);
+    });
+
+    // Collapse aliases into the first symbol at each address
+    uint64_t unique = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (unique > 0 && syms[unique - 1].addr == syms[i].addr) {
+            if (syms[i].size > syms[unique - 1].size) {
+                syms[unique - 1].size = syms[i].size;
+            }
+            continue;
+        }
+        syms[unique++] = syms[i];
+    }
+
+    g_syms      = syms;
+    g_strtab    = str_copy;
+    g_sym_count = unique;
+    g_available = true;
+
+    log::info("symtab: indexed %lu functions", unique);
     return OK;
 }
 
 bool resolve(uint64_t addr, resolve_result* out) {
     if (!g_available || !out) return false;
-    const elf64::Sym* best = nullptr;
-    for (uint64_t i = 0; i < g_sym_count; i++) {
-        const elf64::Sym* sym = &g_symtab[i];
-        if (elf64::sym_type(sym) != elf64::STT_FUNC) continue;
-        if (sym->st_shndx == elf64::SHN_UNDEF) continue;
-        if (sym->st_value == 0) continue;
-        if (sym->st_value > addr) continue;
-        if (sym->st_size > 0 && addr >= sym->st_value + sym->st_size) continue;
-        if (!best || sym->st_value > best->st_value) best = sym;
-    }
-    if (!best) return false;
-    if (best->st_name >= g_strtab_size) return false;
-    out->name   = g_strtab + best->st_name;
-    out->offset = addr - best->st_value;
+    size_t i = sort::upper_bound(g_syms, g_sym_count, [addr](const sym_entry& e) {
+        return addr < e.addr;
+    });
+    if (i == 0) return false;
+    const sym_entry& best = g_syms[i - 1];
+    if (best.size > 0 && addr >= best.addr + best.size) return false;
+    out->name   = g_strtab + best.name;
+    out->offset = addr - best.addr;
     return true;
 }
 
@@ -18,14 +18,16 @@ struct resolve_result {
 };
 
 /**
- * @brief Copy .symtab/.strtab from pre-parsed kernel ELF into heap.
+ * @brief Index the function symbols of the pre-parsed kernel ELF by
+ * address and copy .strtab into heap.
  * @return OK on success, negative error code on failure.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t init(const debug::kernel_elf& elf);
 
 /**
- * @brief Resolve a code address to its containing function symbol.
+ * @brief Resolve a code address to its containing function symbol with a
+ * binary search of the index. O(log n) and allocation free.
  * @param addr  Virtual address to resolve.
  * @param out   Result: symbol name and byte offset from symbol start.
  * @return true if a symbol was found, false otherwise.
@@ -558,9 +558,11 @@ void bcm_genet_driver::process_tx_completions() {
 // RX path
 // ============================================================================
 
-void bcm_genet_driver::process_rx() {
+uint32_t bcm_genet_driver::process_rx(uint32_t budget) {
     uint32_t hw_prod = reg_read(RX_DMA_PROD_INDEX(DMA_DEFAULT_QUEUE)) & DMA_INDEX_MASK;
     uint32_t pending = (hw_prod - m_rx_cons_index) & DMA_INDEX_MASK;
+    if (pending > budget)
+        pending = budget;
 
     for (uint32_t i = 0; i < pending; i++) {
         uint16_t idx = m_rx_cons_index % DMA_DESC_COUNT;
@@ -593,6 +595,12 @@ void bcm_genet_driver::process_rx() {
         m_rx_cons_index = (m_rx_cons_index + 1) & DMA_INDEX_MASK;
         reg_write(RX_DMA_CONS_INDEX(DMA_DEFAULT_QUEUE), m_rx_cons_index);
     }
+    return pending;
+}
+
+bool bcm_genet_driver::rx_pending() {
+    uint32_t hw_prod = reg_read(RX_DMA_PROD_INDEX(DMA_DEFAULT_QUEUE)) & DMA_INDEX_MASK;
+    return hw_prod != m_rx_cons_index;
 }
 
 void bcm_genet_driver::rx_remap_descriptor(uint16_t idx) {
@@ -667,7 +675,9 @@ void bcm_genet_driver::isr(uint32_t /* irq */, void* context) {
     if (status != 0)
         drv->reg_write(INTRL2_CPU_CLEAR, status);
 
-    drv->notify_event();
+    // DMA interrupts stay masked until the NAPI poll has drained the ring
+    drv->reg_write(INTRL2_CPU_SET_MASK, IRQ_TXDMA_DONE | IRQ_RXDMA_DONE);
+    net::napi_schedule(&drv->m_napi);
 }
 
 void bcm_genet_driver::enable_interrupts() {
@@ -696,10 +706,35 @@ void bcm_genet_driver::poll_callback(net::netif* iface) {
 
     RUN_ELEVATED({
         sync::irq_lock_guard guard(drv->m_lock);
-        drv->process_rx();
+        drv->process_rx(DMA_DESC_COUNT);
+        drv->process_tx_completions();
+    });
+}
+
+uint32_t bcm_genet_driver::napi_poll(net::napi_struct* napi, uint32_t budget) {
+    auto* drv = static_cast<bcm_genet_driver*>(napi->iface->driver_data);
+
+    uint32_t done = 0;
+    RUN_ELEVATED({
+        sync::irq_lock_guard guard(drv->m_lock);
+        done = drv->process_rx(budget);
         drv->process_tx_completions();
     });
-    RUN_ELEVATED(net::drain_deferred_tx());
+
+    if (done < budget) {
+        RUN_ELEVATED({
+            net::napi_complete(napi);
+            if (drv->m_has_irq)
+                drv->enable_interrupts();
+            // A frame that landed after the last producer index read
+            // raised its interrupt while masked, poll again for it
+            if (drv->rx_pending()) {
+                drv->reg_write(INTRL2_CPU_SET_MASK, IRQ_TXDMA_DONE | IRQ_RXDMA_DONE);
+                net::napi_schedule(napi);
+            }
+        });
+    }
+    return done;
 }
 
 // ============================================================================
@@ -828,6 +863,10 @@ int32_t bcm_genet_driver::attach() {
     rc = dma_map_rx_descriptors();
     if (rc != 0) return rc;
 
+    // The poll function must be ready before the first interrupt
+    m_netif.driver_data = this;
+    net::napi_init(&m_napi, &m_netif, napi_poll, net::NAPI_WEIGHT_DEFAULT);
+
     // Interrupts (non-fatal if it fails; we fall back to polling)
     setup_interrupts();
 
@@ -842,7 +881,6 @@ int32_t bcm_genet_driver::attach() {
     m_netif.transmit = tx_callback;
     m_netif.link_up = link_callback;
     m_netif.poll = poll_callback;
-    m_netif.driver_data = this;
     net::register_netif(&m_netif);
 
     // Wait for PHY link before DHCP - auto-negotiation takes time
@@ -878,6 +916,7 @@ int32_t bcm_genet_driver::detach() {
     dma_disable_tx_rx();
     disable_interrupts();
     teardown_interrupts();
+    RUN_ELEVATED(net::napi_disable(&m_napi));
     net::unregister_netif(&m_netif);
     dma_free();
     return 0;
@@ -893,25 +932,22 @@ void bcm_genet_driver::run() {
     if (!m_link_up)
         log::info("genet: link not yet up, will keep checking");
 
-    uint32_t link_poll_counter = 0;
-    constexpr uint32_t LINK_POLL_INTERVAL = 100;
+    // Receive runs from NAPI polls scheduled by the interrupt. This task
+    // stands in for the interrupt when there is none, schedules a slow
+    // safety-net poll when there is, and watches the link.
+    uint32_t poll_ms = m_has_irq ? RX_SAFETY_POLL_MS : 1;
+    uint32_t link_elapsed_ms = 0;
+    constexpr uint32_t LINK_POLL_MS = 100;
 
     while (true) {
-        if (m_has_irq)
-            RUN_ELEVATED(sched::sleep_ms(10));
-        else
-            RUN_ELEVATED(sched::sleep_ms(1));
-
         RUN_ELEVATED({
-            sync::irq_lock_guard guard(m_lock);
-            process_rx();
-            process_tx_completions();
+            sched::sleep_ms(poll_ms);
+            net::napi_schedule(&m_napi);
         });
 
-        RUN_ELEVATED(net::drain_deferred_tx());
-
-        if (++link_poll_counter >= LINK_POLL_INTERVAL) {
-            link_poll_counter = 0;
+        link_elapsed_ms += poll_ms;
+        if (link_elapsed_ms >= LINK_POLL_MS) {
+            link_elapsed_ms = 0;
             RUN_ELEVATED(phy_update_link());
         }
     }
@@ -5,6 +5,7 @@
 #include "drivers/net/bcm_genet_regs.h"
 #include "drivers/net/phy_regs.h"
 #include "net/net.h"
+#include "net/napi.h"
 #include "sync/spinlock.h"
 
 namespace drivers {
@@ -26,6 +27,10 @@ public:
     void run() override;
 
 private:
+    // With interrupts, how often run() schedules a poll in case an
+    // interrupt was lost
+    static constexpr uint32_t RX_SAFETY_POLL_MS = 100;
+
     // Register access
     uint32_t reg_read(uint32_t offset);
     void reg_write(uint32_t offset, uint32_t value);
@@ -59,7 +64,8 @@ private:
     void process_tx_completions();
 
     // RX path
-    void process_rx();
+    uint32_t process_rx(uint32_t budget);
+    bool rx_pending();
     void rx_remap_descriptor(uint16_t desc_idx);
 
     // Interrupts
@@ -72,6 +78,7 @@ private:
     // Net interface callbacks
     static bool link_callback(net::netif* iface);
     static void poll_callback(net::netif* iface);
+    static uint32_t napi_poll(net::napi_struct* napi, uint32_t budget);
 
     // MAC filter
     void set_promisc(bool enable);
@@ -105,6 +112,7 @@ private:
 
     // Network interface
     net::netif       m_netif;
+    net::napi_struct m_napi;
 
     // Whether interrupts were successfully set up
     bool             m_has_irq;
@@ -474,10 +474,10 @@ void rtl8168_driver::process_tx_completions() {
     }
 }
 
-void rtl8168_driver::process_rx() {
-    uint32_t budget = RX_DESC_COUNT;
+uint32_t rtl8168_driver::process_rx(uint32_t budget) {
+    uint32_t done = 0;
 
-    while (budget > 0) {
+    while (done < budget) {
         uint32_t idx = m_rx_cur;
         uint32_t opts1 = m_rx_ring[idx].opts1;
 
@@ -486,7 +486,7 @@ void rtl8168_driver::process_rx() {
         if (opts1 & RX_OWN)
             break;
 
-        budget--;
+        done++;
 
         if (opts1 & RX_RES) {
             log::warn("rtl8168: RX error on desc %u (opts1=0x%08x)", idx, opts1);
@@ -534,13 +534,14 @@ void rtl8168_driver::process_rx() {
 
         m_rx_cur = (idx + 1) % RX_DESC_COUNT;
     }
+    return done;
 }
 
 /**
  * MSI interrupt handler. Masks IMR before ACKing ISR to prevent the
  * RTL8168's edge-triggered MSI from becoming permanently stuck: the
  * chip only fires an MSI on a 0->nonzero transition of (ISR & IMR).
- * The main loop re-enables IMR after draining all work.
+ * The NAPI poll re-enables IMR once it has drained the ring.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void rtl8168_driver::on_interrupt(uint32_t) {
@@ -548,6 +549,7 @@ __PRIVILEGED_CODE void rtl8168_driver::on_interrupt(uint32_t) {
     uint16_t status = reg_read16(REG_ISR);
     if (status)
         reg_write16(REG_ISR, status);
+    net::napi_schedule(&m_napi);
 }
 
 void rtl8168_driver::enable_interrupts() {
@@ -575,10 +577,41 @@ void rtl8168_driver::poll_callback(net::netif* iface) {
 
     RUN_ELEVATED({
         sync::irq_lock_guard guard(drv->m_lock);
-        drv->process_rx();
+        drv->process_rx(RX_DESC_COUNT);
         drv->process_tx_completions();
     });
-    RUN_ELEVATED(net::drain_deferred_tx());
+}
+
+uint32_t rtl8168_driver::napi_poll(net::napi_struct* napi, uint32_t budget) {
+    auto* drv = static_cast<rtl8168_driver*>(napi->iface->driver_data);
+
+    uint32_t done = 0;
+    RUN_ELEVATED({
+        sync::irq_lock_guard guard(drv->m_lock);
+        done = drv->process_rx(budget);
+        drv->process_tx_completions();
+    });
+
+    if (done < budget) {
+        RUN_ELEVATED({
+            net::napi_complete(napi);
+            // Re-enable IMR after draining the ring. If ISR bits
+            // accumulated while masked, this creates a 0->nonzero
+            // (ISR & IMR) transition that fires a fresh MSI.
+            if (drv->m_has_msi) {
+                drv->reg_write16(REG_IMR, drv->m_imr);
+            }
+            // A frame that landed before the ISR ack may raise no
+            // interrupt, poll again for it
+            uint32_t opts1 = __atomic_load_n(&drv->m_rx_ring[drv->m_rx_cur].opts1,
+                                             __ATOMIC_ACQUIRE);
+            if (!(opts1 & RX_OWN)) {
+                drv->reg_write16(REG_IMR, 0);
+                net::napi_schedule(napi);
+            }
+        });
+    }
+    return done;
 }
 
 /**
@@ -722,6 +755,10 @@ int32_t rtl8168_driver::attach() {
     rc = fill_rx_ring();
     if (rc != 0) return rc;
 
+    // The poll function must be ready before the first interrupt
+    m_netif.driver_data = this;
+    net::napi_init(&m_napi, &m_netif, napi_poll, net::NAPI_WEIGHT_DEFAULT);
+
     int32_t msi_rc = setup_msi(1);
     if (msi_rc != 0) {
         log::warn("rtl8168: MSI setup failed, will use polling");
@@ -737,7 +774,6 @@ int32_t rtl8168_driver::attach() {
     m_netif.transmit = tx_callback;
     m_netif.link_up = link_callback;
     m_netif.poll = poll_callback;
-    m_netif.driver_data = this;
     net::register_netif(&m_netif);
 
     log::info("rtl8168: attached successfully (%s)",
@@ -749,6 +785,7 @@ int32_t rtl8168_driver::attach() {
 int32_t rtl8168_driver::detach() {
     log::info("rtl8168: detaching");
     hw_stop();
+    RUN_ELEVATED(net::napi_disable(&m_napi));
     net::unregister_netif(&m_netif);
     free_rings();
     return pci_driver::detach();
@@ -778,35 +815,24 @@ void rtl8168_driver::run() {
         log::warn("rtl8168: DHCP failed (%d), interface left unconfigured", dhcp_rc);
     }
 
-    uint32_t link_poll_counter = 0;
-    constexpr uint32_t LINK_POLL_INTERVAL = 100;
+    // Receive runs from NAPI polls scheduled by the interrupt. This task
+    // stands in for the interrupt when there is no MSI, schedules a slow
+    // safety-net poll when there is, and watches the link.
+    uint32_t poll_ms = m_has_msi ? RX_SAFETY_POLL_MS : 1;
+    uint32_t link_elapsed_ms = 0;
+    constexpr uint32_t LINK_POLL_MS = 100;
 
     while (true) {
-        if (m_has_msi) {
-            wait_for_event();
-        } else {
-            RUN_ELEVATED(sched::sleep_ms(1));
-        }
-
         RUN_ELEVATED({
-            sync::irq_lock_guard guard(m_lock);
-            process_rx();
-            process_tx_completions();
+            sched::sleep_ms(poll_ms);
+            net::napi_schedule(&m_napi);
         });
 
-        RUN_ELEVATED(net::drain_deferred_tx());
-
-        if (++link_poll_counter >= LINK_POLL_INTERVAL) {
-            link_poll_counter = 0;
+        link_elapsed_ms += poll_ms;
+        if (link_elapsed_ms >= LINK_POLL_MS) {
+            link_elapsed_ms = 0;
             phy_update_link();
         }
-
-        // Re-enable IMR after draining work. If ISR bits accumulated
-        // while masked, this creates a 0->nonzero (ISR & IMR) transition
-        // that fires a fresh MSI.
-        if (m_has_msi) {
-            reg_write16(REG_IMR, m_imr);
-        }
     }
 }
 
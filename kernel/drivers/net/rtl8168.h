@@ -4,6 +4,7 @@
 #include "drivers/pci_driver.h"
 #include "drivers/net/rtl8168_regs.h"
 #include "net/net.h"
+#include "net/napi.h"
 #include "sync/spinlock.h"
 
 namespace drivers {
@@ -24,6 +25,10 @@ public:
     __PRIVILEGED_CODE void on_interrupt(uint32_t vector) override;
 
 private:
+    // With MSI, how often run() schedules a poll in case an interrupt
+    // was lost
+    static constexpr uint32_t RX_SAFETY_POLL_MS = 100;
+
     uint8_t  reg_read8(uint16_t offset);
     uint16_t reg_read16(uint16_t offset);
     uint32_t reg_read32(uint16_t offset);
@@ -53,10 +58,11 @@ private:
     static int32_t tx_callback(net::netif* iface,
                                const uint8_t* frame, size_t len);
     void process_tx_completions();
-    void process_rx();
+    uint32_t process_rx(uint32_t budget);
 
     static bool link_callback(net::netif* iface);
     static void poll_callback(net::netif* iface);
+    static uint32_t napi_poll(net::napi_struct* napi, uint32_t budget);
 
     void hw_start();
     void hw_stop();
@@ -87,6 +93,7 @@ private:
 
     sync::spinlock m_lock;
     net::netif m_netif;
+    net::napi_struct m_napi;
     bool m_has_msi;
     uint16_t m_imr;
 };
@@ -405,6 +405,10 @@ int32_t virtio_net_driver::attach() {
         return rc;
     }
 
+    // The poll function must be ready before the first interrupt
+    m_netif.driver_data = this;
+    net::napi_init(&m_napi, &m_netif, napi_poll, net::NAPI_WEIGHT_DEFAULT);
+
     // Set up MSI-X interrupts (fall back to MSI, then polling)
     int32_t irq_rc = setup_msix(2);
     if (irq_rc != 0) {
@@ -444,7 +448,6 @@ int32_t virtio_net_driver::attach() {
     m_netif.transmit = tx_callback;
     m_netif.link_up = link_callback;
     m_netif.poll = poll_callback;
-    m_netif.driver_data = this;
 
     net::register_netif(&m_netif);
 
@@ -457,6 +460,7 @@ int32_t virtio_net_driver::attach() {
 int32_t virtio_net_driver::detach() {
     // Reset device
     write_status(0);
+    RUN_ELEVATED(net::napi_disable(&m_napi));
     return pci_driver::detach();
 }
 
@@ -466,17 +470,24 @@ __PRIVILEGED_CODE void virtio_net_driver::on_interrupt(uint32_t vector) {
     if (m_isr_addr) {
         mmio::read8(m_isr_addr);
     }
+    // RX stays quiet until the poll has drained the ring
+    sync::irq_lock_guard guard(m_vq_lock);
+    m_rxq.disable_interrupts();
+    net::napi_schedule(&m_napi);
 }
 
-void virtio_net_driver::drain_rx_locked(rx_batch& batch) {
-    // Drain used buffers from the virtqueue into a local batch.
+void virtio_net_driver::drain_rx_locked(rx_batch& batch, uint16_t max) {
+    // Drain up to max used buffers from the virtqueue into a local batch.
     // Caller must hold m_vq_lock.
     batch.count = 0;
+    if (max > RX_BATCH_MAX) {
+        max = RX_BATCH_MAX;
+    }
 
     uint16_t desc_id;
     uint32_t len;
 
-    while (batch.count < RX_BATCH_MAX && m_rxq.get_used(&desc_id, &len)) {
+    while (batch.count < max && m_rxq.get_used(&desc_id, &len)) {
         // Find which buffer this descriptor belongs to
         int buf_idx = -1;
         for (uint16_t i = 0; i < RX_BUF_COUNT; i++) {
@@ -580,33 +591,66 @@ void virtio_net_driver::run() {
     bool has_msi = false;
     RUN_ELEVATED(has_msi = m_dev->get_msi_state().mode != pci::MSI_MODE_NONE);
 
+    // Receive runs from NAPI polls scheduled by the interrupt. This task
+    // only stands in for the interrupt: every millisecond without MSI,
+    // and as a slow safety net against a lost interrupt with it.
+    uint32_t poll_ms = has_msi ? RX_SAFETY_POLL_MS : 1;
     while (true) {
-        // Wait for interrupt or poll periodically
-        if (has_msi) {
-            wait_for_event();
-        } else {
-            RUN_ELEVATED(sched::sleep_ms(1));
-        }
+        RUN_ELEVATED(sched::sleep_ms(poll_ms));
+        schedule_rx();
+    }
+}
 
-        // Drain RX under lock, deliver frames without the lock so
-        // protocol handlers can transmit, then re-lock to replenish.
+void virtio_net_driver::schedule_rx() {
+    RUN_ELEVATED({
+        sync::irq_lock_guard guard(m_vq_lock);
+        m_rxq.disable_interrupts();
+        net::napi_schedule(&m_napi);
+    });
+}
+
+uint32_t virtio_net_driver::napi_poll(net::napi_struct* napi, uint32_t budget) {
+    auto* drv = static_cast<virtio_net_driver*>(napi->iface->driver_data);
+
+    // Drain RX under lock, deliver frames without the lock so
+    // protocol handlers can transmit, then re-lock to replenish.
+    uint32_t done = 0;
+    while (done < budget) {
+        uint32_t left = budget - done;
         rx_batch batch;
         RUN_ELEVATED({
-            sync::irq_lock_guard guard(m_vq_lock);
-            drain_rx_locked(batch);
-            process_tx_completions();
+            sync::irq_lock_guard guard(drv->m_vq_lock);
+            drv->drain_rx_locked(batch, static_cast<uint16_t>(
+                left < RX_BATCH_MAX ? left : RX_BATCH_MAX));
+            drv->process_tx_completions();
+        });
+        if (batch.count == 0) {
+            break;
+        }
+        RUN_ELEVATED(drv->deliver_rx_batch(batch));
+        RUN_ELEVATED({
+            sync::irq_lock_guard guard(drv->m_vq_lock);
+            drv->replenish_rx();
         });
-        RUN_ELEVATED(deliver_rx_batch(batch));
+        done += batch.count;
+    }
+
+    if (done < budget) {
         RUN_ELEVATED({
-            sync::irq_lock_guard guard(m_vq_lock);
-            replenish_rx();
+            net::napi_complete(napi);
+            bool more = false;
+            {
+                sync::irq_lock_guard guard(drv->m_vq_lock);
+                more = drv->m_rxq.enable_interrupts();
+            }
+            // A frame that landed before interrupts came back on raised
+            // no interrupt, poll again for it
+            if (more) {
+                drv->schedule_rx();
+            }
         });
-        // Send any protocol-generated responses (e.g. ICMP echo replies)
-        // that were queued during RX delivery. This runs at the top level,
-        // so ipv4_send and ARP resolution are safe — no recursion into
-        // deliver_rx_batch.
-        RUN_ELEVATED(net::drain_deferred_tx());
     }
+    return done;
 }
 
 int32_t virtio_net_driver::tx_callback(net::netif* iface, const uint8_t* frame, size_t len) {
@@ -680,7 +724,6 @@ void virtio_net_driver::poll_callback(net::netif* iface) {
         sync::irq_lock_guard guard(drv->m_vq_lock);
         drv->replenish_rx();
     });
-    RUN_ELEVATED(net::drain_deferred_tx());
 }
 
 bool virtio_net_driver::link_callback(net::netif* iface) {
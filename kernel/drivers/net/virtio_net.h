@@ -5,6 +5,7 @@
 #include "drivers/net/virtio_pci.h"
 #include "drivers/net/virtio_queue.h"
 #include "net/net.h"
+#include "net/napi.h"
 #include "common/string.h"
 #include "sync/spinlock.h"
 
@@ -46,6 +47,10 @@ private:
     // Batch of received frames drained from the virtqueue under lock,
     // then delivered to the protocol stack without the lock held.
     static constexpr uint16_t RX_BATCH_MAX = 16;
+
+    // With MSI, how often run() schedules a poll in case an interrupt
+    // was lost
+    static constexpr uint32_t RX_SAFETY_POLL_MS = 100;
     struct rx_batch_entry {
         const uint8_t* data;
         size_t len;
@@ -60,7 +65,9 @@ private:
     static int32_t tx_callback(net::netif* iface, const uint8_t* frame, size_t len);
     static bool link_callback(net::netif* iface);
     static void poll_callback(net::netif* iface);
-    void drain_rx_locked(rx_batch& batch);     // requires m_vq_lock
+    static uint32_t napi_poll(net::napi_struct* napi, uint32_t budget);
+    void schedule_rx();                        // mask RX interrupts, schedule NAPI
+    void drain_rx_locked(rx_batch& batch, uint16_t max = RX_BATCH_MAX); // requires m_vq_lock
     void deliver_rx_batch(rx_batch& batch);    // called without m_vq_lock
     void process_tx_completions();             // under lock
     void replenish_rx();                       // under lock
@@ -116,6 +123,7 @@ private:
 
     // Network interface
     net::netif m_netif;
+    net::napi_struct m_napi;
 
     // Feature flags
     bool m_has_mac = false;
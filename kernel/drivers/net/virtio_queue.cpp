@@ -201,6 +201,17 @@ bool virtqueue::get_used(uint16_t* out_id, uint32_t* out_len) {
     return true;
 }
 
+void virtqueue::disable_interrupts() {
+    m_avail->flags = static_cast<uint16_t>(m_avail->flags | VRING_AVAIL_F_NO_INTERRUPT);
+}
+
+bool virtqueue::enable_interrupts() {
+    m_avail->flags = static_cast<uint16_t>(m_avail->flags & ~VRING_AVAIL_F_NO_INTERRUPT);
+    // Order the flag store before re-reading the used index
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return m_last_used_idx != m_used->idx;
+}
+
 void virtqueue::kick(uintptr_t notify_addr) {
     __atomic_thread_fence(__ATOMIC_SEQ_CST);
     mmio::write16(notify_addr, m_queue_index);
@@ -19,6 +19,9 @@ struct vring_desc {
     uint16_t next;
 } __attribute__((packed));
 
+// Available ring flags
+constexpr uint16_t VRING_AVAIL_F_NO_INTERRUPT = 1; // driver does not want used-buffer interrupts
+
 // Available ring header
 struct vring_avail {
     uint16_t flags;
@@ -94,6 +97,19 @@ public:
      */
     bool has_used() const;
 
+    /**
+     * Ask the device not to interrupt for used buffers. A hint only,
+     * the device may still interrupt.
+     */
+    void disable_interrupts();
+
+    /**
+     * Ask the device to interrupt for used buffers again.
+     * @return true if used buffers arrived while interrupts were off;
+     *   the caller must process them, no interrupt will announce them.
+     */
+    bool enable_interrupts();
+
     /**
      * Notify the device by writing to the doorbell.
      * @param notify_addr Virtual address of the notification register.
@@ -32,6 +32,13 @@ __PRIVILEGED_CODE void pci_driver::notify_interrupt(uint32_t global_vector) {
     sync::spin_unlock_irqrestore(m_irq_lock, irq);
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void pci_driver::free_rcu(rc::rcu::rcu_head* head) {
+    heap::ufree_delete(rc::rcu::head_to_entry<pci_driver, &pci_driver::m_rcu>(head));
+}
+
 static void pci_task_entry(void* arg) {
     auto* drv = static_cast<pci_driver*>(arg);
     drv->run();
@@ -197,7 +204,7 @@ __PRIVILEGED_CODE int32_t init() {
             if (rc != 0) {
                 log::error("drivers: %s attach failed: %d", drv->name(), rc);
                 drv->detach();
-                heap::ufree_delete(drv);
+                rc::rcu::call_rcu(&drv->m_rcu, pci_driver::free_rcu);
                 continue;
             }
 
@@ -206,7 +213,7 @@ __PRIVILEGED_CODE int32_t init() {
             if (!t) {
                 log::error("drivers: task creation failed for %s", drv->name());
                 drv->detach();
-                heap::ufree_delete(drv);
+                rc::rcu::call_rcu(&drv->m_rcu, pci_driver::free_rcu);
                 continue;
             }
 
@@ -5,6 +5,7 @@
 #include "drivers/device_driver.h"
 #include "sync/wait_queue.h"
 #include "mm/paging_types.h"
+#include "rc/rcu.h"
 
 namespace drivers {
 
@@ -57,7 +58,9 @@ __PRIVILEGED_CODE int32_t init();
  * Factory contract: driver factories registered via REGISTER_PCI_DRIVER
  * must allocate from the unprivileged heap (heap::ualloc_new).
  * On failure, the factory must return nullptr without leaking memory.
- * The framework frees driver objects with heap::ufree_delete on error.
+ * The framework frees driver objects with heap::ufree_delete on error,
+ * one RCU grace period after detach() so lockless readers of state the
+ * driver unregistered (a net::netif) are done with it.
  */
 class pci_driver : public device_driver {
 public:
@@ -141,6 +144,11 @@ protected:
 private:
     int32_t register_msi_handlers();
 
+    /** @note Privilege: **required** */
+    __PRIVILEGED_CODE static void free_rcu(rc::rcu::rcu_head* head);
+
+    rc::rcu::rcu_head m_rcu;
+
     /** @note Privilege: **required** */
     __PRIVILEGED_CODE static void isr_trampoline(uint32_t vector, void* context);
 
@@ -18,8 +18,51 @@ void lower();
 // Trap/syscall entry/exit code is responsible for keeping this state accurate.
 bool is_elevated();
 
+// Free-running cycle counter readable at any privilege level
+// (TSC on x86_64, CNTVCT_EL0 on aarch64).
+uint64_t read_cycles();
+
+#ifdef STLX_ELEVATE_STATS
+
+constexpr uint32_t ELEVATE_HIST_BUCKETS = 16;
+
+/**
+ * Per-callsite RUN_ELEVATED accounting, built with ELEVATE_STATS=1.
+ * Each expansion owns one static record, linked into a global list the
+ * first time it runs. Costs are the elevate() plus lower() round trip,
+ * not the elevated code itself.
+ */
+struct elevate_site {
+    const char*   file;
+    uint32_t      line;
+    uint32_t      registered;
+    elevate_site* next;
+    uint64_t      transitions; // runs that elevated and lowered
+    uint64_t      nested;      // runs that found the CPU already elevated
+    uint64_t      cycles;      // total round-trip cycles
+    // Round trips by cost: bucket b counts 64 << b up to 64 << (b + 1)
+    // cycles, bucket 0 everything below 128, the last one everything above
+    uint64_t      hist[ELEVATE_HIST_BUCKETS];
+};
+
+/**
+ * @brief Account one run of a RUN_ELEVATED site.
+ * @param cycles Round-trip cost, ignored when was_elevated.
+ */
+void record_site(elevate_site* site, bool was_elevated, uint64_t cycles);
+
+/**
+ * @brief Head of the list of sites that have run at least once.
+ * Sites are only ever added, at the head.
+ */
+elevate_site* first_site();
+
+#endif // STLX_ELEVATE_STATS
+
 } // namespace dynpriv
 
+#ifndef STLX_ELEVATE_STATS
+
 #define RUN_ELEVATED(code)                           \
     do {                                            \
         bool was_elevated = dynpriv::is_elevated(); \
@@ -32,4 +75,30 @@ bool is_elevated();
         }                                           \
     } while (0)
 
+#else
+
+#define RUN_ELEVATED(code)                                               \
+    do {                                                                \
+        static dynpriv::elevate_site stlx_elevate_site_ = {             \
+            __FILE__, __LINE__, 0, nullptr, 0, 0, 0, {}                 \
+        };                                                              \
+        uint64_t stlx_elevate_cost_ = 0;                                \
+        bool was_elevated = dynpriv::is_elevated();                     \
+        if (!was_elevated) {                                            \
+            uint64_t stlx_elevate_t0_ = dynpriv::read_cycles();         \
+            dynpriv::elevate();                                         \
+            stlx_elevate_cost_ = dynpriv::read_cycles() - stlx_elevate_t0_; \
+        }                                                               \
+        code;                                                           \
+        if (!was_elevated) {                                            \
+            uint64_t stlx_elevate_t0_ = dynpriv::read_cycles();         \
+            dynpriv::lower();                                           \
+            stlx_elevate_cost_ += dynpriv::read_cycles() - stlx_elevate_t0_; \
+        }                                                               \
+        dynpriv::record_site(&stlx_elevate_site_, was_elevated,         \
+                             stlx_elevate_cost_);                       \
+    } while (0)
+
+#endif // STLX_ELEVATE_STATS
+
 #endif // STELLUX_DYNPRIV_DYNPRIV_H
@@ -0,0 +1,43 @@
+#include "dynpriv/dynpriv.h"
+
+#ifdef STLX_ELEVATE_STATS
+
+namespace dynpriv {
+
+// Written from unprivileged kernel code, so plain (unprivileged) data
+static elevate_site* g_sites = nullptr;
+
+void record_site(elevate_site* site, bool was_elevated, uint64_t cycles) {
+    if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE)) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&site->registered, &expected, 1,
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            elevate_site* head = __atomic_load_n(&g_sites, __ATOMIC_RELAXED);
+            do {
+                site->next = head;
+            } while (!__atomic_compare_exchange_n(&g_sites, &head, site, true,
+                                                  __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        }
+    }
+
+    if (was_elevated) {
+        __atomic_fetch_add(&site->nested, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t bucket = 0;
+    for (uint64_t v = cycles >> 6; v > 1 && bucket < ELEVATE_HIST_BUCKETS - 1; v >>= 1) {
+        bucket++;
+    }
+    __atomic_fetch_add(&site->transitions, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&site->cycles, cycles, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&site->hist[bucket], 1, __ATOMIC_RELAXED);
+}
+
+elevate_site* first_site() {
+    return __atomic_load_n(&g_sites, __ATOMIC_ACQUIRE);
+}
+
+} // namespace dynpriv
+
+#endif // STLX_ELEVATE_STATS
@@ -147,9 +147,10 @@ __PRIVILEGED_CODE static int32_t load_segments(
     const void* buffer,
     size_t buffer_size,
     const elf_image& img,
-    uint64_t pt_root
+    mm::mm_context* mm_ctx
 ) {
     auto* base = static_cast<const uint8_t*>(buffer);
+    uint64_t pt_root = mm_ctx->pt_root;
 
     for (uint32_t i = 0; i < img.segment_count; i++) {
         const auto& seg = img.segments[i];
@@ -187,6 +188,7 @@ __PRIVILEGED_CODE static int32_t load_segments(
                     pmm::free_page(phys);
                     return ERR_PAGE_MAP;
                 }
+                mm::rss_add(mm_ctx, 1);
             }
 
             uint64_t copy_start = (page_vaddr < seg_vaddr) ? seg_vaddr : page_vaddr;
@@ -265,7 +267,7 @@ int32_t load_elf(const void* buffer, size_t size, loaded_image* out) {
         if (!mm_ctx) {
             load_rc = ERR_PT_CREATE;
         } else {
-            load_rc = load_segments(buffer, size, img, mm_ctx->pt_root);
+            load_rc = load_segments(buffer, size, img, mm_ctx);
             if (load_rc != OK) {
                 cleanup_mapped_segment_pages(mm_ctx, img);
                 mm::mm_context_release(mm_ctx);
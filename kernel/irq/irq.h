@@ -52,6 +52,17 @@ __PRIVILEGED_CODE void unmask(uint32_t irq);
  */
 __PRIVILEGED_CODE void mask(uint32_t irq);
 
+/**
+ * @brief Send a reschedule IPI to a CPU, the sender's own CPU included.
+ * The target enters the scheduler from its interrupt handler, which
+ * restarts a stopped tick if a task became runnable there.
+ * x86_64: fixed-delivery LAPIC IPI on VEC_RESCHED.
+ * AArch64: GICv2 SGI RESCHED_SGI through GICD_SGIR.
+ * @param cpu_id Logical CPU ID of the target, must be online.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void send_resched_ipi(uint32_t cpu_id);
+
 // Generic IRQ handler dispatch table
 
 constexpr int32_t ERR_INVAL    = -3;
@@ -0,0 +1,445 @@
+#include "kmsg/kmsg.h"
+#include "fs/node.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs/fstypes.h"
+#include "fs/devfs/devfs.h"
+#include "mm/heap.h"
+#include "percpu/percpu.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "hw/cpu.h"
+#include "smp/smp.h"
+#include "clock/clock.h"
+#include "sync/spinlock.h"
+#include "sync/wait_queue.h"
+#include "dynpriv/dynpriv.h"
+#include "common/logging.h"
+#include "common/string.h"
+
+namespace kmsg {
+
+namespace {
+
+static_assert((RING_LINES & (RING_LINES - 1)) == 0, "RING_LINES must be a power of two");
+static_assert((HISTORY_LINES & (HISTORY_LINES - 1)) == 0,
+              "HISTORY_LINES must be a power of two");
+
+struct line {
+    uint64_t seq;   // global order of reservation
+    uint64_t ts_ns;
+    uint16_t len;
+    uint8_t  level; // log::level
+    uint8_t  cpu;
+    char     text[LINE_MAX];
+};
+
+/**
+ * commit is reserved + 1 once the line is complete, stored last so
+ * klogd can tell a published slot from one still being formatted.
+ */
+struct slot {
+    uint64_t commit;
+    uint64_t reserved; // ring index this slot was reserved at
+    line     ln;
+};
+
+/**
+ * Line ring of one CPU. Writers reserve a slot and its sequence number
+ * together with IRQs off, so an interrupt that logs on top of a half
+ * formatted line gets the next slot and a later seq, and ring order is
+ * seq order. tail is advanced by klogd and by emergency_flush() on the
+ * way down, with a compare-and-swap so each line is taken once.
+ */
+struct cpu_ring {
+    slot*    slots;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t drops;
+};
+
+static DEFINE_PER_CPU(cpu_ring*, klog_ring);
+
+__PRIVILEGED_BSS static uint32_t           g_ready;
+__PRIVILEGED_BSS static uint64_t           g_seq;
+__PRIVILEGED_BSS static uint32_t           g_kicked;     // lines published since klogd last looked
+__PRIVILEGED_BSS static uint64_t           g_drops_seen; // drops klogd has already reported
+__PRIVILEGED_BSS static sched::task*       g_klogd;
+__PRIVILEGED_BSS static sync::wait_queue   g_wait_queue;
+__PRIVILEGED_DATA static sync::spinlock    g_wait_lock = sync::SPINLOCK_INIT;
+
+// /dev/kmsg history, appended by klogd. g_hist_count lines were ever added.
+__PRIVILEGED_BSS static line*              g_history;
+__PRIVILEGED_BSS static uint64_t           g_hist_count;
+__PRIVILEGED_DATA static sync::spinlock    g_hist_lock = sync::SPINLOCK_INIT;
+
+size_t append_str(char* buf, size_t cap, size_t pos, const char* s) {
+    while (*s && pos < cap) {
+        buf[pos++] = *s++;
+    }
+    return pos;
+}
+
+size_t append_u64(char* buf, size_t cap, size_t pos, uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0 && pos < cap) {
+        buf[pos++] = digits[--count];
+    }
+    return pos;
+}
+
+// syslog priority of a log::level, raw output is reported as info
+uint64_t syslog_priority(uint8_t level) {
+    switch (static_cast<log::level>(level)) {
+    case log::level::debug: return 7;
+    case log::level::warn:  return 4;
+    case log::level::error: return 3;
+    case log::level::fatal: return 2;
+    default:                return 6;
+    }
+}
+
+/**
+ * Wake klogd unless a wakeup is already pending.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void kick_klogd() {
+    if (__atomic_exchange_n(&g_kicked, 1, __ATOMIC_ACQ_REL) == 0) {
+        sync::irq_state irq = sync::spin_lock_irqsave(g_wait_lock);
+        sync::wake_one(g_wait_queue);
+        sync::spin_unlock_irqrestore(g_wait_lock, irq);
+    }
+}
+
+/**
+ * A full ring is waited out only by a task that can be switched away
+ * from: IRQs enabled, not in a handler, not idle and not klogd itself.
+ * Everything else drops the line.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool can_wait_for_space() {
+    sched::task* t = sched::current();
+    if (!t || t == g_klogd || !cpu::irqs_enabled()) {
+        return false;
+    }
+    return (t->exec.flags & (sched::TASK_FLAG_IDLE | sched::TASK_FLAG_IN_IRQ)) == 0;
+}
+
+/**
+ * Oldest published line across the CPU rings, by sequence number.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE cpu_ring* next_ring(slot** out) {
+    cpu_ring* best = nullptr;
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_ring* r = per_cpu_on(klog_ring, cpu);
+        if (!r) {
+            continue;
+        }
+        uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        slot& s = r->slots[tail & (RING_LINES - 1)];
+        if (__atomic_load_n(&s.commit, __ATOMIC_ACQUIRE) != tail + 1) {
+            continue;
+        }
+        if (!best || s.ln.seq < (*out)->ln.seq) {
+            best = r;
+            *out = &s;
+        }
+    }
+    return best;
+}
+
+/**
+ * Copy the oldest published line into out and advance its ring past it.
+ * The slot is copied before the tail moves, since a writer may reuse it
+ * right after. When klogd and emergency_flush() race for a line, the
+ * tail compare-and-swap hands it to one of them.
+ * @return false once every ring is empty.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool take_line(line* out) {
+    for (;;) {
+        slot* s = nullptr;
+        cpu_ring* r = next_ring(&s);
+        if (!r) {
+            return false;
+        }
+        uint64_t tail = s->reserved;
+        out->seq = s->ln.seq;
+        out->ts_ns = s->ln.ts_ns;
+        out->len = s->ln.len;
+        out->level = s->ln.level;
+        out->cpu = s->ln.cpu;
+        string::memcpy(out->text, s->ln.text, out->len);
+        if (__atomic_compare_exchange_n(&r->tail, &tail, tail + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void append_history(const line& ln) {
+    sync::irq_state irq = sync::spin_lock_irqsave(g_hist_lock);
+    line& h = g_history[g_hist_count & (HISTORY_LINES - 1)];
+    h.seq = ln.seq;
+    h.ts_ns = ln.ts_ns;
+    h.len = ln.len;
+    h.level = ln.level;
+    h.cpu = ln.cpu;
+    string::memcpy(h.text, ln.text, ln.len);
+    g_hist_count++;
+    sync::spin_unlock_irqrestore(g_hist_lock, irq);
+}
+
+/**
+ * Write the rings out in sequence order until they are empty.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void drain() {
+    line ln;
+    while (take_line(&ln)) {
+        log::write_line(static_cast<log::level>(ln.level), ln.text, ln.len);
+        append_history(ln);
+    }
+
+    uint64_t drops = 0;
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_ring* r = per_cpu_on(klog_ring, cpu);
+        if (r) {
+            drops += __atomic_load_n(&r->drops, __ATOMIC_RELAXED);
+        }
+    }
+    if (drops != g_drops_seen) {
+        log::warn("kmsg: %lu lines dropped, rings full", drops - g_drops_seen);
+        g_drops_seen = drops;
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void klogd_main(void*) {
+    while (true) {
+        __atomic_store_n(&g_kicked, 0, __ATOMIC_RELEASE);
+        drain();
+
+        sync::irq_state irq = sync::spin_lock_irqsave(g_wait_lock);
+        while (!__atomic_load_n(&g_kicked, __ATOMIC_ACQUIRE)) {
+            irq = sync::wait(g_wait_queue, g_wait_lock, irq);
+        }
+        sync::spin_unlock_irqrestore(g_wait_lock, irq);
+    }
+}
+
+class kmsg_node : public fs::node {
+public:
+    kmsg_node() : fs::node(fs::node_type::char_device, nullptr, "kmsg") {}
+
+    ssize_t read(fs::file* f, void* buf, size_t count) override {
+        if (!f || !buf) {
+            return fs::ERR_BADF;
+        }
+        ssize_t rc = 0;
+        RUN_ELEVATED(rc = read_line(f, static_cast<char*>(buf), count));
+        return rc;
+    }
+
+    int64_t seek(fs::file* f, int64_t offset, int whence) override {
+        if (!f || offset != 0) {
+            return fs::ERR_INVAL;
+        }
+        uint64_t pos = 0;
+        if (whence == fs::SEEK_SET) {
+            RUN_ELEVATED(pos = oldest_line());
+        } else if (whence == fs::SEEK_END) {
+            RUN_ELEVATED(pos = __atomic_load_n(&g_hist_count, __ATOMIC_ACQUIRE));
+        } else {
+            return fs::ERR_INVAL;
+        }
+        f->set_offset(static_cast<int64_t>(pos));
+        return 0;
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = 0;
+        return fs::OK;
+    }
+
+private:
+    /**
+     * @note Privilege: **required**
+     */
+    __PRIVILEGED_CODE static uint64_t oldest_line() {
+        uint64_t count = __atomic_load_n(&g_hist_count, __ATOMIC_ACQUIRE);
+        return count > HISTORY_LINES ? count - HISTORY_LINES : 0;
+    }
+
+    /**
+     * Format the line at the file position into buf and advance past it.
+     * A reader that fell behind the history skips to the oldest line.
+     * @note Privilege: **required**
+     */
+    __PRIVILEGED_CODE static ssize_t read_line(fs::file* f, char* buf, size_t count) {
+        sync::irq_state irq = sync::spin_lock_irqsave(g_hist_lock);
+        uint64_t pos = static_cast<uint64_t>(f->offset());
+        if (pos < oldest_line()) {
+            pos = oldest_line();
+        }
+        if (pos >= g_hist_count) {
+            sync::spin_unlock_irqrestore(g_hist_lock, irq);
+            return 0;
+        }
+        const line& ln = g_history[pos & (HISTORY_LINES - 1)];
+        size_t len = 0;
+        len = append_u64(buf, count, len, syslog_priority(ln.level));
+        len = append_str(buf, count, len, ",");
+        len = append_u64(buf, count, len, ln.seq);
+        len = append_str(buf, count, len, ",");
+        len = append_u64(buf, count, len, ln.ts_ns / 1000);
+        len = append_str(buf, count, len, ",-;");
+        bool fits = len + ln.len + 1 <= count;
+        if (fits) {
+            string::memcpy(buf + len, ln.text, ln.len);
+            len += ln.len;
+            buf[len++] = '\n';
+        }
+        sync::spin_unlock_irqrestore(g_hist_lock, irq);
+
+        // Lines are never split across reads
+        if (!fits) {
+            return fs::ERR_INVAL;
+        }
+        f->set_offset(static_cast<int64_t>(pos + 1));
+        return static_cast<ssize_t>(len);
+    }
+};
+
+} // anonymous namespace
+
+__PRIVILEGED_CODE int32_t init() {
+    g_wait_queue.init();
+
+    g_history = static_cast<line*>(heap::kzalloc(HISTORY_LINES * sizeof(line)));
+    if (!g_history) {
+        log::error("kmsg: failed to allocate history");
+        return ERR;
+    }
+
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        auto* r = static_cast<cpu_ring*>(heap::kzalloc(sizeof(cpu_ring)));
+        if (!r) {
+            log::error("kmsg: failed to allocate ring for cpu %u", cpu);
+            return ERR;
+        }
+        r->slots = static_cast<slot*>(heap::kzalloc(RING_LINES * sizeof(slot)));
+        if (!r->slots) {
+            heap::kfree(r);
+            log::error("kmsg: failed to allocate ring for cpu %u", cpu);
+            return ERR;
+        }
+        per_cpu_on(klog_ring, cpu) = r;
+    }
+
+    sched::task* task = sched::create_kernel_task(
+        klogd_main, nullptr, "klogd", sched::TASK_FLAG_ELEVATED);
+    if (!task) {
+        log::error("kmsg: failed to create klogd");
+        return ERR;
+    }
+
+    auto* node = heap::kalloc_new<kmsg_node>();
+    if (!node || devfs::add_char_device("kmsg", node) != devfs::OK) {
+        // Logging still goes through klogd, only /dev/kmsg is missing
+        log::error("kmsg: failed to register /dev/kmsg");
+        if (node) {
+            heap::kfree_delete(node);
+        }
+    }
+
+    g_klogd = task;
+    __atomic_store_n(&g_ready, 1, __ATOMIC_RELEASE);
+    sched::enqueue(task);
+    return OK;
+}
+
+__PRIVILEGED_CODE bool ready() {
+    return __atomic_load_n(&g_ready, __ATOMIC_ACQUIRE) != 0;
+}
+
+__PRIVILEGED_CODE void* reserve(uint8_t level, char** text) {
+    cpu_ring* r = this_cpu(klog_ring);
+    if (!r) {
+        return nullptr;
+    }
+
+    slot* s = nullptr;
+    for (;;) {
+        // No interrupt on this CPU can reserve between the slot and its
+        // seq, so a later slot always carries a later seq
+        uint64_t flags = cpu::irq_save();
+        r = this_cpu(klog_ring);
+        uint64_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        if (head - tail < RING_LINES) {
+            s = &r->slots[head & (RING_LINES - 1)];
+            s->reserved = head;
+            s->ln.seq = __atomic_fetch_add(&g_seq, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&r->head, head + 1, __ATOMIC_RELAXED);
+            cpu::irq_restore(flags);
+            break;
+        }
+        cpu::irq_restore(flags);
+
+        if (!can_wait_for_space()) {
+            __atomic_fetch_add(&r->drops, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+        // Let klogd catch up; the task may come back on another CPU
+        kick_klogd();
+        sched::yield();
+    }
+
+    s->ln.ts_ns = clock::now_ns();
+    s->ln.level = level;
+    s->ln.cpu = static_cast<uint8_t>(percpu::current_cpu_id());
+    s->ln.len = 0;
+    *text = s->ln.text;
+    return s;
+}
+
+__PRIVILEGED_CODE void commit(void* handle, size_t len) {
+    auto* s = static_cast<slot*>(handle);
+    s->ln.len = static_cast<uint16_t>(len > LINE_MAX ? LINE_MAX : len);
+    __atomic_store_n(&s->commit, s->reserved + 1, __ATOMIC_RELEASE);
+
+    // Only the first line after klogd looked needs to wake it
+    kick_klogd();
+}
+
+__PRIVILEGED_CODE void emergency_flush() {
+    if (!ready()) {
+        return;
+    }
+    // klogd may be draining on another CPU, take_line() gives each
+    // line to only one of us
+    line ln;
+    while (take_line(&ln)) {
+        log::emergency_write_line(static_cast<log::level>(ln.level), ln.text, ln.len);
+    }
+}
+
+} // namespace kmsg
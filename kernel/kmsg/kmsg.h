@@ -0,0 +1,82 @@
+#ifndef STELLUX_KMSG_KMSG_H
+#define STELLUX_KMSG_KMSG_H
+
+#include "common/types.h"
+
+namespace kmsg {
+
+constexpr int32_t OK  = 0;
+constexpr int32_t ERR = -1;
+
+/*
+ * Asynchronous kernel log.
+ *
+ * Once init() has run, log::debug/info/warn/error and log::raw no longer
+ * write to the console themselves. Each line is formatted straight into
+ * a slot of the calling CPU's ring, reserved with IRQs briefly off
+ * together with a global sequence number, and the "klogd" task writes the
+ * rings to the log backend (the serial console unless log::set_backend()
+ * installed another) in sequence order. A logging CPU therefore never
+ * waits for the UART or for another CPU's message. When a ring is full a
+ * task that can sleep yields until klogd has made room; interrupt
+ * handlers, code running with IRQs disabled and klogd itself drop the
+ * line instead, and klogd reports the loss.
+ *
+ * klogd keeps the last HISTORY_LINES lines for /dev/kmsg. Each read()
+ * returns one line as "<priority>,<seq>,<usec>,-;<text>\n"; reads return
+ * 0 once the reader has caught up, and lseek(fd, 0, SEEK_SET/SEEK_END)
+ * moves to the oldest line or past the newest one.
+ *
+ * log::fatal and the panic handlers stay synchronous; they call
+ * emergency_flush() first so the lines leading up to the crash are not
+ * lost in the rings.
+ */
+
+constexpr size_t   LINE_MAX      = 480;  // text bytes per line, longer lines are truncated
+constexpr uint32_t RING_LINES    = 128;  // per CPU, power of two
+constexpr uint32_t HISTORY_LINES = 256;  // kept for /dev/kmsg, power of two
+
+/**
+ * @brief Allocate the per-CPU rings, start klogd and register /dev/kmsg.
+ * Logging is synchronous until this succeeds. Call once, after
+ * smp::init() and after devfs is mounted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init();
+
+/**
+ * @brief true once init() has succeeded and lines go through klogd.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool ready();
+
+/**
+ * @brief Reserve a line slot in the current CPU's ring.
+ * @param level log::level of the line, or log::level::none for raw output.
+ * @param text Receives the slot's text buffer of LINE_MAX bytes.
+ * @return A handle for commit(), or nullptr if this CPU has no ring or the
+ *   ring is full and the caller cannot yield (the line is counted as
+ *   dropped).
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void* reserve(uint8_t level, char** text);
+
+/**
+ * @brief Publish a reserved line of len bytes and wake klogd if it sleeps.
+ * Safe from IRQ context; must not be called with a runqueue lock held.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void commit(void* handle, size_t len);
+
+/**
+ * @brief Write every published line still in the rings straight to the
+ * serial port, without locks. A line klogd is draining at the same time
+ * is printed by only one of the two. For crash paths only, with IRQs
+ * disabled.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void emergency_flush();
+
+} // namespace kmsg
+
+#endif // STELLUX_KMSG_KMSG_H
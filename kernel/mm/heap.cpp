@@ -19,14 +19,22 @@ static uint8_t size_to_class(size_t size) {
     return 0xFF;
 }
 
+// Offset of the first object in a slab page. Objects start at a
+// multiple of their size, so each one is aligned to its size class
+// (XSAVE areas and other alignas(64) objects rely on this). Costs no
+// capacity: the header only ever displaces a single object.
+static constexpr size_t slab_obj_offset(uint16_t obj_size) {
+    return obj_size < sizeof(slab_header) ? sizeof(slab_header) : obj_size;
+}
+
 // Validate that a freelist pointer is within the valid object region of its slab page.
 __PRIVILEGED_CODE static bool validate_freelist_ptr(
     void* ptr, uintptr_t page_base, uint16_t obj_size, uint16_t objs_per_slab
 ) {
     uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
     if ((p & ~0xFFFULL) != page_base) return false;
-    if (p < page_base + sizeof(slab_header)) return false;
-    uintptr_t offset = p - page_base - sizeof(slab_header);
+    if (p < page_base + slab_obj_offset(obj_size)) return false;
+    uintptr_t offset = p - page_base - slab_obj_offset(obj_size);
     if (offset % obj_size != 0) return false;
     if (offset / obj_size >= objs_per_slab) return false;
     return true;
@@ -69,7 +77,7 @@ __PRIVILEGED_CODE static slab_header* new_slab(uint8_t class_idx, heap_state* st
     header->next = nullptr;
     header->prev = nullptr;
 
-    uintptr_t obj_base = page_va + sizeof(slab_header);
+    uintptr_t obj_base = page_va + slab_obj_offset(obj_size);
     for (uint16_t i = 0; i < capacity - 1; i++) {
         void** slot = reinterpret_cast<void**>(obj_base + i * obj_size);
         *slot = reinterpret_cast<void*>(obj_base + (i + 1) * obj_size);
@@ -259,7 +267,8 @@ __PRIVILEGED_CODE static void init_heap_state(heap_state& state, paging::page_fl
         state.classes[i].partial_head = nullptr;
         state.classes[i].obj_size = CLASS_SIZES[i];
         state.classes[i].objs_per_slab =
-            static_cast<uint16_t>((pmm::PAGE_SIZE - sizeof(slab_header)) / CLASS_SIZES[i]);
+            static_cast<uint16_t>((pmm::PAGE_SIZE - slab_obj_offset(CLASS_SIZES[i])) /
+                                  CLASS_SIZES[i]);
         state.classes[i].total_allocs = 0;
         state.classes[i].total_frees = 0;
     }
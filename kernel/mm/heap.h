@@ -19,6 +19,9 @@ __PRIVILEGED_CODE int32_t init();
 
 /**
  * @brief Allocate from the privileged heap (PAGE_KERNEL_RW).
+ * Blocks are aligned to their size class rounded up to a power of two
+ * (page aligned above 2048 bytes), so a T with alignof(T) <= sizeof(T)
+ * from kalloc_new() is suitably aligned.
  * @note Privilege: **required**
  */
 [[nodiscard]] __PRIVILEGED_CODE void* kalloc(size_t size);
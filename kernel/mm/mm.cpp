@@ -6,6 +6,9 @@
 #include "mm/heap.h"
 #include "mm/paging.h"
 #include "mm/shmem.h"
+#include "sync/futex.h"
+#include "sched/sched.h"
+#include "sched/task.h"
 #include "common/string.h"
 #include "common/logging.h"
 
@@ -20,7 +23,7 @@ void mm_context::ref_destroy(mm_context* self) {
         return;
     }
 
-    sync::mutex_lock(self->lock);
+    sync::down_write(self->lock);
     while (vma* node = self->vmas.min()) {
         if (node->flags & (VMA_FLAG_SHARED | VMA_FLAG_DEVICE)) {
             unmap_pages_only(self, node->start, node->end);
@@ -30,8 +33,9 @@ void mm_context::ref_destroy(mm_context* self) {
         self->vmas.remove(*node);
         free_vma(node);
     }
-    sync::mutex_unlock(self->lock);
+    sync::up_write(self->lock);
 
+    sync::futex_mm_destroy(self);
     paging::destroy_user_pt_root(self->pt_root);
     self->pt_root = 0;
     heap::kfree_delete(self);
@@ -82,9 +86,9 @@ bool handle_user_pf(
         return false;
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_read(mm_ctx->lock);
     bool resolved = handle_user_pf_locked(mm_ctx, fault_address, pf_flags);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_read(mm_ctx->lock);
     return resolved;
 }
 
@@ -138,13 +142,26 @@ bool handle_user_pf_locked(
     // Zero out the memory
     string::memset(paging::phys_to_virt(phys), 0, pmm::PAGE_SIZE);
 
-    // Setup the PTE with appropriate protection bits
+    // Faults hold mm_ctx->lock shared, so other CPUs may be installing
+    // entries in the same tables. Only the install itself is serialized.
     paging::page_flags_t pagefl = prot_to_page_flags(vm->prot);
-    if (paging::map_page(page_addr, phys, pagefl, mm_ctx->pt_root) != paging::OK) {
+    sync::irq_state irq = sync::spin_lock_irqsave(mm_ctx->pt_lock);
+    if (paging::get_physical(page_addr, mm_ctx->pt_root) != 0) {
+        sync::spin_unlock_irqrestore(mm_ctx->pt_lock, irq);
+        pmm::free_page(phys);
+        return true;
+    }
+    int32_t rc = paging::map_page(page_addr, phys, pagefl, mm_ctx->pt_root);
+    sync::spin_unlock_irqrestore(mm_ctx->pt_lock, irq);
+    if (rc != paging::OK) {
         pmm::free_page(phys);
         return false;
     }
 
+    rss_add(mm_ctx, 1);
+    if (sched::task* self = sched::current()) {
+        __atomic_fetch_add(&self->ru.minflt, 1, __ATOMIC_RELAXED);
+    }
     return true;
 }
 
@@ -173,6 +190,11 @@ __PRIVILEGED_CODE mm_context* mm_context_create() {
     }
 
     mm_ctx->lock.init();
+    mm_ctx->pt_lock = sync::SPINLOCK_INIT;
+    mm_ctx->futex = nullptr;
+    mm_ctx->futex_lock = sync::SPINLOCK_INIT;
+    mm_ctx->rss_pages = 0;
+    mm_ctx->hiwater_rss_pages = 0;
     return mm_ctx;
 }
 
@@ -221,22 +243,22 @@ __PRIVILEGED_CODE int32_t mm_context_add_vma(
         return MM_CTX_ERR_INVALID_ARG;
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
 
     vma* node = alloc_vma(start, end, prot, vma_flags);
     if (!node) {
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_NO_MEM;
     }
 
     if (!vma_insert_locked(mm_ctx, node)) {
         free_vma(node);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_EXISTS;
     }
 
     coalesce_all_locked(mm_ctx);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
     return MM_CTX_OK;
 }
 
@@ -290,25 +312,25 @@ __PRIVILEGED_CODE int32_t mm_context_map_anonymous(
         }
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
 
     if (fixed) {
         if (no_replace && vma_find_overlap_locked(mm_ctx, start, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_EXISTS;
         }
 
         if (!no_replace) {
             int32_t rc = unmap_range_locked(mm_ctx, start, end);
             if (rc != MM_CTX_OK) {
-                sync::mutex_unlock(mm_ctx->lock);
+                sync::up_write(mm_ctx->lock);
                 return rc;
             }
         }
     } else {
         start = vma_find_gap_topdown_locked(mm_ctx, aligned_len);
         if (start == 0) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_VIRT;
         }
         end = start + aligned_len;
@@ -322,7 +344,7 @@ __PRIVILEGED_CODE int32_t mm_context_map_anonymous(
             pmm::phys_addr_t phys = pmm::alloc_page();
             if (phys == 0) {
                 rollback_new_pages(mm_ctx, start, mapped_end);
-                sync::mutex_unlock(mm_ctx->lock);
+                sync::up_write(mm_ctx->lock);
                 return MM_CTX_ERR_NO_MEM;
             }
 
@@ -330,9 +352,10 @@ __PRIVILEGED_CODE int32_t mm_context_map_anonymous(
             if (paging::map_page(vaddr, phys, page_flags, mm_ctx->pt_root) != paging::OK) {
                 pmm::free_page(phys);
                 rollback_new_pages(mm_ctx, start, mapped_end);
-                sync::mutex_unlock(mm_ctx->lock);
+                sync::up_write(mm_ctx->lock);
                 return MM_CTX_ERR_MAP_FAILED;
             }
+            rss_add(mm_ctx, 1);
             mapped_end = vaddr + pmm::PAGE_SIZE;
         }
     }
@@ -345,19 +368,19 @@ __PRIVILEGED_CODE int32_t mm_context_map_anonymous(
     vma* node = alloc_vma(start, end, prot, vma_flags);
     if (!node) {
         rollback_new_pages(mm_ctx, start, end);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_NO_MEM;
     }
 
     if (!vma_insert_locked(mm_ctx, node)) {
         free_vma(node);
         rollback_new_pages(mm_ctx, start, end);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_EXISTS;
     }
 
     coalesce_all_locked(mm_ctx);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
 
     *out_addr = start;
     return MM_CTX_OK;
@@ -381,9 +404,9 @@ __PRIVILEGED_CODE int32_t mm_context_unmap(
         return MM_CTX_ERR_INVALID_ARG;
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
     int32_t rc = unmap_range_locked(mm_ctx, addr, end);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
     return rc;
 }
 
@@ -409,17 +432,27 @@ __PRIVILEGED_CODE int32_t mm_context_mprotect(
         return MM_CTX_ERR_INVALID_ARG;
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
 
     if (!range_fully_mapped_locked(mm_ctx, addr, end)) {
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_NOT_MAPPED;
     }
+    if (prot & MM_PROT_WRITE) {
+        for (uintptr_t cur = addr; cur < end;) {
+            vma* node = vma_find_locked(mm_ctx, cur);
+            if (node->flags & VMA_FLAG_READ_ONLY) {
+                sync::up_write(mm_ctx->lock);
+                return MM_CTX_ERR_ACCESS;
+            }
+            cur = node->end;
+        }
+    }
 
     vma* at_start = vma_find_locked(mm_ctx, addr);
     if (at_start && at_start->start < addr && addr < at_start->end) {
         if (!split_vma_locked(mm_ctx, at_start, addr)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_MEM;
         }
     }
@@ -427,7 +460,7 @@ __PRIVILEGED_CODE int32_t mm_context_mprotect(
     vma* at_end = vma_find_locked(mm_ctx, end - 1);
     if (at_end && at_end->start < end && end < at_end->end) {
         if (!split_vma_locked(mm_ctx, at_end, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_MEM;
         }
     }
@@ -451,7 +484,7 @@ __PRIVILEGED_CODE int32_t mm_context_mprotect(
 
         int32_t rc = apply_page_protection(mm_ctx, range_start, range_end, prot);
         if (rc != MM_CTX_OK) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return rc;
         }
 
@@ -460,7 +493,7 @@ __PRIVILEGED_CODE int32_t mm_context_mprotect(
     }
 
     coalesce_all_locked(mm_ctx);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
     return MM_CTX_OK;
 }
 
@@ -501,38 +534,38 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
     uintptr_t start = 0;
     uintptr_t end = 0;
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
 
     if (fixed) {
         if (!is_page_aligned(addr)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_INVALID_ARG;
         }
         start = addr;
         if (!range_from_len(start, aligned_len, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_INVALID_ARG;
         }
         if (start < mm_ctx->mmap_base || end > mm_ctx->mmap_end) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_VIRT;
         }
 
         if (no_replace && vma_find_overlap_locked(mm_ctx, start, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_EXISTS;
         }
         if (!no_replace) {
             int32_t rc = unmap_range_locked(mm_ctx, start, end);
             if (rc != MM_CTX_OK) {
-                sync::mutex_unlock(mm_ctx->lock);
+                sync::up_write(mm_ctx->lock);
                 return rc;
             }
         }
     } else {
         start = vma_find_gap_topdown_locked(mm_ctx, aligned_len);
         if (start == 0) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_VIRT;
         }
         end = start + aligned_len;
@@ -543,7 +576,7 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
     size_t backed_size = backing->m_page_count * pmm::PAGE_SIZE;
     if (aligned_len > backed_size || offset > backed_size - aligned_len) {
         sync::mutex_unlock(backing->lock);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_INVALID_ARG;
     }
 
@@ -556,7 +589,7 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
         if (phys == 0) {
             unmap_pages_only(mm_ctx, start, start + i * pmm::PAGE_SIZE);
             sync::mutex_unlock(backing->lock);
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_MEM;
         }
 
@@ -564,9 +597,10 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
         if (paging::map_page(vaddr, phys, page_flags, mm_ctx->pt_root) != paging::OK) {
             unmap_pages_only(mm_ctx, start, vaddr);
             sync::mutex_unlock(backing->lock);
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_MAP_FAILED;
         }
+        rss_add(mm_ctx, 1);
     }
 
     sync::mutex_unlock(backing->lock);
@@ -574,7 +608,7 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
     vma* node = alloc_vma(start, end, prot, VMA_FLAG_SHARED);
     if (!node) {
         unmap_pages_only(mm_ctx, start, end);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_NO_MEM;
     }
 
@@ -585,12 +619,12 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
     if (!vma_insert_locked(mm_ctx, node)) {
         unmap_pages_only(mm_ctx, start, end);
         free_vma(node);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_EXISTS;
     }
 
     coalesce_all_locked(mm_ctx);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
 
     *out_addr = start;
     return MM_CTX_OK;
@@ -607,7 +641,8 @@ __PRIVILEGED_CODE int32_t mm_context_map_device(
     uint32_t cache_type,
     uint32_t map_flags,
     uintptr_t addr,
-    uintptr_t* out_addr
+    uintptr_t* out_addr,
+    bool read_only
 ) {
     if (!mm_ctx || !out_addr) {
         return MM_CTX_ERR_INVALID_ARG;
@@ -615,6 +650,9 @@ __PRIVILEGED_CODE int32_t mm_context_map_device(
     if ((prot & ~MM_PROT_MASK) != 0) {
         return MM_CTX_ERR_INVALID_ARG;
     }
+    if (read_only && (prot & MM_PROT_WRITE)) {
+        return MM_CTX_ERR_ACCESS;
+    }
     if (!is_page_aligned(phys_base)) {
         return MM_CTX_ERR_INVALID_ARG;
     }
@@ -630,38 +668,38 @@ __PRIVILEGED_CODE int32_t mm_context_map_device(
     uintptr_t start = 0;
     uintptr_t end = 0;
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_write(mm_ctx->lock);
 
     if (fixed) {
         if (!is_page_aligned(addr)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_INVALID_ARG;
         }
         start = addr;
         if (!range_from_len(start, aligned_len, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_INVALID_ARG;
         }
         if (start < mm_ctx->mmap_base || end > mm_ctx->mmap_end) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_VIRT;
         }
 
         if (no_replace && vma_find_overlap_locked(mm_ctx, start, end)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_EXISTS;
         }
         if (!no_replace) {
             int32_t rc = unmap_range_locked(mm_ctx, start, end);
             if (rc != MM_CTX_OK) {
-                sync::mutex_unlock(mm_ctx->lock);
+                sync::up_write(mm_ctx->lock);
                 return rc;
             }
         }
     } else {
         start = vma_find_gap_topdown_locked(mm_ctx, aligned_len);
         if (start == 0) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_write(mm_ctx->lock);
             return MM_CTX_ERR_NO_VIRT;
         }
         end = start + aligned_len;
@@ -671,26 +709,28 @@ __PRIVILEGED_CODE int32_t mm_context_map_device(
     size_t pages = aligned_len / pmm::PAGE_SIZE;
 
     if (paging::map_pages(start, phys_base, page_flags, pages, mm_ctx->pt_root) != paging::OK) {
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_MAP_FAILED;
     }
+    rss_add(mm_ctx, pages);
 
-    vma* node = alloc_vma(start, end, prot, VMA_FLAG_DEVICE);
+    vma* node = alloc_vma(start, end, prot,
+                          VMA_FLAG_DEVICE | (read_only ? VMA_FLAG_READ_ONLY : 0));
     if (!node) {
         unmap_pages_only(mm_ctx, start, end);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_NO_MEM;
     }
 
     if (!vma_insert_locked(mm_ctx, node)) {
         unmap_pages_only(mm_ctx, start, end);
         free_vma(node);
-        sync::mutex_unlock(mm_ctx->lock);
+        sync::up_write(mm_ctx->lock);
         return MM_CTX_ERR_EXISTS;
     }
 
     coalesce_all_locked(mm_ctx);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_write(mm_ctx->lock);
 
     *out_addr = start;
     return MM_CTX_OK;
@@ -704,9 +744,9 @@ __PRIVILEGED_CODE size_t mm_context_vma_count(mm_context* mm_ctx) {
         return 0;
     }
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_read(mm_ctx->lock);
     size_t count = mm_ctx->vmas.size();
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_read(mm_ctx->lock);
     return count;
 }
 
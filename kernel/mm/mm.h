@@ -3,6 +3,8 @@
 
 #include "mm/vma.h"
 
+namespace sync { struct futex_table; }
+
 namespace mm {
 
 constexpr int32_t OK  = 0;
@@ -13,13 +15,30 @@ constexpr uint64_t PF_FLAG_PRESENT     = (1u << 0); // page was present, so must
 constexpr uint64_t PF_FLAG_WRITE       = (1u << 1); // write access violation
 constexpr uint64_t PF_FLAG_INSTRUCTION = (1u << 2); // instruction fetch (NX violation)
 
+/**
+ * `lock` is held shared by page faults and user-range validation and
+ * exclusive by anything that changes the VMA tree or existing mappings.
+ * Shared holders that install page-table entries serialize on
+ * `pt_lock`, which is never held across a sleep.
+ */
 struct mm_context final : rc::ref_counted<mm_context> {
     pmm::phys_addr_t pt_root;
     uintptr_t        mmap_base;
     uintptr_t        mmap_end;
-    sync::mutex      lock;
+    sync::rwsem      lock;
+    sync::spinlock   pt_lock;
     vma_tree         vmas;
 
+    // Futex hash table of this address space, allocated on the first
+    // futex wait and replaced under futex_lock as threads are added
+    sync::futex_table* futex;
+    sync::spinlock     futex_lock;
+
+    // Pages mapped into user space and their high-water mark, kept by
+    // rss_add() and rss_sub()
+    uint64_t           rss_pages;
+    uint64_t           hiwater_rss_pages;
+
     /**
      * @brief Destroy mm_context and reclaim all mapped resources.
      * @note Privilege: **required**
@@ -27,6 +46,25 @@ struct mm_context final : rc::ref_counted<mm_context> {
     __PRIVILEGED_CODE static void ref_destroy(mm_context* self);
 };
 
+/**
+ * @brief Count pages newly mapped into mm_ctx's user space.
+ */
+inline void rss_add(mm_context* mm_ctx, uint64_t pages) {
+    uint64_t rss = __atomic_add_fetch(&mm_ctx->rss_pages, pages, __ATOMIC_RELAXED);
+    uint64_t peak = __atomic_load_n(&mm_ctx->hiwater_rss_pages, __ATOMIC_RELAXED);
+    while (rss > peak &&
+           !__atomic_compare_exchange_n(&mm_ctx->hiwater_rss_pages, &peak, rss, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief Count pages unmapped from mm_ctx's user space.
+ */
+inline void rss_sub(mm_context* mm_ctx, uint64_t pages) {
+    __atomic_sub_fetch(&mm_ctx->rss_pages, pages, __ATOMIC_RELAXED);
+}
+
 /**
  * @brief Initialize the memory management subsystem.
  * Calls PMM, VA layout, KVA, and VMM init in order.
@@ -53,8 +91,8 @@ __PRIVILEGED_CODE bool handle_user_pf(
 );
 
 /**
- * @brief handle_user_pf with mm_ctx->lock already held by the caller.
- * Never blocks, so it is safe from interrupt context.
+ * @brief handle_user_pf with mm_ctx->lock already held by the caller,
+ * shared or exclusive. Never blocks, so it is safe from interrupt context.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE bool handle_user_pf_locked(
@@ -167,7 +205,10 @@ __PRIVILEGED_CODE int32_t mm_context_map_shared(
  * @param map_flags MM_MAP_SHARED, optionally MM_MAP_FIXED / MM_MAP_FIXED_NOREPLACE.
  * @param addr Hint or fixed address.
  * @param out_addr Receives the mapped virtual address.
- * @return MM_CTX_OK on success, error code on failure.
+ * @param read_only Refuse MM_PROT_WRITE now and in later mprotect calls,
+ *   for kernel-written pages published to userland.
+ * @return MM_CTX_OK on success, MM_CTX_ERR_ACCESS for a writable
+ *   read_only mapping, other error code on failure.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t mm_context_map_device(
@@ -178,7 +219,8 @@ __PRIVILEGED_CODE int32_t mm_context_map_device(
     uint32_t cache_type,
     uint32_t map_flags,
     uintptr_t addr,
-    uintptr_t* out_addr
+    uintptr_t* out_addr,
+    bool read_only = false
 );
 
 /**
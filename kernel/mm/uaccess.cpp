@@ -4,7 +4,7 @@
 #include "mm/mm.h"
 #include "sched/sched.h"
 #include "sched/task.h"
-#include "sync/mutex.h"
+#include "sync/rwsem.h"
 #include "common/string.h"
 
 namespace mm::uaccess {
@@ -39,23 +39,23 @@ __PRIVILEGED_CODE int32_t validate_user_range(
     }
 
     mm_context* mm_ctx = task->exec.mm_ctx;
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_read(mm_ctx->lock);
 
     uintptr_t cursor = start;
     while (cursor <= end) {
         vma* region = vma_find_locked(mm_ctx, cursor);
         if (!region || cursor < region->start || cursor >= region->end) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
         if ((region->prot & required_prot) != required_prot) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
 
         uintptr_t next = region->end;
         if (next == 0 || next <= cursor) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
         if (next > end) {
@@ -64,10 +64,9 @@ __PRIVILEGED_CODE int32_t validate_user_range(
         cursor = next;
     }
 
-    sync::mutex_unlock(mm_ctx->lock);
-
     // Pre-fault any lazy pages in the validated range so that the kernel-mode
     // memcpy in copy_from_user/copy_to_user doesn't fault on a not-present PTE.
+    // Still shared, so concurrent faults and copies proceed in parallel.
     uintptr_t end_page = end & ~(pmm::PAGE_SIZE - 1);
     for (uintptr_t page = start & ~(pmm::PAGE_SIZE - 1);
          page <= end_page;
@@ -76,11 +75,13 @@ __PRIVILEGED_CODE int32_t validate_user_range(
             continue;
         }
 
-        if (!handle_user_pf(mm_ctx, page, 0)) {
+        if (!handle_user_pf_locked(mm_ctx, page, 0)) {
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
     }
 
+    sync::up_read(mm_ctx->lock);
     return OK;
 }
 
@@ -160,7 +161,7 @@ __PRIVILEGED_CODE int32_t copy_to_user_nonblock(
 
     // Interrupt context cannot block on the address-space lock
     mm_context* mm_ctx = task->exec.mm_ctx;
-    if (!sync::mutex_trylock(mm_ctx->lock)) {
+    if (!sync::down_read_trylock(mm_ctx->lock)) {
         return ERR_RETRY;
     }
 
@@ -169,13 +170,13 @@ __PRIVILEGED_CODE int32_t copy_to_user_nonblock(
         vma* region = vma_find_locked(mm_ctx, cursor);
         if (!region || cursor < region->start || cursor >= region->end ||
             (region->prot & MM_PROT_WRITE) == 0) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
 
         uintptr_t next = region->end;
         if (next == 0 || next <= cursor) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
         if (next > end) {
@@ -195,14 +196,14 @@ __PRIVILEGED_CODE int32_t copy_to_user_nonblock(
             continue;
         }
         if (!handle_user_pf_locked(mm_ctx, page, 0)) {
-            sync::mutex_unlock(mm_ctx->lock);
+            sync::up_read(mm_ctx->lock);
             return ERR_FAULT;
         }
     }
 
     // Copying under the held lock keeps a concurrent unmap out of the range
     string::memcpy(udst, ksrc, len);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_read(mm_ctx->lock);
     return OK;
 }
 
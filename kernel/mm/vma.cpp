@@ -208,6 +208,7 @@ __PRIVILEGED_CODE void unmap_and_free_pages(mm_context* mm_ctx, uintptr_t start,
 
         pmm::phys_addr_t phys = paging::get_physical(vaddr, mm_ctx->pt_root);
         paging::unmap_page(vaddr, mm_ctx->pt_root);
+        rss_sub(mm_ctx, 1);
         if (phys != 0) {
             pmm::free_page(phys);
         }
@@ -220,6 +221,7 @@ __PRIVILEGED_CODE void unmap_pages_only(mm_context* mm_ctx, uintptr_t start, uin
             continue;
         }
         paging::unmap_page(vaddr, mm_ctx->pt_root);
+        rss_sub(mm_ctx, 1);
     }
 }
 
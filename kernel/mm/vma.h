@@ -7,6 +7,7 @@
 #include "mm/pmm_types.h"
 #include "mm/shmem.h"
 #include "sync/mutex.h"
+#include "sync/rwsem.h"
 #include "rc/ref_counted.h"
 #include "rc/strong_ref.h"
 
@@ -19,6 +20,7 @@ constexpr int32_t MM_CTX_ERR_NO_VIRT      = -3;
 constexpr int32_t MM_CTX_ERR_EXISTS       = -4;
 constexpr int32_t MM_CTX_ERR_MAP_FAILED   = -5;
 constexpr int32_t MM_CTX_ERR_NOT_MAPPED   = -6;
+constexpr int32_t MM_CTX_ERR_ACCESS       = -7;
 
 constexpr uint32_t MM_PROT_READ    = (1u << 0);
 constexpr uint32_t MM_PROT_WRITE   = (1u << 1);
@@ -43,6 +45,7 @@ constexpr uint32_t VMA_FLAG_ELF       = (1u << 2);
 constexpr uint32_t VMA_FLAG_STACK     = (1u << 3);
 constexpr uint32_t VMA_FLAG_SHARED    = (1u << 4);
 constexpr uint32_t VMA_FLAG_DEVICE    = (1u << 5);
+constexpr uint32_t VMA_FLAG_READ_ONLY = (1u << 6); // never made writable
 
 constexpr uintptr_t MMAP_BASE_DEFAULT = 0x00000080000000ULL;
 constexpr uintptr_t USER_STACK_TOP    = 0x00007FFFFFF00000ULL;
@@ -135,7 +138,7 @@ __PRIVILEGED_CODE void free_vma(vma* node);
 
 /**
  * @brief Insert VMA into address tree if it does not overlap neighbors.
- * Caller must hold mm_ctx->lock.
+ * Caller must hold mm_ctx->lock exclusive.
  * @return true on success, false if overlap/duplicate prevents insertion.
  * @note Privilege: **required**
  */
@@ -143,7 +146,7 @@ __PRIVILEGED_CODE void free_vma(vma* node);
 
 /**
  * @brief Remove VMA from address tree.
- * Caller must hold mm_ctx->lock.
+ * Caller must hold mm_ctx->lock exclusive.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void vma_remove_locked(mm_context* mm_ctx, vma& node);
@@ -185,7 +188,7 @@ __PRIVILEGED_CODE void rollback_new_pages(
 
 /**
  * @brief Merge adjacent VMAs with identical prot/flags/backing.
- * Idempotent. Caller must hold mm_ctx->lock.
+ * Idempotent. Caller must hold mm_ctx->lock exclusive.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void coalesce_all_locked(mm_context* mm_ctx);
@@ -193,7 +196,7 @@ __PRIVILEGED_CODE void coalesce_all_locked(mm_context* mm_ctx);
 /**
  * @brief Split a VMA at split_addr into two adjacent VMAs.
  * The left part keeps the original node; the right part is freshly allocated
- * and inserted into the tree. Caller must hold mm_ctx->lock.
+ * and inserted into the tree. Caller must hold mm_ctx->lock exclusive.
  * @return The newly-allocated right-hand VMA, or nullptr on allocation failure
  *         or out-of-range split_addr.
  * @note Privilege: **required**
@@ -204,7 +207,7 @@ __PRIVILEGED_CODE void coalesce_all_locked(mm_context* mm_ctx);
 /**
  * @brief Unmap every VMA overlapping [start, end), splitting at the edges.
  * Frees pages for owned VMAs and releases backing refs for shared/device VMAs.
- * Idempotent over already-unmapped regions. Caller must hold mm_ctx->lock.
+ * Idempotent over already-unmapped regions. Caller must hold mm_ctx->lock exclusive.
  * @return MM_CTX_OK on success, MM_CTX_ERR_NO_MEM if an edge split fails.
  * @note Privilege: **required**
  */
@@ -115,8 +115,9 @@ void arp_recv(netif* iface, const uint8_t* data, size_t len) {
     uint32_t target_ip = ntohl(arp->target_ip);
     uint16_t opcode = ntohs(arp->opcode);
 
-    // Always learn from incoming ARP packets
+    // Always learn from incoming ARP packets, and send what was waiting on it
     arp_table_update(sender_ip, arp->sender_mac);
+    resubmit_arp_pending(sender_ip);
 
     if (opcode == ARP_OP_REQUEST && iface->configured && target_ip == iface->ipv4_addr) {
         // Queue ARP reply for deferred transmission (same principle as
@@ -159,7 +160,7 @@ void arp_send_request(netif* iface, uint32_t target_ip) {
              reinterpret_cast<const uint8_t*>(&req), sizeof(req));
 }
 
-int32_t arp_resolve(netif* iface, uint32_t target_ip, uint8_t* out_mac) {
+int32_t arp_lookup(netif* iface, uint32_t target_ip, uint8_t* out_mac) {
     if (!iface || !out_mac) return ERR_INVAL;
 
     // Check if it's a broadcast address
@@ -169,14 +170,20 @@ int32_t arp_resolve(netif* iface, uint32_t target_ip, uint8_t* out_mac) {
         return OK;
     }
 
-    // Check cache first
-    if (arp_table_lookup(target_ip, out_mac)) {
+    return arp_table_lookup(target_ip, out_mac) ? OK : ERR_NOARP;
+}
+
+int32_t arp_resolve(netif* iface, uint32_t target_ip, uint8_t* out_mac) {
+    if (!iface || !out_mac) return ERR_INVAL;
+
+    // Broadcast or cached
+    if (arp_lookup(iface, target_ip, out_mac) == OK) {
         return OK;
     }
 
     // Sleep between polls so the scheduler can run other tasks and interrupts can fire
-    constexpr uint32_t POLLS_PER_ATTEMPT = 100;
     constexpr uint64_t POLL_SLEEP_MS = 10;
+    constexpr uint32_t POLLS_PER_ATTEMPT = ARP_RETRY_INTERVAL_MS / POLL_SLEEP_MS;
 
     for (uint32_t attempt = 0; attempt < ARP_RETRY_COUNT; attempt++) {
         arp_send_request(iface, target_ip);
@@ -12,6 +12,7 @@ constexpr uint16_t ARP_OP_REPLY    = 2;
 
 constexpr uint32_t ARP_TABLE_SIZE  = 32;
 constexpr uint32_t ARP_RETRY_COUNT = 3;
+constexpr uint64_t ARP_RETRY_INTERVAL_MS = 1000;
 
 struct arp_header {
     uint16_t hw_type;      // network byte order
@@ -39,11 +40,20 @@ void arp_recv(netif* iface, const uint8_t* data, size_t len);
 
 /**
  * Resolve an IPv4 address (host byte order) to a MAC address.
- * May block briefly if an ARP request needs to be sent.
+ * On a cache miss sends requests and sleeps, up to ARP_RETRY_COUNT
+ * intervals of ARP_RETRY_INTERVAL_MS. Work functions must not call it,
+ * see ipv4_send_nowait().
  * @return 0 on success (out_mac filled), negative on failure.
  */
 int32_t arp_resolve(netif* iface, uint32_t target_ip, uint8_t* out_mac);
 
+/**
+ * Look up an IPv4 address (host byte order) in the ARP cache without
+ * sending anything. Broadcast addresses always resolve.
+ * @return 0 on success (out_mac filled), ERR_NOARP on a miss.
+ */
+int32_t arp_lookup(netif* iface, uint32_t target_ip, uint8_t* out_mac);
+
 /**
  * Send an ARP request for the given IP (host byte order).
  */
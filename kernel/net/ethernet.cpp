@@ -5,6 +5,7 @@
 #include "common/logging.h"
 #include "common/string.h"
 #include "mm/heap.h"
+#include "trace/trace.h"
 
 namespace net {
 
@@ -15,6 +16,7 @@ void eth_recv(netif* iface, const uint8_t* data, size_t len) {
 
     const auto* hdr = reinterpret_cast<const eth_header*>(data);
     uint16_t ethertype = ntohs(hdr->ethertype);
+    TRACE(NET_RX, len, ethertype);
 
     const uint8_t* payload = data + sizeof(eth_header);
     size_t payload_len = len - sizeof(eth_header);
@@ -56,6 +58,7 @@ int32_t eth_send(netif* iface, const uint8_t* dst_mac,
 
     int32_t rc = iface->transmit(iface, frame, frame_len);
     heap::kfree(frame);
+    TRACE(NET_TX, frame_len, ethertype, rc);
     return rc;
 }
 
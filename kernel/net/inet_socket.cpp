@@ -161,6 +161,17 @@ __PRIVILEGED_CODE static int32_t inet_ioctl(
     return resource::ERR_UNSUP;
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void inet_socket_free_rcu(rc::rcu::rcu_head* head) {
+    auto* sock = rc::rcu::head_to_entry<inet_socket, &inet_socket::rcu>(head);
+    if (sock->rx_buf) {
+        ring_buffer_destroy(sock->rx_buf);
+    }
+    heap::kfree_delete(sock);
+}
+
 __PRIVILEGED_CODE static void inet_close(resource::resource_object* obj) {
     if (!obj || !obj->impl) {
         return;
@@ -175,10 +186,9 @@ __PRIVILEGED_CODE static void inet_close(resource::resource_object* obj) {
         udp_unregister_socket(sock);
     }
 
-    if (sock->rx_buf) {
-        ring_buffer_destroy(sock->rx_buf);
-    }
-    heap::kfree_delete(sock);
+    // The UDP RX demux walks its list without a lock, free the socket
+    // and its rx_buf once it can no longer be standing on them
+    rc::rcu::call_rcu(&sock->rcu, inet_socket_free_rcu);
     obj->impl = nullptr;
 }
 
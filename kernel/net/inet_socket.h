@@ -4,6 +4,7 @@
 #include "common/types.h"
 #include "resource/resource.h"
 #include "sync/spinlock.h"
+#include "rc/rcu.h"
 
 struct ring_buffer;
 
@@ -27,7 +28,8 @@ struct inet_socket {
     ring_buffer*   rx_buf;     // incoming packets queued here
     uint32_t       so_options; // bitmask of socket options
     sync::spinlock lock;
-    inet_socket*   next;       // linked list for protocol registry
+    inet_socket*      next;    // linked list for protocol registry
+    rc::rcu::rcu_head rcu;     // RX demux may still hold it after unlink
 };
 
 /**
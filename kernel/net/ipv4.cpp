@@ -91,9 +91,16 @@ void ipv4_recv(netif* iface, const uint8_t* data, size_t len) {
     }
 }
 
-int32_t ipv4_send(netif* iface, uint32_t dst_ip, uint8_t protocol,
-                  const uint8_t* payload, size_t payload_len,
-                  uint32_t src_ip_override) {
+namespace {
+
+/**
+ * Build and send one IPv4 packet. With miss_hop null an ARP miss blocks
+ * in arp_resolve(); otherwise the miss sends one ARP request, stores the
+ * next hop in *miss_hop and returns ERR_NOARP without sending.
+ */
+int32_t ipv4_output(netif* iface, uint32_t dst_ip, uint8_t protocol,
+                    const uint8_t* payload, size_t payload_len,
+                    uint32_t src_ip_override, uint32_t* miss_hop) {
     if (!payload) {
         return ERR_INVAL;
     }
@@ -180,7 +187,16 @@ int32_t ipv4_send(netif* iface, uint32_t dst_ip, uint8_t protocol,
 
     // For CONNECTED and GATEWAY routes, resolve the next hop via ARP
     uint8_t dst_mac[MAC_ADDR_LEN];
-    int32_t arp_rc = arp_resolve(out_iface, rt.next_hop, dst_mac);
+    int32_t arp_rc;
+    if (miss_hop) {
+        arp_rc = arp_lookup(out_iface, rt.next_hop, dst_mac);
+        if (arp_rc != OK) {
+            arp_send_request(out_iface, rt.next_hop);
+            *miss_hop = rt.next_hop;
+        }
+    } else {
+        arp_rc = arp_resolve(out_iface, rt.next_hop, dst_mac);
+    }
     if (arp_rc != OK) {
         heap::kfree(packet);
         return arp_rc;
@@ -191,4 +207,23 @@ int32_t ipv4_send(netif* iface, uint32_t dst_ip, uint8_t protocol,
     return rc;
 }
 
+} // anonymous namespace
+
+int32_t ipv4_send(netif* iface, uint32_t dst_ip, uint8_t protocol,
+                  const uint8_t* payload, size_t payload_len,
+                  uint32_t src_ip_override) {
+    return ipv4_output(iface, dst_ip, protocol, payload, payload_len,
+                       src_ip_override, nullptr);
+}
+
+int32_t ipv4_send_nowait(netif* iface, uint32_t dst_ip, uint8_t protocol,
+                         const uint8_t* payload, size_t payload_len,
+                         uint32_t* out_next_hop) {
+    if (!out_next_hop) {
+        return ERR_INVAL;
+    }
+    return ipv4_output(iface, dst_ip, protocol, payload, payload_len,
+                       0, out_next_hop);
+}
+
 } // namespace net
@@ -60,6 +60,16 @@ int32_t ipv4_send(netif* iface, uint32_t dst_ip, uint8_t protocol,
                   const uint8_t* payload, size_t payload_len,
                   uint32_t src_ip_override = 0);
 
+/**
+ * Send an IPv4 packet without waiting for ARP. If the next hop is not in
+ * the ARP cache, sends one ARP request instead and returns ERR_NOARP
+ * with the next hop in *out_next_hop, so the caller can retry once it
+ * resolves. Otherwise behaves as ipv4_send() with routing-chosen source.
+ */
+int32_t ipv4_send_nowait(netif* iface, uint32_t dst_ip, uint8_t protocol,
+                         const uint8_t* payload, size_t payload_len,
+                         uint32_t* out_next_hop);
+
 } // namespace net
 
 #endif // STELLUX_NET_IPV4_H
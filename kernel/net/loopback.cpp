@@ -15,13 +15,11 @@ static bool g_lo_initialized = false;
  * Loopback transmit callback.
  * Feeds the frame directly back to the receive path.
  *
- * Safety: This is called from eth_send() which is called from:
- *   (a) ipv4_send() — top-level send path, not inside RX processing
- *   (b) drain_deferred_tx() — also top-level, after RX delivery
- * In both cases, we are NOT inside rx_frame() processing, so calling
- * rx_frame() here does not cause recursion. Protocol handlers that
- * need to reply (e.g. ICMP echo) use queue_deferred_tx() to defer
- * their responses.
+ * Safety: This is called from eth_send() on the top-level send path or
+ * from a workqueue worker sending a deferred reply, never from inside
+ * rx_frame() processing, so calling rx_frame() here does not recurse.
+ * Protocol handlers that need to reply (e.g. ICMP echo) use
+ * queue_deferred_tx(), and the reply loops back from the worker.
  */
 static int32_t lo_transmit(netif* iface, const uint8_t* frame, size_t len) {
     if (!iface || !frame || len == 0) {
@@ -31,12 +29,6 @@ static int32_t lo_transmit(netif* iface, const uint8_t* frame, size_t len) {
     // Feed the frame back to the receive path.
     rx_frame(iface, frame, len);
 
-    // Drain any deferred TX that was queued during RX processing
-    // (e.g. ICMP echo replies). For hardware NICs, this is done by
-    // the driver's run() loop or poll_callback(). Since loopback has
-    // no driver event loop, we drain immediately here.
-    drain_deferred_tx();
-
     return OK;
 }
 
@@ -0,0 +1,81 @@
+#include "net/napi.h"
+#include "net/net.h"
+
+namespace net {
+
+namespace {
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void napi_run(workqueue::work_item* w) {
+    auto* napi = workqueue::work_to_entry<napi_struct, &napi_struct::work>(w);
+
+    uint32_t done = napi->poll(napi, napi->weight);
+    __atomic_fetch_add(&napi->polls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&napi->frames, done, __ATOMIC_RELAXED);
+
+    if (done >= napi->weight) {
+        // Still scheduled and the device interrupt still masked, go to
+        // the back of this CPU's queue and continue from there
+        __atomic_fetch_add(&napi->repolls, 1, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&napi->state, __ATOMIC_ACQUIRE) & NAPI_STATE_DISABLED) {
+            napi_complete(napi);
+            return;
+        }
+        workqueue::queue_work(&napi->work);
+    }
+}
+
+} // anonymous namespace
+
+void napi_init(napi_struct* napi, netif* iface, napi_poll_fn poll, uint32_t weight) {
+    workqueue::init_work(&napi->work, napi_run);
+    napi->iface = iface;
+    napi->poll = poll;
+    napi->weight = weight ? weight : NAPI_WEIGHT_DEFAULT;
+    napi->state = 0;
+    napi->schedules = 0;
+    napi->polls = 0;
+    napi->frames = 0;
+    napi->repolls = 0;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool napi_schedule(napi_struct* napi) {
+    uint32_t old = __atomic_load_n(&napi->state, __ATOMIC_RELAXED);
+    do {
+        if (old & (NAPI_STATE_SCHED | NAPI_STATE_DISABLED)) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&napi->state, &old, old | NAPI_STATE_SCHED,
+                                          true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (!workqueue::queue_work(&napi->work)) {
+        // No workqueue yet, the driver's own polling picks it up
+        napi_complete(napi);
+        return false;
+    }
+    __atomic_fetch_add(&napi->schedules, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void napi_complete(napi_struct* napi) {
+    __atomic_fetch_and(&napi->state, ~NAPI_STATE_SCHED, __ATOMIC_RELEASE);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void napi_disable(napi_struct* napi) {
+    __atomic_fetch_or(&napi->state, NAPI_STATE_DISABLED, __ATOMIC_ACQ_REL);
+    workqueue::cancel_work(&napi->work);
+    __atomic_fetch_and(&napi->state, ~NAPI_STATE_SCHED, __ATOMIC_RELEASE);
+}
+
+} // namespace net
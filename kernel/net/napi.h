@@ -0,0 +1,87 @@
+#ifndef STELLUX_NET_NAPI_H
+#define STELLUX_NET_NAPI_H
+
+#include "common/types.h"
+#include "workqueue/workqueue.h"
+
+namespace net {
+
+struct netif;
+
+/*
+ * Interrupt/poll hybrid receive.
+ *
+ * A driver's RX interrupt masks the device's RX interrupt and calls
+ * napi_schedule(). The poll function then runs on the workqueue worker
+ * of the CPU that took the interrupt and processes at most budget
+ * frames. If it used the whole budget it returns the budget, stays
+ * scheduled and is queued again behind any other pending work, so
+ * busy interfaces on a CPU share it round-robin in weight-sized slices.
+ * Otherwise the ring is drained: it calls napi_complete() and only then
+ * unmasks the device interrupt, rechecking the ring to close the race
+ * with a frame that landed in between. Under load the device raises
+ * one interrupt per burst instead of one per frame.
+ */
+
+// Frames a poll call may process before yielding to other work
+constexpr uint32_t NAPI_WEIGHT_DEFAULT = 64;
+
+// napi_struct::state bits
+constexpr uint32_t NAPI_STATE_SCHED    = (1u << 0); // poll queued or running
+constexpr uint32_t NAPI_STATE_DISABLED = (1u << 1); // napi_schedule is a no-op
+
+struct napi_struct;
+
+/**
+ * Driver poll function. Processes up to budget received frames.
+ * @return Frames processed. Less than budget means the ring was drained
+ *   and the function has called napi_complete().
+ */
+using napi_poll_fn = uint32_t (*)(napi_struct* napi, uint32_t budget);
+
+struct napi_struct {
+    workqueue::work_item work;
+    netif*        iface;
+    napi_poll_fn  poll;
+    uint32_t      weight;
+    uint32_t      state;      // NAPI_STATE_*
+
+    // Statistics
+    uint64_t      schedules;  // interrupts (or timer polls) that scheduled it
+    uint64_t      polls;      // poll function calls
+    uint64_t      frames;     // frames processed
+    uint64_t      repolls;    // polls that used the whole budget
+};
+
+/**
+ * @brief Prepare a napi_struct. Call before the device can interrupt.
+ * @param weight Budget per poll call, NAPI_WEIGHT_DEFAULT if 0.
+ */
+void napi_init(napi_struct* napi, netif* iface, napi_poll_fn poll, uint32_t weight);
+
+/**
+ * @brief Schedule a poll on this CPU unless one is already scheduled.
+ * Safe from IRQ context. The caller has masked the device's RX
+ * interrupt; it stays masked until the poll function completes.
+ * @return true if this call scheduled the poll.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool napi_schedule(napi_struct* napi);
+
+/**
+ * @brief Mark the poll finished. Called by the poll function once the
+ * ring is empty, before it unmasks the device interrupt.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void napi_complete(napi_struct* napi);
+
+/**
+ * @brief Stop scheduling polls and wait out one in flight. Task context
+ * only. Call after masking the device interrupt, before freeing rings.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void napi_disable(napi_struct* napi);
+
+} // namespace net
+
+#endif // STELLUX_NET_NAPI_H
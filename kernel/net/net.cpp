@@ -8,6 +8,10 @@
 #include "common/logging.h"
 #include "common/string.h"
 #include "sync/spinlock.h"
+#include "rc/rcu.h"
+#include "workqueue/workqueue.h"
+#include "timer/timer.h"
+#include "clock/clock.h"
 #include "mm/heap.h"
 #include "dynpriv/dynpriv.h"
 
@@ -17,22 +21,26 @@ namespace {
 
 __PRIVILEGED_DATA static netif* g_iface_list = nullptr;
 __PRIVILEGED_DATA static netif* g_default_iface = nullptr;
+// Writers serialize on g_net_lock; lookups walk the list under RCU.
 __PRIVILEGED_DATA static sync::spinlock g_net_lock = sync::SPINLOCK_INIT;
 
-// Deferred TX queue: protocol-generated responses (e.g. ICMP echo replies)
-// that cannot be sent inline from RX processing context.
-constexpr uint32_t DEFERRED_TX_MAX = 8;
-
+// Deferred TX: protocol-generated responses (e.g. ICMP echo replies)
+// that cannot be sent inline from RX processing context. Each one is a
+// heap-allocated work item sent by the workqueue worker of the CPU that
+// queued it. The worker is shared with NAPI polls, so an IPv4 send whose
+// next hop misses the ARP cache is parked on g_arp_pending instead of
+// sleeping in arp_resolve().
 enum class deferred_tx_kind : uint8_t {
     ipv4,     // send via ipv4_send (dst_ip + protocol + payload)
     ethernet, // send via eth_send (dst_mac + ethertype + payload)
 };
 
 struct deferred_tx_entry {
+    workqueue::work_item work;
+    deferred_tx_entry* next_pending; // link on g_arp_pending
     netif*           iface;
     deferred_tx_kind kind;
     size_t           len;
-    uint8_t          data[ETH_MTU];
 
     // IPv4-level fields
     uint32_t dst_ip;
@@ -41,17 +49,166 @@ struct deferred_tx_entry {
     // Ethernet-level fields
     uint8_t  dst_mac[MAC_ADDR_LEN];
     uint16_t ethertype;
+
+    // ARP wait state of a parked IPv4 entry
+    uint32_t next_hop;
+    uint32_t arp_tries;   // requests sent so far
+    uint64_t arp_wait_ns; // when to ask again, or drop after the last try
+
+    uint8_t  data[];
 };
 
-__PRIVILEGED_DATA static deferred_tx_entry g_deferred_tx[DEFERRED_TX_MAX] = {};
-__PRIVILEGED_DATA static uint32_t g_deferred_tx_count = 0;
-__PRIVILEGED_DATA static sync::spinlock g_deferred_tx_lock = sync::SPINLOCK_INIT;
+// Deferred transmits queued and not yet sent, for drain_deferred_tx().
+// Entries parked on g_arp_pending are not counted.
+__PRIVILEGED_DATA static uint32_t g_deferred_tx_inflight = 0;
+
+// IPv4 entries waiting for their next hop's MAC. An ARP packet from the
+// next hop requeues them; otherwise the timer requeues them every
+// ARP_RETRY_INTERVAL_MS, and each retry sends another request until
+// ARP_RETRY_COUNT requests went unanswered.
+__PRIVILEGED_DATA static deferred_tx_entry* g_arp_pending = nullptr;
+__PRIVILEGED_DATA static sync::spinlock g_arp_pending_lock = sync::SPINLOCK_INIT;
+__PRIVILEGED_BSS static timer::timer_event g_arp_pending_timer;
+__PRIVILEGED_BSS static workqueue::work_item g_arp_pending_work;
+
+__PRIVILEGED_CODE static void submit_deferred_tx(deferred_tx_entry* entry);
+
+/**
+ * Park an IPv4 entry whose next hop missed the ARP cache, or drop it
+ * once its last request went unanswered. Called from its work function.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void park_arp_pending(deferred_tx_entry* entry,
+                                               uint32_t next_hop) {
+    if (entry->arp_tries >= ARP_RETRY_COUNT) {
+        log::warn("net: no ARP reply from %u.%u.%u.%u, dropping deferred tx",
+                  (next_hop >> 24) & 0xFF, (next_hop >> 16) & 0xFF,
+                  (next_hop >> 8) & 0xFF, next_hop & 0xFF);
+        heap::kfree(entry);
+        return;
+    }
+    entry->next_hop = next_hop;
+    entry->arp_tries++;
+    entry->arp_wait_ns = clock::now_ns() + ARP_RETRY_INTERVAL_MS * 1000000ULL;
+
+    sync::irq_state irq = sync::spin_lock_irqsave(g_arp_pending_lock);
+    entry->next_pending = g_arp_pending;
+    g_arp_pending = entry;
+    // Deadlines only grow, except for entries coming back from a requeue
+    if (!timer::timer_pending(&g_arp_pending_timer) ||
+        entry->arp_wait_ns < g_arp_pending_timer.deadline_ns) {
+        timer::add_timer(&g_arp_pending_timer, entry->arp_wait_ns, 0);
+    }
+    sync::spin_unlock_irqrestore(g_arp_pending_lock, irq);
+}
+
+/**
+ * Timer callback, interrupt context: hand the sweep to a worker.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void arp_pending_timer_fn(void*) {
+    workqueue::queue_work(&g_arp_pending_work);
+}
+
+/**
+ * Requeue parked entries whose wait ran out, so their work function
+ * asks again or drops them, and re-arm the timer for the rest.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void arp_pending_sweep_fn(workqueue::work_item*) {
+    uint64_t now = clock::now_ns();
+    deferred_tx_entry* due = nullptr;
+
+    sync::irq_state irq = sync::spin_lock_irqsave(g_arp_pending_lock);
+    uint64_t next_ns = 0;
+    deferred_tx_entry** pp = &g_arp_pending;
+    while (*pp) {
+        deferred_tx_entry* entry = *pp;
+        if (entry->arp_wait_ns <= now) {
+            *pp = entry->next_pending;
+            entry->next_pending = due;
+            due = entry;
+            continue;
+        }
+        if (!next_ns || entry->arp_wait_ns < next_ns) {
+            next_ns = entry->arp_wait_ns;
+        }
+        pp = &entry->next_pending;
+    }
+    if (next_ns) {
+        timer::add_timer(&g_arp_pending_timer, next_ns, 0);
+    }
+    sync::spin_unlock_irqrestore(g_arp_pending_lock, irq);
+
+    while (due) {
+        deferred_tx_entry* entry = due;
+        due = entry->next_pending;
+        submit_deferred_tx(entry);
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void deferred_tx_fn(workqueue::work_item* w) {
+    auto* entry = workqueue::work_to_entry<deferred_tx_entry,
+                                           &deferred_tx_entry::work>(w);
+    if (entry->kind == deferred_tx_kind::ipv4) {
+        uint32_t next_hop = 0;
+        if (ipv4_send_nowait(entry->iface, entry->dst_ip, entry->protocol,
+                             entry->data, entry->len, &next_hop) == ERR_NOARP) {
+            park_arp_pending(entry, next_hop);
+            __atomic_fetch_sub(&g_deferred_tx_inflight, 1, __ATOMIC_RELEASE);
+            return;
+        }
+    } else if (entry->kind == deferred_tx_kind::ethernet) {
+        eth_send(entry->iface, entry->dst_mac, entry->ethertype,
+                 entry->data, entry->len);
+    }
+    heap::kfree(entry);
+    __atomic_fetch_sub(&g_deferred_tx_inflight, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Allocate a deferred TX entry with room for len payload bytes.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static deferred_tx_entry* alloc_deferred_tx(
+    netif* iface, deferred_tx_kind kind, const uint8_t* data, size_t len
+) {
+    auto* entry = static_cast<deferred_tx_entry*>(
+        heap::kzalloc(sizeof(deferred_tx_entry) + len));
+    if (!entry) {
+        return nullptr;
+    }
+    workqueue::init_work(&entry->work, deferred_tx_fn);
+    entry->iface = iface;
+    entry->kind = kind;
+    entry->len = len;
+    string::memcpy(entry->data, data, len);
+    return entry;
+}
+
+/**
+ * Hand a filled entry to this CPU's worker, dropping it if the
+ * workqueues are not running.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void submit_deferred_tx(deferred_tx_entry* entry) {
+    __atomic_fetch_add(&g_deferred_tx_inflight, 1, __ATOMIC_ACQ_REL);
+    if (!workqueue::queue_work(&entry->work)) {
+        __atomic_fetch_sub(&g_deferred_tx_inflight, 1, __ATOMIC_RELEASE);
+        heap::kfree(entry);
+    }
+}
 
 } // anonymous namespace
 
 __PRIVILEGED_CODE int32_t init() {
     arp_init();
     route_init();
+    timer::init_timer(&g_arp_pending_timer, arp_pending_timer_fn, nullptr);
+    workqueue::init_work(&g_arp_pending_work, arp_pending_sweep_fn);
 
     int32_t lo_rc = loopback_init();
     if (lo_rc != OK) {
@@ -79,7 +236,7 @@ int32_t register_netif(netif* iface) {
     RUN_ELEVATED({
         sync::irq_lock_guard guard(g_net_lock);
         iface->next = g_iface_list;
-        g_iface_list = iface;
+        rc::rcu::assign_pointer(g_iface_list, iface);
         // Set as default only if no default exists AND this is not loopback.
         // Loopback should never be the default outbound interface — external
         // traffic must go through a real NIC. If loopback is the only
@@ -112,7 +269,8 @@ int32_t unregister_netif(netif* iface) {
         netif** pp = &g_iface_list;
         while (*pp) {
             if (*pp == iface) {
-                *pp = iface->next;
+                // Keep iface->next so a reader standing on it can move on
+                rc::rcu::assign_pointer(*pp, iface->next);
                 break;
             }
             pp = &(*pp)->next;
@@ -131,7 +289,6 @@ int32_t unregister_netif(netif* iface) {
         }
     });
 
-    iface->next = nullptr;
     return OK;
 }
 
@@ -180,13 +337,15 @@ netif* find_netif(const char* name) {
 
     netif* result = nullptr;
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_net_lock);
-        for (netif* cur = g_iface_list; cur; cur = cur->next) {
+        sync::irq_state irq = rc::rcu::read_lock();
+        for (netif* cur = rc::rcu::dereference(g_iface_list); cur;
+             cur = rc::rcu::dereference(cur->next)) {
             if (string::strcmp(cur->name, name) == 0) {
                 result = cur;
                 break;
             }
         }
+        rc::rcu::read_unlock(irq);
     });
     return result;
 }
@@ -196,13 +355,15 @@ netif* find_netif_by_ip(uint32_t ip) {
 
     netif* result = nullptr;
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_net_lock);
-        for (netif* cur = g_iface_list; cur; cur = cur->next) {
+        sync::irq_state irq = rc::rcu::read_lock();
+        for (netif* cur = rc::rcu::dereference(g_iface_list); cur;
+             cur = rc::rcu::dereference(cur->next)) {
             if (cur->configured && cur->ipv4_addr == ip) {
                 result = cur;
                 break;
             }
         }
+        rc::rcu::read_unlock(irq);
     });
     return result;
 }
@@ -225,17 +386,12 @@ void queue_deferred_tx(netif* iface, uint32_t dst_ip, uint8_t protocol,
     }
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_deferred_tx_lock);
-
-        if (g_deferred_tx_count < DEFERRED_TX_MAX) {
-            auto& entry = g_deferred_tx[g_deferred_tx_count];
-            entry.iface = iface;
-            entry.kind = deferred_tx_kind::ipv4;
-            entry.dst_ip = dst_ip;
-            entry.protocol = protocol;
-            entry.len = len;
-            string::memcpy(entry.data, data, len);
-            g_deferred_tx_count++;
+        deferred_tx_entry* entry =
+            alloc_deferred_tx(iface, deferred_tx_kind::ipv4, data, len);
+        if (entry) {
+            entry->dst_ip = dst_ip;
+            entry->protocol = protocol;
+            submit_deferred_tx(entry);
         }
     });
 }
@@ -247,53 +403,52 @@ void queue_deferred_eth_tx(netif* iface, const uint8_t* dst_mac,
     }
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_deferred_tx_lock);
-
-        if (g_deferred_tx_count < DEFERRED_TX_MAX) {
-            auto& entry = g_deferred_tx[g_deferred_tx_count];
-            entry.iface = iface;
-            entry.kind = deferred_tx_kind::ethernet;
-            string::memcpy(entry.dst_mac, dst_mac, MAC_ADDR_LEN);
-            entry.ethertype = ethertype;
-            entry.len = len;
-            string::memcpy(entry.data, data, len);
-            g_deferred_tx_count++;
+        deferred_tx_entry* entry =
+            alloc_deferred_tx(iface, deferred_tx_kind::ethernet, data, len);
+        if (entry) {
+            string::memcpy(entry->dst_mac, dst_mac, MAC_ADDR_LEN);
+            entry->ethertype = ethertype;
+            submit_deferred_tx(entry);
         }
     });
 }
 
-void drain_deferred_tx() {
-    // Snapshot and clear the queue under the lock, then send outside it.
-    uint32_t count = 0;
-
-    // Heap-allocate the snapshot
-    auto* local = static_cast<deferred_tx_entry*>(
-        heap::kzalloc(DEFERRED_TX_MAX * sizeof(deferred_tx_entry))
-    );
-    if (!local) {
-        return;
-    }
-
+void resubmit_arp_pending(uint32_t ip) {
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_deferred_tx_lock);
-        count = g_deferred_tx_count;
-        if (count > 0) {
-            string::memcpy(local, g_deferred_tx, count * sizeof(deferred_tx_entry));
-            g_deferred_tx_count = 0;
+        deferred_tx_entry* ready = nullptr;
+        sync::irq_state irq = sync::spin_lock_irqsave(g_arp_pending_lock);
+        deferred_tx_entry** pp = &g_arp_pending;
+        while (*pp) {
+            deferred_tx_entry* entry = *pp;
+            if (entry->next_hop == ip) {
+                *pp = entry->next_pending;
+                entry->next_pending = ready;
+                ready = entry;
+            } else {
+                pp = &entry->next_pending;
+            }
         }
-    });
+        sync::spin_unlock_irqrestore(g_arp_pending_lock, irq);
 
-    for (uint32_t i = 0; i < count; i++) {
-        if (local[i].kind == deferred_tx_kind::ipv4) {
-            ipv4_send(local[i].iface, local[i].dst_ip, local[i].protocol,
-                      local[i].data, local[i].len);
-        } else if (local[i].kind == deferred_tx_kind::ethernet) {
-            eth_send(local[i].iface, local[i].dst_mac, local[i].ethertype,
-                     local[i].data, local[i].len);
+        while (ready) {
+            deferred_tx_entry* entry = ready;
+            ready = entry->next_pending;
+            submit_deferred_tx(entry);
         }
-    }
+    });
+}
 
-    heap::kfree(local);
+void drain_deferred_tx() {
+    // A worker sending a deferred reply can reach here through loopback,
+    // it must not wait on the workers
+    RUN_ELEVATED({
+        if (!workqueue::in_worker()) {
+            // Sends may queue follow-up replies, so repeat until none is left
+            while (__atomic_load_n(&g_deferred_tx_inflight, __ATOMIC_ACQUIRE) != 0) {
+                workqueue::flush_all();
+            }
+        }
+    });
 }
 
 __PRIVILEGED_CODE int32_t query_status(net_status* out) {
@@ -301,10 +456,10 @@ __PRIVILEGED_CODE int32_t query_status(net_status* out) {
 
     string::memset(out, 0, sizeof(net_status));
 
-    // Snapshot interface data under the lock.
+    // Snapshot interface data in a read-side section.
     // Save link_up callback + netif pointer for each interface so we
-    // can query live link status outside the lock (avoids calling
-    // driver callbacks while holding g_net_lock).
+    // can query live link status outside it (avoids calling driver
+    // callbacks with IRQs masked).
     struct snapshot_entry {
         netif* iface;
         netif_link_fn link_fn;
@@ -314,9 +469,9 @@ __PRIVILEGED_CODE int32_t query_status(net_status* out) {
     uint32_t count = 0;
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_net_lock);
+        sync::irq_state irq = rc::rcu::read_lock();
 
-        netif* cur = g_iface_list;
+        netif* cur = rc::rcu::dereference(g_iface_list);
         while (cur && count < MAX_INTERFACES) {
             auto& e = out->interfaces[count];
             string::memcpy(e.name, cur->name, 16);
@@ -337,11 +492,12 @@ __PRIVILEGED_CODE int32_t query_status(net_status* out) {
             snap[count].link_fn = cur->link_up;
             snap[count].is_default = (cur == g_default_iface);
             count++;
-            cur = cur->next;
+            cur = rc::rcu::dereference(cur->next);
         }
+        rc::rcu::read_unlock(irq);
     });
 
-    // Query live link status outside the lock.
+    // Query live link status outside the section.
     for (uint32_t i = 0; i < count; i++) {
         if (snap[i].link_fn && snap[i].link_fn(snap[i].iface)) {
             out->interfaces[i].flags |= IFF_UP;
@@ -77,7 +77,9 @@ __PRIVILEGED_CODE int32_t init();
 int32_t register_netif(netif* iface);
 
 /**
- * Unregister a network interface (for hot-unplug).
+ * Unregister a network interface (for hot-unplug). Does not wait for
+ * lockless readers: the caller keeps *iface valid for an RCU grace
+ * period after this returns (call_rcu or rcu::synchronize).
  * @note Safe to call from any kernel context.
  */
 int32_t unregister_netif(netif* iface);
@@ -133,7 +135,10 @@ void rx_frame(netif* iface, const uint8_t* data, size_t len);
  * Queue a protocol-generated response (e.g. ICMP echo reply) for
  * deferred transmission. Called from RX processing context where
  * inline TX would cause recursion through the ARP/poll path.
- * Packets are sent later by drain_deferred_tx().
+ * The packet is copied and sent from this CPU's workqueue worker;
+ * it is dropped if no memory is available. If the next hop is not in
+ * the ARP cache it waits for the reply without holding the worker, and
+ * is dropped after ARP_RETRY_COUNT unanswered requests.
  * @param iface    Interface to send on.
  * @param dst_ip   Destination IP in host byte order.
  * @param protocol IPv4 protocol number.
@@ -151,10 +156,16 @@ void queue_deferred_eth_tx(netif* iface, const uint8_t* dst_mac,
                            uint16_t ethertype, const uint8_t* data, size_t len);
 
 /**
- * Send all packets queued by queue_deferred_tx().
- * Called from the driver's run() or poll_callback after RX delivery
- * is complete. Runs at the top level, outside any RX processing,
- * so ipv4_send and ARP resolution are safe.
+ * Requeue deferred IPv4 packets that were waiting for ip (host byte
+ * order) to answer ARP. Called when an ARP packet from ip is learned.
+ */
+void resubmit_arp_pending(uint32_t ip);
+
+/**
+ * Wait until every packet queued by queue_deferred_tx() and
+ * queue_deferred_eth_tx(), and any reply those trigger, has been sent.
+ * Packets waiting for an ARP reply are not waited for.
+ * Task context only, may sleep. No-op from a workqueue worker.
  */
 void drain_deferred_tx();
 
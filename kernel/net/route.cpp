@@ -1,13 +1,25 @@
 #include "net/route.h"
 #include "net/loopback.h"
 #include "sync/spinlock.h"
+#include "rc/rcu.h"
+#include "mm/heap.h"
+#include "common/string.h"
+#include "common/logging.h"
 #include "dynpriv/dynpriv.h"
 
 namespace net {
 
 namespace {
 
-__PRIVILEGED_DATA static route_entry g_route_table[ROUTE_TABLE_SIZE] = {};
+// The table is copy-on-write. Writers serialize on g_route_lock, build
+// a modified copy and publish it; lookups read whichever table is
+// current under RCU and the old one is freed after a grace period.
+struct route_table {
+    rc::rcu::rcu_head rcu;
+    route_entry       entries[ROUTE_TABLE_SIZE];
+};
+
+__PRIVILEGED_DATA static route_table* g_route_table = nullptr;
 __PRIVILEGED_DATA static sync::spinlock g_route_lock = sync::SPINLOCK_INIT;
 
 /**
@@ -20,12 +32,45 @@ static uint32_t popcount32(uint32_t v) {
     return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void free_route_table(rc::rcu::rcu_head* head) {
+    heap::kfree(rc::rcu::head_to_entry<route_table, &route_table::rcu>(head));
+}
+
+/**
+ * Allocate an empty table. Writers allocate before taking g_route_lock
+ * and fill the copy in under it.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static route_table* alloc_route_table() {
+    return static_cast<route_table*>(heap::kzalloc(sizeof(route_table)));
+}
+
+/**
+ * Publish next in place of the current table and retire the old one.
+ * Caller must hold g_route_lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void publish_route_table_locked(route_table* next) {
+    route_table* old = g_route_table;
+    rc::rcu::assign_pointer(g_route_table, next);
+    if (old) {
+        rc::rcu::call_rcu(&old->rcu, free_route_table);
+    }
+}
+
 } // anonymous namespace
 
 __PRIVILEGED_CODE void route_init() {
-    for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
-        g_route_table[i].valid = false;
+    route_table* table = alloc_route_table();
+    if (!table) {
+        log::warn("net: route table allocation failed");
+        return;
     }
+    sync::irq_lock_guard guard(g_route_lock);
+    publish_route_table_locked(table);
 }
 
 int32_t route_add(uint32_t dest, uint32_t netmask, uint32_t gateway,
@@ -43,21 +88,35 @@ int32_t route_add(uint32_t dest, uint32_t netmask, uint32_t gateway,
     int32_t result = ERR_NOMEM;
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_route_lock);
+        route_table* next = alloc_route_table();
+        if (next) {
+            sync::irq_lock_guard guard(g_route_lock);
+            if (g_route_table) {
+                string::memcpy(next->entries, g_route_table->entries,
+                               sizeof(next->entries));
+            }
 
-        for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
-            if (!g_route_table[i].valid) {
-                g_route_table[i].dest    = dest;
-                g_route_table[i].netmask = netmask;
-                g_route_table[i].gateway = gateway;
-                g_route_table[i].iface   = iface;
-                g_route_table[i].owner   = owner;
-                g_route_table[i].type    = type;
-                g_route_table[i].metric  = metric;
-                g_route_table[i].valid   = true;
-                result = OK;
-                break;
+            for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
+                if (!next->entries[i].valid) {
+                    next->entries[i].dest    = dest;
+                    next->entries[i].netmask = netmask;
+                    next->entries[i].gateway = gateway;
+                    next->entries[i].iface   = iface;
+                    next->entries[i].owner   = owner;
+                    next->entries[i].type    = type;
+                    next->entries[i].metric  = metric;
+                    next->entries[i].valid   = true;
+                    result = OK;
+                    break;
+                }
             }
+
+            if (result == OK) {
+                publish_route_table_locked(next);
+            }
+        }
+        if (result != OK && next) {
+            heap::kfree(next);
         }
     });
 
@@ -68,14 +127,31 @@ void route_del_iface(netif* iface) {
     if (!iface) return;
 
     RUN_ELEVATED({
+        route_table* next = alloc_route_table();
         sync::irq_lock_guard guard(g_route_lock);
 
-        // Match on the owner field so that LOCAL routes (which point to
-        // loopback as their outgoing interface) are correctly associated
-        // with the interface whose configure() created them.
-        for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
-            if (g_route_table[i].valid && g_route_table[i].owner == iface) {
-                g_route_table[i].valid = false;
+        route_table* cur = g_route_table;
+        if (!cur) {
+            if (next) heap::kfree(next);
+        } else if (next) {
+            // Match on the owner field so that LOCAL routes (which point to
+            // loopback as their outgoing interface) are correctly associated
+            // with the interface whose configure() created them.
+            string::memcpy(next->entries, cur->entries, sizeof(next->entries));
+            for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
+                if (next->entries[i].valid && next->entries[i].owner == iface) {
+                    next->entries[i].valid = false;
+                }
+            }
+            publish_route_table_locked(next);
+        } else {
+            // No memory for a copy. Clearing valid in place is still
+            // safe for readers, only refilling a slot in place is not,
+            // and route_add never does that.
+            for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
+                if (cur->entries[i].valid && cur->entries[i].owner == iface) {
+                    __atomic_store_n(&cur->entries[i].valid, false, __ATOMIC_RELAXED);
+                }
             }
         }
     });
@@ -84,40 +160,42 @@ void route_del_iface(netif* iface) {
 int32_t route_lookup(uint32_t dst_ip, route_result* result) {
     if (!result) return ERR_INVAL;
 
-    int32_t rc = ERR_NOIF;
+    int32_t status = ERR_NOIF;
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_route_lock);
+        sync::irq_state irq = rc::rcu::read_lock();
+        route_table* table = rc::rcu::dereference(g_route_table);
 
         bool found = false;
         uint32_t best_prefix_len = 0;
         uint16_t best_metric = 0xFFFF;
         uint32_t best_idx = 0;
 
-        for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
-            if (!g_route_table[i].valid) continue;
+        for (uint32_t i = 0; table && i < ROUTE_TABLE_SIZE; i++) {
+            const route_entry& e = table->entries[i];
+            if (!__atomic_load_n(&e.valid, __ATOMIC_RELAXED)) continue;
 
             // Check if destination matches this route's network
-            if ((dst_ip & g_route_table[i].netmask) != g_route_table[i].dest) {
+            if ((dst_ip & e.netmask) != e.dest) {
                 continue;
             }
 
-            uint32_t prefix_len = popcount32(g_route_table[i].netmask);
+            uint32_t prefix_len = popcount32(e.netmask);
 
             // Prefer longest prefix match, then lowest metric
             if (!found ||
                 prefix_len > best_prefix_len ||
                 (prefix_len == best_prefix_len &&
-                 g_route_table[i].metric < best_metric)) {
+                 e.metric < best_metric)) {
                 best_prefix_len = prefix_len;
-                best_metric = g_route_table[i].metric;
+                best_metric = e.metric;
                 best_idx = i;
                 found = true;
             }
         }
 
         if (found) {
-            const auto& best = g_route_table[best_idx];
+            const auto& best = table->entries[best_idx];
             result->iface = best.iface;
             result->type  = best.type;
 
@@ -136,11 +214,12 @@ int32_t route_lookup(uint32_t dst_ip, route_result* result) {
                 break;
             }
 
-            rc = OK;
+            status = OK;
         }
+        rc::rcu::read_unlock(irq);
     });
 
-    return rc;
+    return status;
 }
 
 void route_add_interface_routes(netif* iface) {
@@ -179,12 +258,14 @@ uint32_t route_count() {
     uint32_t count = 0;
 
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_route_lock);
-        for (uint32_t i = 0; i < ROUTE_TABLE_SIZE; i++) {
-            if (g_route_table[i].valid) {
+        sync::irq_state irq = rc::rcu::read_lock();
+        route_table* table = rc::rcu::dereference(g_route_table);
+        for (uint32_t i = 0; table && i < ROUTE_TABLE_SIZE; i++) {
+            if (__atomic_load_n(&table->entries[i].valid, __ATOMIC_RELAXED)) {
                 count++;
             }
         }
+        rc::rcu::read_unlock(irq);
     });
 
     return count;
@@ -21,7 +21,8 @@ namespace net {
 
 // TCP port registry: global linked list of all TCP sockets that have
 // a local port assigned (via bind). Used by tcp_recv to find the
-// matching socket for incoming segments.
+// matching socket for incoming segments. Writers serialize on
+// g_tcp_sock_lock, tcp_lookup walks the list under RCU.
 __PRIVILEGED_DATA static tcp_socket* g_tcp_sock_list = nullptr;
 __PRIVILEGED_DATA static sync::spinlock g_tcp_sock_lock = sync::SPINLOCK_INIT;
 
@@ -175,8 +176,8 @@ __PRIVILEGED_CODE static void tcp_close(resource::resource_object* obj) {
                 tcp_socket* child = *pp;
                 if (child->parent == sock) {
                     if (child->state == tcp_state::SYN_RECEIVED) {
-                        *pp = child->next;
-                        child->next = destroy_list;
+                        rc::rcu::assign_pointer(*pp, child->next);
+                        child->destroy_next = destroy_list;
                         destroy_list = child;
                         child->parent = nullptr;
                         continue;
@@ -190,8 +191,7 @@ __PRIVILEGED_CODE static void tcp_close(resource::resource_object* obj) {
             pp = &g_tcp_sock_list;
             while (*pp) {
                 if (*pp == sock) {
-                    *pp = sock->next;
-                    sock->next = nullptr;
+                    rc::rcu::assign_pointer(*pp, sock->next);
                     break;
                 }
                 pp = &(*pp)->next;
@@ -210,8 +210,8 @@ __PRIVILEGED_CODE static void tcp_close(resource::resource_object* obj) {
 
         while (destroy_list) {
             tcp_socket* child = destroy_list;
-            destroy_list = child->next;
-            child->next = nullptr;
+            destroy_list = child->destroy_next;
+            child->destroy_next = nullptr;
             tcp_sock_release(child);
         }
 
@@ -400,10 +400,15 @@ __PRIVILEGED_CODE static int32_t tcp_accept(
     while (sock->accept_queue.empty()
            && sock->state == tcp_state::LISTEN
            && !signals::interrupt_pending(task)) {
-        irq = sync::wait(sock->accept_wq, sock->lock, irq);
+        irq = sync::wait_exclusive(sock->accept_wq, sock->lock, irq);
     }
     if (signals::interrupt_pending(task)) {
+        // Hand a connection this acceptor may have been woken for to the next
+        bool pass = !sock->accept_queue.empty();
         sync::spin_unlock_irqrestore(sock->lock, irq);
+        if (pass) {
+            sync::wake_one(sock->accept_wq);
+        }
         return resource::ERR_INTR;
     }
 
@@ -631,7 +636,7 @@ __PRIVILEGED_CODE static int32_t tcp_connect(
         RUN_ELEVATED({
             sync::irq_lock_guard guard(g_tcp_sock_lock);
             sock->next = g_tcp_sock_list;
-            g_tcp_sock_list = sock;
+            rc::rcu::assign_pointer(g_tcp_sock_list, sock);
         });
     }
     sync::spin_unlock_irqrestore(sock->lock, irq);
@@ -843,12 +848,15 @@ const resource::resource_ops g_tcp_ops = {
 // Look up a TCP socket matching an incoming segment.
 // For LISTEN sockets: match on local port (and optionally local addr).
 // For established connections: match on the full 4-tuple.
-// Caller must hold g_tcp_sock_lock. Returns a ref'd pointer or nullptr.
+// Caller must be in an RCU read-side section. try_add_ref fails on a
+// socket whose last ref is already gone, its memory stays valid until
+// the grace period ends. Returns a ref'd pointer or nullptr.
 static tcp_socket* tcp_lookup(uint32_t src_ip, uint16_t src_port,
                               uint32_t dst_ip, uint16_t dst_port) {
     tcp_socket* listen_match = nullptr;
 
-    for (tcp_socket* s = g_tcp_sock_list; s; s = s->next) {
+    for (tcp_socket* s = rc::rcu::dereference(g_tcp_sock_list); s;
+         s = rc::rcu::dereference(s->next)) {
         if (s->local_port != dst_port) continue;
         if (s->local_addr != 0 && s->local_addr != dst_ip) continue;
 
@@ -920,6 +928,7 @@ static void tcp_listen_recv_syn(tcp_socket* listener,
     child->shut_wr = false;
     child->lock = sync::SPINLOCK_INIT;
     child->next = nullptr;
+    child->destroy_next = nullptr;
 
     bool registered = false;
     RUN_ELEVATED({
@@ -927,7 +936,7 @@ static void tcp_listen_recv_syn(tcp_socket* listener,
         child->parent = listener;
         if (listener->state == tcp_state::LISTEN) {
             child->next = g_tcp_sock_list;
-            g_tcp_sock_list = child;
+            rc::rcu::assign_pointer(g_tcp_sock_list, child);
             registered = true;
         }
     });
@@ -1015,8 +1024,11 @@ static void tcp_synrcvd_recv_ack(tcp_socket* sock, uint32_t ack_num,
     }
 }
 
-__PRIVILEGED_CODE void tcp_socket::ref_destroy(tcp_socket* self) {
-    if (!self) return;
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void tcp_socket_free_rcu(rc::rcu::rcu_head* head) {
+    auto* self = rc::rcu::head_to_entry<tcp_socket, &tcp_socket::rcu>(head);
     if (self->rx_buf) {
         ring_buffer_destroy(self->rx_buf);
         self->rx_buf = nullptr;
@@ -1024,6 +1036,11 @@ __PRIVILEGED_CODE void tcp_socket::ref_destroy(tcp_socket* self) {
     heap::kfree_delete(self);
 }
 
+__PRIVILEGED_CODE void tcp_socket::ref_destroy(tcp_socket* self) {
+    if (!self) return;
+    rc::rcu::call_rcu(&self->rcu, tcp_socket_free_rcu);
+}
+
 bool tcp_try_register(tcp_socket* sock) {
     if (!sock || sock->local_port == 0) {
         return false;
@@ -1051,7 +1068,7 @@ bool tcp_try_register(tcp_socket* sock) {
 
         if (!conflict) {
             sock->next = g_tcp_sock_list;
-            g_tcp_sock_list = sock;
+            rc::rcu::assign_pointer(g_tcp_sock_list, sock);
             registered = true;
         }
     });
@@ -1067,8 +1084,8 @@ bool tcp_unregister_socket(tcp_socket* sock) {
         tcp_socket** pp = &g_tcp_sock_list;
         while (*pp) {
             if (*pp == sock) {
-                *pp = sock->next;
-                sock->next = nullptr;
+                // Keep sock->next so a lookup standing on it can move on
+                rc::rcu::assign_pointer(*pp, sock->next);
                 found = true;
                 break;
             }
@@ -1108,6 +1125,7 @@ int32_t create_tcp_socket(resource::resource_object** out) {
     sock->shut_wr = false;
     sock->lock = sync::SPINLOCK_INIT;
     sock->next = nullptr;
+    sock->destroy_next = nullptr;
 
     auto* obj = heap::kalloc_new<resource::resource_object>();
     if (!obj) {
@@ -1152,8 +1170,9 @@ void tcp_recv(netif* iface, uint32_t src_ip, uint32_t dst_ip,
     // Look up matching socket
     tcp_socket* sock = nullptr;
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_tcp_sock_lock);
+        sync::irq_state irq = rc::rcu::read_lock();
         sock = tcp_lookup(src_ip, src_port, dst_ip, dst_port);
+        rc::rcu::read_unlock(irq);
     });
 
     if (!sock) {
@@ -4,6 +4,7 @@
 #include "net/net.h"
 #include "resource/resource.h"
 #include "rc/ref_counted.h"
+#include "rc/rcu.h"
 #include "sync/spinlock.h"
 #include "sync/wait_queue.h"
 #include "common/list.h"
@@ -96,9 +97,13 @@ struct tcp_socket : rc::ref_counted<tcp_socket> {
     bool           shut_rd;     // read side shutdown (SHUT_RD)
     bool           shut_wr;     // write side shutdown (SHUT_WR / FIN sent)
     sync::spinlock lock;
-    tcp_socket*    next;        // linked list for port registry
+    tcp_socket*    next;        // linked list for port registry (RCU)
+    tcp_socket*    destroy_next; // listener close: children to release
+    rc::rcu::rcu_head rcu;      // lookups may still hold it after unlink
 
     /**
+     * Frees the socket after an RCU grace period, since the lockless
+     * segment lookup can still be walking over it.
      * @note Privilege: **required**
      */
     __PRIVILEGED_CODE static void ref_destroy(tcp_socket* self);
@@ -8,6 +8,7 @@
 #include "common/ring_buffer.h"
 #include "mm/heap.h"
 #include "sync/spinlock.h"
+#include "rc/rcu.h"
 #include "dynpriv/dynpriv.h"
 #include "common/logging.h"
 
@@ -15,6 +16,8 @@ namespace net {
 
 namespace {
 
+// Writers serialize on g_udp_sock_lock, the RX demux walks the list
+// under RCU
 __PRIVILEGED_DATA static inet_socket* g_udp_sock_list = nullptr;
 __PRIVILEGED_DATA static sync::spinlock g_udp_sock_lock = sync::SPINLOCK_INIT;
 __PRIVILEGED_DATA static volatile uint32_t g_ephemeral_next = UDP_PORT_EPHEMERAL_MIN;
@@ -62,8 +65,8 @@ void udp_recv(netif* iface, uint32_t src_ip, uint32_t dst_ip,
         dhcp_rx_hook(payload, payload_len);
     }
 
-    // Build the framed ring buffer entry before taking the lock.
-    // This keeps heap alloc/free outside the IRQ-disabled critical section.
+    // Build the framed ring buffer entry before the lookup.
+    // This keeps heap alloc/free outside the IRQ-disabled read section.
     uint32_t src_ip_net = htonl(src_ip);
     uint16_t src_port_net = hdr->src_port;
     uint16_t plen = static_cast<uint16_t>(payload_len);
@@ -79,10 +82,12 @@ void udp_recv(netif* iface, uint32_t src_ip, uint32_t dst_ip,
         string::memcpy(entry + RX_ENTRY_HEADER, payload, payload_len);
     }
 
-    // Lock only for socket lookup + ring buffer write
+    // Socket lookup + ring buffer write. A closed socket and its rx_buf
+    // are freed through call_rcu, after this section.
     RUN_ELEVATED({
-        sync::irq_lock_guard guard(g_udp_sock_lock);
-        for (inet_socket* s = g_udp_sock_list; s; s = s->next) {
+        sync::irq_state irq = rc::rcu::read_lock();
+        for (inet_socket* s = rc::rcu::dereference(g_udp_sock_list); s;
+             s = rc::rcu::dereference(s->next)) {
             if (htons(s->bound_port) == dst_port_net
                 && (s->bound_addr == 0 || s->bound_addr == dst_ip)
                 && s->rx_buf) {
@@ -90,6 +95,7 @@ void udp_recv(netif* iface, uint32_t src_ip, uint32_t dst_ip,
                 break;
             }
         }
+        rc::rcu::read_unlock(irq);
     });
 
     heap::kfree(entry);
@@ -101,7 +107,7 @@ void udp_register_socket(inet_socket* sock) {
     RUN_ELEVATED({
         sync::irq_lock_guard guard(g_udp_sock_lock);
         sock->next = g_udp_sock_list;
-        g_udp_sock_list = sock;
+        rc::rcu::assign_pointer(g_udp_sock_list, sock);
     });
 }
 
@@ -113,8 +119,8 @@ void udp_unregister_socket(inet_socket* sock) {
         inet_socket** pp = &g_udp_sock_list;
         while (*pp) {
             if (*pp == sock) {
-                *pp = sock->next;
-                sock->next = nullptr;
+                // Keep sock->next so a reader standing on it can move on
+                rc::rcu::assign_pointer(*pp, sock->next);
                 break;
             }
             pp = &(*pp)->next;
@@ -148,7 +154,7 @@ bool udp_try_register(inet_socket* sock) {
 
         if (!conflict) {
             sock->next = g_udp_sock_list;
-            g_udp_sock_list = sock;
+            rc::rcu::assign_pointer(g_udp_sock_list, sock);
             registered = true;
         }
     });
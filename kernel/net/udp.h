@@ -38,7 +38,8 @@ void udp_register_socket(inet_socket* sock);
 
 /**
  * Unregister an inet socket from UDP delivery.
- * Called during socket close.
+ * Called during socket close. The RX demux may still be looking at the
+ * socket, so the caller frees it only after a grace period (call_rcu).
  */
 void udp_unregister_socket(inet_socket* sock);
 
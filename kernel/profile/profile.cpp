@@ -0,0 +1,347 @@
+#include "profile/profile.h"
+#include "fs/node.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs/devfs/devfs.h"
+#include "mm/heap.h"
+#include "mm/uaccess.h"
+#include "percpu/percpu.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "smp/smp.h"
+#include "clock/clock.h"
+#include "timer/timer.h"
+#include "sync/mutex.h"
+#include "debug/stacktrace.h"
+#include "debug/symtab.h"
+#include "dynpriv/dynpriv.h"
+#include "common/logging.h"
+#include "common/string.h"
+
+namespace profile {
+
+namespace {
+
+static_assert((RING_SAMPLES & (RING_SAMPLES - 1)) == 0,
+              "RING_SAMPLES must be a power of two");
+
+/**
+ * Sampling state of one CPU. head is advanced only by this CPU's timer
+ * interrupt and tail only by read_samples(), so the ring needs no lock.
+ * session, pending and the timer are touched only on the owning CPU.
+ */
+struct cpu_profile {
+    timer::timer_event timer;
+    sample*            ring;
+    uint32_t           head;
+    uint32_t           tail;
+    uint32_t           session; // session the sampling timer is armed for
+    bool               pending; // sampling timer fired, sample at the next hook
+    uint64_t           samples;
+    uint64_t           drops;
+};
+
+// Allocated on the first start(), then kept for the life of the kernel
+static DEFINE_PER_CPU(cpu_profile*, cpu_prof);
+
+__PRIVILEGED_BSS static uint32_t   g_running;
+__PRIVILEGED_BSS static uint32_t   g_session;
+__PRIVILEGED_BSS static uint32_t   g_freq_hz;
+__PRIVILEGED_BSS static uint32_t   g_next_cpu;   // first CPU the next read drains
+__PRIVILEGED_BSS static sync::mutex g_lock;      // start/stop and readers
+
+__PRIVILEGED_CODE uint64_t period_ns() {
+    return 1000000000ULL / __atomic_load_n(&g_freq_hz, __ATOMIC_RELAXED);
+}
+
+__PRIVILEGED_CODE cpu_profile* cpu_state(uint32_t cpu) {
+    return __atomic_load_n(&per_cpu_on(cpu_prof, cpu), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Sampling timer callback, runs in interrupt context on the owning CPU.
+ * Flags the sample for on_timer_interrupt(), which has the trap frame,
+ * and re-arms while the session lasts.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void sample_timer_fn(void* arg) {
+    auto* cp = static_cast<cpu_profile*>(arg);
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE) ||
+        cp->session != __atomic_load_n(&g_session, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    cp->pending = true;
+    timer::add_timer(&cp->timer, clock::now_ns() + period_ns(), timer::TIMER_HIGHRES);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t alloc_cpu_states() {
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        if (cpu_state(cpu)) {
+            continue;
+        }
+        auto* cp = static_cast<cpu_profile*>(heap::kzalloc(sizeof(cpu_profile)));
+        if (!cp) {
+            return ERR;
+        }
+        cp->ring = static_cast<sample*>(heap::kzalloc(RING_SAMPLES * sizeof(sample)));
+        if (!cp->ring) {
+            heap::kfree(cp);
+            return ERR;
+        }
+        timer::init_timer(&cp->timer, sample_timer_fn, cp);
+        __atomic_store_n(&per_cpu_on(cpu_prof, cpu), cp, __ATOMIC_RELEASE);
+    }
+    return OK;
+}
+
+/**
+ * Append one sample to this CPU's ring. Runs in interrupt context.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record(cpu_profile* cp, uint64_t pc, uint64_t fp,
+                              bool user, bool elevated) {
+    uint32_t head = cp->head;
+    uint32_t tail = __atomic_load_n(&cp->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= RING_SAMPLES) {
+        __atomic_fetch_add(&cp->drops, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    sample& s = cp->ring[head & (RING_SAMPLES - 1)];
+    sched::task* t = sched::current();
+    s.pc = pc;
+    s.tid = t ? t->tid : 0;
+    s.cpu = static_cast<uint16_t>(percpu::current_cpu_id());
+    s.flags = (user ? SAMPLE_USER : 0) | (elevated ? SAMPLE_ELEVATED : 0);
+    s.depth = 0;
+
+    // Only kernel stacks are walked, user frame pointers are not trusted here
+    if (!user) {
+        stacktrace::frame frames[SAMPLE_MAX_STACK];
+        int depth = stacktrace::walk(fp, frames, SAMPLE_MAX_STACK);
+        for (int i = 0; i < depth; i++) {
+            s.stack[i] = frames[i].return_addr;
+        }
+        s.depth = static_cast<uint8_t>(depth);
+    }
+
+    __atomic_store_n(&cp->head, head + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&cp->samples, 1, __ATOMIC_RELAXED);
+}
+
+class profile_node : public fs::node {
+public:
+    profile_node() : fs::node(fs::node_type::char_device, nullptr, "profile") {}
+
+    ssize_t read(fs::file*, void* buf, size_t count) override {
+        if (!buf || count < sizeof(sample)) {
+            return fs::ERR_INVAL;
+        }
+        size_t got = 0;
+        RUN_ELEVATED(got = read_samples(static_cast<sample*>(buf),
+                                        count / sizeof(sample)));
+        return static_cast<ssize_t>(got * sizeof(sample));
+    }
+
+    int32_t ioctl(fs::file*, uint32_t cmd, uint64_t arg) override {
+        int32_t rc = fs::OK;
+        switch (cmd) {
+        case PROFILE_START:
+            RUN_ELEVATED(rc = start() == OK ? fs::OK : fs::ERR_NOMEM);
+            return rc;
+        case PROFILE_STOP:
+            RUN_ELEVATED(stop());
+            return fs::OK;
+        case PROFILE_SET_FREQ:
+            if (arg == 0 || arg > MAX_FREQ_HZ) {
+                return fs::ERR_INVAL;
+            }
+            RUN_ELEVATED(set_frequency(static_cast<uint32_t>(arg)));
+            return fs::OK;
+        case PROFILE_GET_STATS:
+            RUN_ELEVATED({
+                profile_stats stats = read_stats();
+                if (mm::uaccess::copy_to_user(reinterpret_cast<void*>(arg),
+                                              &stats, sizeof(stats)) != mm::uaccess::OK) {
+                    rc = fs::ERR_INVAL;
+                }
+            });
+            return rc;
+        case PROFILE_RESOLVE:
+            RUN_ELEVATED(rc = resolve_user(arg));
+            return rc;
+        default:
+            return fs::ERR_NOSYS;
+        }
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = 0;
+        return fs::OK;
+    }
+
+private:
+    /**
+     * @note Privilege: **required**
+     */
+    __PRIVILEGED_CODE static int32_t resolve_user(uint64_t arg) {
+        profile_symbol sym;
+        auto* usym = reinterpret_cast<profile_symbol*>(arg);
+        if (mm::uaccess::copy_from_user(&sym, usym, sizeof(sym)) != mm::uaccess::OK) {
+            return fs::ERR_INVAL;
+        }
+
+        symtab::resolve_result res;
+        if (!symtab::resolve(sym.addr, &res)) {
+            return fs::ERR_NOENT;
+        }
+        size_t len = string::strnlen(res.name, sizeof(sym.name) - 1);
+        string::memcpy(sym.name, res.name, len);
+        sym.name[len] = '\0';
+        sym.offset = res.offset;
+
+        if (mm::uaccess::copy_to_user(usym, &sym, sizeof(sym)) != mm::uaccess::OK) {
+            return fs::ERR_INVAL;
+        }
+        return fs::OK;
+    }
+};
+
+} // anonymous namespace
+
+__PRIVILEGED_CODE int32_t init() {
+    g_lock.init();
+    g_freq_hz = DEFAULT_FREQ_HZ;
+
+    auto* node = heap::kalloc_new<profile_node>();
+    if (!node) {
+        log::error("profile: failed to allocate /dev/profile");
+        return ERR;
+    }
+    if (devfs::add_char_device("profile", node) != devfs::OK) {
+        log::error("profile: failed to register /dev/profile");
+        heap::kfree_delete(node);
+        return ERR;
+    }
+    return OK;
+}
+
+__PRIVILEGED_CODE int32_t start() {
+    sync::mutex_lock(g_lock);
+    if (alloc_cpu_states() != OK) {
+        sync::mutex_unlock(g_lock);
+        log::error("profile: failed to allocate sample rings");
+        return ERR;
+    }
+
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_profile* cp = cpu_state(cpu);
+        __atomic_store_n(&cp->tail, __atomic_load_n(&cp->head, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELEASE);
+        __atomic_store_n(&cp->samples, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&cp->drops, 0, __ATOMIC_RELAXED);
+    }
+
+    // Each CPU arms its sampling timer on its next timer interrupt
+    __atomic_fetch_add(&g_session, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_running, 1, __ATOMIC_RELEASE);
+    sync::mutex_unlock(g_lock);
+    return OK;
+}
+
+__PRIVILEGED_CODE void stop() {
+    sync::mutex_lock(g_lock);
+    __atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_profile* cp = cpu_state(cpu);
+        if (cp) {
+            timer::cancel_timer(&cp->timer);
+        }
+    }
+    sync::mutex_unlock(g_lock);
+}
+
+__PRIVILEGED_CODE void set_frequency(uint32_t hz) {
+    if (hz == 0) hz = 1;
+    if (hz > MAX_FREQ_HZ) hz = MAX_FREQ_HZ;
+    __atomic_store_n(&g_freq_hz, hz, __ATOMIC_RELAXED);
+}
+
+__PRIVILEGED_CODE profile_stats read_stats() {
+    profile_stats stats = {};
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_profile* cp = cpu_state(cpu);
+        if (cp) {
+            stats.samples += __atomic_load_n(&cp->samples, __ATOMIC_RELAXED);
+            stats.drops += __atomic_load_n(&cp->drops, __ATOMIC_RELAXED);
+        }
+    }
+    stats.freq_hz = __atomic_load_n(&g_freq_hz, __ATOMIC_RELAXED);
+    stats.running = __atomic_load_n(&g_running, __ATOMIC_ACQUIRE);
+    return stats;
+}
+
+__PRIVILEGED_CODE size_t read_samples(sample* out, size_t max) {
+    sync::mutex_lock(g_lock);
+    uint32_t cpus = smp::cpu_count();
+    size_t got = 0;
+
+    // Rotate the starting CPU so small reads do not favour CPU 0
+    for (uint32_t i = 0; i < cpus && got < max; i++) {
+        uint32_t cpu = (g_next_cpu + i) % cpus;
+        cpu_profile* cp = cpu_state(cpu);
+        if (!cp) {
+            continue;
+        }
+        uint32_t tail = cp->tail;
+        uint32_t head = __atomic_load_n(&cp->head, __ATOMIC_ACQUIRE);
+        while (tail != head && got < max) {
+            out[got++] = cp->ring[tail & (RING_SAMPLES - 1)];
+            tail++;
+        }
+        __atomic_store_n(&cp->tail, tail, __ATOMIC_RELEASE);
+    }
+    if (cpus) {
+        g_next_cpu = (g_next_cpu + 1) % cpus;
+    }
+
+    sync::mutex_unlock(g_lock);
+    return got;
+}
+
+__PRIVILEGED_CODE void on_timer_interrupt(uint64_t pc, uint64_t fp,
+                                          bool user, bool elevated) {
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    cpu_profile* cp = __atomic_load_n(&this_cpu(cpu_prof), __ATOMIC_ACQUIRE);
+    if (!cp) {
+        return;
+    }
+
+    uint32_t session = __atomic_load_n(&g_session, __ATOMIC_ACQUIRE);
+    if (cp->session != session) {
+        // First interrupt of a new session on this CPU
+        cp->session = session;
+        cp->pending = false;
+        timer::add_timer(&cp->timer, clock::now_ns() + period_ns(), timer::TIMER_HIGHRES);
+        return;
+    }
+
+    if (!cp->pending) {
+        return;
+    }
+    cp->pending = false;
+    record(cp, pc, fp, user, elevated);
+}
+
+} // namespace profile
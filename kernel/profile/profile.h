@@ -0,0 +1,125 @@
+#ifndef STELLUX_PROFILE_PROFILE_H
+#define STELLUX_PROFILE_PROFILE_H
+
+#include "common/types.h"
+
+namespace profile {
+
+constexpr int32_t OK  = 0;
+constexpr int32_t ERR = -1;
+
+/*
+ * Statistical sampling profiler.
+ *
+ * While running, every CPU arms a high resolution timer at the sampling
+ * frequency. The timer interrupt that follows records the interrupted
+ * pc, task, mode and, for kernel code, a frame pointer backtrace into a
+ * per-CPU single-producer ring, so sampling takes no locks. A CPU joins
+ * a session on its first timer interrupt after start(); a NOHZ idle CPU
+ * takes no samples until it has work. Full rings drop new samples.
+ *
+ * /dev/profile streams the samples as struct sample records and is
+ * controlled with the PROFILE_* ioctls below.
+ */
+
+constexpr uint32_t SAMPLE_MAX_STACK = 14;
+
+// sample::flags
+constexpr uint8_t SAMPLE_USER     = (1u << 0); // interrupted in user code
+constexpr uint8_t SAMPLE_ELEVATED = (1u << 1); // task was elevated
+
+struct sample {
+    uint64_t pc;
+    uint32_t tid;
+    uint16_t cpu;
+    uint8_t  flags;
+    uint8_t  depth;                   // valid stack entries
+    uint64_t stack[SAMPLE_MAX_STACK]; // return addresses, innermost first
+};
+
+static_assert(sizeof(sample) == 128, "profile::sample must be 128 bytes");
+
+constexpr uint32_t DEFAULT_FREQ_HZ = 1000;
+constexpr uint32_t MAX_FREQ_HZ     = 10000;
+constexpr uint32_t RING_SAMPLES    = 2048; // per CPU, power of two
+
+// /dev/profile ioctls
+constexpr uint32_t PROFILE_START     = 0x5000; // discard old samples and start
+constexpr uint32_t PROFILE_STOP      = 0x5001;
+constexpr uint32_t PROFILE_SET_FREQ  = 0x5002; // arg: frequency in Hz
+constexpr uint32_t PROFILE_GET_STATS = 0x5003; // arg: profile_stats*
+constexpr uint32_t PROFILE_RESOLVE   = 0x5004; // arg: profile_symbol*
+
+struct profile_stats {
+    uint64_t samples; // recorded since the last start
+    uint64_t drops;   // lost to full rings since the last start
+    uint32_t freq_hz;
+    uint32_t running;
+};
+
+// PROFILE_RESOLVE: addr in, kernel symbol name and offset out
+struct profile_symbol {
+    uint64_t addr;
+    uint64_t offset;
+    char     name[112];
+};
+
+static_assert(sizeof(profile_symbol) == 128, "profile::profile_symbol must be 128 bytes");
+
+/**
+ * @brief Register /dev/profile. Must be called after devfs is mounted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init();
+
+/**
+ * @brief Discard buffered samples and start sampling on every CPU.
+ * Allocates the per-CPU rings on first use.
+ * @return OK, or ERR if the rings could not be allocated.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t start();
+
+/**
+ * @brief Stop sampling. Buffered samples stay readable.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void stop();
+
+/**
+ * @brief Set the sampling frequency, clamped to 1..MAX_FREQ_HZ. Takes
+ * effect at each CPU's next sample.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void set_frequency(uint32_t hz);
+
+/**
+ * @brief Counters and state of the current or last session.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE profile_stats read_stats();
+
+/**
+ * @brief Move up to max buffered samples into out, draining the CPUs in
+ * turn. Readers are serialized; sampling continues meanwhile.
+ * @return Number of samples copied, 0 once every ring is empty.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE size_t read_samples(sample* out, size_t max);
+
+/**
+ * @brief Timer interrupt hook, called by the arch trap handler before
+ * the scheduler tick with the interrupted context. Records a sample if
+ * this CPU's sampling timer fired since the last call.
+ * @param pc Interrupted program counter.
+ * @param fp Interrupted frame pointer.
+ * @param user Interrupted code was userland.
+ * @param elevated Interrupted task was running elevated.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void on_timer_interrupt(uint64_t pc, uint64_t fp,
+                                          bool user, bool elevated);
+
+} // namespace profile
+
+#endif // STELLUX_PROFILE_PROFILE_H
@@ -0,0 +1,137 @@
+#include "rc/rcu.h"
+#include "sched/sched.h"
+#include "smp/smp.h"
+#include "percpu/percpu.h"
+
+namespace rc {
+namespace rcu {
+
+// Poll interval of synchronize() while a grace period is in flight
+constexpr uint64_t RCU_SYNC_POLL_NS = 1000000;
+
+// Grace periods are numbered. g_gp_started is the newest one begun,
+// every period up to g_gp_completed has ended, and g_gp_requested is
+// the newest one some caller is waiting for. At most one is in flight.
+__PRIVILEGED_DATA static sync::spinlock g_gp_lock = sync::SPINLOCK_INIT;
+__PRIVILEGED_DATA static uint64_t g_gp_started = 0;
+__PRIVILEGED_DATA static uint64_t g_gp_completed = 0;
+__PRIVILEGED_DATA static uint64_t g_gp_requested = 0;
+
+// Newest grace period this CPU has passed a quiescent state in
+static DEFINE_PER_CPU(uint64_t, cpu_qs_seq);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void note_quiescent_state() {
+    uint64_t started = __atomic_load_n(&g_gp_started, __ATOMIC_ACQUIRE);
+    if (this_cpu(cpu_qs_seq) != started) {
+        // Release: the read-side sections this CPU ran before here
+        // happen before whoever sees the report and frees
+        __atomic_store_n(&this_cpu(cpu_qs_seq), started, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * End the grace period in flight once every online CPU has reported,
+ * then start the next one if anyone is waiting for it.
+ * Caller must hold g_gp_lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void advance_locked() {
+    if (g_gp_started != g_gp_completed) {
+        bool lagging = false;
+        for (uint32_t cpu = 0; cpu < smp::cpu_count(); cpu++) {
+            smp::cpu_info* info = smp::get_cpu_info(cpu);
+            if (!info || __atomic_load_n(&info->state, __ATOMIC_ACQUIRE) != smp::CPU_ONLINE) {
+                continue;
+            }
+            if (__atomic_load_n(&per_cpu_on(cpu_qs_seq, cpu), __ATOMIC_ACQUIRE) != g_gp_started) {
+                // A tickless idle CPU passes no scheduler trap on its own
+                sched::kick_if_idle(cpu);
+                lagging = true;
+            }
+        }
+        if (lagging) {
+            return;
+        }
+        __atomic_store_n(&g_gp_completed, g_gp_started, __ATOMIC_RELEASE);
+    }
+
+    if (g_gp_requested != g_gp_completed) {
+        __atomic_store_n(&g_gp_started, g_gp_completed + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint64_t start_grace_period() {
+    sync::irq_state irq = sync::spin_lock_irqsave(g_gp_lock);
+    // A period already in flight may have seen this CPU's report before
+    // the caller's removal, so the removal needs the one after it
+    uint64_t cookie = g_gp_started + 1;
+    if (g_gp_requested < cookie) {
+        g_gp_requested = cookie;
+    }
+    advance_locked();
+    sync::spin_unlock_irqrestore(g_gp_lock, irq);
+    return cookie;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool poll_grace_period(uint64_t cookie) {
+    if (__atomic_load_n(&g_gp_completed, __ATOMIC_ACQUIRE) >= cookie) {
+        return true;
+    }
+
+    note_quiescent_state();
+    sync::irq_state irq = sync::spin_lock_irqsave(g_gp_lock);
+    advance_locked();
+    bool done = g_gp_completed >= cookie;
+    sync::spin_unlock_irqrestore(g_gp_lock, irq);
+    // A period may have just started, report for it too
+    note_quiescent_state();
+    return done;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static reaper::cleanup_result run_callback(reaper::dead_node* node) {
+    rcu_head* head = reinterpret_cast<rcu_head*>(
+        reinterpret_cast<uintptr_t>(node) - __builtin_offsetof(rcu_head, reaper_node));
+    if (!poll_grace_period(head->gp_cookie)) {
+        return reaper::RETRY_LATER;
+    }
+    head->fn(head);
+    return reaper::DONE;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void call_rcu(rcu_head* head, rcu_callback fn) {
+    if (!head || !fn) {
+        return;
+    }
+    head->fn = fn;
+    head->gp_cookie = start_grace_period();
+    head->reaper_node.init(run_callback);
+    reaper::defer(&head->reaper_node);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void synchronize() {
+    uint64_t cookie = start_grace_period();
+    while (!poll_grace_period(cookie)) {
+        sched::sleep_ns(RCU_SYNC_POLL_NS);
+    }
+}
+
+} // namespace rcu
+} // namespace rc
@@ -0,0 +1,117 @@
+#ifndef STELLUX_RC_RCU_H
+#define STELLUX_RC_RCU_H
+
+#include "common/types.h"
+#include "rc/reaper.h"
+#include "sync/spinlock.h"
+#include "hw/cpu.h"
+
+/*
+ * Read-copy-update for read-mostly kernel tables.
+ *
+ * Readers bracket lookups with read_lock()/read_unlock() and take no
+ * lock shared with writers. A read-side section runs with IRQs masked,
+ * so it is never preempted and must not sleep. Every scheduler trap
+ * (tick, yield, reschedule IPI) is therefore a quiescent state for its
+ * CPU: no read-side section spans it.
+ *
+ * Writers still serialize among themselves with their own lock, unlink
+ * an object with release ordering, and free it only after a grace
+ * period, once every online CPU has passed a quiescent state. Deferred
+ * frees ride on the reaper queue.
+ */
+
+namespace rc {
+namespace rcu {
+
+struct rcu_head;
+using rcu_callback = void (*)(rcu_head*);
+
+struct rcu_head {
+    reaper::dead_node reaper_node;
+    uint64_t          gp_cookie;
+    rcu_callback      fn;
+};
+
+/**
+ * Enter a read-side section. Sections nest.
+ * @note Privilege: **required**
+ */
+[[nodiscard]] __PRIVILEGED_CODE inline sync::irq_state read_lock() {
+    return sync::irq_state{cpu::irq_save()};
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline void read_unlock(sync::irq_state state) {
+    cpu::irq_restore(state.flags);
+}
+
+/**
+ * Load an RCU-protected pointer inside a read-side section.
+ */
+template<typename T>
+inline T* dereference(T* const& ptr) {
+    return __atomic_load_n(&ptr, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Publish a pointer to a fully initialized object to readers.
+ */
+template<typename T>
+inline void assign_pointer(T*& ptr, T* value) {
+    __atomic_store_n(&ptr, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * Report a quiescent state for this CPU. Called from the scheduler trap
+ * paths; callers outside them must not be inside a read-side section.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void note_quiescent_state();
+
+/**
+ * Request a grace period that starts after every removal done so far.
+ * @return Cookie for poll_grace_period().
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint64_t start_grace_period();
+
+/**
+ * Check, and push forward, the grace period behind a cookie. Lagging
+ * tickless idle CPUs are kicked. The caller must not be inside a
+ * read-side section.
+ * @return true once the grace period has ended.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool poll_grace_period(uint64_t cookie);
+
+/**
+ * Invoke fn(head) from the reaper after a grace period. Never blocks,
+ * safe from IRQ context and inside read-side sections.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void call_rcu(rcu_head* head, rcu_callback fn);
+
+/**
+ * Block until a full grace period has elapsed. Task context only,
+ * outside any read-side section.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void synchronize();
+
+/**
+ * Recover the object embedding an rcu_head, for use in callbacks.
+ */
+template<typename T, rcu_head T::*Member>
+inline T* head_to_entry(rcu_head* head) {
+    const uintptr_t offset = reinterpret_cast<uintptr_t>(
+        &(static_cast<T*>(nullptr)->*Member));
+    return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(head) - offset);
+}
+
+} // namespace rcu
+} // namespace rc
+
+#endif // STELLUX_RC_RCU_H
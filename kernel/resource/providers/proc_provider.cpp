@@ -114,9 +114,14 @@ __PRIVILEGED_CODE int32_t create_proc_resource(
 
     pr->lock = sync::SPINLOCK_INIT;
     pr->child = child_task;
+    pr->pid = child_task->tid;
+    pr->thread = child_task->group && child_task->group->pid != child_task->tid;
     pr->wait_queue.init();
     pr->wait_status = 0;
+    pr->rusage = {};
+    pr->children_rusage = {};
     pr->exited = false;
+    pr->reaped = false;
     pr->detached = false;
 
     pr->add_ref(); // refcount 1 -> 2 (second ref for the child task)
@@ -168,38 +173,16 @@ __PRIVILEGED_CODE void destroy_unstarted_task(sched::task* t) {
         return;
     }
 
-    // Leave the registry before the group teardown so registry walkers
-    // never see a task whose group is being freed (same order as reap_task)
-    sched::g_task_registry.remove(*t);
-
-    resource::release_task_handles(t);
-    if (t->cwd) {
-        if (t->cwd->release()) {
-            fs::node::ref_destroy(t->cwd);
-        }
-        t->cwd = nullptr;
-    }
-
-    if (t->exec.mm_ctx) {
-        mm::mm_context_release(t->exec.mm_ctx);
-        t->exec.mm_ctx = nullptr;
-    }
-
-    if (t->group) {
-        if (t->group->leader != t && t->group_link.is_linked()) {
-            sync::irq_state irq = sync::spin_lock_irqsave(t->group->lock);
-            t->group->threads.remove(t);
-            t->group->thread_count--;
-            sync::spin_unlock_irqrestore(t->group->lock, irq);
-        }
-        if (t->group->release()) {
-            sched::thread_group::ref_destroy(t->group);
-        }
-        t->group = nullptr;
+    if (t->group && t->group->leader != t && t->group_link.is_linked()) {
+        sync::irq_state irq = sync::spin_lock_irqsave(t->group->lock);
+        t->group->threads.remove(t);
+        t->group->thread_count--;
+        sync::spin_unlock_irqrestore(t->group->lock, irq);
     }
 
-    vmm::free(t->sys_stack_base);
-    heap::kfree_delete(t);
+    // Lockless registry walkers may still hold the task; the reaper
+    // frees it after a grace period, as it does exited tasks
+    sched::reap_unstarted(t);
 }
 
 } // namespace resource::proc_provider
@@ -5,15 +5,21 @@
 #include "sync/wait_queue.h"
 #include "rc/ref_counted.h"
 #include "rc/strong_ref.h"
+#include "sched/rusage.h"
 
 namespace resource::proc_provider {
 
 struct proc_resource : rc::ref_counted<proc_resource> {
     sync::spinlock    lock;
     sched::task*      child;
+    uint32_t          pid; // child tid, kept after the child is gone
+    bool              thread; // child is a thread, not a new process
     sync::wait_queue  wait_queue;
     int32_t           wait_status;
+    sched::task_rusage rusage; // usage at exit, valid once exited
+    sched::task_rusage children_rusage; // its own reaped children at exit
     bool              exited;
+    bool              reaped; // claimed by one waiter, under lock
     bool              detached;
 
     /**
@@ -47,7 +53,8 @@ __PRIVILEGED_CODE int32_t create_proc_resource(
 
 /**
  * @brief Destroy a task that was created but never started (TASK_STATE_CREATED).
- * Frees mm_ctx, system stack, and the task struct. Does NOT release proc_res ref.
+ * Hands it to the reaper, which frees mm_ctx, system stack, and the task
+ * struct after an RCU grace period. Does NOT release proc_res ref.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void destroy_unstarted_task(sched::task* t);
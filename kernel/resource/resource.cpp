@@ -158,6 +158,11 @@ __PRIVILEGED_CODE ssize_t read(
     if (obj->ops && obj->ops->read) {
         result = obj->ops->read(obj, kdst, count, handle_flags);
     }
+    if (result > 0) {
+        uint64_t* counter = obj->type == resource_type::SOCKET
+            ? &owner->ru.net_rx_bytes : &owner->ru.read_bytes;
+        __atomic_fetch_add(counter, static_cast<uint64_t>(result), __ATOMIC_RELAXED);
+    }
 
     resource_release(obj);
     return result;
@@ -187,6 +192,11 @@ __PRIVILEGED_CODE ssize_t write(
     if (obj->ops && obj->ops->write) {
         result = obj->ops->write(obj, ksrc, count, handle_flags);
     }
+    if (result > 0) {
+        uint64_t* counter = obj->type == resource_type::SOCKET
+            ? &owner->ru.net_tx_bytes : &owner->ru.write_bytes;
+        __atomic_fetch_add(counter, static_cast<uint64_t>(result), __ATOMIC_RELAXED);
+    }
 
     resource_release(obj);
     return result;
@@ -0,0 +1,113 @@
+#include "sched/rusage.h"
+#include "sched/task.h"
+#include "mm/mm.h"
+#include "mm/pmm.h"
+
+namespace sched {
+
+void rusage_add(task_rusage* into, const task_rusage& from) {
+    into->user_ns      += from.user_ns;
+    into->sys_ns       += from.sys_ns;
+    into->minflt       += from.minflt;
+    into->nvcsw        += from.nvcsw;
+    into->nivcsw       += from.nivcsw;
+    into->syscalls     += from.syscalls;
+    into->read_bytes   += from.read_bytes;
+    into->write_bytes  += from.write_bytes;
+    into->net_rx_bytes += from.net_rx_bytes;
+    into->net_tx_bytes += from.net_tx_bytes;
+    if (from.maxrss_kb > into->maxrss_kb) {
+        into->maxrss_kb = from.maxrss_kb;
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_task_rusage(const task* t, task_rusage* out) {
+    const task_rusage& ru = t->ru;
+    uint64_t run_ns = __atomic_load_n(&t->run_ns, __ATOMIC_RELAXED);
+    uint64_t sys_ns = __atomic_load_n(&ru.sys_ns, __ATOMIC_RELAXED);
+
+    // Both are charged at different points, so sys_ns can briefly lead
+    if (t->exec.flags & TASK_FLAG_KERNEL) {
+        sys_ns = run_ns;
+    } else if (sys_ns > run_ns) {
+        sys_ns = run_ns;
+    }
+    out->user_ns      = run_ns - sys_ns;
+    out->sys_ns       = sys_ns;
+    out->minflt       = __atomic_load_n(&ru.minflt, __ATOMIC_RELAXED);
+    out->nvcsw        = __atomic_load_n(&ru.nvcsw, __ATOMIC_RELAXED);
+    out->nivcsw       = __atomic_load_n(&ru.nivcsw, __ATOMIC_RELAXED);
+    out->syscalls     = __atomic_load_n(&ru.syscalls, __ATOMIC_RELAXED);
+    out->read_bytes   = __atomic_load_n(&ru.read_bytes, __ATOMIC_RELAXED);
+    out->write_bytes  = __atomic_load_n(&ru.write_bytes, __ATOMIC_RELAXED);
+    out->net_rx_bytes = __atomic_load_n(&ru.net_rx_bytes, __ATOMIC_RELAXED);
+    out->net_tx_bytes = __atomic_load_n(&ru.net_tx_bytes, __ATOMIC_RELAXED);
+
+    mm::mm_context* mm_ctx = t->exec.mm_ctx;
+    out->maxrss_kb = mm_ctx
+        ? __atomic_load_n(&mm_ctx->hiwater_rss_pages, __ATOMIC_RELAXED) * (pmm::PAGE_SIZE / 1024)
+        : 0;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_group_rusage(thread_group* tg, task_rusage* out) {
+    task_rusage live = {};
+
+    sync::irq_state irq = sync::spin_lock_irqsave(tg->lock);
+    *out = tg->exited_ru;
+    if (tg->leader) {
+        read_task_rusage(tg->leader, &live);
+        rusage_add(out, live);
+    }
+    for (task& thread : tg->threads) {
+        read_task_rusage(&thread, &live);
+        rusage_add(out, live);
+    }
+    sync::spin_unlock_irqrestore(tg->lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_children_rusage(thread_group* tg, task_rusage* out) {
+    sync::irq_state irq = sync::spin_lock_irqsave(tg->lock);
+    *out = tg->children_ru;
+    sync::spin_unlock_irqrestore(tg->lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_exit_rusage(task* t, task_rusage* out) {
+    thread_group* tg = t->group;
+    if (tg && tg->pid == t->tid) {
+        read_group_rusage(tg, out);
+    } else {
+        read_task_rusage(t, out);
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void add_child_rusage(thread_group* tg, const task_rusage& child) {
+    sync::irq_state irq = sync::spin_lock_irqsave(tg->lock);
+    rusage_add(&tg->children_ru, child);
+    sync::spin_unlock_irqrestore(tg->lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void fold_exited_task_locked(thread_group* tg, const task* t) {
+    task_rusage ru = {};
+    read_task_rusage(t, &ru);
+    rusage_add(&tg->exited_ru, ru);
+}
+
+} // namespace sched
@@ -0,0 +1,83 @@
+#ifndef STELLUX_SCHED_RUSAGE_H
+#define STELLUX_SCHED_RUSAGE_H
+
+#include "common/types.h"
+
+namespace sched {
+
+struct task;
+struct thread_group;
+
+/**
+ * Resource usage counters. Every task counts its own while it runs; a
+ * thread_group adds up the threads that have exited and, separately,
+ * the children its threads have reaped. The layout is shared with
+ * userland through SYS_PROC_INFO.
+ *
+ * System time is CPU time spent inside syscalls, stamped at syscall
+ * entry and exit, plus all CPU time while the task runs elevated or is
+ * a kernel task. User time is the rest of the task's CPU time.
+ */
+struct task_rusage {
+    uint64_t user_ns;
+    uint64_t sys_ns;
+    uint64_t minflt;       // page faults served by demand paging
+    uint64_t nvcsw;        // switched out while blocking
+    uint64_t nivcsw;       // switched out while runnable (preempted, yield)
+    uint64_t syscalls;
+    uint64_t read_bytes;   // read through handles other than sockets
+    uint64_t write_bytes;  // written through handles other than sockets
+    uint64_t net_rx_bytes; // received on sockets
+    uint64_t net_tx_bytes; // sent on sockets
+    uint64_t maxrss_kb;    // peak resident size of the address space
+};
+static_assert(sizeof(task_rusage) == 88, "sched::task_rusage is shared with userland");
+
+/**
+ * @brief Usage of t alone. user_ns and maxrss_kb are derived from its
+ * run time and its address space; the counters in t->ru leave them zero.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_task_rusage(const task* t, task_rusage* out);
+
+/**
+ * @brief Usage of a whole process: its exited threads plus every live one.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_group_rusage(thread_group* tg, task_rusage* out);
+
+/**
+ * @brief Usage of the children reaped by tg's threads.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_children_rusage(thread_group* tg, task_rusage* out);
+
+/**
+ * @brief Usage t's process reports to the waiter: the whole process for
+ * a group leader, t alone for other threads and kernel tasks.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void read_exit_rusage(task* t, task_rusage* out);
+
+/**
+ * @brief Add a reaped child's usage to tg's children totals.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void add_child_rusage(thread_group* tg, const task_rusage& child);
+
+/**
+ * @brief Fold an exiting task's usage into its group's exited totals.
+ * Caller holds tg->lock and unlinks t (or clears tg->leader) in the same
+ * critical section, so group readers count t exactly once.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void fold_exited_task_locked(thread_group* tg, const task* t);
+
+/**
+ * @brief Add every counter of from to into, keeping the larger maxrss.
+ */
+void rusage_add(task_rusage* into, const task_rusage& from);
+
+} // namespace sched
+
+#endif // STELLUX_SCHED_RUSAGE_H
@@ -19,7 +19,9 @@
 #include "hw/cpu.h"
 #include "clock/clock.h"
 #include "timer/timer.h"
+#include "irq/irq.h"
 #include "rc/reaper.h"
+#include "rc/rcu.h"
 #include "exec/elf.h"
 #include "mm/pmm.h"
 #include "mm/vma.h"
@@ -29,8 +31,11 @@
 #include "fs/node.h"
 #include "mm/uaccess.h"
 #include "sync/futex.h"
+#include "trace/trace.h"
 
 DEFINE_PER_CPU(sched::task*, current_task);
+// Tid of current_task, for code that cannot read the privileged task
+static DEFINE_PER_CPU(uint32_t, current_task_tid);
 DEFINE_PER_CPU(bool, percpu_is_elevated);
 DEFINE_PER_CPU(uint32_t, percpu_cpu_id);
 static DEFINE_PER_CPU(sched::task*, pending_off_cpu_task);
@@ -38,13 +43,18 @@ static DEFINE_PER_CPU(uint64_t, cpu_tlb_sync_epoch);
 
 static DEFINE_PER_CPU(sched::runqueue, cpu_rq);
 
-static DEFINE_PER_CPU(sched::cpu_accounting_stats, cpu_accounting);
+// Each CPU's ledger lives in the user-mappable cpu_time_page
+static DEFINE_PER_CPU(sched::cpu_time_record*, cpu_time);
+static DEFINE_PER_CPU(sched::wake_stats, cpu_wake_stats);
 
 static uint32_t g_next_tid = 1;
 static uint32_t g_pending_tlb_sync_tickets = 0;
 
 __PRIVILEGED_DATA static uint32_t g_lb_next_cpu = 0;
 
+__PRIVILEGED_BSS static sched::cpu_time_page* g_cpu_time_page;
+__PRIVILEGED_BSS static pmm::phys_addr_t g_cpu_time_page_phys;
+
 namespace sched {
 
 __PRIVILEGED_CODE void thread_group::ref_destroy(thread_group* self) {
@@ -59,6 +69,15 @@ constexpr uint16_t SYSTEM_GUARD_PAGES = 1;
 
 constexpr uint64_t TLB_SYNC_CPU_IGNORED = ~0ULL;
 
+constexpr uint64_t NS_PER_SEC = 1000000000ULL;
+
+// Wakeup placement: a task that left its CPU less than WAKE_CACHE_HOT_NS
+// ago still has a warm cache there. Waker and wakee both running for
+// less than WAKE_AFFINE_BURST_NS per stint look like an IPC pair that
+// hands the CPU back and forth, and share the waker's CPU.
+constexpr uint64_t WAKE_CACHE_HOT_NS    = 500000;
+constexpr uint64_t WAKE_AFFINE_BURST_NS = 1000000;
+
 constexpr uint64_t AT_NULL   = 0;
 constexpr uint64_t AT_PHDR   = 3;
 constexpr uint64_t AT_PHENT  = 4;
@@ -96,6 +115,19 @@ __PRIVILEGED_CODE static inline void assert_switch_privilege_state(
 }
 #endif
 
+/**
+ * Send a reschedule IPI to a CPU that is running its idle task, so it
+ * picks up work queued on its runqueue. With the tick stopped an idle
+ * CPU would otherwise sleep until its next timer deadline.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void kick_if_idle(uint32_t cpu) {
+    runqueue& rq = per_cpu_on(cpu_rq, cpu);
+    if (__atomic_load_n(&per_cpu_on(current_task, cpu), __ATOMIC_ACQUIRE) == rq.idle_task) {
+        irq::send_resched_ipi(cpu);
+    }
+}
+
 /**
  * @note Privilege: **required**
  */
@@ -137,6 +169,8 @@ __PRIVILEGED_CODE static rc::reaper::cleanup_result reap_task(sched::task* t) {
             }
             uint64_t epoch = __atomic_load_n(&per_cpu_on(cpu_tlb_sync_epoch, cpu), __ATOMIC_ACQUIRE);
             if ((epoch - t->tlb_sync_ticket.cpu_epoch_snapshot[cpu]) == 0) {
+                // A tickless idle CPU passes no scheduler trap on its own
+                kick_if_idle(cpu);
                 return rc::reaper::RETRY_LATER;
             }
         }
@@ -144,11 +178,18 @@ __PRIVILEGED_CODE static rc::reaper::cleanup_result reap_task(sched::task* t) {
         store_cleanup_stage(t, TASK_CLEANUP_STAGE_READY_TO_RECLAIM);
     }
 
-    if (load_cleanup_stage(t) != TASK_CLEANUP_STAGE_READY_TO_RECLAIM) {
+    if (load_cleanup_stage(t) == TASK_CLEANUP_STAGE_READY_TO_RECLAIM) {
+        // Lockless registry readers may still be looking at the task
+        g_task_registry.remove(*t);
+        t->rcu_gp_cookie = rc::rcu::start_grace_period();
+        store_cleanup_stage(t, TASK_CLEANUP_STAGE_WAITING_FOR_RCU);
+    }
+
+    if (load_cleanup_stage(t) != TASK_CLEANUP_STAGE_WAITING_FOR_RCU ||
+        !rc::rcu::poll_grace_period(t->rcu_gp_cookie)) {
         return rc::reaper::RETRY_LATER;
     }
 
-    g_task_registry.remove(*t);
     resource::release_task_handles(t);
     if (t->cwd) {
         if (t->cwd->release()) {
@@ -184,6 +225,17 @@ task* current() {
     return this_cpu(current_task);
 }
 
+uint32_t current_tid() {
+    return __atomic_load_n(&this_cpu(current_task_tid), __ATOMIC_RELAXED);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool task_running_on(const task* t, uint32_t cpu_id) {
+    return __atomic_load_n(&per_cpu_on(current_task, cpu_id), __ATOMIC_ACQUIRE) == t;
+}
+
 // A pending SIGKILL bit is the task's "must terminate" marker
 static inline bool task_kill_bit_set(const task* t) {
     return (__atomic_load_n(&t->sig.pending, __ATOMIC_ACQUIRE)
@@ -237,32 +289,128 @@ __PRIVILEGED_CODE void cancel_block_task() {
 }
 
 /**
+ * Charge the time since this CPU's last charge to prev and to the busy
+ * or idle ledger, then restart the open period for what runs next.
+ * @param next_idle True when the CPU runs its idle task from now on.
+ * @return The timestamp the charge was taken at.
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void record_cpu_tick(task* prev) {
-    cpu_accounting_stats& stats = this_cpu(cpu_accounting);
+__PRIVILEGED_CODE static uint64_t account_cpu_time(task* prev, bool next_idle) {
+    cpu_time_record& ct = *this_cpu(cpu_time);
     runqueue& rq = this_cpu(cpu_rq);
 
-    // Only this CPU's tick path writes these counters, remote readers
-    // use relaxed atomic loads
-    uint64_t* counter = (prev == rq.idle_task) ? &stats.idle_ticks
-                                               : &stats.busy_ticks;
-    __atomic_store_n(counter, *counter + 1, __ATOMIC_RELAXED);
-    __atomic_store_n(&prev->run_ticks, prev->run_ticks + 1, __ATOMIC_RELAXED);
+    uint64_t now = clock::now_ns();
+    uint64_t delta = now > ct.stamp_ns ? now - ct.stamp_ns : 0;
+
+    __atomic_store_n(&ct.seq, ct.seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    uint64_t* counter = (prev == rq.idle_task) ? &ct.idle_ns : &ct.busy_ns;
+    __atomic_store_n(counter, *counter + delta, __ATOMIC_RELAXED);
+    __atomic_store_n(&ct.stamp_ns, now, __ATOMIC_RELAXED);
+    __atomic_store_n(&ct.in_idle, next_idle ? 1u : 0u, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&ct.seq, ct.seq + 1, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&prev->run_ns, prev->run_ns + delta, __ATOMIC_RELAXED);
+
+    // System time: an elevated task is charged the whole stretch, a
+    // syscall in progress the part since its entry or last charge
+    if (prev->exec.flags & TASK_FLAG_ELEVATED) {
+        __atomic_fetch_add(&prev->ru.sys_ns, delta, __ATOMIC_RELAXED);
+    } else if (uint64_t entered = __atomic_load_n(&prev->sys_enter_ns, __ATOMIC_RELAXED)) {
+        if (now > entered) {
+            __atomic_fetch_add(&prev->ru.sys_ns, now - entered, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&prev->sys_enter_ns, now, __ATOMIC_RELAXED);
+    }
+    return now;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record_cpu_tick(task* prev) {
+    account_cpu_time(prev, prev == this_cpu(cpu_rq).idle_task);
 }
 
 /**
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE cpu_accounting_stats read_cpu_accounting_stats(uint32_t cpu_id) {
-    cpu_accounting_stats& stats = per_cpu_on(cpu_accounting, cpu_id);
+    cpu_time_record& ct = *per_cpu_on(cpu_time, cpu_id);
+
+    uint64_t busy_ns = 0;
+    uint64_t idle_ns = 0;
+    uint64_t stamp_ns = 0;
+    uint32_t in_idle = 0;
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&ct.seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            cpu::relax();
+            continue;
+        }
+        busy_ns = __atomic_load_n(&ct.busy_ns, __ATOMIC_RELAXED);
+        idle_ns = __atomic_load_n(&ct.idle_ns, __ATOMIC_RELAXED);
+        stamp_ns = __atomic_load_n(&ct.stamp_ns, __ATOMIC_RELAXED);
+        in_idle = __atomic_load_n(&ct.in_idle, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ct.seq, __ATOMIC_RELAXED) == seq) {
+            break;
+        }
+    }
+
+    // A tickless idle CPU charges nothing until it wakes up, so fold
+    // in the open idle period to keep its idle time advancing
+    if (in_idle) {
+        uint64_t now = clock::now_ns();
+        if (now > stamp_ns) {
+            idle_ns += now - stamp_ns;
+        }
+    }
+
     cpu_accounting_stats out;
-    out.busy_ticks = __atomic_load_n(&stats.busy_ticks, __ATOMIC_RELAXED);
-    out.idle_ticks = __atomic_load_n(&stats.idle_ticks, __ATOMIC_RELAXED);
     out.tick_hz = timer::tick_hz();
+    uint64_t tick_ns = out.tick_hz ? NS_PER_SEC / out.tick_hz : 0;
+    out.busy_ticks = tick_ns ? busy_ns / tick_ns : 0;
+    out.idle_ticks = tick_ns ? idle_ns / tick_ns : 0;
     return out;
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint64_t cpu_time_page_phys(size_t* out_size) {
+    *out_size = pmm::page_align_up(sizeof(cpu_time_page));
+    return g_cpu_time_page_phys;
+}
+
+/**
+ * Point this CPU at its record in the cpu_time_page and open its first
+ * idle period.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void init_cpu_time(uint32_t cpu_id) {
+    cpu_time_record* ct = &g_cpu_time_page->cpus[cpu_id];
+    ct->stamp_ns = clock::now_ns();
+    ct->in_idle = 1;
+    this_cpu(cpu_time) = ct;
+
+    uint32_t count = __atomic_load_n(&g_cpu_time_page->cpu_count, __ATOMIC_RELAXED);
+    while (cpu_id + 1 > count &&
+           !__atomic_compare_exchange_n(&g_cpu_time_page->cpu_count, &count, cpu_id + 1,
+                                        true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void reap_unstarted(task* t) {
+    store_cleanup_stage(t, TASK_CLEANUP_STAGE_SCHEDULER_DETACHED);
+    rc::reaper::defer(&t->reaper_node);
+}
+
 /**
  * @note Privilege: **required**
  */
@@ -339,6 +487,11 @@ __PRIVILEGED_CODE task* pick_next_and_switch(task* prev) {
 
     sync::irq_state irq = sync::spin_lock_irqsave(rq.lock);
 
+    // Switching away from a blocking task is voluntary, from one that
+    // stays runnable (preempted or yielding) involuntary
+    bool prev_blocked = prev->state == TASK_STATE_BLOCKED;
+    bool prev_runnable = prev->state == TASK_STATE_RUNNING;
+
     // Only re-enqueue if prev was running (not dead, blocked, or already woken)
     if (prev != rq.idle_task && prev->state == TASK_STATE_RUNNING) {
         prev->state = TASK_STATE_READY;
@@ -359,8 +512,11 @@ __PRIVILEGED_CODE task* pick_next_and_switch(task* prev) {
     }
 
     next->state = TASK_STATE_RUNNING;
-    this_cpu(current_task) = next;
+    // Release pairs with kick_if_idle: a waker that enqueued after this
+    // lock section sees the idle task here and sends the kick
+    __atomic_store_n(&this_cpu(current_task), next, __ATOMIC_RELEASE);
     this_cpu(current_task_exec) = &next->exec;
+    __atomic_store_n(&this_cpu(current_task_tid), next->tid, __ATOMIC_RELAXED);
     // Runtime elevation state remains true while trap/syscall teardown continues.
     // Return-boundary code restores percpu_is_elevated from the selected task's
     // TASK_FLAG_ELEVATED after switch teardown is complete.
@@ -370,6 +526,39 @@ __PRIVILEGED_CODE task* pick_next_and_switch(task* prev) {
 
     sync::spin_unlock_irqrestore(rq.lock, irq);
 
+    bool prev_idle = (prev == rq.idle_task);
+    bool next_idle = (next == rq.idle_task);
+    if (next != prev) {
+        TRACE(SCHED_SWITCH, prev->tid, next->tid, prev->state);
+        uint64_t now = account_cpu_time(prev, next_idle);
+        if (!prev_idle) {
+            prev->last_ran_ns = now;
+            prev->last_burst_ns = now - prev->switch_in_ns;
+            if (prev_blocked) {
+                __atomic_fetch_add(&prev->ru.nvcsw, 1, __ATOMIC_RELAXED);
+            } else if (prev_runnable) {
+                __atomic_fetch_add(&prev->ru.nivcsw, 1, __ATOMIC_RELAXED);
+            }
+        }
+        if (!next_idle) {
+            next->switch_in_ns = now;
+            // Time off-CPU inside a syscall is not system time
+            if (__atomic_load_n(&next->sys_enter_ns, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&next->sys_enter_ns, now, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    // NOHZ idle: no periodic tick while the idle task runs, wakeups
+    // targeting this CPU kick it through the reschedule IPI instead.
+    // The tick is stopped one tick after idle entry, from a trap that
+    // has already published the switched-out task's off-CPU state.
+    if (next_idle && prev_idle) {
+        timer::tick_stop();
+    } else if (!next_idle && prev_idle) {
+        timer::tick_restart();
+    }
+
     return next;
 }
 
@@ -391,6 +580,7 @@ __PRIVILEGED_CODE void enqueue(task* t) {
     rq.policy->enqueue(t);
     rq.nr_running++;
     sync::spin_unlock_irqrestore(rq.lock, irq);
+    kick_if_idle(cpu);
 }
 
 /**
@@ -404,12 +594,91 @@ __PRIVILEGED_CODE void enqueue_on(task* t, uint32_t cpu_id) {
         return;
     }
 
+    // Placed on purpose, wakeups must not move it elsewhere
+    t->exec.flags |= TASK_FLAG_PINNED;
     t->exec.cpu = cpu_id;
     runqueue& rq = per_cpu_on(cpu_rq, cpu_id);
     sync::irq_state irq = sync::spin_lock_irqsave(rq.lock);
     rq.policy->enqueue(t);
     rq.nr_running++;
     sync::spin_unlock_irqrestore(rq.lock, irq);
+    kick_if_idle(cpu_id);
+}
+
+/**
+ * True when a CPU runs its idle task with nothing queued.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool cpu_is_idle(uint32_t cpu) {
+    runqueue& rq = per_cpu_on(cpu_rq, cpu);
+    return __atomic_load_n(&per_cpu_on(current_task, cpu), __ATOMIC_ACQUIRE) == rq.idle_task &&
+           __atomic_load_n(&rq.nr_running, __ATOMIC_RELAXED) == 0;
+}
+
+/**
+ * Scan online CPUs for an idle one, starting after start.
+ * @return The idle CPU, or start if there is none.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint32_t find_idle_cpu(uint32_t start) {
+    uint32_t total = smp::cpu_count();
+    for (uint32_t i = 1; i < total; i++) {
+        uint32_t cpu = (start + i) % total;
+        smp::cpu_info* info = smp::get_cpu_info(cpu);
+        if (info && __atomic_load_n(&info->state, __ATOMIC_ACQUIRE) == smp::CPU_ONLINE &&
+            cpu_is_idle(cpu)) {
+            return cpu;
+        }
+    }
+    return start;
+}
+
+/**
+ * Choose the CPU a woken task is queued on, in order of preference:
+ * its previous CPU if idle, the waker's CPU for short-burst IPC pairs,
+ * its previous CPU while its cache is hot and nothing else is queued
+ * there, any idle CPU, and finally its previous CPU. Bumps the matching
+ * counter in this CPU's wake_stats.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint32_t select_wake_cpu(task* t, uint32_t prev_cpu) {
+    wake_stats& ws = this_cpu(cpu_wake_stats);
+    uint32_t self_cpu = percpu::current_cpu_id();
+
+    if (cpu_is_idle(prev_cpu)) {
+        __atomic_fetch_add(&ws.prev_idle, 1, __ATOMIC_RELAXED);
+        return prev_cpu;
+    }
+
+    uint64_t now = clock::now_ns();
+    task* waker = current();
+
+    // An interrupt or the idle task says nothing about who consumes the
+    // wakee's output, only a task waker can pull it over
+    bool task_waker = waker && waker != this_cpu(cpu_rq).idle_task &&
+                      !(waker->exec.flags & TASK_FLAG_IN_IRQ);
+    if (task_waker && self_cpu != prev_cpu &&
+        __atomic_load_n(&this_cpu(cpu_rq).nr_running, __ATOMIC_RELAXED) == 0 &&
+        t->last_burst_ns < WAKE_AFFINE_BURST_NS &&
+        now - waker->switch_in_ns < WAKE_AFFINE_BURST_NS) {
+        __atomic_fetch_add(&ws.affine, 1, __ATOMIC_RELAXED);
+        return self_cpu;
+    }
+
+    if (now - t->last_ran_ns < WAKE_CACHE_HOT_NS &&
+        __atomic_load_n(&per_cpu_on(cpu_rq, prev_cpu).nr_running, __ATOMIC_RELAXED) == 0) {
+        __atomic_fetch_add(&ws.cache_hot, 1, __ATOMIC_RELAXED);
+        return prev_cpu;
+    }
+
+    uint32_t idle_cpu = find_idle_cpu(prev_cpu);
+    if (idle_cpu != prev_cpu) {
+        __atomic_fetch_add(&ws.idle_cpu, 1, __ATOMIC_RELAXED);
+        return idle_cpu;
+    }
+
+    __atomic_fetch_add(&ws.prev_busy, 1, __ATOMIC_RELAXED);
+    return prev_cpu;
 }
 
 /**
@@ -422,18 +691,83 @@ __PRIVILEGED_CODE void wake(task* t) {
         return;
     }
 
+    // Requeueing on the previous CPU is safe while the task is still
+    // switching out there, that CPU finishes the switch before its next
+    // pick. Moving it elsewhere needs the off-CPU publication first, a
+    // task still marked on_cpu stays put instead of waiting for it.
     uint32_t task_cpu = __atomic_load_n(&t->exec.cpu, __ATOMIC_RELAXED);
-    if (task_cpu != percpu::current_cpu_id()) {
-        while (__atomic_load_n(&t->exec.on_cpu, __ATOMIC_ACQUIRE)) {
-            cpu::relax();
-        }
+    uint32_t target = task_cpu;
+    if (t->exec.flags & TASK_FLAG_PINNED) {
+        // Tasks placed with enqueue_on stay on their CPU
+        __atomic_fetch_add(&this_cpu(cpu_wake_stats).pinned, 1, __ATOMIC_RELAXED);
+    } else if (!__atomic_load_n(&t->exec.on_cpu, __ATOMIC_ACQUIRE)) {
+        target = select_wake_cpu(t, task_cpu);
+    } else {
+        __atomic_fetch_add(&this_cpu(cpu_wake_stats).prev_busy, 1, __ATOMIC_RELAXED);
     }
 
-    runqueue& rq = per_cpu_on(cpu_rq, task_cpu);
+    wake_stats& ws = this_cpu(cpu_wake_stats);
+    if (target != task_cpu) {
+        __atomic_fetch_add(&ws.migrations, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&t->exec.cpu, target, __ATOMIC_RELAXED);
+        TRACE(SCHED_MIGRATE, t->tid, task_cpu, target);
+    }
+    if (target != percpu::current_cpu_id()) {
+        __atomic_fetch_add(&ws.remote, 1, __ATOMIC_RELAXED);
+    }
+
+    TRACE(SCHED_WAKE, t->tid, target);
+
+    runqueue& rq = per_cpu_on(cpu_rq, target);
     sync::irq_state irq = sync::spin_lock_irqsave(rq.lock);
     rq.policy->enqueue(t);
     rq.nr_running++;
     sync::spin_unlock_irqrestore(rq.lock, irq);
+    kick_if_idle(target);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void pi_boost(task* t) {
+    if (__atomic_fetch_add(&t->pi_boost, 1, __ATOMIC_RELAXED) != 0) {
+        return;
+    }
+
+    // Already boosted tasks were moved forward when they first were, a
+    // task that is not queued picks the boost up at its next enqueue
+    if (__atomic_load_n(&t->state, __ATOMIC_ACQUIRE) != TASK_STATE_READY) {
+        return;
+    }
+    uint32_t cpu = __atomic_load_n(&t->exec.cpu, __ATOMIC_RELAXED);
+    runqueue& rq = per_cpu_on(cpu_rq, cpu);
+    sync::irq_state irq = sync::spin_lock_irqsave(rq.lock);
+    rq.policy->boost(t);
+    sync::spin_unlock_irqrestore(rq.lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void pi_unboost(task* t) {
+    __atomic_fetch_sub(&t->pi_boost, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE wake_stats read_wake_stats(uint32_t cpu_id) {
+    wake_stats& ws = per_cpu_on(cpu_wake_stats, cpu_id);
+    wake_stats out;
+    out.prev_idle  = __atomic_load_n(&ws.prev_idle, __ATOMIC_RELAXED);
+    out.affine     = __atomic_load_n(&ws.affine, __ATOMIC_RELAXED);
+    out.cache_hot  = __atomic_load_n(&ws.cache_hot, __ATOMIC_RELAXED);
+    out.idle_cpu   = __atomic_load_n(&ws.idle_cpu, __ATOMIC_RELAXED);
+    out.prev_busy  = __atomic_load_n(&ws.prev_busy, __ATOMIC_RELAXED);
+    out.pinned     = __atomic_load_n(&ws.pinned, __ATOMIC_RELAXED);
+    out.migrations = __atomic_load_n(&ws.migrations, __ATOMIC_RELAXED);
+    out.remote     = __atomic_load_n(&ws.remote, __ATOMIC_RELAXED);
+    return out;
 }
 
 /**
@@ -545,12 +879,14 @@ __PRIVILEGED_CODE void sleep_ms(uint64_t ms) {
                         force_wake_for_kill(&thread);
                     }
                 }
+                fold_exited_task_locked(tg, task);
                 tg->leader = nullptr;
                 sync::spin_unlock_irqrestore(tg->lock, irq);
             } else if (task->group_link.is_linked()) {
                 sync::irq_state irq = sync::spin_lock_irqsave(tg->lock);
                 tg->threads.remove(task);
                 tg->thread_count--;
+                fold_exited_task_locked(tg, task);
                 sync::spin_unlock_irqrestore(tg->lock, irq);
             }
         }
@@ -558,6 +894,15 @@ __PRIVILEGED_CODE void sleep_ms(uint64_t ms) {
         if (task->proc_res) {
             auto* pr = task->proc_res;
 
+            // A leader reports its whole process, threads still being
+            // killed included up to this point
+            task_rusage exit_ru = {};
+            read_exit_rusage(task, &exit_ru);
+            task_rusage children_ru = {};
+            if (task->group && task->group->pid == task->tid) {
+                read_children_rusage(task->group, &children_ru);
+            }
+
             uint32_t ges = task->group
                 ? __atomic_load_n(&task->group->group_exit_status,
                                   __ATOMIC_ACQUIRE)
@@ -574,6 +919,8 @@ __PRIVILEGED_CODE void sleep_ms(uint64_t ms) {
                 } else {
                     pr->wait_status = (exit_code & 0xFF) << 8;
                 }
+                pr->rusage = exit_ru;
+                pr->children_rusage = children_ru;
                 pr->exited = true;
                 pr->child = nullptr;
                 sync::wake_all(pr->wait_queue);
@@ -654,8 +1001,7 @@ __PRIVILEGED_CODE task* create_kernel_task(
     t->task_registry_link = {};
     t->sched_link = {};
     t->wait_link = {};
-    t->timer_link = {};
-    t->timer_deadline = 0;
+    t->sleep_timer = {};
     string::memcpy(t->name, name, string::strnlen(name, TASK_NAME_MAX - 1));
     t->name[string::strnlen(name, TASK_NAME_MAX - 1)] = '\0';
     t->cleanup_stage = TASK_CLEANUP_STAGE_ACTIVE;
@@ -919,8 +1265,7 @@ __PRIVILEGED_CODE task* create_user_task(
     t->task_registry_link = {};
     t->sched_link = {};
     t->wait_link = {};
-    t->timer_link = {};
-    t->timer_deadline = 0;
+    t->sleep_timer = {};
     string::memcpy(t->name, name, string::strnlen(name, TASK_NAME_MAX - 1));
     t->name[string::strnlen(name, TASK_NAME_MAX - 1)] = '\0';
     t->cleanup_stage = TASK_CLEANUP_STAGE_ACTIVE;
@@ -1089,8 +1434,7 @@ __PRIVILEGED_CODE static task* init_user_thread_core(
     t->task_registry_link = {};
     t->sched_link = {};
     t->wait_link = {};
-    t->timer_link = {};
-    t->timer_deadline = 0;
+    t->sleep_timer = {};
     t->tlb_sync_ticket.armed = 0;
 
     for (uint32_t i = 0; i < MAX_CPUS; i++) {
@@ -1205,8 +1549,7 @@ __PRIVILEGED_CODE int32_t init() {
     idle->task_registry_link = {};
     idle->sched_link = {};
     idle->wait_link = {};
-    idle->timer_link = {};
-    idle->timer_deadline = 0;
+    idle->sleep_timer = {};
     string::memcpy(idle->name, "idle", 4);
     idle->name[4] = '\0';
     idle->cleanup_stage = TASK_CLEANUP_STAGE_ACTIVE;
@@ -1225,10 +1568,30 @@ __PRIVILEGED_CODE int32_t init() {
 
     this_cpu(current_task) = idle;
     this_cpu(current_task_exec) = &idle->exec;
+    this_cpu(current_task_tid) = idle->tid;
     this_cpu(percpu_is_elevated) = (idle->exec.flags & TASK_FLAG_ELEVATED) != 0;
     this_cpu(pending_off_cpu_task) = nullptr;
     this_cpu(cpu_tlb_sync_epoch) = 0;
 
+    // Shared with userland, so it takes whole pages of its own
+    constexpr size_t CPU_TIME_PAGES = pmm::page_align_up(sizeof(cpu_time_page)) / pmm::PAGE_SIZE;
+    uint8_t order = 0;
+    while ((static_cast<size_t>(1) << order) < CPU_TIME_PAGES) {
+        order++;
+    }
+    g_cpu_time_page_phys = pmm::alloc_pages(order);
+    if (!g_cpu_time_page_phys) {
+        log::error("sched: failed to allocate the cpu time page");
+        return ERR_NO_MEM;
+    }
+    g_cpu_time_page = static_cast<cpu_time_page*>(paging::phys_to_virt(g_cpu_time_page_phys));
+    string::memset(g_cpu_time_page, 0, pmm::PAGE_SIZE << order);
+    g_cpu_time_page->magic = CPU_TIME_PAGE_MAGIC;
+    g_cpu_time_page->version = CPU_TIME_PAGE_VERSION;
+    g_cpu_time_page->record_offset = static_cast<uint32_t>(__builtin_offsetof(cpu_time_page, cpus));
+    g_cpu_time_page->record_size = sizeof(cpu_time_record);
+    init_cpu_time(0);
+
     // Initialize per-CPU runqueue
     runqueue& rq = this_cpu(cpu_rq);
     rq.lock = sync::SPINLOCK_INIT;
@@ -1294,10 +1657,14 @@ __PRIVILEGED_CODE int32_t init_ap(uint32_t cpu_id, uintptr_t task_stack_top,
 
     this_cpu(current_task) = idle;
     this_cpu(current_task_exec) = &idle->exec;
+    this_cpu(current_task_tid) = idle->tid;
     this_cpu(percpu_is_elevated) = true;
     this_cpu(pending_off_cpu_task) = nullptr;
     this_cpu(cpu_tlb_sync_epoch) = 0;
 
+    // Idle time starts now rather than at boot
+    init_cpu_time(cpu_id);
+
     runqueue& rq = this_cpu(cpu_rq);
     rq.lock = sync::SPINLOCK_INIT;
     rq.nr_running = 0;
@@ -17,8 +17,9 @@ constexpr size_t MAX_ARG_STRLEN  = 256; // bytes per argv/envp string, including
 constexpr size_t MAX_ARG_STRINGS = 64;  // strings per argv/envp array
 
 /**
- * One CPU's timer tick counters. A tick is charged as idle when it
- * interrupts the CPU's idle task and as busy otherwise. Snapshots
+ * One CPU's time split into busy and idle, in scheduler tick units.
+ * Time is measured with clock::now_ns() at every tick and context
+ * switch, so a tickless idle CPU keeps accruing idle time. Snapshots
  * carry the scheduler tick frequency so readers can convert tick
  * counts into wall time.
  */
@@ -28,6 +29,61 @@ struct cpu_accounting_stats {
     uint32_t tick_hz;
 };
 
+/**
+ * One CPU's busy/idle time ledger. Only the owning CPU writes it, under
+ * an odd/even sequence count so remote readers can take a consistent
+ * snapshot. While in_idle is set the CPU has been idle since stamp_ns
+ * and charges nothing until it wakes, so readers add the open period
+ * to idle_ns themselves. Times are clock::now_ns() nanoseconds, the
+ * clock behind CLOCK_MONOTONIC.
+ */
+struct cpu_time_record {
+    uint32_t seq;
+    uint32_t in_idle;  // the CPU runs its idle task since stamp_ns
+    uint64_t stamp_ns; // time of the last charge
+    uint64_t busy_ns;
+    uint64_t idle_ns;
+    uint64_t reserved[4];
+};
+static_assert(sizeof(cpu_time_record) == 64, "one cache line per CPU");
+
+constexpr uint32_t CPU_TIME_PAGE_MAGIC   = 0x454D4954; // "TIME"
+constexpr uint32_t CPU_TIME_PAGE_VERSION = 1;
+
+/**
+ * The page(s) holding every CPU's ledger, mapped read-only into
+ * monitors through /dev/sysinfo/cpupage so they can sample CPU time
+ * without a syscall. Readers locate records through record_offset and
+ * record_size, later versions only append fields.
+ */
+struct cpu_time_page {
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        cpu_count;     // CPUs brought up so far
+    uint32_t        record_offset; // of cpus[0]
+    uint32_t        record_size;
+    uint32_t        reserved[11];
+    cpu_time_record cpus[MAX_CPUS];
+};
+static_assert(sizeof(cpu_time_page) == 64 + MAX_CPUS * sizeof(cpu_time_record),
+              "cpu_time_page layout is shared with userland");
+
+/**
+ * Wakeup placement decisions made on one CPU (the waker's), for tuning
+ * the wake-affine heuristics. Every wake() lands in exactly one of the
+ * first six counters.
+ */
+struct wake_stats {
+    uint64_t prev_idle;   // the task's previous CPU was idle, woken there
+    uint64_t affine;      // pulled to the waker's CPU (short IPC-style bursts)
+    uint64_t cache_hot;   // ran recently, kept on its busy previous CPU
+    uint64_t idle_cpu;    // moved to another idle CPU
+    uint64_t prev_busy;   // no better choice, queued on its previous CPU
+    uint64_t pinned;      // placed with enqueue_on, woken on that CPU
+    uint64_t migrations;  // placed on a CPU other than the previous one
+    uint64_t remote;      // placed on a CPU other than the waker's
+};
+
 /**
  * @brief Initialize the scheduler for the BSP. Creates idle task,
  * per-CPU runqueue, and scheduling policy. Call after mm::init().
@@ -133,12 +189,28 @@ __PRIVILEGED_CODE void enqueue(task* t);
  * @brief Add a task to a specific CPU's runqueue.
  * Same semantics as enqueue() but targets a remote CPU. The target
  * CPU's timer tick will pick up the task within one scheduling period.
+ * The task is pinned there: wakeup placement never migrates it.
  * @param t Task in TASK_STATE_CREATED.
  * @param cpu_id Logical CPU ID to enqueue on.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void enqueue_on(task* t, uint32_t cpu_id);
 
+/**
+ * @brief Priority inheritance for PI futexes. Each task blocked on a PI
+ * futex that t owns adds one boost; while boosted, t is queued ahead of
+ * unboosted ready tasks, including right away if it is already queued.
+ * Safe with IRQs masked and under spinlocks ordered before runqueue locks.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void pi_boost(task* t);
+
+/**
+ * @brief Drop one boost added by pi_boost().
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void pi_unboost(task* t);
+
 /**
  * @brief Resume a blocked task by placing it on the local runqueue.
  * Atomically transitions BLOCKED -> READY via CAS.
@@ -155,6 +227,15 @@ __PRIVILEGED_CODE void wake(task* t);
  */
 __PRIVILEGED_CODE void force_wake_for_kill(task* t);
 
+/**
+ * @brief Hand a task that never ran, already claimed as TASK_STATE_DEAD
+ * and unlinked from its group's threads, to the reaper. It leaves the
+ * registry and is freed with its handles, address space and group
+ * reference after an RCU grace period. Never blocks.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void reap_unstarted(task* t);
+
 /**
  * @brief Publish intent to block: moves the current task to BLOCKED.
  * Pair with block_task_interrupted before yielding.
@@ -200,6 +281,27 @@ void yield();
  */
 task* current();
 
+/**
+ * @brief Tid of the current task on this CPU, 0 for the idle task.
+ * Read from a per-CPU copy kept at context switch, so lowered code can
+ * call it without touching the privileged task.
+ */
+uint32_t current_tid();
+
+/**
+ * @brief true while t is the task currently running on cpu_id. Only
+ * compares pointers, so t may be a stale pointer to an exited task.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool task_running_on(const task* t, uint32_t cpu_id);
+
+/**
+ * @brief Send a reschedule IPI to cpu_id if it is running its idle
+ * task, so a tickless idle CPU passes through the scheduler once.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void kick_if_idle(uint32_t cpu_id);
+
 /**
  * @brief Read a snapshot of a CPU's accounting stats. Safe to call
  * from any CPU.
@@ -208,9 +310,24 @@ task* current();
  */
 __PRIVILEGED_CODE cpu_accounting_stats read_cpu_accounting_stats(uint32_t cpu_id);
 
+/**
+ * @brief Physical address of the cpu_time_page, valid after init().
+ * @param out_size Receives its size, a whole number of pages.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint64_t cpu_time_page_phys(size_t* out_size);
+
+/**
+ * @brief Read a CPU's wakeup placement counters. Safe to call from any
+ * CPU, counters are sampled individually.
+ * @param cpu_id Logical CPU ID, must be below smp::cpu_count().
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE wake_stats read_wake_stats(uint32_t cpu_id);
+
 /**
  * @brief Block the current task for at least ns nanoseconds.
- * The task is placed on the per-CPU sleep queue and woken by the
+ * The task arms its high resolution sleep timer and is woken from the
  * timer interrupt when the deadline expires.
  * Must not be called from the idle task.
  * @param ns Duration in nanoseconds. If 0, yields without blocking.
@@ -43,9 +43,10 @@ __PRIVILEGED_CODE void arch_post_switch(task* next);
 __PRIVILEGED_CODE task* pick_next_and_switch(task* prev);
 
 /**
- * Common: charge one timer tick to the interrupted task and to this
- * CPU's busy or idle counter. Called by arch on_tick handlers before
- * any early return so non-preemptible work is still recorded.
+ * Common: charge the time since the last tick or switch to the
+ * interrupted task and to this CPU's busy or idle counter. Called by
+ * arch on_tick handlers before any early return so non-preemptible
+ * work is still recorded.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void record_cpu_tick(task* prev);
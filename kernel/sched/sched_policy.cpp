@@ -17,6 +17,11 @@ void round_robin_policy::enqueue(task* t) {
                    t->tid, t->name, t->state, t->exec.cpu, t->exec.on_cpu);
     }
 #endif
+    // Owners of contended PI futexes run before everything else queued
+    if (__atomic_load_n(&t->pi_boost, __ATOMIC_RELAXED)) {
+        m_ready_list.push_front(t);
+        return;
+    }
     m_ready_list.push_back(t);
 }
 
@@ -28,4 +33,16 @@ task* round_robin_policy::pick_next() {
     return m_ready_list.pop_front();
 }
 
+void round_robin_policy::boost(task* t) {
+    // Membership is only stable for this list under the runqueue lock,
+    // so look the task up instead of trusting sched_link
+    for (task& queued : m_ready_list) {
+        if (&queued == t) {
+            m_ready_list.remove(t);
+            m_ready_list.push_front(t);
+            return;
+        }
+    }
+}
+
 } // namespace sched
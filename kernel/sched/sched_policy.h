@@ -10,6 +10,8 @@ struct sched_policy {
     virtual void   dequeue(task* t) = 0;
     virtual task*  pick_next() = 0;
     virtual void   tick(task* current) = 0;
+    // t gained a priority-inheritance boost, move it forward if queued here
+    virtual void   boost(task* t) = 0;
 protected:
     ~sched_policy() = default;
 };
@@ -22,6 +24,7 @@ public:
     void   dequeue(task* t) override;
     task*  pick_next() override;
     void   tick(task*) override {}
+    void   boost(task* t) override;
 
 private:
     list::head<task, &task::sched_link> m_ready_list;
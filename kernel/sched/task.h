@@ -8,7 +8,9 @@
 #include "rc/reaper.h"
 #include "signals/signal_types.h"
 #include "sync/spinlock.h"
+#include "timer/timer.h"
 #include "resource/handle_table.h"
+#include "sched/rusage.h"
 
 namespace resource::proc_provider { struct proc_resource; }
 namespace fs { class node; }
@@ -30,6 +32,7 @@ constexpr uint32_t TASK_CLEANUP_STAGE_EXIT_REQUESTED        = 1;
 constexpr uint32_t TASK_CLEANUP_STAGE_SCHEDULER_DETACHED    = 2;
 constexpr uint32_t TASK_CLEANUP_STAGE_WAITING_FOR_TLB_SYNC  = 3;
 constexpr uint32_t TASK_CLEANUP_STAGE_READY_TO_RECLAIM      = 4;
+constexpr uint32_t TASK_CLEANUP_STAGE_WAITING_FOR_RCU       = 5;
 
 /**
  * Per-task TLB sync ticket used by reaper before reclaiming task stacks.
@@ -78,10 +81,17 @@ struct task {
     // Scheduler state
     list::node              sched_link;
     list::node              wait_link;
-    list::node              timer_link;
-    uint64_t                timer_deadline;
-    uint64_t                run_ticks; // timer ticks observed while current
+    bool                    wait_exclusive; // queued by sync::wait_exclusive()
+    timer::timer_event      sleep_timer;
+    uint64_t                run_ns; // CPU time charged while current
+    uint64_t                switch_in_ns;  // clock::now_ns() when last switched in
+    uint64_t                last_ran_ns;   // clock::now_ns() when last switched out
+    uint64_t                last_burst_ns; // length of the last stint on a CPU
+    uint64_t                sys_enter_ns;  // start of the open stretch inside a syscall, 0 outside
+    task_rusage             ru;            // own usage counters, see sched/rusage.h
+    uint32_t                pi_boost; // waiters blocked on PI futexes this task owns
     task_tlb_sync_ticket    tlb_sync_ticket;
+    uint64_t                rcu_gp_cookie; // grace period after registry removal
     rc::reaper::dead_node   reaper_node;
 
     // Resources, the handle table is private by default and shared
@@ -118,6 +128,10 @@ struct thread_group : rc::ref_counted<thread_group> {
     // Signals (per-process action table and shared pending set)
     signals::group_signals sig;
 
+    // Usage of exited threads and of reaped children, under lock
+    task_rusage    exited_ru;
+    task_rusage    children_ru;
+
     /**
      * @note Privilege: **required**
      */
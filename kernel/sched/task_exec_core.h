@@ -21,6 +21,7 @@ constexpr uint32_t TASK_FLAG_IN_SYSCALL  = (1 << 5);  // Currently handling a sy
 constexpr uint32_t TASK_FLAG_IN_IRQ      = (1 << 6);  // Currently in interrupt handler
 constexpr uint32_t TASK_FLAG_PREEMPTIBLE = (1 << 7);  // Can be preempted
 constexpr uint32_t TASK_FLAG_POSIX_THREAD = (1 << 8); // Created through clone
+constexpr uint32_t TASK_FLAG_PINNED      = (1 << 9);  // Placed by enqueue_on, never migrated
 
 struct task_exec_core {
     uint32_t  flags;
@@ -32,7 +33,6 @@ struct task_exec_core {
     uint64_t  pt_root; // physical address of top-level page table (CR3 / TTBR1)
     uint64_t  user_pt_root; // physical address of user-space page table (= pt_root on x86 / TTBR0 on aarch64)
     mm::mm_context* mm_ctx; // owning reference to process address-space metadata
-    fpu_state fpu_ctx;
     uint64_t  tls_base;    // thread-local storage base (FS_BASE on x86, TPIDR_EL0 on aarch64)
 
     // Staged full-register return context (x86): a signal
@@ -40,6 +40,10 @@ struct task_exec_core {
     // IRET exit. Consumed by the syscall exit assembly.
     uint32_t  iret_pending;
     thread_cpu_context iret_ctx;
+
+    // Last: its size and alignment vary with the saved register set,
+    // and the offsets above are shared with assembly
+    fpu_state fpu_ctx;
 };
 
 constexpr size_t TASK_FLAGS_OFFSET          = __builtin_offsetof(task_exec_core, flags);
@@ -58,13 +62,16 @@ constexpr size_t TASK_IRET_CTX_OFFSET       = __builtin_offsetof(task_exec_core,
 // If these fail, update the assembly constants in:
 //   - kernel/arch/x86_64/trap/entry.S (TASK_FLAGS_OFFSET, TASK_SYS_STACK_OFFSET)
 //   - kernel/arch/x86_64/syscall/syscall_entry.S (TASK_FLAGS_OFFSET, TASK_SYS_STACK_OFFSET,
-//     TASK_IRET_PENDING_OFFSET, TASK_IRET_CTX_OFFSET, CTX_* register slots)
+//     TASK_IRET_PENDING_OFFSET, TASK_IRET_CTX_OFFSET, CTX_* register slots,
+//     TASK_FLAG_ELEVATED, TASK_FLAG_CAN_ELEVATE)
 static_assert(TASK_FLAGS_OFFSET == 0x00, "TASK_FLAGS_OFFSET changed - update x86_64 entry.S and syscall_entry.S");
 static_assert(TASK_SYS_STACK_OFFSET == 0x10, "TASK_SYS_STACK_OFFSET changed - update x86_64 entry.S and syscall_entry.S");
+static_assert(TASK_FLAG_ELEVATED == 0x1 && TASK_FLAG_CAN_ELEVATE == 0x4,
+              "elevation flags changed - update x86_64 syscall_entry.S");
 
 #if defined(__x86_64__)
-static_assert(TASK_IRET_PENDING_OFFSET == 0x2E8, "TASK_IRET_PENDING_OFFSET changed - update syscall_entry.S");
-static_assert(TASK_IRET_CTX_OFFSET == 0x2F0, "TASK_IRET_CTX_OFFSET changed - update syscall_entry.S");
+static_assert(TASK_IRET_PENDING_OFFSET == 0xE0, "TASK_IRET_PENDING_OFFSET changed - update syscall_entry.S");
+static_assert(TASK_IRET_CTX_OFFSET == 0xE8, "TASK_IRET_CTX_OFFSET changed - update syscall_entry.S");
 static_assert(__builtin_offsetof(thread_cpu_context, rax) == 0x00);
 static_assert(__builtin_offsetof(thread_cpu_context, rcx) == 0x10);
 static_assert(__builtin_offsetof(thread_cpu_context, rsp) == 0x38);
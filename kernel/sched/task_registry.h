@@ -34,7 +34,8 @@ public:
 
     /**
      * Remove a task from the registry. Safe to call on tasks that were
-     * never inserted (pprev guard).
+     * never inserted (pprev guard). Lockless readers may still hold the
+     * task, it must not be freed before an rc::rcu grace period.
      * @note Privilege: **required**
      */
     __PRIVILEGED_CODE void remove(task& t);
@@ -47,33 +48,24 @@ public:
     __PRIVILEGED_CODE uint32_t snapshot_tids(uint32_t* buf, uint32_t max);
 
     /**
-     * Acquire the registry lock. Must be paired with unlock().
-     * @note Privilege: **required**
-     */
-    [[nodiscard]] __PRIVILEGED_CODE sync::irq_state lock();
-
-    /**
-     * Release the registry lock.
-     * @note Privilege: **required**
-     */
-    __PRIVILEGED_CODE void unlock(sync::irq_state irq);
-
-    /**
-     * Find a task by TID. Caller must hold the registry lock.
-     * The returned pointer is valid only while the lock is held.
+     * Find a task by TID without taking the registry lock. Caller must
+     * be inside an rc::rcu read-side section; the returned pointer stays
+     * valid until the section ends.
      * @return task pointer, or nullptr if not found.
      * @note Privilege: **required**
      */
-    [[nodiscard]] __PRIVILEGED_CODE task* find_locked(uint32_t tid);
+    [[nodiscard]] __PRIVILEGED_CODE task* find_rcu(uint32_t tid);
 
     /**
-     * Visit every registered task. Caller must hold the registry lock,
-     * and visited pointers are valid only while it is held.
+     * Visit every registered task without taking the registry lock.
+     * Caller must be inside an rc::rcu read-side section, visited
+     * pointers are valid only until it ends. Tasks inserted or removed
+     * concurrently may or may not be visited.
      * @note Privilege: **required**
      */
     template <typename Fn>
-    __PRIVILEGED_CODE void for_each_locked(Fn fn) {
-        m_map.for_each(fn);
+    __PRIVILEGED_CODE void for_each_rcu(Fn fn) {
+        m_map.for_each_rcu(fn);
     }
 
     /**
@@ -84,7 +76,7 @@ public:
 private:
     using map_type = hashmap::map<task, &task::task_registry_link, tid_key_ops>;
 
-    sync::spinlock  m_lock;
+    sync::spinlock  m_lock; // serializes writers only
     hashmap::bucket m_buckets[BUCKET_COUNT];
     map_type        m_map;
 };
@@ -2,6 +2,7 @@
 #include "sched/sched.h"
 #include "sched/task.h"
 #include "sched/task_registry.h"
+#include "rc/rcu.h"
 #include "timer/timer.h"
 #include "common/logging.h"
 
@@ -275,8 +276,8 @@ __PRIVILEGED_CODE int32_t send_to_group_id(uint32_t group_id, uint32_t sig) {
     uint32_t seen_count = 0;
     bool found = false;
 
-    sync::irq_state irq = sched::g_task_registry.lock();
-    sched::g_task_registry.for_each_locked([&](sched::task& t) {
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::g_task_registry.for_each_rcu([&](sched::task& t) {
         sched::thread_group* tg = t.group;
         if (!tg || __atomic_load_n(&tg->group_id, __ATOMIC_ACQUIRE) != group_id) {
             return;
@@ -296,7 +297,7 @@ __PRIVILEGED_CODE int32_t send_to_group_id(uint32_t group_id, uint32_t sig) {
             send_to_group(tg, sig);
         }
     });
-    sched::g_task_registry.unlock(irq);
+    rc::rcu::read_unlock(irq);
 
     return found ? OK : ERR_INVAL;
 }
@@ -264,10 +264,15 @@ __PRIVILEGED_CODE static int32_t unix_accept(
     }
     while (ls->accept_queue.empty() && !ls->closed
            && !signals::interrupt_pending(task)) {
-        irq = sync::wait(ls->accept_wq, ls->lock, irq);
+        irq = sync::wait_exclusive(ls->accept_wq, ls->lock, irq);
     }
     if (signals::interrupt_pending(task)) {
+        // Hand a connection this acceptor may have been woken for to the next
+        bool pass = !ls->accept_queue.empty();
         sync::spin_unlock_irqrestore(ls->lock, irq);
+        if (pass) {
+            sync::wake_one(ls->accept_wq);
+        }
         return resource::ERR_INTR;
     }
     if (ls->accept_queue.empty()) {
@@ -0,0 +1,240 @@
+#include "strace/strace.h"
+#include "fs/node.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs/devfs/devfs.h"
+#include "mm/heap.h"
+#include "mm/uaccess.h"
+#include "syscall/syscall_table.h"
+#include "clock/clock.h"
+#include "sync/spinlock.h"
+#include "dynpriv/dynpriv.h"
+#include "common/logging.h"
+#include "common/string.h"
+
+namespace strace {
+
+__PRIVILEGED_BSS uint32_t g_traced_pid;
+
+namespace {
+
+static_assert((RING_RECORDS & (RING_RECORDS - 1)) == 0,
+              "RING_RECORDS must be a power of two");
+
+// Only the traced process pays for the lock, so one shared buffer will do
+__PRIVILEGED_BSS static record*      g_ring; // allocated on the first attach
+__PRIVILEGED_BSS static uint64_t     g_head;
+__PRIVILEGED_BSS static uint64_t     g_tail;
+__PRIVILEGED_BSS static uint64_t     g_records;
+__PRIVILEGED_BSS static uint64_t     g_drops;
+__PRIVILEGED_BSS static const void*  g_owner;
+__PRIVILEGED_DATA static sync::spinlock g_lock = sync::SPINLOCK_INIT;
+
+/**
+ * Claim the next slot, or nullptr if the buffer is full. Caller holds g_lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE record* next_slot() {
+    if (!g_ring || g_head - g_tail >= RING_RECORDS) {
+        g_drops++;
+        return nullptr;
+    }
+    record* r = &g_ring[g_head & (RING_RECORDS - 1)];
+    g_head++;
+    g_records++;
+    return r;
+}
+
+class strace_node : public fs::node {
+public:
+    strace_node() : fs::node(fs::node_type::char_device, nullptr, "strace") {}
+
+    ssize_t read(fs::file*, void* buf, size_t count) override {
+        if (!buf || count < sizeof(record)) {
+            return fs::ERR_INVAL;
+        }
+        size_t got = 0;
+        RUN_ELEVATED(got = read_records(static_cast<record*>(buf),
+                                        count / sizeof(record)));
+        return static_cast<ssize_t>(got * sizeof(record));
+    }
+
+    int32_t ioctl(fs::file* f, uint32_t cmd, uint64_t arg) override {
+        int32_t rc = fs::OK;
+        switch (cmd) {
+        case STRACE_ATTACH:
+            if (arg == 0 || arg > 0xFFFFFFFFull) {
+                return fs::ERR_INVAL;
+            }
+            RUN_ELEVATED(rc = attach(static_cast<uint32_t>(arg), f));
+            if (rc == ERR_BUSY) {
+                return fs::ERR_BUSY;
+            }
+            return rc == OK ? fs::OK : fs::ERR_NOMEM;
+        case STRACE_DETACH:
+            RUN_ELEVATED(detach(f));
+            return fs::OK;
+        case STRACE_GET_STATS:
+            RUN_ELEVATED({
+                strace_stats stats = read_stats();
+                if (mm::uaccess::copy_to_user(reinterpret_cast<void*>(arg),
+                                              &stats, sizeof(stats)) != mm::uaccess::OK) {
+                    rc = fs::ERR_INVAL;
+                }
+            });
+            return rc;
+        case STRACE_GET_NAME:
+            RUN_ELEVATED(rc = copy_name(reinterpret_cast<strace_name*>(arg)));
+            return rc;
+        default:
+            return fs::ERR_NOSYS;
+        }
+    }
+
+    int32_t on_close(fs::file* f) override {
+        RUN_ELEVATED(detach(f));
+        return fs::OK;
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = 0;
+        return fs::OK;
+    }
+
+private:
+    /**
+     * @note Privilege: **required**
+     */
+    __PRIVILEGED_CODE static int32_t copy_name(strace_name* uname) {
+        strace_name n = {};
+        if (mm::uaccess::copy_from_user(&n, uname, sizeof(n)) != mm::uaccess::OK) {
+            return fs::ERR_INVAL;
+        }
+        const char* name = n.nr < syscall::MAX_SYSCALL_NUM
+            ? syscall::g_syscall_names[n.nr] : nullptr;
+        string::memset(n.name, 0, sizeof(n.name));
+        if (name) {
+            size_t len = string::strlen(name);
+            if (len >= sizeof(n.name)) {
+                len = sizeof(n.name) - 1;
+            }
+            string::memcpy(n.name, name, len);
+        }
+        if (mm::uaccess::copy_to_user(uname, &n, sizeof(n)) != mm::uaccess::OK) {
+            return fs::ERR_INVAL;
+        }
+        return fs::OK;
+    }
+};
+
+} // anonymous namespace
+
+__PRIVILEGED_CODE int32_t init() {
+    auto* node = heap::kalloc_new<strace_node>();
+    if (!node) {
+        log::error("strace: failed to allocate /dev/strace");
+        return ERR;
+    }
+    if (devfs::add_char_device("strace", node) != devfs::OK) {
+        log::error("strace: failed to register /dev/strace");
+        heap::kfree_delete(node);
+        return ERR;
+    }
+    return OK;
+}
+
+__PRIVILEGED_CODE int32_t attach(uint32_t pid, const void* owner) {
+    if (!__atomic_load_n(&g_ring, __ATOMIC_ACQUIRE)) {
+        auto* ring = static_cast<record*>(heap::kzalloc(RING_RECORDS * sizeof(record)));
+        if (!ring) {
+            log::error("strace: failed to allocate record buffer");
+            return ERR;
+        }
+        record* expected = nullptr;
+        if (!__atomic_compare_exchange_n(&g_ring, &expected, ring, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            heap::kfree(ring);
+        }
+    }
+
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    if (g_owner && g_owner != owner) {
+        sync::spin_unlock_irqrestore(g_lock, irq);
+        return ERR_BUSY;
+    }
+    g_owner = owner;
+    g_tail = g_head;
+    g_records = 0;
+    g_drops = 0;
+    __atomic_store_n(&g_traced_pid, pid, __ATOMIC_RELEASE);
+    sync::spin_unlock_irqrestore(g_lock, irq);
+    return OK;
+}
+
+__PRIVILEGED_CODE void detach(const void* owner) {
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    if (g_owner == owner) {
+        g_owner = nullptr;
+        __atomic_store_n(&g_traced_pid, 0, __ATOMIC_RELEASE);
+    }
+    sync::spin_unlock_irqrestore(g_lock, irq);
+}
+
+__PRIVILEGED_CODE void record_enter(uint32_t tid, uint64_t nr, const uint64_t args[6]) {
+    uint64_t now = clock::now_ns();
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    if (record* r = next_slot()) {
+        r->ts_ns = now;
+        r->dur_ns = 0;
+        for (int i = 0; i < 6; i++) {
+            r->args[i] = args[i];
+        }
+        r->ret = 0;
+        r->tid = tid;
+        r->nr = static_cast<uint16_t>(nr);
+        r->kind = REC_ENTER;
+    }
+    sync::spin_unlock_irqrestore(g_lock, irq);
+}
+
+__PRIVILEGED_CODE void record_exit(uint32_t tid, uint64_t nr, int64_t ret, uint64_t dur_ns) {
+    uint64_t now = clock::now_ns();
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    if (record* r = next_slot()) {
+        r->ts_ns = now;
+        r->dur_ns = dur_ns;
+        for (int i = 0; i < 6; i++) {
+            r->args[i] = 0;
+        }
+        r->ret = ret;
+        r->tid = tid;
+        r->nr = static_cast<uint16_t>(nr);
+        r->kind = REC_EXIT;
+    }
+    sync::spin_unlock_irqrestore(g_lock, irq);
+}
+
+__PRIVILEGED_CODE size_t read_records(record* out, size_t max) {
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    size_t got = 0;
+    while (got < max && g_tail != g_head) {
+        out[got++] = g_ring[g_tail & (RING_RECORDS - 1)];
+        g_tail++;
+    }
+    sync::spin_unlock_irqrestore(g_lock, irq);
+    return got;
+}
+
+__PRIVILEGED_CODE strace_stats read_stats() {
+    sync::irq_state irq = sync::spin_lock_irqsave(g_lock);
+    strace_stats stats = {};
+    stats.records = g_records;
+    stats.drops = g_drops;
+    stats.pid = __atomic_load_n(&g_traced_pid, __ATOMIC_RELAXED);
+    sync::spin_unlock_irqrestore(g_lock, irq);
+    return stats;
+}
+
+} // namespace strace
@@ -0,0 +1,118 @@
+#ifndef STELLUX_STRACE_STRACE_H
+#define STELLUX_STRACE_STRACE_H
+
+#include "common/types.h"
+#include "sched/task.h"
+
+namespace strace {
+
+constexpr int32_t OK       = 0;
+constexpr int32_t ERR      = -1;
+constexpr int32_t ERR_BUSY = -2;
+
+/*
+ * Per-process syscall tracing through /dev/strace.
+ *
+ * One process at a time can be traced. The file that attached owns the
+ * trace until it detaches or is closed. While attached, every thread of
+ * the process records an enter record with the raw arguments before its
+ * handler runs and an exit record with the return value and the time
+ * spent in the handler after it. Syscalls that never return (exit,
+ * exit_group, a fatal signal) have no exit record.
+ *
+ * read() returns whole records and never blocks; it returns 0 when the
+ * buffer is empty. When the buffer is full new records are dropped and
+ * counted.
+ */
+
+constexpr uint32_t STRACE_ATTACH    = 0x5200; // arg: pid
+constexpr uint32_t STRACE_DETACH    = 0x5201;
+constexpr uint32_t STRACE_GET_STATS = 0x5202; // arg: strace_stats*
+constexpr uint32_t STRACE_GET_NAME  = 0x5203; // arg: strace_name*, nr filled in
+
+constexpr uint16_t REC_ENTER = 0;
+constexpr uint16_t REC_EXIT  = 1;
+
+constexpr uint32_t RING_RECORDS = 2048; // power of two
+
+struct record {
+    uint64_t ts_ns;
+    uint64_t dur_ns;  // exit: time spent in the handler
+    uint64_t args[6]; // enter: raw arguments
+    int64_t  ret;     // exit: value returned to userland
+    uint32_t tid;
+    uint16_t nr;
+    uint16_t kind;    // REC_ENTER or REC_EXIT
+};
+static_assert(sizeof(record) == 80, "strace::record is shared with userland");
+
+struct strace_stats {
+    uint64_t records;
+    uint64_t drops;
+    uint32_t pid; // traced pid, 0 if detached
+    uint32_t reserved;
+};
+
+struct strace_name {
+    uint32_t nr;
+    char     name[28]; // empty if nr has no handler
+};
+
+// pid of the traced process, 0 when tracing is off
+extern uint32_t g_traced_pid;
+
+/**
+ * @brief true if t belongs to the traced process. One load when tracing
+ * is off.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE inline bool traced(const sched::task* t) {
+    uint32_t pid = __atomic_load_n(&g_traced_pid, __ATOMIC_RELAXED);
+    return __builtin_expect(pid != 0, 0) && t && t->group && t->group->pid == pid;
+}
+
+/**
+ * @brief Register /dev/strace. Must be called after devfs is mounted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init();
+
+/**
+ * @brief Start tracing pid, discarding records left from an earlier trace.
+ * @param owner Opaque owner cookie, attach fails with ERR_BUSY while
+ *   another owner is attached.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t attach(uint32_t pid, const void* owner);
+
+/**
+ * @brief Stop tracing if owner is attached.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void detach(const void* owner);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record_enter(uint32_t tid, uint64_t nr, const uint64_t args[6]);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record_exit(uint32_t tid, uint64_t nr, int64_t ret, uint64_t dur_ns);
+
+/**
+ * @brief Copy up to max buffered records to out, oldest first.
+ * @return Number of records copied.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE size_t read_records(record* out, size_t max);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE strace_stats read_stats();
+
+} // namespace strace
+
+#endif // STELLUX_STRACE_STRACE_H
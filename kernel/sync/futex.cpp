@@ -2,40 +2,311 @@
 #include "sync/spinlock.h"
 #include "sched/sched.h"
 #include "sched/task.h"
+#include "sched/task_registry.h"
 #include "signals/signal.h"
+#include "mm/mm.h"
+#include "mm/heap.h"
 #include "mm/uaccess.h"
 #include "mm/vma.h"
 #include "common/hash.h"
 #include "common/string.h"
 #include "clock/clock.h"
 #include "timer/timer.h"
+#include "trace/trace.h"
 
 namespace sync {
 
 constexpr uint32_t WAKE_BATCH_SIZE = 16;
 
-__PRIVILEGED_BSS static futex_bucket g_futex_table[FUTEX_BUCKET_COUNT];
+// FUTEX_WAKE_OP encoding: op:4 (bit 3 = shift oparg), cmp:4, oparg:12, cmparg:12
+constexpr uint32_t FUTEX_OP_SET         = 0;
+constexpr uint32_t FUTEX_OP_ADD         = 1;
+constexpr uint32_t FUTEX_OP_OR          = 2;
+constexpr uint32_t FUTEX_OP_ANDN        = 3;
+constexpr uint32_t FUTEX_OP_XOR         = 4;
+constexpr uint32_t FUTEX_OP_OPARG_SHIFT = 8;
+
+constexpr uint32_t FUTEX_OP_CMP_EQ = 0;
+constexpr uint32_t FUTEX_OP_CMP_NE = 1;
+constexpr uint32_t FUTEX_OP_CMP_LT = 2;
+constexpr uint32_t FUTEX_OP_CMP_LE = 3;
+constexpr uint32_t FUTEX_OP_CMP_GT = 4;
+constexpr uint32_t FUTEX_OP_CMP_GE = 5;
+
+__PRIVILEGED_BSS static futex_bucket g_kernel_buckets[FUTEX_BUCKET_COUNT];
+__PRIVILEGED_BSS static futex_table g_kernel_table;
+
+__PRIVILEGED_CODE static void init_buckets(futex_bucket* buckets, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        buckets[i].lock = SPINLOCK_INIT;
+        buckets[i].waiters.init();
+    }
+}
 
 __PRIVILEGED_CODE void futex_init() {
-    for (uint32_t i = 0; i < FUTEX_BUCKET_COUNT; i++) {
-        g_futex_table[i].lock = SPINLOCK_INIT;
-        g_futex_table[i].waiters.init();
+    init_buckets(g_kernel_buckets, FUTEX_BUCKET_COUNT);
+    g_kernel_table.buckets = g_kernel_buckets;
+    g_kernel_table.mask = FUTEX_BUCKET_MASK;
+    g_kernel_table.dead = false;
+}
+
+__PRIVILEGED_CODE static uint32_t futex_hash(const futex_table* table,
+                                             mm::mm_context* mm, uintptr_t addr) {
+    // A private table only ever holds one address space's futexes
+    uint64_t h = (table == &g_kernel_table)
+        ? hash::combine(hash::ptr(mm), hash::u64(addr))
+        : hash::u64(addr);
+    return static_cast<uint32_t>(h) & table->mask;
+}
+
+/**
+ * Table for mm inside a read-side section, nullptr if the address space
+ * has not waited on a futex yet.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static futex_table* current_table(mm::mm_context* mm) {
+    return mm ? rc::rcu::dereference(mm->futex) : &g_kernel_table;
+}
+
+__PRIVILEGED_CODE static void free_table_rcu(rc::rcu::rcu_head* head) {
+    heap::kfree(rc::rcu::head_to_entry<futex_table, &futex_table::rcu>(head));
+}
+
+/**
+ * Buckets wanted for the address space of a task.
+ */
+__PRIVILEGED_CODE static uint32_t private_table_size(sched::task* task) {
+    uint32_t threads = 1;
+    if (task->group) {
+        threads += __atomic_load_n(&task->group->thread_count, __ATOMIC_RELAXED);
+    }
+    uint32_t want = threads * FUTEX_BUCKETS_PER_THREAD;
+    uint32_t n = FUTEX_PRIVATE_MIN_BUCKETS;
+    while (n < want && n < FUTEX_PRIVATE_MAX_BUCKETS) {
+        n <<= 1;
+    }
+    return n;
+}
+
+/**
+ * Install a table of `count` buckets for mm, moving every waiter over
+ * from the current one, which is retired after a grace period.
+ * @return false if no table exists and none could be allocated.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool grow_private_table(mm::mm_context* mm, uint32_t count) {
+    auto* fresh = static_cast<futex_table*>(
+        heap::kzalloc(sizeof(futex_table) + count * sizeof(futex_bucket)));
+    if (!fresh) {
+        return __atomic_load_n(&mm->futex, __ATOMIC_ACQUIRE) != nullptr;
+    }
+    fresh->buckets = reinterpret_cast<futex_bucket*>(fresh + 1);
+    fresh->mask = count - 1;
+    fresh->dead = false;
+    init_buckets(fresh->buckets, count);
+
+    irq_state irq = spin_lock_irqsave(mm->futex_lock);
+    futex_table* old = mm->futex;
+    if (old && old->mask + 1 >= count) {
+        // Another thread grew it first
+        spin_unlock_irqrestore(mm->futex_lock, irq);
+        heap::kfree(fresh);
+        return true;
+    }
+
+    if (old) {
+        // Bucket locks are always taken in index order, so holding all
+        // of them excludes every waker, requeue and departing waiter
+        for (uint32_t i = 0; i <= old->mask; i++) {
+            spin_lock(old->buckets[i].lock);
+        }
+        for (uint32_t i = 0; i <= old->mask; i++) {
+            while (futex_waiter* w = old->buckets[i].waiters.pop_front()) {
+                futex_bucket* dst = &fresh->buckets[futex_hash(fresh, mm, w->addr)];
+                dst->waiters.push_back(w);
+                __atomic_store_n(&w->bucket, dst, __ATOMIC_RELEASE);
+            }
+        }
+        old->dead = true;
+    }
+
+    rc::rcu::assign_pointer(mm->futex, fresh);
+
+    if (old) {
+        for (uint32_t i = 0; i <= old->mask; i++) {
+            spin_unlock(old->buckets[i].lock);
+        }
+    }
+    spin_unlock_irqrestore(mm->futex_lock, irq);
+
+    if (old) {
+        rc::rcu::call_rcu(&old->rcu, free_table_rcu);
+    }
+    return true;
+}
+
+/**
+ * Make sure the caller's address space has a table sized for its
+ * current thread count. Kernel tasks always use the global table.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool ensure_table(sched::task* self, mm::mm_context* mm) {
+    if (!mm) {
+        return true;
+    }
+    uint32_t want = private_table_size(self);
+    futex_table* table = __atomic_load_n(&mm->futex, __ATOMIC_ACQUIRE);
+    if (table && table->mask + 1 >= want) {
+        return true;
+    }
+    return grow_private_table(mm, want);
+}
+
+/**
+ * Lock the bucket of (mm, addr). Returns with IRQs masked, or nullptr
+ * (IRQs unchanged) when mm has no table and so no waiters.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static futex_bucket* lock_bucket(mm::mm_context* mm, uintptr_t addr,
+                                                   irq_state* irq) {
+    for (;;) {
+        irq_state rcu = rc::rcu::read_lock();
+        futex_table* table = current_table(mm);
+        if (!table) {
+            rc::rcu::read_unlock(rcu);
+            return nullptr;
+        }
+        futex_bucket* bucket = &table->buckets[futex_hash(table, mm, addr)];
+        spin_lock(bucket->lock);
+        if (!table->dead) {
+            *irq = rcu;
+            return bucket;
+        }
+        spin_unlock(bucket->lock);
+        rc::rcu::read_unlock(rcu);
+    }
+}
+
+/**
+ * Lock the buckets of two futexes in one address space, lower index
+ * first. *b1 == *b2 when they share a bucket.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool lock_two_buckets(mm::mm_context* mm,
+                                               uintptr_t addr1, uintptr_t addr2,
+                                               futex_bucket** b1, futex_bucket** b2,
+                                               irq_state* irq) {
+    for (;;) {
+        irq_state rcu = rc::rcu::read_lock();
+        futex_table* table = current_table(mm);
+        if (!table) {
+            rc::rcu::read_unlock(rcu);
+            return false;
+        }
+        *b1 = &table->buckets[futex_hash(table, mm, addr1)];
+        *b2 = &table->buckets[futex_hash(table, mm, addr2)];
+        futex_bucket* first = (*b1 < *b2) ? *b1 : *b2;
+        futex_bucket* second = (*b1 < *b2) ? *b2 : *b1;
+        spin_lock(first->lock);
+        if (second != first) {
+            spin_lock(second->lock);
+        }
+        if (!table->dead) {
+            *irq = rcu;
+            return true;
+        }
+        if (second != first) {
+            spin_unlock(second->lock);
+        }
+        spin_unlock(first->lock);
+        rc::rcu::read_unlock(rcu);
+    }
+}
+
+__PRIVILEGED_CODE static void unlock_two_buckets(futex_bucket* b1, futex_bucket* b2,
+                                                 irq_state irq) {
+    if (b2 != b1) {
+        spin_unlock(b2->lock);
+    }
+    spin_unlock_irqrestore(b1->lock, irq);
+}
+
+/**
+ * Take a waiter off whichever bucket it is queued on now; requeue and
+ * table growth may have moved it since it went to sleep.
+ * @return true if it was still queued (not woken).
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool unqueue_waiter(futex_waiter* waiter) {
+    for (;;) {
+        irq_state rcu = rc::rcu::read_lock();
+        futex_bucket* bucket = __atomic_load_n(&waiter->bucket, __ATOMIC_ACQUIRE);
+        spin_lock(bucket->lock);
+        if (__atomic_load_n(&waiter->bucket, __ATOMIC_RELAXED) != bucket) {
+            spin_unlock(bucket->lock);
+            rc::rcu::read_unlock(rcu);
+            continue;
+        }
+        bool linked = waiter->link.is_linked();
+        if (linked) {
+            bucket->waiters.remove(waiter);
+            if (waiter->pi_owner) {
+                sched::task* owner = sched::g_task_registry.find_rcu(waiter->pi_owner);
+                if (owner) {
+                    sched::pi_unboost(owner);
+                }
+                waiter->pi_owner = 0;
+            }
+        }
+        spin_unlock(bucket->lock);
+        rc::rcu::read_unlock(rcu);
+        return linked;
     }
 }
 
-__PRIVILEGED_CODE static uint32_t futex_hash(mm::mm_context* mm, uintptr_t addr) {
-    uint64_t h = hash::combine(hash::ptr(mm), hash::u64(addr));
-    return static_cast<uint32_t>(h) & FUTEX_BUCKET_MASK;
+/**
+ * Dequeue up to max waiters on (mm, addr) whose bitset intersects
+ * bitset into batch. Caller holds the bucket lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint32_t dequeue_waiters(futex_bucket* bucket, mm::mm_context* mm,
+                                                  uintptr_t addr, uint32_t bitset,
+                                                  uint32_t max, sched::task** batch) {
+    uint32_t n = 0;
+    auto it = bucket->waiters.begin();
+    auto end = bucket->waiters.end();
+    while (it != end && n < max) {
+        futex_waiter& w = *it;
+        ++it; // advance before removal
+        if (w.mm == mm && w.addr == addr && !w.pi && (w.bitset & bitset)) {
+            bucket->waiters.remove(&w);
+            batch[n++] = w.task;
+        }
+    }
+    return n;
+}
+
+__PRIVILEGED_CODE static void wake_batch(sched::task** batch, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        sched::wake(batch[i]);
+    }
 }
 
 __PRIVILEGED_CODE int32_t futex_wait(uintptr_t uaddr, uint32_t expected,
                                      uint64_t timeout_ns) {
+    uint64_t deadline = timeout_ns > 0 ? clock::now_ns() + timeout_ns : 0;
+    return futex_wait_bitset(uaddr, expected, deadline, FUTEX_BITSET_MATCH_ANY);
+}
+
+__PRIVILEGED_CODE int32_t futex_wait_bitset(uintptr_t uaddr, uint32_t expected,
+                                            uint64_t deadline_ns, uint32_t bitset) {
     sched::task* self = sched::current();
     mm::mm_context* mm = self->exec.mm_ctx;
     if (uaddr & 0x3) return -22; // EINVAL
+    if (bitset == 0) return -22; // EINVAL
 
     // Read the value before taking the bucket lock. copy_from_user
-    // acquires mm_ctx->lock (a sleeping mutex) so it must not be called
+    // acquires mm_ctx->lock (a sleeping rwsem) so it must not be called
     // under a spinlock. This also faults in the page so the re-read
     // under the spinlock below is safe.
     uint32_t pre_val;
@@ -51,16 +322,21 @@ __PRIVILEGED_CODE int32_t futex_wait(uintptr_t uaddr, uint32_t expected,
     // Early exit: if the value already changed, no need to lock the bucket.
     if (pre_val != expected) return -11; // EAGAIN
 
-    uint32_t idx = futex_hash(mm, uaddr);
-    futex_bucket* bucket = &g_futex_table[idx];
+    if (!ensure_table(self, mm)) return -12; // ENOMEM
 
     futex_waiter waiter;
     waiter.task = self;
     waiter.mm = mm;
     waiter.addr = uaddr;
+    waiter.bitset = bitset;
     waiter.link = {};
+    waiter.pi = false;
+    waiter.pi_acquired = false;
+    waiter.pi_owner = 0;
 
-    irq_state irq = spin_lock_irqsave(bucket->lock);
+    // A table is never removed while its address space has tasks
+    irq_state irq;
+    futex_bucket* bucket = lock_bucket(mm, uaddr, &irq);
 
     // Re-read the futex word under the bucket lock. The page is already
     // validated/faulted by the copy_from_user above, so a direct read
@@ -76,22 +352,19 @@ __PRIVILEGED_CODE int32_t futex_wait(uintptr_t uaddr, uint32_t expected,
 
     sched::prepare_to_block_task();
     bucket->waiters.push_back(&waiter);
+    waiter.bucket = bucket;
 
-    if (timeout_ns > 0) {
-        uint64_t deadline = clock::now_ns() + timeout_ns;
-        timer::schedule_sleep(self, deadline);
+    if (deadline_ns > 0) {
+        timer::schedule_sleep(self, deadline_ns);
     }
 
     spin_unlock_irqrestore(bucket->lock, irq);
+    TRACE(FUTEX_WAIT, uaddr, expected);
 
     if (sched::block_task_interrupted()) {
         // Interrupted during futex entry: unwind waiter and timer, don't block.
         timer::cancel_sleep(self);
-        irq = spin_lock_irqsave(bucket->lock);
-        if (waiter.link.is_linked()) {
-            bucket->waiters.remove(&waiter);
-        }
-        spin_unlock_irqrestore(bucket->lock, irq);
+        unqueue_waiter(&waiter);
         sched::cancel_block_task();
         return -4; // EINTR
     }
@@ -102,105 +375,511 @@ __PRIVILEGED_CODE int32_t futex_wait(uintptr_t uaddr, uint32_t expected,
     timer::cancel_sleep(self);
 
     // Remove self from bucket if still linked (timeout or interrupt wakeup).
-    bool was_linked = false;
-    irq = spin_lock_irqsave(bucket->lock);
-    if (waiter.link.is_linked()) {
-        bucket->waiters.remove(&waiter);
-        was_linked = true;
-    }
-    spin_unlock_irqrestore(bucket->lock, irq);
+    bool was_linked = unqueue_waiter(&waiter);
 
     if (signals::interrupt_pending(self)) return -4; // EINTR
     if (was_linked) return -110; // ETIMEDOUT
     return 0;
 }
 
+__PRIVILEGED_CODE int32_t futex_waitv(const futex_wait_key* keys, uint32_t count,
+                                      uint64_t deadline_ns) {
+    sched::task* self = sched::current();
+    mm::mm_context* mm = self->exec.mm_ctx;
+    if (count == 0 || count > FUTEX_WAITV_MAX) return -22; // EINVAL
+
+    // Fault every word in and fail early on a mismatch, as futex_wait does
+    for (uint32_t i = 0; i < count; i++) {
+        if (keys[i].addr & 0x3) return -22; // EINVAL
+        uint32_t pre_val;
+        if (mm) {
+            if (mm::uaccess::copy_from_user(
+                    &pre_val, reinterpret_cast<const void*>(keys[i].addr),
+                    sizeof(uint32_t)) != 0) {
+                return -14; // EFAULT
+            }
+        } else {
+            string::memcpy(&pre_val, reinterpret_cast<const void*>(keys[i].addr),
+                           sizeof(uint32_t));
+        }
+        if (pre_val != keys[i].expected) return -11; // EAGAIN
+    }
+
+    if (!ensure_table(self, mm)) return -12; // ENOMEM
+
+    auto* waiters = static_cast<futex_waiter*>(
+        heap::kzalloc(count * sizeof(futex_waiter)));
+    if (!waiters) return -12; // ENOMEM
+
+    // Queue on each bucket in turn, re-checking the word under its lock.
+    // A wake on an already queued word is caught by the final unqueue.
+    sched::prepare_to_block_task();
+    uint32_t queued = 0;
+    bool mismatch = false;
+    for (; queued < count; queued++) {
+        futex_waiter* w = &waiters[queued];
+        w->task = self;
+        w->mm = mm;
+        w->addr = keys[queued].addr;
+        w->bitset = FUTEX_BITSET_MATCH_ANY;
+        w->link = {};
+
+        irq_state irq;
+        futex_bucket* bucket = lock_bucket(mm, w->addr, &irq);
+        uint32_t current_val;
+        string::memcpy(&current_val, reinterpret_cast<const void*>(w->addr),
+                       sizeof(uint32_t));
+        if (current_val != keys[queued].expected) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            mismatch = true;
+            break;
+        }
+        bucket->waiters.push_back(w);
+        w->bucket = bucket;
+        spin_unlock_irqrestore(bucket->lock, irq);
+    }
+
+    bool interrupted = !mismatch && sched::block_task_interrupted();
+    if (mismatch || interrupted) {
+        for (uint32_t i = 0; i < queued; i++) {
+            unqueue_waiter(&waiters[i]);
+        }
+        sched::cancel_block_task();
+        heap::kfree(waiters);
+        return mismatch ? -11 : -4; // EAGAIN : EINTR
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        TRACE(FUTEX_WAIT, keys[i].addr, keys[i].expected);
+    }
+
+    if (deadline_ns > 0) {
+        timer::schedule_sleep(self, deadline_ns);
+    }
+    sched::yield();
+    timer::cancel_sleep(self);
+
+    // A waiter a waker took off its bucket is the one that woke us
+    int32_t woken = -1;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!unqueue_waiter(&waiters[i]) && woken < 0) {
+            woken = static_cast<int32_t>(i);
+        }
+    }
+    heap::kfree(waiters);
+
+    if (woken >= 0) return woken;
+    if (signals::interrupt_pending(self)) return -4; // EINTR
+    return -110; // ETIMEDOUT
+}
+
 __PRIVILEGED_CODE int32_t futex_wake(uintptr_t uaddr, uint32_t count) {
+    return futex_wake_bitset(uaddr, count, FUTEX_BITSET_MATCH_ANY);
+}
+
+__PRIVILEGED_CODE int32_t futex_wake_bitset(uintptr_t uaddr, uint32_t count,
+                                            uint32_t bitset) {
     sched::task* self = sched::current();
     mm::mm_context* mm = self->exec.mm_ctx;
     if (uaddr & 0x3) return -22; // EINVAL
+    if (bitset == 0) return -22; // EINVAL
     if (count == 0) return 0;
 
-    uint32_t idx = futex_hash(mm, uaddr);
-    futex_bucket* bucket = &g_futex_table[idx];
-
     uint32_t total_woken = 0;
 
-    for (;;) {
+    while (total_woken < count) {
         sched::task* batch[WAKE_BATCH_SIZE];
-        uint32_t n = 0;
-        bool done = false;
-
-        irq_state irq = spin_lock_irqsave(bucket->lock);
-
-        auto it = bucket->waiters.begin();
-        auto end = bucket->waiters.end();
-        while (it != end && n < WAKE_BATCH_SIZE) {
-            futex_waiter& w = *it;
-            ++it; // advance before removal
-            if (w.mm == mm && w.addr == uaddr) {
-                bucket->waiters.remove(&w);
-                batch[n++] = w.task;
-                if (total_woken + n >= count) {
-                    done = true;
-                    break;
-                }
-            }
-        }
+        uint32_t want = count - total_woken;
+        if (want > WAKE_BATCH_SIZE) want = WAKE_BATCH_SIZE;
 
-        if (n == 0) done = true;
+        irq_state irq;
+        futex_bucket* bucket = lock_bucket(mm, uaddr, &irq);
+        if (!bucket) break;
+        uint32_t n = dequeue_waiters(bucket, mm, uaddr, bitset, want, batch);
         spin_unlock_irqrestore(bucket->lock, irq);
 
-        for (uint32_t i = 0; i < n; i++) {
-            sched::wake(batch[i]);
-        }
+        wake_batch(batch, n);
         total_woken += n;
 
-        if (done) break;
+        if (n < want) break;
     }
 
+    TRACE(FUTEX_WAKE, uaddr, total_woken);
     return static_cast<int32_t>(total_woken);
 }
 
 __PRIVILEGED_CODE int32_t futex_wake_all(uintptr_t uaddr) {
+    return futex_wake_bitset(uaddr, 0xFFFFFFFFu, FUTEX_BITSET_MATCH_ANY);
+}
+
+/**
+ * Apply a FUTEX_WAKE_OP operation to *uaddr atomically.
+ * @return The previous value.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint32_t apply_wake_op(uintptr_t uaddr, uint32_t op,
+                                                uint32_t oparg) {
+    auto* word = reinterpret_cast<uint32_t*>(uaddr);
+    uint32_t old = __atomic_load_n(word, __ATOMIC_RELAXED);
+    uint32_t val;
+    do {
+        switch (op) {
+        case FUTEX_OP_SET:  val = oparg; break;
+        case FUTEX_OP_ADD:  val = old + oparg; break;
+        case FUTEX_OP_OR:   val = old | oparg; break;
+        case FUTEX_OP_ANDN: val = old & ~oparg; break;
+        default:            val = old ^ oparg; break; // FUTEX_OP_XOR
+        }
+    } while (!__atomic_compare_exchange_n(word, &old, val, true,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    return old;
+}
+
+static bool wake_op_compare(uint32_t cmp, int32_t oldval, int32_t cmparg) {
+    switch (cmp) {
+    case FUTEX_OP_CMP_EQ: return oldval == cmparg;
+    case FUTEX_OP_CMP_NE: return oldval != cmparg;
+    case FUTEX_OP_CMP_LT: return oldval < cmparg;
+    case FUTEX_OP_CMP_LE: return oldval <= cmparg;
+    case FUTEX_OP_CMP_GT: return oldval > cmparg;
+    default:              return oldval >= cmparg; // FUTEX_OP_CMP_GE
+    }
+}
+
+static int32_t sign_extend12(uint32_t v) {
+    return static_cast<int32_t>(v << 20) >> 20;
+}
+
+__PRIVILEGED_CODE int32_t futex_wake_op(uintptr_t uaddr, uintptr_t uaddr2,
+                                        uint32_t count, uint32_t count2,
+                                        uint32_t encoded_op) {
     sched::task* self = sched::current();
     mm::mm_context* mm = self->exec.mm_ctx;
-    if (uaddr & 0x3) return -22; // EINVAL
+    if ((uaddr | uaddr2) & 0x3) return -22; // EINVAL
 
-    uint32_t idx = futex_hash(mm, uaddr);
-    futex_bucket* bucket = &g_futex_table[idx];
+    uint32_t op = (encoded_op >> 28) & 0xF;
+    uint32_t cmp = (encoded_op >> 24) & 0xF;
+    int32_t oparg = sign_extend12((encoded_op >> 12) & 0xFFF);
+    int32_t cmparg = sign_extend12(encoded_op & 0xFFF);
 
-    uint32_t total_woken = 0;
+    if (op & FUTEX_OP_OPARG_SHIFT) {
+        if (oparg < 0 || oparg > 31) return -22; // EINVAL
+        oparg = static_cast<int32_t>(1u << oparg);
+        op &= ~FUTEX_OP_OPARG_SHIFT;
+    }
+    if (op > FUTEX_OP_XOR || cmp > FUTEX_OP_CMP_GE) return -38; // ENOSYS
+
+    // Fault in the second word for writing before any spinlock is held
+    if (mm && mm::uaccess::validate_user_range(
+            reinterpret_cast<const void*>(uaddr2), sizeof(uint32_t),
+            mm::MM_PROT_READ | mm::MM_PROT_WRITE) != mm::uaccess::OK) {
+        return -14; // EFAULT
+    }
+
+    futex_bucket* b1 = nullptr;
+    futex_bucket* b2 = nullptr;
+    irq_state irq;
+    if (!lock_two_buckets(mm, uaddr, uaddr2, &b1, &b2, &irq)) {
+        // No table yet, so nobody to wake, but the operation still happens
+        apply_wake_op(uaddr2, op, static_cast<uint32_t>(oparg));
+        return 0;
+    }
+
+    uint32_t oldval = apply_wake_op(uaddr2, op, static_cast<uint32_t>(oparg));
+    bool wake2 = wake_op_compare(cmp, static_cast<int32_t>(oldval), cmparg);
+
+    sched::task* batch[2 * WAKE_BATCH_SIZE];
+    uint32_t want1 = count < WAKE_BATCH_SIZE ? count : WAKE_BATCH_SIZE;
+    uint32_t want2 = count2 < WAKE_BATCH_SIZE ? count2 : WAKE_BATCH_SIZE;
+    uint32_t n1 = dequeue_waiters(b1, mm, uaddr, FUTEX_BITSET_MATCH_ANY, want1, batch);
+    uint32_t n2 = 0;
+    if (wake2) {
+        n2 = dequeue_waiters(b2, mm, uaddr2, FUTEX_BITSET_MATCH_ANY, want2, batch + n1);
+    }
+    unlock_two_buckets(b1, b2, irq);
+    wake_batch(batch, n1 + n2);
+
+    // Waiters past one batch were queued before the operation too, so
+    // waking them after dropping the locks is equivalent
+    int32_t total = static_cast<int32_t>(n1 + n2);
+    if (n1 == want1 && count > want1) {
+        total += futex_wake(uaddr, count - want1);
+    }
+    if (wake2 && n2 == want2 && count2 > want2) {
+        total += futex_wake(uaddr2, count2 - want2);
+    }
+    return total;
+}
+
+__PRIVILEGED_CODE int32_t futex_requeue(uintptr_t uaddr, uintptr_t uaddr2,
+                                        uint32_t nr_wake, uint32_t nr_requeue,
+                                        bool check, uint32_t cmp_val) {
+    sched::task* self = sched::current();
+    mm::mm_context* mm = self->exec.mm_ctx;
+    if ((uaddr | uaddr2) & 0x3) return -22; // EINVAL
+    if (uaddr == uaddr2) return -22; // EINVAL
+
+    if (check) {
+        // Fault the word in so the locked re-read below cannot fault
+        uint32_t pre_val;
+        if (mm) {
+            if (mm::uaccess::copy_from_user(
+                    &pre_val, reinterpret_cast<const void*>(uaddr),
+                    sizeof(uint32_t)) != 0) {
+                return -14; // EFAULT
+            }
+        } else {
+            string::memcpy(&pre_val, reinterpret_cast<const void*>(uaddr),
+                           sizeof(uint32_t));
+        }
+        if (pre_val != cmp_val) return -11; // EAGAIN
+    }
+
+    uint32_t woken = 0;
+    uint32_t requeued = 0;
 
     for (;;) {
+        futex_bucket* b1 = nullptr;
+        futex_bucket* b2 = nullptr;
+        irq_state irq;
+        if (!lock_two_buckets(mm, uaddr, uaddr2, &b1, &b2, &irq)) {
+            break;
+        }
+
+        if (check) {
+            uint32_t current_val;
+            string::memcpy(&current_val, reinterpret_cast<const void*>(uaddr),
+                           sizeof(uint32_t));
+            if (current_val != cmp_val) {
+                unlock_two_buckets(b1, b2, irq);
+                return -11; // EAGAIN
+            }
+            check = false;
+        }
+
         sched::task* batch[WAKE_BATCH_SIZE];
-        uint32_t n = 0;
-
-        irq_state irq = spin_lock_irqsave(bucket->lock);
-
-        auto it = bucket->waiters.begin();
-        auto end = bucket->waiters.end();
-        while (it != end && n < WAKE_BATCH_SIZE) {
-            futex_waiter& w = *it;
-            ++it;
-            if (w.mm == mm && w.addr == uaddr) {
-                bucket->waiters.remove(&w);
-                batch[n++] = w.task;
+        uint32_t want = nr_wake - woken;
+        if (want > WAKE_BATCH_SIZE) want = WAKE_BATCH_SIZE;
+        uint32_t n = dequeue_waiters(b1, mm, uaddr, FUTEX_BITSET_MATCH_ANY, want, batch);
+        woken += n;
+
+        bool more_to_wake = (n == want && woken < nr_wake);
+        if (!more_to_wake) {
+            // Move the rest over without waking them
+            auto it = b1->waiters.begin();
+            auto end = b1->waiters.end();
+            while (it != end && requeued < nr_requeue) {
+                futex_waiter& w = *it;
+                ++it;
+                if (w.mm == mm && w.addr == uaddr && !w.pi) {
+                    b1->waiters.remove(&w);
+                    w.addr = uaddr2;
+                    b2->waiters.push_back(&w);
+                    __atomic_store_n(&w.bucket, b2, __ATOMIC_RELEASE);
+                    requeued++;
+                }
+            }
+        }
+
+        unlock_two_buckets(b1, b2, irq);
+        wake_batch(batch, n);
+
+        if (!more_to_wake) break;
+    }
+
+    return static_cast<int32_t>(woken + requeued);
+}
+
+/**
+ * First PI waiter on (mm, addr) in a locked bucket, starting after `after`
+ * when given.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static futex_waiter* next_pi_waiter(futex_bucket* bucket,
+                                                      mm::mm_context* mm, uintptr_t addr,
+                                                      futex_waiter* after) {
+    bool past = (after == nullptr);
+    for (futex_waiter& w : bucket->waiters) {
+        if (!past) {
+            past = (&w == after);
+            continue;
+        }
+        if (w.pi && w.mm == mm && w.addr == addr) {
+            return &w;
+        }
+    }
+    return nullptr;
+}
+
+__PRIVILEGED_CODE int32_t futex_lock_pi(uintptr_t uaddr, uint64_t deadline_ns,
+                                        bool try_only) {
+    sched::task* self = sched::current();
+    mm::mm_context* mm = self->exec.mm_ctx;
+    if (uaddr & 0x3) return -22; // EINVAL
+
+    // The word is updated in place under the bucket lock, so fault it in
+    // for writing first
+    if (mm && mm::uaccess::validate_user_range(
+            reinterpret_cast<const void*>(uaddr), sizeof(uint32_t),
+            mm::MM_PROT_READ | mm::MM_PROT_WRITE) != mm::uaccess::OK) {
+        return -14; // EFAULT
+    }
+    if (!ensure_table(self, mm)) return -12; // ENOMEM
+
+    auto* word = reinterpret_cast<uint32_t*>(uaddr);
+    futex_waiter waiter;
+    waiter.task = self;
+    waiter.mm = mm;
+    waiter.addr = uaddr;
+    waiter.bitset = FUTEX_BITSET_MATCH_ANY;
+    waiter.link = {};
+    waiter.pi = true;
+    waiter.pi_acquired = false;
+    waiter.pi_owner = 0;
+
+    for (;;) {
+        irq_state irq;
+        futex_bucket* bucket = lock_bucket(mm, uaddr, &irq);
+        uint32_t val = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+        uint32_t owner_tid = val & FUTEX_TID_MASK;
+
+        if (owner_tid == 0) {
+            // Free, possibly with a dead owner's bit left for the caller
+            // to see: take it, keeping FUTEX_WAITERS while others wait
+            uint32_t next = self->tid | (val & FUTEX_OWNER_DIED);
+            if (next_pi_waiter(bucket, mm, uaddr, nullptr)) {
+                next |= FUTEX_WAITERS;
             }
+            bool taken = __atomic_compare_exchange_n(word, &val, next, false,
+                                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+            spin_unlock_irqrestore(bucket->lock, irq);
+            if (taken) return 0;
+            continue;
+        }
+        if (owner_tid == self->tid) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            return -35; // EDEADLK
+        }
+        if (try_only) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            return -11; // EAGAIN
+        }
+
+        // Force the owner's unlock into the kernel
+        if (!(val & FUTEX_WAITERS) &&
+            !__atomic_compare_exchange_n(word, &val, val | FUTEX_WAITERS, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            continue;
+        }
+
+        // The bucket lock holds an RCU read-side section
+        sched::task* owner = sched::g_task_registry.find_rcu(owner_tid);
+        if (!owner) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            return -3; // ESRCH
+        }
+
+        sched::prepare_to_block_task();
+        bucket->waiters.push_back(&waiter);
+        waiter.bucket = bucket;
+        waiter.pi_owner = owner_tid;
+        sched::pi_boost(owner);
+
+        if (deadline_ns > 0) {
+            timer::schedule_sleep(self, deadline_ns);
         }
 
-        bool drained = (n == 0);
         spin_unlock_irqrestore(bucket->lock, irq);
+        TRACE(FUTEX_LOCK_PI, uaddr, owner_tid);
+
+        if (sched::block_task_interrupted()) {
+            timer::cancel_sleep(self);
+            unqueue_waiter(&waiter);
+            sched::cancel_block_task();
+            // An unlock may have handed the lock over before the unqueue
+            if (waiter.pi_acquired) return 0;
+            return -4; // EINTR
+        }
+        sched::yield();
+        timer::cancel_sleep(self);
 
-        for (uint32_t i = 0; i < n; i++) {
-            sched::wake(batch[i]);
+        // Only a handoff takes a PI waiter off its bucket
+        if (!unqueue_waiter(&waiter) || waiter.pi_acquired) return 0;
+        if (signals::interrupt_pending(self)) return -4; // EINTR
+        if (deadline_ns > 0 && clock::now_ns() >= deadline_ns) return -110; // ETIMEDOUT
+    }
+}
+
+__PRIVILEGED_CODE int32_t futex_unlock_pi(uintptr_t uaddr) {
+    sched::task* self = sched::current();
+    mm::mm_context* mm = self->exec.mm_ctx;
+    if (uaddr & 0x3) return -22; // EINVAL
+
+    if (mm && mm::uaccess::validate_user_range(
+            reinterpret_cast<const void*>(uaddr), sizeof(uint32_t),
+            mm::MM_PROT_READ | mm::MM_PROT_WRITE) != mm::uaccess::OK) {
+        return -14; // EFAULT
+    }
+
+    auto* word = reinterpret_cast<uint32_t*>(uaddr);
+    for (;;) {
+        irq_state irq;
+        futex_bucket* bucket = lock_bucket(mm, uaddr, &irq);
+        uint32_t val = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+        if ((val & FUTEX_TID_MASK) != self->tid) {
+            if (bucket) spin_unlock_irqrestore(bucket->lock, irq);
+            return -1; // EPERM
         }
-        total_woken += n;
 
-        if (drained) break;
+        futex_waiter* next = bucket ? next_pi_waiter(bucket, mm, uaddr, nullptr) : nullptr;
+        if (!next) {
+            bool released = __atomic_compare_exchange_n(word, &val, 0u, false,
+                                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            if (bucket) spin_unlock_irqrestore(bucket->lock, irq);
+            if (released) {
+                TRACE(FUTEX_UNLOCK_PI, uaddr, 0);
+                return 0;
+            }
+            continue;
+        }
+
+        // Hand the lock straight to the first waiter so nobody can barge
+        // in between the release and its wakeup
+        futex_waiter* rest = next_pi_waiter(bucket, mm, uaddr, next);
+        sched::task* heir = next->task;
+        uint32_t handed = heir->tid | (rest ? FUTEX_WAITERS : 0);
+        if (!__atomic_compare_exchange_n(word, &val, handed, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            spin_unlock_irqrestore(bucket->lock, irq);
+            continue;
+        }
+
+        bucket->waiters.remove(next);
+        next->pi_owner = 0;
+        next->pi_acquired = true;
+        sched::pi_unboost(self);
+
+        // The remaining waiters now boost the new owner
+        for (futex_waiter* w = rest; w; w = next_pi_waiter(bucket, mm, uaddr, w)) {
+            sched::pi_unboost(self);
+            w->pi_owner = heir->tid;
+            sched::pi_boost(heir);
+        }
+
+        spin_unlock_irqrestore(bucket->lock, irq);
+        TRACE(FUTEX_UNLOCK_PI, uaddr, heir->tid);
+        sched::wake(heir);
+        return 0;
     }
+}
 
-    return static_cast<int32_t>(total_woken);
+__PRIVILEGED_CODE void futex_mm_destroy(mm::mm_context* mm) {
+    futex_table* table = mm->futex;
+    mm->futex = nullptr;
+    if (table) {
+        heap::kfree(table);
+    }
 }
 
 } // namespace sync
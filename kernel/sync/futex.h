@@ -4,17 +4,41 @@
 #include "common/types.h"
 #include "common/list.h"
 #include "sync/spinlock.h"
+#include "rc/rcu.h"
 
 namespace sched { struct task; }
 namespace mm { struct mm_context; }
 
 namespace sync {
 
+/*
+ * Futex hash tables.
+ *
+ * Futexes are keyed by (address space, virtual address), so a futex
+ * never matches across processes and every user futex is private to
+ * its mm_context. Each address space therefore gets its own table,
+ * allocated on the first wait and grown with the thread count, and
+ * unrelated processes never share a bucket lock. Kernel tasks, which
+ * have no mm_context, use one global table.
+ *
+ * Requeue and table growth move waiters between buckets under both
+ * bucket locks. A waiter always finds its current bucket through
+ * futex_waiter::bucket, and retired tables are freed after an RCU
+ * grace period.
+ */
+
+struct futex_bucket;
+
 struct futex_waiter {
     sched::task*    task;
     mm::mm_context* mm;
     uintptr_t       addr;
+    uint32_t        bitset;   // FUTEX_WAIT_BITSET mask, all ones for plain waits
+    futex_bucket*   bucket;   // bucket the waiter is queued on, under its lock
     list::node      link;
+    bool            pi;          // blocked in futex_lock_pi, ignored by plain wakes
+    bool            pi_acquired; // futex_unlock_pi handed the lock over
+    uint32_t        pi_owner;    // tid of the owner this waiter boosts, 0 for none
 };
 
 struct futex_bucket {
@@ -22,15 +46,48 @@ struct futex_bucket {
     list::head<futex_waiter, &futex_waiter::link> waiters;
 };
 
+struct futex_table {
+    futex_bucket*     buckets;
+    uint32_t          mask;   // bucket count - 1
+    bool              dead;   // replaced by a larger table, set under every bucket lock
+    rc::rcu::rcu_head rcu;
+};
+
 constexpr uint32_t FUTEX_BUCKET_COUNT = 256;
 constexpr uint32_t FUTEX_BUCKET_MASK  = FUTEX_BUCKET_COUNT - 1;
 
+// Per-address-space tables: buckets per thread, clamped to a power of two
+constexpr uint32_t FUTEX_BUCKETS_PER_THREAD  = 4;
+constexpr uint32_t FUTEX_PRIVATE_MIN_BUCKETS = 16;
+constexpr uint32_t FUTEX_PRIVATE_MAX_BUCKETS = 1024;
+
+constexpr uint32_t FUTEX_BITSET_MATCH_ANY = 0xFFFFFFFF;
+
+// Most futexes one futex_waitv call may wait on
+constexpr uint32_t FUTEX_WAITV_MAX = 128;
+
+// PI futex word: owner tid plus state bits, as on Linux
+constexpr uint32_t FUTEX_WAITERS    = 0x80000000;
+constexpr uint32_t FUTEX_OWNER_DIED = 0x40000000;
+constexpr uint32_t FUTEX_TID_MASK   = 0x3FFFFFFF;
+
+struct futex_wait_key {
+    uintptr_t addr;
+    uint32_t  expected;
+};
+
 /**
- * Initialize the futex hash table. Call once during boot after sched::init().
+ * Initialize the kernel futex table. Call once during boot after sched::init().
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void futex_init();
 
+/**
+ * Free the futex table of an address space that has no tasks left.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void futex_mm_destroy(mm::mm_context* mm);
+
 /**
  * Block if *uaddr == expected. timeout_ns=0 means wait indefinitely.
  * Returns 0 on wake, -EAGAIN on mismatch, -ETIMEDOUT, -EINTR, -EFAULT.
@@ -39,18 +96,88 @@ __PRIVILEGED_CODE void futex_init();
 __PRIVILEGED_CODE int32_t futex_wait(uintptr_t uaddr, uint32_t expected,
                                      uint64_t timeout_ns);
 
+/**
+ * futex_wait with a wake mask and an absolute clock::now_ns() deadline
+ * (0 for none). Only wakes whose bitset intersects this one match.
+ * Returns -EINVAL for an empty bitset.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_wait_bitset(uintptr_t uaddr, uint32_t expected,
+                                            uint64_t deadline_ns, uint32_t bitset);
+
+/**
+ * Block until any of count futexes is woken. Fails with -EAGAIN without
+ * blocking if any key's word differs from its expected value.
+ * deadline_ns is an absolute clock::now_ns() time, 0 for none.
+ * Returns the index of a woken key, -EAGAIN, -ETIMEDOUT, -EINTR,
+ * -EFAULT, -EINVAL or -ENOMEM.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_waitv(const futex_wait_key* keys, uint32_t count,
+                                      uint64_t deadline_ns);
+
 /**
  * Wake up to count threads waiting on uaddr. Returns number woken.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t futex_wake(uintptr_t uaddr, uint32_t count);
 
+/**
+ * Wake up to count waiters on uaddr whose wait bitset intersects bitset.
+ * Returns number woken, -EINVAL for an empty bitset.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_wake_bitset(uintptr_t uaddr, uint32_t count,
+                                            uint32_t bitset);
+
 /**
  * Wake all threads waiting on uaddr. Returns number woken.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE int32_t futex_wake_all(uintptr_t uaddr);
 
+/**
+ * FUTEX_WAKE_OP: atomically apply the encoded operation to *uaddr2, wake
+ * up to count waiters on uaddr and, if the encoded comparison holds for
+ * the old value of *uaddr2, up to count2 waiters on uaddr2.
+ * Returns the total woken, -EFAULT, -EINVAL or -ENOSYS for a bad op.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_wake_op(uintptr_t uaddr, uintptr_t uaddr2,
+                                        uint32_t count, uint32_t count2,
+                                        uint32_t encoded_op);
+
+/**
+ * Wake up to nr_wake waiters on uaddr and move up to nr_requeue of the
+ * rest onto uaddr2 without waking them. With check set, fails with
+ * -EAGAIN unless *uaddr == cmp_val. Returns woken plus requeued.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_requeue(uintptr_t uaddr, uintptr_t uaddr2,
+                                        uint32_t nr_wake, uint32_t nr_requeue,
+                                        bool check, uint32_t cmp_val);
+
+/**
+ * Acquire the priority-inheritance futex at uaddr for the caller. A free
+ * word (tid 0) is taken by storing the caller's tid; otherwise FUTEX_WAITERS
+ * is set and the caller blocks, boosting the owner until the lock is
+ * handed over by futex_unlock_pi(). With try_only set, never blocks.
+ * deadline_ns is an absolute clock::now_ns() time, 0 for none.
+ * Returns 0 once owned, -EAGAIN (try_only), -EDEADLK if the caller owns
+ * it, -ESRCH for a dead owner, -ETIMEDOUT, -EINTR, -EFAULT or -EINVAL.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_lock_pi(uintptr_t uaddr, uint64_t deadline_ns,
+                                        bool try_only);
+
+/**
+ * Release a PI futex the caller owns. The lock goes directly to the first
+ * blocked waiter, which inherits the boosts of the remaining ones.
+ * Returns 0, -EPERM if the caller is not the owner, -EFAULT or -EINVAL.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t futex_unlock_pi(uintptr_t uaddr);
+
 } // namespace sync
 
 #endif // STELLUX_SYNC_FUTEX_H
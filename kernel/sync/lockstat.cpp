@@ -0,0 +1,324 @@
+#include "sync/lockstat.h"
+
+#ifdef STLX_LOCKSTAT
+
+#include "sync/spinlock.h"
+#include "dynpriv/dynpriv.h"
+
+namespace sync {
+
+namespace lockstat {
+
+static_assert((MAX_CLASSES & (MAX_CLASSES - 1)) == 0, "MAX_CLASSES must be a power of two");
+
+// Table slots are claimed with a compare-and-swap on state and filled
+// before READY is published, so lookups never take a lock (they run
+// inside spin_lock itself)
+constexpr uint32_t SLOT_FREE     = 0;
+constexpr uint32_t SLOT_CLAIMING = 1;
+constexpr uint32_t SLOT_READY    = 2;
+
+struct site {
+    uint32_t    state;
+    uint32_t    line;
+    const char* file;
+    uint64_t    acquisitions;
+    uint64_t    inherited;
+    uint64_t    contended;
+    uint64_t    wait_cycles;
+};
+
+struct lock_class {
+    uint32_t    state;
+    uint32_t    line;
+    const char* file;
+    uint8_t     kind;
+    bool        by_site;
+    uint64_t    acquisitions;
+    uint64_t    contended;
+    uint64_t    wait_cycles;
+    uint64_t    hold_cycles;
+    uint64_t    max_wait_cycles;
+    uint64_t    max_hold_cycles;
+    uint64_t    other_sites;
+    site        sites[SITES_PER_CLASS];
+};
+
+__PRIVILEGED_BSS static lock_class g_classes[MAX_CLASSES];
+
+// Set once a probe has found every class slot taken by other classes;
+// slots are never freed, so later lookups can give up at once
+__PRIVILEGED_BSS static bool g_classes_full;
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint32_t wait_ready(uint32_t* state) {
+    uint32_t s;
+    while ((s = __atomic_load_n(state, __ATOMIC_ACQUIRE)) == SLOT_CLAIMING) {
+        cpu::relax();
+    }
+    return s;
+}
+
+/**
+ * Move a slot from `from` (FREE, or READY to replace a site) to CLAIMING
+ * with IRQs disabled, so an interrupt on this CPU cannot take a lock
+ * whose probe waits on the slot we hold. On success the caller fills the
+ * slot, publishes READY and restores *flags.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool try_claim(uint32_t* state, uint64_t* flags,
+                                        uint32_t from = SLOT_FREE) {
+    *flags = cpu::irq_save();
+    uint32_t expected = from;
+    if (__atomic_compare_exchange_n(state, &expected, SLOT_CLAIMING, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return true;
+    }
+    cpu::irq_restore(*flags);
+    return false;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void update_max(uint64_t* max, uint64_t value) {
+    uint64_t cur = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while (value > cur &&
+           !__atomic_compare_exchange_n(max, &cur, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * Site record of file:line in cls, claiming a free one on first use.
+ * @return nullptr if all SITES_PER_CLASS are taken by other sites.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static site* site_of(lock_class* cls, const char* file, uint32_t line) {
+    for (uint32_t i = 0; i < SITES_PER_CLASS; i++) {
+        site* s = &cls->sites[i];
+        uint32_t state = wait_ready(&s->state);
+        if (state == SLOT_FREE) {
+            uint64_t flags;
+            if (try_claim(&s->state, &flags)) {
+                s->file = file;
+                s->line = line;
+                __atomic_store_n(&s->state, SLOT_READY, __ATOMIC_RELEASE);
+                cpu::irq_restore(flags);
+                return s;
+            }
+            wait_ready(&s->state);
+        }
+        if (s->file == file && s->line == line) {
+            return s;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Give file:line the least-used site of a full class. It inherits the
+ * count it replaces, so listed counts never drop and a site hit more
+ * often than the least-used listed one cannot stay out. The replaced
+ * site's own acquisitions move to other_sites. Increments racing with
+ * the replacement may land on either site.
+ * @return nullptr if another CPU is replacing the same site.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static site* replace_least_used(lock_class* cls, const char* file,
+                                                  uint32_t line) {
+    site* victim = &cls->sites[0];
+    for (uint32_t i = 1; i < SITES_PER_CLASS; i++) {
+        if (__atomic_load_n(&cls->sites[i].acquisitions, __ATOMIC_RELAXED) <
+            __atomic_load_n(&victim->acquisitions, __ATOMIC_RELAXED)) {
+            victim = &cls->sites[i];
+        }
+    }
+
+    uint64_t flags;
+    if (!try_claim(&victim->state, &flags, SLOT_READY)) {
+        return nullptr;
+    }
+    uint64_t count = __atomic_load_n(&victim->acquisitions, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&cls->other_sites, count - victim->inherited, __ATOMIC_RELAXED);
+    victim->file = file;
+    victim->line = line;
+    victim->inherited = count;
+    __atomic_store_n(&victim->contended, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&victim->wait_cycles, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&victim->state, SLOT_READY, __ATOMIC_RELEASE);
+    cpu::irq_restore(flags);
+    return victim;
+}
+
+__PRIVILEGED_CODE lock_class* lookup(const char* file, uint32_t line,
+                                     uint8_t kind, bool by_site) {
+    uint64_t hash = (reinterpret_cast<uintptr_t>(file) ^ (static_cast<uint64_t>(line) << 20) ^
+                     (static_cast<uint64_t>(kind) << 40)) * 0x9E3779B97F4A7C15ull;
+    uint32_t start = static_cast<uint32_t>(hash >> 32);
+
+    if (__atomic_load_n(&g_classes_full, __ATOMIC_RELAXED)) {
+        return nullptr;
+    }
+
+    for (uint32_t probe = 0; probe < MAX_CLASSES; probe++) {
+        lock_class* cls = &g_classes[(start + probe) & (MAX_CLASSES - 1)];
+        uint32_t state = wait_ready(&cls->state);
+        if (state == SLOT_FREE) {
+            uint64_t flags;
+            if (try_claim(&cls->state, &flags)) {
+                cls->file = file;
+                cls->line = line;
+                cls->kind = kind;
+                cls->by_site = by_site;
+                __atomic_store_n(&cls->state, SLOT_READY, __ATOMIC_RELEASE);
+                cpu::irq_restore(flags);
+                return cls;
+            }
+            wait_ready(&cls->state);
+        }
+        if (cls->file == file && cls->line == line &&
+            cls->kind == kind && cls->by_site == by_site) {
+            return cls;
+        }
+    }
+    __atomic_store_n(&g_classes_full, true, __ATOMIC_RELAXED);
+    return nullptr;
+}
+
+__PRIVILEGED_CODE void record_acquire(lock_class* cls, const char* site_file,
+                                      uint32_t site_line, bool contended,
+                                      uint64_t wait_cycles) {
+    if (!cls) {
+        return;
+    }
+    __atomic_fetch_add(&cls->acquisitions, 1, __ATOMIC_RELAXED);
+    if (contended) {
+        __atomic_fetch_add(&cls->contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&cls->wait_cycles, wait_cycles, __ATOMIC_RELAXED);
+        update_max(&cls->max_wait_cycles, wait_cycles);
+    }
+
+    site* s = site_of(cls, site_file, site_line);
+    if (!s) {
+        s = replace_least_used(cls, site_file, site_line);
+    }
+    if (!s) {
+        __atomic_fetch_add(&cls->other_sites, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&s->acquisitions, 1, __ATOMIC_RELAXED);
+    if (contended) {
+        __atomic_fetch_add(&s->contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s->wait_cycles, wait_cycles, __ATOMIC_RELAXED);
+    }
+}
+
+__PRIVILEGED_CODE void record_release(lock_class* cls, uint64_t hold_cycles) {
+    if (!cls) {
+        return;
+    }
+    __atomic_fetch_add(&cls->hold_cycles, hold_cycles, __ATOMIC_RELAXED);
+    update_max(&cls->max_hold_cycles, hold_cycles);
+}
+
+__PRIVILEGED_CODE size_t read_classes(class_stats* out, size_t max) {
+    size_t count = 0;
+    for (uint32_t i = 0; i < MAX_CLASSES && count < max; i++) {
+        lock_class* cls = &g_classes[i];
+        if (__atomic_load_n(&cls->state, __ATOMIC_ACQUIRE) != SLOT_READY ||
+            __atomic_load_n(&cls->acquisitions, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+        class_stats& o = out[count++];
+        o.file = cls->file;
+        o.line = cls->line;
+        o.kind = cls->kind;
+        o.by_site = cls->by_site;
+        o.acquisitions = __atomic_load_n(&cls->acquisitions, __ATOMIC_RELAXED);
+        o.contended = __atomic_load_n(&cls->contended, __ATOMIC_RELAXED);
+        o.wait_cycles = __atomic_load_n(&cls->wait_cycles, __ATOMIC_RELAXED);
+        o.hold_cycles = __atomic_load_n(&cls->hold_cycles, __ATOMIC_RELAXED);
+        o.max_wait_cycles = __atomic_load_n(&cls->max_wait_cycles, __ATOMIC_RELAXED);
+        o.max_hold_cycles = __atomic_load_n(&cls->max_hold_cycles, __ATOMIC_RELAXED);
+        o.other_sites = __atomic_load_n(&cls->other_sites, __ATOMIC_RELAXED);
+        o.site_count = 0;
+        for (uint32_t j = 0; j < SITES_PER_CLASS; j++) {
+            site* s = &cls->sites[j];
+            if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != SLOT_READY ||
+                __atomic_load_n(&s->acquisitions, __ATOMIC_RELAXED) == 0) {
+                continue;
+            }
+            site_stats& so = o.sites[o.site_count++];
+            so.file = s->file;
+            so.line = s->line;
+            so.acquisitions = __atomic_load_n(&s->acquisitions, __ATOMIC_RELAXED);
+            so.inherited = s->inherited;
+            so.contended = __atomic_load_n(&s->contended, __ATOMIC_RELAXED);
+            so.wait_cycles = __atomic_load_n(&s->wait_cycles, __ATOMIC_RELAXED);
+        }
+    }
+    return count;
+}
+
+__PRIVILEGED_CODE void reset() {
+    for (uint32_t i = 0; i < MAX_CLASSES; i++) {
+        lock_class* cls = &g_classes[i];
+        uint64_t* counters[] = {
+            &cls->acquisitions, &cls->contended, &cls->wait_cycles, &cls->hold_cycles,
+            &cls->max_wait_cycles, &cls->max_hold_cycles, &cls->other_sites,
+        };
+        for (uint64_t* c : counters) {
+            __atomic_store_n(c, 0, __ATOMIC_RELAXED);
+        }
+        for (uint32_t j = 0; j < SITES_PER_CLASS; j++) {
+            site* s = &cls->sites[j];
+            __atomic_store_n(&s->acquisitions, 0, __ATOMIC_RELAXED);
+            s->inherited = 0;
+            __atomic_store_n(&s->contended, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&s->wait_cycles, 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+} // namespace lockstat
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_lock(spinlock& lock, const char* site_file, uint32_t site_line) {
+    bool contended = false;
+    uint64_t wait = 0;
+    uint32_t expected = 0;
+    if (!__atomic_compare_exchange_n(&lock.val, &expected, SPINLOCK_LOCKED, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        uint64_t start = dynpriv::read_cycles();
+        spin_lock_slowpath(lock);
+        wait = dynpriv::read_cycles() - start;
+        contended = true;
+    }
+
+    // Resolved by the first holder, later holders reuse it
+    if (!lock.cls) {
+        lock.cls = lock.class_file
+            ? lockstat::lookup(lock.class_file, lock.class_line, lockstat::KIND_SPIN, false)
+            : lockstat::lookup(site_file, site_line, lockstat::KIND_SPIN, true);
+    }
+    lockstat::record_acquire(lock.cls, site_file, site_line, contended, wait);
+    lock.acquired_at = dynpriv::read_cycles();
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_unlock(spinlock& lock) {
+    lockstat::record_release(lock.cls, dynpriv::read_cycles() - lock.acquired_at);
+    __atomic_fetch_and(&lock.val, ~SPINLOCK_LOCKED, __ATOMIC_RELEASE);
+    cpu::send_event();
+}
+
+} // namespace sync
+
+#endif // STLX_LOCKSTAT
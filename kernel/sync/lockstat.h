@@ -0,0 +1,110 @@
+#ifndef STELLUX_SYNC_LOCKSTAT_H
+#define STELLUX_SYNC_LOCKSTAT_H
+
+#include "common/types.h"
+
+#ifdef STLX_LOCKSTAT
+
+namespace sync::lockstat {
+
+/*
+ * Lock contention statistics, built with LOCKSTAT=1.
+ *
+ * Locks are grouped into classes by the place that initialized them:
+ * every SPINLOCK_INIT expansion and every mutex::init() or rwsem::init()
+ * call is a class of its own, so all mm_context locks (one rwsem::init()
+ * in mm.cpp) count together while a lock declared once counts alone. A
+ * lock that was only zeroed is classed by the place that first acquired
+ * it. Within a class the acquiring call sites (the spin_lock,
+ * spin_lock_irqsave, irq_lock_guard, mutex_lock, mutex_trylock,
+ * down_read or down_write call) are counted separately. A class lists
+ * SITES_PER_CLASS sites; when a new site finds them all taken it
+ * replaces the least-used one and inherits its count (space-saving), so
+ * a hot site stays listed however late it first runs. A listed site's
+ * own acquisitions are its count minus `inherited`, and `other_sites`
+ * holds those of the sites it replaced.
+ *
+ * An acquisition is contended when its first attempt finds the lock
+ * held; its wait runs from that attempt until the lock is taken. Hold
+ * time runs from the acquisition to the release; for an rwsem, shared
+ * holds are timed as one period from the first reader in to the last
+ * one out. The rwsem trylocks are not counted. Times are in
+ * read_cycles() units.
+ */
+
+constexpr uint32_t MAX_CLASSES     = 256; // power of two
+constexpr uint32_t SITES_PER_CLASS = 8;
+
+constexpr uint8_t KIND_SPIN  = 0;
+constexpr uint8_t KIND_MUTEX = 1;
+constexpr uint8_t KIND_RWSEM = 2;
+
+struct site_stats {
+    const char* file;
+    uint32_t    line;
+    uint64_t    acquisitions; // including inherited
+    uint64_t    inherited;    // taken over from the sites this one replaced
+    uint64_t    contended;
+    uint64_t    wait_cycles;
+};
+
+struct class_stats {
+    const char* file;     // init site, or first acquiring site if by_site
+    uint32_t    line;
+    uint8_t     kind;
+    bool        by_site;
+    uint64_t    acquisitions;
+    uint64_t    contended;
+    uint64_t    wait_cycles;
+    uint64_t    hold_cycles;
+    uint64_t    max_wait_cycles;
+    uint64_t    max_hold_cycles;
+    uint64_t    other_sites; // own acquisitions of replaced sites
+    uint32_t    site_count;
+    site_stats  sites[SITES_PER_CLASS];
+};
+
+struct lock_class;
+
+/**
+ * @brief Find or create the class of a lock.
+ * @param file,line Init site of the lock, or its first acquiring site
+ *   when by_site is set.
+ * @return nullptr once MAX_CLASSES classes exist; such locks are not counted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE lock_class* lookup(const char* file, uint32_t line,
+                                     uint8_t kind, bool by_site);
+
+/**
+ * @brief Count one acquisition made at site_file:site_line.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record_acquire(lock_class* cls, const char* site_file,
+                                      uint32_t site_line, bool contended,
+                                      uint64_t wait_cycles);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void record_release(lock_class* cls, uint64_t hold_cycles);
+
+/**
+ * @brief Copy the counters of up to max classes that were acquired
+ * since the last reset(). Counters are sampled individually.
+ * @return Number of classes copied.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE size_t read_classes(class_stats* out, size_t max);
+
+/**
+ * @brief Zero every counter. Classes and sites stay registered.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void reset();
+
+} // namespace sync::lockstat
+
+#endif // STLX_LOCKSTAT
+
+#endif // STELLUX_SYNC_LOCKSTAT_H
@@ -1,7 +1,11 @@
 #include "sync/mutex.h"
 #include "sched/sched.h"
 #include "sched/task_exec_core.h"
+#include "percpu/percpu.h"
+#include "clock/clock.h"
+#include "hw/cpu.h"
 #include "common/logging.h"
+#include "dynpriv/dynpriv.h"
 
 #ifdef DEBUG
 #define MUTEX_ASSERT(cond, msg) \
@@ -12,26 +16,134 @@
 
 namespace sync {
 
+// Upper bound on one optimistic spin, past it the contender sleeps even
+// if the owner is still running
+constexpr uint64_t MUTEX_SPIN_MAX_NS = 20000;
+constexpr uint32_t MUTEX_SPIN_CLOCK_MASK = 63;
+
 /**
+ * Claim an unowned mutex.
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void mutex_lock(mutex& m) {
+__PRIVILEGED_CODE static bool try_claim(mutex& m, sched::task* self) {
+    sched::task* expected = nullptr;
+    if (!__atomic_compare_exchange_n(&m.owner, &expected, self, false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    __atomic_store_n(&m.owner_cpu, percpu::current_cpu_id(), __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * Optimistic spinning: poll the mutex while its owner is running on a
+ * CPU, since a running owner usually releases soon and a context switch
+ * costs more than the wait. A stale owner_cpu only ends the spin early.
+ * @return true if the mutex was claimed, false to fall back to sleeping.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool spin_on_owner(mutex& m, sched::task* self) {
+    uint64_t deadline = 0;
+    for (uint32_t spins = 0;; spins++) {
+        if ((spins & MUTEX_SPIN_CLOCK_MASK) == 0) {
+            uint64_t now = clock::now_ns();
+            if (deadline == 0) {
+                deadline = now + MUTEX_SPIN_MAX_NS;
+            } else if (now > deadline) {
+                return false;
+            }
+        }
+
+        sched::task* owner = __atomic_load_n(&m.owner, __ATOMIC_RELAXED);
+        if (!owner) {
+            if (try_claim(m, self)) {
+                return true;
+            }
+            continue;
+        }
+
+        uint32_t owner_cpu = __atomic_load_n(&m.owner_cpu, __ATOMIC_RELAXED);
+        if (!sched::task_running_on(owner, owner_cpu)) {
+            return false;
+        }
+        cpu::relax();
+    }
+}
+
+/**
+ * Acquire m for the current task.
+ * @return true if the first attempt found it held.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool acquire(mutex& m) {
     sched::task* self = sched::current();
 
-    irq_state irq = spin_lock_irqsave(m.lock);
+    MUTEX_ASSERT(__atomic_load_n(&m.owner, __ATOMIC_RELAXED) != self,
+                 "recursive lock detected");
 
-    MUTEX_ASSERT(m.owner != self, "recursive lock detected");
+    __atomic_fetch_add(&m.stats.acquisitions, 1, __ATOMIC_RELAXED);
+    if (try_claim(m, self)) {
+        return false;
+    }
+
+    __atomic_fetch_add(&m.stats.contended, 1, __ATOMIC_RELAXED);
+    if (spin_on_owner(m, self)) {
+        __atomic_fetch_add(&m.stats.spin_acquired, 1, __ATOMIC_RELAXED);
+        return true;
+    }
 
-    while (m.owner != nullptr) {
+    // The release takes m.lock, so a failed claim here and the enqueue
+    // inside wait() cannot straddle an unlock and miss its wakeup
+    irq_state irq = spin_lock_irqsave(m.lock);
+    while (!try_claim(m, self)) {
         MUTEX_ASSERT(!(self->exec.flags & sched::TASK_FLAG_IDLE),
                      "idle task blocked on contended mutex");
-        irq = wait(m.wq, m.lock, irq);
+        __atomic_fetch_add(&m.stats.sleeps, 1, __ATOMIC_RELAXED);
+        irq = wait_exclusive(m.wq, m.lock, irq);
     }
-
-    m.owner = self;
     spin_unlock_irqrestore(m.lock, irq);
+    return true;
 }
 
+#ifdef STLX_LOCKSTAT
+
+/**
+ * Count an acquisition by the new owner of m.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void lockstat_acquired(mutex& m, const char* site_file,
+                                                uint32_t site_line, bool contended,
+                                                uint64_t wait_cycles) {
+    if (!m.cls) {
+        m.cls = m.class_file
+            ? lockstat::lookup(m.class_file, m.class_line, lockstat::KIND_MUTEX, false)
+            : lockstat::lookup(site_file, site_line, lockstat::KIND_MUTEX, true);
+    }
+    lockstat::record_acquire(m.cls, site_file, site_line, contended, wait_cycles);
+    m.acquired_at = dynpriv::read_cycles();
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void mutex_lock(mutex& m, const char* site_file, uint32_t site_line) {
+    uint64_t start = dynpriv::read_cycles();
+    bool contended = acquire(m);
+    uint64_t wait = contended ? dynpriv::read_cycles() - start : 0;
+    lockstat_acquired(m, site_file, site_line, contended, wait);
+}
+
+#else
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void mutex_lock(mutex& m) {
+    acquire(m);
+}
+
+#endif // STLX_LOCKSTAT
+
 /**
  * @note Privilege: **required**
  */
@@ -41,7 +153,11 @@ __PRIVILEGED_CODE void mutex_unlock(mutex& m) {
     MUTEX_ASSERT(m.owner == sched::current(),
                  "unlock called by non-owner");
 
-    m.owner = nullptr;
+#ifdef STLX_LOCKSTAT
+    lockstat::record_release(m.cls, dynpriv::read_cycles() - m.acquired_at);
+#endif
+
+    __atomic_store_n(&m.owner, static_cast<sched::task*>(nullptr), __ATOMIC_RELEASE);
     spin_unlock_irqrestore(m.lock, irq);
 
     wake_one(m.wq);
@@ -50,18 +166,19 @@ __PRIVILEGED_CODE void mutex_unlock(mutex& m) {
 /**
  * @note Privilege: **required**
  */
+#ifdef STLX_LOCKSTAT
+__PRIVILEGED_CODE bool mutex_trylock(mutex& m, const char* site_file, uint32_t site_line) {
+#else
 __PRIVILEGED_CODE bool mutex_trylock(mutex& m) {
-    irq_state irq = spin_lock_irqsave(m.lock);
-
-    if (m.owner != nullptr) {
-        spin_unlock_irqrestore(m.lock, irq);
+#endif
+    if (!try_claim(m, sched::current())) {
         return false;
     }
-
-    m.owner = sched::current();
-    spin_unlock_irqrestore(m.lock, irq);
+    __atomic_fetch_add(&m.stats.acquisitions, 1, __ATOMIC_RELAXED);
+#ifdef STLX_LOCKSTAT
+    lockstat_acquired(m, site_file, site_line, false, 0);
+#endif
     return true;
 }
 
 } // namespace sync
-
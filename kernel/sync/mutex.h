@@ -3,27 +3,79 @@
 
 #include "sync/spinlock.h"
 #include "sync/wait_queue.h"
+#include "sync/lockstat.h"
 
 namespace sync {
 
+/**
+ * Per-lock contention counters, updated with relaxed atomics. An
+ * acquisition is contended when the first try finds the mutex held;
+ * it then ends either by spinning or by sleeping at least once.
+ */
+struct mutex_stats {
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t spin_acquired; // contended, won while spinning on a running owner
+    uint64_t sleeps;        // times a contender blocked on the wait queue
+};
+
+/**
+ * Sleeping mutex with adaptive spinning. The owner is claimed with a
+ * compare-and-swap; `lock` only orders the release against waiters
+ * queueing on `wq`. A contender spins while the owner is running on
+ * another CPU and sleeps once it is not.
+ */
 struct mutex {
     spinlock lock;
     sched::task* owner;
+    uint32_t owner_cpu; // CPU the owner acquired on, valid while owner is set
     wait_queue wq;
+    mutex_stats stats;
+#ifdef STLX_LOCKSTAT
+    // Lock class and hold start, see sync/lockstat.h
+    const char*           class_file; // init() caller
+    uint32_t              class_line;
+    lockstat::lock_class* cls;        // resolved on the first acquisition
+    uint64_t              acquired_at;
+#endif
 
+#ifdef STLX_LOCKSTAT
+    // The default arguments name the caller, which is the lock class
+    void init(const char* file = __builtin_FILE(), uint32_t line = __builtin_LINE()) {
+        reset();
+        class_file = file;
+        class_line = line;
+        cls = nullptr;
+        acquired_at = 0;
+    }
+#else
     void init() {
+        reset();
+    }
+#endif
+
+private:
+    void reset() {
         lock = SPINLOCK_INIT;
         owner = nullptr;
+        owner_cpu = 0;
         wq.init();
+        stats = {};
     }
 };
 
 /**
- * Acquire the mutex. Blocks if held by another task.
- * Must not be called from IRQ context or by the idle task.
+ * Acquire the mutex. Spins briefly while the owner runs on another CPU,
+ * then blocks. Must not be called from IRQ context or by the idle task.
  * @note Privilege: **required**
  */
+#ifdef STLX_LOCKSTAT
+__PRIVILEGED_CODE void mutex_lock(mutex& m,
+                                  const char* site_file = __builtin_FILE(),
+                                  uint32_t site_line = __builtin_LINE());
+#else
 __PRIVILEGED_CODE void mutex_lock(mutex& m);
+#endif
 
 /**
  * Release the mutex. Wakes one waiting task if any.
@@ -37,7 +89,13 @@ __PRIVILEGED_CODE void mutex_unlock(mutex& m);
  * @return true if the lock was acquired, false if already held.
  * @note Privilege: **required**
  */
+#ifdef STLX_LOCKSTAT
+[[nodiscard]] __PRIVILEGED_CODE bool mutex_trylock(mutex& m,
+                                                  const char* site_file = __builtin_FILE(),
+                                                  uint32_t site_line = __builtin_LINE());
+#else
 [[nodiscard]] __PRIVILEGED_CODE bool mutex_trylock(mutex& m);
+#endif
 
 /**
  * Check if the mutex is currently held. Advisory only; the result
@@ -47,6 +105,19 @@ inline bool mutex_is_locked(const mutex& m) {
     return __atomic_load_n(&m.owner, __ATOMIC_RELAXED) != nullptr;
 }
 
+/**
+ * Snapshot of a mutex's contention counters. Counters are sampled
+ * individually and may be mutually inconsistent under contention.
+ */
+inline mutex_stats mutex_read_stats(const mutex& m) {
+    mutex_stats out;
+    out.acquisitions  = __atomic_load_n(&m.stats.acquisitions, __ATOMIC_RELAXED);
+    out.contended     = __atomic_load_n(&m.stats.contended, __ATOMIC_RELAXED);
+    out.spin_acquired = __atomic_load_n(&m.stats.spin_acquired, __ATOMIC_RELAXED);
+    out.sleeps        = __atomic_load_n(&m.stats.sleeps, __ATOMIC_RELAXED);
+    return out;
+}
+
 } // namespace sync
 
 #endif // STELLUX_SYNC_MUTEX_H
@@ -0,0 +1,209 @@
+#include "sync/rwsem.h"
+#include "sched/sched.h"
+#include "sched/task_exec_core.h"
+#include "common/logging.h"
+#include "dynpriv/dynpriv.h"
+
+#ifdef DEBUG
+#define RWSEM_ASSERT(cond, msg) \
+    do { if (!(cond)) log::fatal("rwsem: " msg); } while(0)
+#else
+#define RWSEM_ASSERT(cond, msg) ((void)0)
+#endif
+
+namespace sync {
+
+/**
+ * Take rw shared, blocking behind writers.
+ * @return true if the first try failed.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool acquire_read(rwsem& rw) {
+    if (down_read_trylock(rw)) {
+        return false;
+    }
+
+    // Writers publish RWSEM_WRITER_WAITING and release under rw.lock, so
+    // a failed check here cannot miss the wake_all of the last writer
+    irq_state irq = spin_lock_irqsave(rw.lock);
+    while (!down_read_trylock(rw)) {
+        RWSEM_ASSERT(!(sched::current()->exec.flags & sched::TASK_FLAG_IDLE),
+                     "idle task blocked on contended rwsem");
+        irq = wait(rw.readers_wq, rw.lock, irq);
+    }
+    spin_unlock_irqrestore(rw.lock, irq);
+    return true;
+}
+
+#ifdef STLX_LOCKSTAT
+
+/**
+ * Count an acquisition of rw made at site_file:site_line.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void lockstat_acquired(rwsem& rw, const char* site_file,
+                                                uint32_t site_line, bool contended,
+                                                uint64_t wait_cycles) {
+    // Readers resolve concurrently, and all of them find the same class
+    lockstat::lock_class* cls = __atomic_load_n(&rw.cls, __ATOMIC_RELAXED);
+    if (!cls) {
+        cls = rw.class_file
+            ? lockstat::lookup(rw.class_file, rw.class_line, lockstat::KIND_RWSEM, false)
+            : lockstat::lookup(site_file, site_line, lockstat::KIND_RWSEM, true);
+        __atomic_store_n(&rw.cls, cls, __ATOMIC_RELAXED);
+    }
+    lockstat::record_acquire(cls, site_file, site_line, contended, wait_cycles);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void down_read(rwsem& rw, const char* site_file, uint32_t site_line) {
+    uint64_t start = dynpriv::read_cycles();
+    bool contended = acquire_read(rw);
+    uint64_t now = dynpriv::read_cycles();
+    lockstat_acquired(rw, site_file, site_line, contended, contended ? now - start : 0);
+
+    // Shared holds are timed as one period, from the first reader that
+    // finds it unstamped to the last reader out
+    uint64_t unstamped = 0;
+    __atomic_compare_exchange_n(&rw.read_since, &unstamped, now, false,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+#else
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void down_read(rwsem& rw) {
+    acquire_read(rw);
+}
+
+#endif // STLX_LOCKSTAT
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void up_read(rwsem& rw) {
+#ifdef STLX_LOCKSTAT
+    // Read before the release, a new period may stamp right after it
+    uint64_t since = __atomic_load_n(&rw.read_since, __ATOMIC_RELAXED);
+#endif
+    uint32_t prev = __atomic_fetch_sub(&rw.state, RWSEM_READER_BIAS, __ATOMIC_RELEASE);
+    RWSEM_ASSERT(prev & RWSEM_READER_MASK, "up_read without a reader");
+
+#ifdef STLX_LOCKSTAT
+    // The last reader out closes the period, unless a new one took over
+    if ((prev & RWSEM_READER_MASK) == RWSEM_READER_BIAS && since &&
+        __atomic_compare_exchange_n(&rw.read_since, &since, 0, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        lockstat::record_release(__atomic_load_n(&rw.cls, __ATOMIC_RELAXED),
+                                 dynpriv::read_cycles() - since);
+    }
+#endif
+
+    // A queued writer set the waiting bit under rw.lock before sleeping;
+    // taking the lock here waits until it is actually on the queue
+    if ((prev & RWSEM_READER_MASK) == RWSEM_READER_BIAS &&
+        (prev & RWSEM_WRITER_WAITING)) {
+        irq_state irq = spin_lock_irqsave(rw.lock);
+        spin_unlock_irqrestore(rw.lock, irq);
+        wake_one(rw.writers_wq);
+    }
+}
+
+/**
+ * Claim a free rwsem for a writer that queued in the slow path, keeping
+ * the waiting bit for the writers still behind it.
+ * Caller must hold rw.lock.
+ */
+static bool claim_queued_write(rwsem& rw) {
+    uint32_t s = __atomic_load_n(&rw.state, __ATOMIC_RELAXED);
+    while (!(s & (RWSEM_WRITER | RWSEM_READER_MASK))) {
+        uint32_t desired = RWSEM_WRITER;
+        if (rw.writers_waiting > 1) {
+            desired |= RWSEM_WRITER_WAITING;
+        }
+        if (__atomic_compare_exchange_n(&rw.state, &s, desired, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            rw.writers_waiting--;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Take rw exclusive, queueing behind other writers.
+ * @return true if the first try failed.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool acquire_write(rwsem& rw) {
+    if (down_write_trylock(rw)) {
+        return false;
+    }
+
+    irq_state irq = spin_lock_irqsave(rw.lock);
+    rw.writers_waiting++;
+    __atomic_fetch_or(&rw.state, RWSEM_WRITER_WAITING, __ATOMIC_RELAXED);
+    while (!claim_queued_write(rw)) {
+        RWSEM_ASSERT(!(sched::current()->exec.flags & sched::TASK_FLAG_IDLE),
+                     "idle task blocked on contended rwsem");
+        irq = wait_exclusive(rw.writers_wq, rw.lock, irq);
+    }
+    spin_unlock_irqrestore(rw.lock, irq);
+    return true;
+}
+
+#ifdef STLX_LOCKSTAT
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void down_write(rwsem& rw, const char* site_file, uint32_t site_line) {
+    uint64_t start = dynpriv::read_cycles();
+    bool contended = acquire_write(rw);
+    uint64_t wait = contended ? dynpriv::read_cycles() - start : 0;
+    lockstat_acquired(rw, site_file, site_line, contended, wait);
+    rw.write_since = dynpriv::read_cycles();
+}
+
+#else
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void down_write(rwsem& rw) {
+    acquire_write(rw);
+}
+
+#endif // STLX_LOCKSTAT
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void up_write(rwsem& rw) {
+    irq_state irq = spin_lock_irqsave(rw.lock);
+    RWSEM_ASSERT(rw.state & RWSEM_WRITER, "up_write without a writer");
+
+#ifdef STLX_LOCKSTAT
+    // 0 after down_write_trylock, which is not counted
+    if (rw.write_since) {
+        lockstat::record_release(rw.cls, dynpriv::read_cycles() - rw.write_since);
+        rw.write_since = 0;
+    }
+#endif
+
+    __atomic_fetch_and(&rw.state, ~RWSEM_WRITER, __ATOMIC_RELEASE);
+    bool writer_next = rw.writers_waiting != 0;
+    spin_unlock_irqrestore(rw.lock, irq);
+
+    if (writer_next) {
+        wake_one(rw.writers_wq);
+    } else {
+        wake_all(rw.readers_wq);
+    }
+}
+
+} // namespace sync
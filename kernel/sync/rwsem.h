@@ -0,0 +1,145 @@
+#ifndef STELLUX_SYNC_RWSEM_H
+#define STELLUX_SYNC_RWSEM_H
+
+#include "sync/spinlock.h"
+#include "sync/wait_queue.h"
+#include "sync/lockstat.h"
+
+namespace sync {
+
+// rwsem state word layout
+constexpr uint32_t RWSEM_WRITER         = (1u << 0); // held exclusive
+constexpr uint32_t RWSEM_WRITER_WAITING = (1u << 1); // writers queued, new readers block
+constexpr uint32_t RWSEM_READER_BIAS    = (1u << 2); // one shared holder
+constexpr uint32_t RWSEM_READER_MASK    = ~(RWSEM_READER_BIAS - 1);
+
+/**
+ * Sleeping reader/writer semaphore. Shared holders are counted in
+ * `state` and take and drop the lock with one atomic when no writer is
+ * involved. Writers are preferred: once a writer queues, new readers
+ * block until it has run, so a steady stream of readers cannot starve
+ * it. `lock` orders state changes against tasks queueing on the two
+ * wait queues, the same way mutex::lock does.
+ */
+struct rwsem {
+    spinlock lock;
+    uint32_t state;
+    uint32_t writers_waiting; // protected by lock
+    wait_queue readers_wq;
+    wait_queue writers_wq;
+#ifdef STLX_LOCKSTAT
+    // Lock class and hold starts, see sync/lockstat.h
+    const char*           class_file;     // init() caller
+    uint32_t              class_line;
+    lockstat::lock_class* cls;            // resolved on the first acquisition
+    uint64_t              write_since;    // exclusive hold start
+    uint64_t              read_since;     // shared period start, 0 when unstamped
+#endif
+
+#ifdef STLX_LOCKSTAT
+    // The default arguments name the caller, which is the lock class
+    void init(const char* file = __builtin_FILE(), uint32_t line = __builtin_LINE()) {
+        reset();
+        class_file = file;
+        class_line = line;
+        cls = nullptr;
+        write_since = 0;
+        read_since = 0;
+    }
+#else
+    void init() {
+        reset();
+    }
+#endif
+
+private:
+    void reset() {
+        lock = SPINLOCK_INIT;
+        state = 0;
+        writers_waiting = 0;
+        readers_wq.init();
+        writers_wq.init();
+    }
+};
+
+/**
+ * Acquire shared. Blocks while a writer holds or waits for the lock.
+ * Must not be called from IRQ context or by the idle task.
+ * @note Privilege: **required**
+ */
+#ifdef STLX_LOCKSTAT
+__PRIVILEGED_CODE void down_read(rwsem& rw,
+                                 const char* site_file = __builtin_FILE(),
+                                 uint32_t site_line = __builtin_LINE());
+#else
+__PRIVILEGED_CODE void down_read(rwsem& rw);
+#endif
+
+/**
+ * Release a shared hold. The last reader out wakes a queued writer.
+ * Safe from IRQ context.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void up_read(rwsem& rw);
+
+/**
+ * Acquire exclusive. Blocks until all holders have released.
+ * Must not be called from IRQ context or by the idle task.
+ * @note Privilege: **required**
+ */
+#ifdef STLX_LOCKSTAT
+__PRIVILEGED_CODE void down_write(rwsem& rw,
+                                  const char* site_file = __builtin_FILE(),
+                                  uint32_t site_line = __builtin_LINE());
+#else
+__PRIVILEGED_CODE void down_write(rwsem& rw);
+#endif
+
+/**
+ * Release an exclusive hold. Hands the lock to the next queued writer
+ * if any, otherwise wakes all blocked readers.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void up_write(rwsem& rw);
+
+/**
+ * Try to acquire shared without blocking. Safe from IRQ context. Not
+ * counted by lockstat, see sync/lockstat.h.
+ * @return true if acquired.
+ */
+[[nodiscard]] inline bool down_read_trylock(rwsem& rw) {
+    uint32_t s = __atomic_load_n(&rw.state, __ATOMIC_RELAXED);
+    while (!(s & (RWSEM_WRITER | RWSEM_WRITER_WAITING))) {
+        if (__atomic_compare_exchange_n(&rw.state, &s, s + RWSEM_READER_BIAS, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Try to acquire exclusive without blocking. Not counted by lockstat.
+ * @return true if acquired.
+ */
+[[nodiscard]] inline bool down_write_trylock(rwsem& rw) {
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&rw.state, &expected, RWSEM_WRITER, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * Advisory checks, may be stale without external synchronization.
+ */
+inline bool rwsem_is_write_locked(const rwsem& rw) {
+    return (__atomic_load_n(&rw.state, __ATOMIC_RELAXED) & RWSEM_WRITER) != 0;
+}
+
+inline uint32_t rwsem_reader_count(const rwsem& rw) {
+    return (__atomic_load_n(&rw.state, __ATOMIC_RELAXED) & RWSEM_READER_MASK) /
+           RWSEM_READER_BIAS;
+}
+
+} // namespace sync
+
+#endif // STELLUX_SYNC_RWSEM_H
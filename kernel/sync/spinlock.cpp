@@ -0,0 +1,134 @@
+#include "sync/spinlock.h"
+#include "percpu/percpu.h"
+
+namespace sync {
+
+// Contended acquires can nest on one CPU: task context, an IRQ handler,
+// and an exception taken inside either. One queue node per level.
+constexpr uint32_t QNODE_LEVELS   = 4;
+constexpr uint32_t TAIL_IDX_BITS  = 2;
+constexpr uint32_t TAIL_IDX_MASK  = (1u << TAIL_IDX_BITS) - 1;
+
+static_assert(QNODE_LEVELS <= (1u << TAIL_IDX_BITS), "node index must fit the tail");
+static_assert(MAX_CPUS < (1u << (32 - SPINLOCK_TAIL_SHIFT - TAIL_IDX_BITS)),
+              "CPU number must fit the tail");
+
+struct qnode {
+    qnode*   next;
+    uint32_t locked; // set by the predecessor when the queue head passes on
+};
+
+struct qnode_set {
+    qnode    nodes[QNODE_LEVELS];
+    uint32_t depth; // nodes in use on this CPU
+};
+
+static DEFINE_PER_CPU_CACHELINE_ALIGNED(qnode_set, cpu_qnodes);
+
+/**
+ * A tail is (cpu + 1, node index), so zero means an empty queue.
+ */
+static inline uint32_t encode_tail(uint32_t cpu, uint32_t idx) {
+    return (((cpu + 1) << TAIL_IDX_BITS) | idx) << SPINLOCK_TAIL_SHIFT;
+}
+
+__PRIVILEGED_CODE static inline qnode* decode_tail(uint32_t tail) {
+    tail >>= SPINLOCK_TAIL_SHIFT;
+    uint32_t cpu = (tail >> TAIL_IDX_BITS) - 1;
+    return &per_cpu_on(cpu_qnodes, cpu).nodes[tail & TAIL_IDX_MASK];
+}
+
+static inline bool try_lock_word(spinlock& lock) {
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&lock.val, &expected, SPINLOCK_LOCKED,
+                                       false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_lock_slowpath(spinlock& lock) {
+    qnode_set& set = this_cpu(cpu_qnodes);
+
+    // An interrupt nesting here runs its own acquire to completion and
+    // restores depth before we resume, so a plain increment is enough
+    uint32_t idx = set.depth++;
+    if (idx >= QNODE_LEVELS) {
+        while (!try_lock_word(lock)) {
+            cpu::relax();
+        }
+        set.depth--;
+        return;
+    }
+
+    qnode* node = &set.nodes[idx];
+    node->next = nullptr;
+    node->locked = 0;
+    uint32_t tail = encode_tail(percpu::current_cpu_id(), idx);
+
+    // Publish the node as the new tail, unless the lock went free
+    uint32_t old = __atomic_load_n(&lock.val, __ATOMIC_RELAXED);
+    for (;;) {
+        if (old == 0) {
+            if (try_lock_word(lock)) {
+                set.depth--;
+                return;
+            }
+            old = __atomic_load_n(&lock.val, __ATOMIC_RELAXED);
+            continue;
+        }
+        uint32_t desired = (old & SPINLOCK_LOCKED) | tail;
+        if (__atomic_compare_exchange_n(&lock.val, &old, desired, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    // Link behind the previous tail and wait until it hands over the
+    // queue head. Only this CPU's node cache line is polled.
+    uint32_t prev_tail = old & ~SPINLOCK_LOCKED;
+    if (prev_tail) {
+        qnode* prev = decode_tail(prev_tail);
+        __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+        cpu::send_event();
+        while (!__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) {
+            cpu::relax();
+        }
+    }
+
+    // Queue head: wait for the owner, then take the lock. Only the head
+    // can set the locked bit while a tail is present, the fast path
+    // needs a zero word.
+    for (;;) {
+        uint32_t val = __atomic_load_n(&lock.val, __ATOMIC_ACQUIRE);
+        if (val & SPINLOCK_LOCKED) {
+            cpu::relax();
+            continue;
+        }
+
+        if (val == tail) {
+            // Last in line: take the lock and empty the queue at once
+            if (__atomic_compare_exchange_n(&lock.val, &val, SPINLOCK_LOCKED, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                set.depth--;
+                return;
+            }
+            continue;
+        }
+
+        __atomic_fetch_or(&lock.val, SPINLOCK_LOCKED, __ATOMIC_ACQUIRE);
+        break;
+    }
+
+    // A successor swapped the tail but may not have linked in yet
+    qnode* next;
+    while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))) {
+        cpu::relax();
+    }
+    __atomic_store_n(&next->locked, 1u, __ATOMIC_RELEASE);
+    cpu::send_event();
+
+    set.depth--;
+}
+
+} // namespace sync
@@ -6,26 +6,97 @@
 
 namespace sync {
 
+#ifdef STLX_LOCKSTAT
+namespace lockstat { struct lock_class; }
+#endif
+
+/**
+ * Queued spinlock (MCS style). The lock word holds a locked bit and the
+ * tail of a queue of waiters; each waiter spins on its own per-CPU node
+ * instead of a shared cache line, and the lock is handed over in FIFO
+ * order like the ticket lock it replaces. The uncontended acquire and
+ * the release are a single atomic on the lock word.
+ */
 struct alignas(64) spinlock {
-    uint16_t next_ticket;
-    uint16_t now_serving;
+    uint32_t val;
+#ifdef STLX_LOCKSTAT
+    // Lock class and hold start, see sync/lockstat.h. These fit in the
+    // cache line padding, the lock stays 64 bytes.
+    const char*           class_file; // SPINLOCK_INIT site, nullptr if only zeroed
+    uint32_t              class_line;
+    lockstat::lock_class* cls;        // resolved on the first acquisition
+    uint64_t              acquired_at;
+#endif
 };
 
-constexpr spinlock SPINLOCK_INIT = {0, 0};
+#ifdef STLX_LOCKSTAT
+constexpr spinlock spinlock_init_at(const char* file, uint32_t line) {
+    return spinlock{0, file, line, nullptr, 0};
+}
+
+// Each expansion is a lock class of its own. Written sync::SPINLOCK_INIT
+// outside the namespace, like the constant it replaces
+#define SPINLOCK_INIT spinlock_init_at(__FILE__, __LINE__)
+#else
+constexpr spinlock SPINLOCK_INIT = {0};
+#endif
+
+// Lock word layout: bit 0 = locked, bits 16-31 = queue tail
+constexpr uint32_t SPINLOCK_LOCKED     = 1u;
+constexpr uint32_t SPINLOCK_TAIL_SHIFT = 16;
 
 struct irq_state {
     uint64_t flags;
 };
 
+/**
+ * Contended acquire: queue on this CPU's node and wait for the handoff.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_lock_slowpath(spinlock& lock);
+
+#ifdef STLX_LOCKSTAT
+
+/**
+ * Lockstat builds acquire out of line in sync/lockstat.cpp. The default
+ * arguments record the calling file and line as the acquiring site.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_lock(spinlock& lock,
+                                 const char* site_file = __builtin_FILE(),
+                                 uint32_t site_line = __builtin_LINE());
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void spin_unlock(spinlock& lock);
+
+/**
+ * @note Privilege: **required**
+ */
+[[nodiscard]] __PRIVILEGED_CODE inline irq_state spin_lock_irqsave(
+    spinlock& lock,
+    const char* site_file = __builtin_FILE(),
+    uint32_t site_line = __builtin_LINE()) {
+    irq_state state{cpu::irq_save()};
+    spin_lock(lock, site_file, site_line);
+    return state;
+}
+
+#else
+
 inline void spin_lock(spinlock& lock) {
-    uint16_t ticket = __atomic_fetch_add(&lock.next_ticket, 1, __ATOMIC_RELAXED);
-    while (__atomic_load_n(&lock.now_serving, __ATOMIC_ACQUIRE) != ticket) {
-        cpu::relax();
+    uint32_t expected = 0;
+    if (__builtin_expect(__atomic_compare_exchange_n(&lock.val, &expected, SPINLOCK_LOCKED,
+                                                      false, __ATOMIC_ACQUIRE,
+                                                      __ATOMIC_RELAXED), 1)) {
+        return;
     }
+    spin_lock_slowpath(lock);
 }
 
 inline void spin_unlock(spinlock& lock) {
-    __atomic_add_fetch(&lock.now_serving, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_and(&lock.val, ~SPINLOCK_LOCKED, __ATOMIC_RELEASE);
     cpu::send_event();
 }
 
@@ -38,6 +109,8 @@ inline void spin_unlock(spinlock& lock) {
     return state;
 }
 
+#endif // STLX_LOCKSTAT
+
 /**
  * @note Privilege: **required**
  */
@@ -51,8 +124,15 @@ public:
     /**
      * @note Privilege: **required**
      */
+#ifdef STLX_LOCKSTAT
+    __PRIVILEGED_CODE explicit irq_lock_guard(spinlock& lk,
+                                              const char* site_file = __builtin_FILE(),
+                                              uint32_t site_line = __builtin_LINE())
+        : lock_(lk), state_(spin_lock_irqsave(lk, site_file, site_line)) {}
+#else
     __PRIVILEGED_CODE explicit irq_lock_guard(spinlock& lk)
         : lock_(lk), state_(spin_lock_irqsave(lk)) {}
+#endif
 
     /**
      * @note Privilege: **required**
@@ -60,8 +60,8 @@ __PRIVILEGED_CODE static void notify_observers_and_unlock(
  * the caller loops on signals::interrupt_pending().
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE
-irq_state wait(wait_queue& wq, spinlock& lock, irq_state saved) {
+__PRIVILEGED_CODE static irq_state wait_common(wait_queue& wq, spinlock& lock,
+                                               irq_state saved, bool exclusive) {
     sched::task* self = sched::current();
 
     if (self->exec.flags & sched::TASK_FLAG_IDLE) {
@@ -72,7 +72,12 @@ irq_state wait(wait_queue& wq, spinlock& lock, irq_state saved) {
 
     spin_lock(wq.lock);
     sched::prepare_to_block_task();
-    wq.waiters.push_back(self);
+    self->wait_exclusive = exclusive;
+    if (exclusive) {
+        wq.waiters.push_back(self);
+    } else {
+        wq.waiters.push_front(self);
+    }
     spin_unlock(wq.lock);
 
     spin_unlock_irqrestore(lock, saved);
@@ -91,44 +96,60 @@ irq_state wait(wait_queue& wq, spinlock& lock, irq_state saved) {
 /**
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void wake_one(wait_queue& wq) {
-    irq_state irq = spin_lock_irqsave(wq.lock);
-    sched::task* t = wq.waiters.pop_front();
-
-    if (!wq.observers.empty()) {
-        // notify_observers_and_unlock releases wq.lock
-        notify_observers_and_unlock(wq, irq);
-    } else {
-        spin_unlock_irqrestore(wq.lock, irq);
-    }
+__PRIVILEGED_CODE
+irq_state wait(wait_queue& wq, spinlock& lock, irq_state saved) {
+    return wait_common(wq, lock, saved, false);
+}
 
-    if (t) {
-        sched::wake(t);
-    }
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE
+irq_state wait_exclusive(wait_queue& wq, spinlock& lock, irq_state saved) {
+    return wait_common(wq, lock, saved, true);
 }
 
 /**
- * Wake all waiting tasks. Snapshots waiter pointers into a stack batch
- * so wait_link is fully unlinked (prev=next=nullptr) before any task
- * can be scheduled. This prevents a concurrent force_wake_for_kill from
- * racing with post-yield cleanup in sync::wait, which assumes is_linked
- * means "still on wq.waiters".
+ * Snapshots waiter pointers into a stack batch so wait_link is fully
+ * unlinked (prev=next=nullptr) before any task can be scheduled. This
+ * prevents a concurrent force_wake_for_kill from racing with post-yield
+ * cleanup in sync::wait, which assumes is_linked means "still on
+ * wq.waiters".
+ *
+ * Plain waiters are all ahead of the exclusive ones, so the scan stops
+ * at the first exclusive waiter once nr_exclusive are taken.
  *
  * @note Privilege: **required**
  */
-__PRIVILEGED_CODE void wake_all(wait_queue& wq) {
+__PRIVILEGED_CODE void wake_nr(wait_queue& wq, uint32_t nr_exclusive) {
     sched::task* batch[WAITER_BATCH_SIZE];
 
     for (;;) {
         uint32_t n = 0;
         irq_state irq = spin_lock_irqsave(wq.lock);
 
-        while (!wq.waiters.empty() && n < WAITER_BATCH_SIZE) {
-            batch[n++] = wq.waiters.pop_front();
+        bool done = true;
+        auto it = wq.waiters.begin();
+        auto end = wq.waiters.end();
+        while (it != end) {
+            sched::task& t = *it;
+            if (t.wait_exclusive && nr_exclusive == 0) {
+                break;
+            }
+            if (n == WAITER_BATCH_SIZE) {
+                done = false;
+                break;
+            }
+            ++it; // advance before removal
+            if (t.wait_exclusive) {
+                nr_exclusive--;
+            }
+            wq.waiters.remove(&t);
+            batch[n++] = &t;
         }
-        bool drained = wq.waiters.empty();
 
-        if (drained && !wq.observers.empty()) {
+        if (done && !wq.observers.empty()) {
+            // notify_observers_and_unlock releases wq.lock
             notify_observers_and_unlock(wq, irq);
         } else {
             spin_unlock_irqrestore(wq.lock, irq);
@@ -138,8 +159,22 @@ __PRIVILEGED_CODE void wake_all(wait_queue& wq) {
             sched::wake(batch[i]);
         }
 
-        if (drained) break;
+        if (done) break;
     }
 }
 
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void wake_one(wait_queue& wq) {
+    wake_nr(wq, 1);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void wake_all(wait_queue& wq) {
+    wake_nr(wq, 0xFFFFFFFFu);
+}
+
 } // namespace sync
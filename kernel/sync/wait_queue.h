@@ -9,6 +9,15 @@
 
 namespace sync {
 
+/*
+ * Waiters come in two kinds. Plain waiters, queued by wait(), are woken
+ * by every wake. Exclusive waiters, queued by wait_exclusive(), each
+ * stand for a consumer of one unit of the resource (one connection, one
+ * work item, the lock itself), so a wake hands out only as many of those
+ * as it was asked for. Plain waiters sit at the head of the queue and
+ * exclusive ones behind them in FIFO order. Poll observers are notified
+ * on every wake.
+ */
 struct wait_queue {
     spinlock lock;
     list::head<sched::task, &sched::task::wait_link> waiters;
@@ -47,14 +56,31 @@ struct wait_queue {
 irq_state wait(wait_queue& wq, spinlock& lock, irq_state saved);
 
 /**
- * Wake the first waiting task (FIFO order).
+ * Same as wait(), but queue as an exclusive waiter: wake_one() and
+ * wake_nr() wake exclusive waiters one at a time, oldest first. A task
+ * woken this way that leaves without consuming the resource should
+ * pass the wake on with wake_one().
+ * @note Privilege: **required**
+ */
+[[nodiscard]] __PRIVILEGED_CODE
+irq_state wait_exclusive(wait_queue& wq, spinlock& lock, irq_state saved);
+
+/**
+ * Wake every plain waiter and up to nr_exclusive exclusive waiters.
+ * Poll observers are always notified. Safe from IRQ context.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void wake_nr(wait_queue& wq, uint32_t nr_exclusive);
+
+/**
+ * Wake every plain waiter and the oldest exclusive waiter.
  * No-op if the queue is empty. Safe from IRQ context.
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE void wake_one(wait_queue& wq);
 
 /**
- * Wake all waiting tasks.
+ * Wake all waiting tasks, exclusive or not.
  * No-op if the queue is empty. Safe from IRQ context.
  * @note Privilege: **required**
  */
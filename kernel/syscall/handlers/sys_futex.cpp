@@ -1,24 +1,52 @@
 #include "syscall/handlers/sys_futex.h"
 #include "sync/futex.h"
 #include "mm/uaccess.h"
+#include "mm/heap.h"
+#include "clock/clock.h"
 
-// Relative timeout as userland passes it to the futex syscall
+// Timeout as userland passes it to the futex syscall, relative for
+// FUTEX_WAIT and absolute for FUTEX_WAIT_BITSET
 struct futex_timespec {
     int64_t tv_sec;
     int64_t tv_nsec;
 };
 
-// Futex operations implemented by the multiplexer, the private flag
-// is meaningless here because waiters are already keyed by address
-// space, and requeue degrades to waking every waiter
-constexpr uint64_t FUTEX_CMD_MASK       = 0x7F;
-constexpr uint64_t FUTEX_OP_WAIT        = 0;
-constexpr uint64_t FUTEX_OP_WAKE        = 1;
-constexpr uint64_t FUTEX_OP_REQUEUE     = 3;
-constexpr uint64_t FUTEX_OP_CMP_REQUEUE = 4;
+// Futex operations implemented by the multiplexer. Every user futex is
+// keyed by address space already, so the private flag (128) is masked
+// off with the command: private and shared waits both use the
+// per-process table
+constexpr uint64_t FUTEX_CMD_MASK         = 0x7F;
+constexpr uint64_t FUTEX_CLOCK_REALTIME   = 256;
+constexpr uint64_t FUTEX_OP_WAIT          = 0;
+constexpr uint64_t FUTEX_OP_WAKE          = 1;
+constexpr uint64_t FUTEX_OP_REQUEUE       = 3;
+constexpr uint64_t FUTEX_OP_CMP_REQUEUE   = 4;
+constexpr uint64_t FUTEX_OP_WAKE_OP       = 5;
+constexpr uint64_t FUTEX_OP_LOCK_PI       = 6;
+constexpr uint64_t FUTEX_OP_UNLOCK_PI     = 7;
+constexpr uint64_t FUTEX_OP_TRYLOCK_PI    = 8;
+constexpr uint64_t FUTEX_OP_WAIT_BITSET   = 9;
+constexpr uint64_t FUTEX_OP_WAKE_BITSET   = 10;
+constexpr uint64_t FUTEX_OP_LOCK_PI2      = 13;
 
 constexpr int64_t NSEC_PER_SEC = 1000000000;
 
+// One futex_waitv entry as userland lays it out, for both the Linux
+// syscall and SYS_FUTEX_WAITV
+struct futex_waitv_user {
+    uint64_t val;
+    uint64_t uaddr;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+constexpr uint32_t FUTEX2_SIZE_U32  = 0x02;
+constexpr uint32_t FUTEX2_SIZE_MASK = 0x03;
+constexpr uint32_t FUTEX2_PRIVATE   = 128;
+
+constexpr uint64_t FUTEX_CLOCK_ID_REALTIME  = 0;
+constexpr uint64_t FUTEX_CLOCK_ID_MONOTONIC = 1;
+
 // Read the optional relative timeout, returning zero on success and a
 // negative errno otherwise. Zero nanoseconds means wait forever in the
 // native layer, so an already expired timeout clamps to one nanosecond
@@ -48,11 +76,51 @@ static int64_t read_futex_timeout(uint64_t u_timeout, uint64_t* out_ns) {
     return 0;
 }
 
-DEFINE_SYSCALL6(futex, u_uaddr, u_op, u_val, u_timeout, u_uaddr2, u_val3) {
-    (void)u_uaddr2;
+// Read the optional absolute FUTEX_WAIT_BITSET timeout as a clock::now_ns()
+// deadline, zero meaning none. A deadline already in the past becomes
+// the current time so the futex value is still checked first
+static int64_t read_futex_deadline(uint64_t u_timeout, bool realtime,
+                                   uint64_t* out_deadline) {
+    if (u_timeout == 0) {
+        *out_deadline = 0;
+        return 0;
+    }
+
+    futex_timespec ts;
+
+    if (mm::uaccess::copy_from_user(
+            &ts, reinterpret_cast<const void*>(u_timeout),
+            sizeof(ts)) != mm::uaccess::OK) {
+        return syscall::EFAULT;
+    }
+
+    if (ts.tv_sec < 0 || ts.tv_nsec < 0 || ts.tv_nsec >= NSEC_PER_SEC) {
+        return syscall::EINVAL;
+    }
 
+    uint64_t abs_ns = static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC
+                    + static_cast<uint64_t>(ts.tv_nsec);
+    uint64_t now = clock::now_ns();
+
+    if (realtime) {
+        uint64_t base = clock::boot_realtime_ns();
+        abs_ns = (abs_ns > base) ? abs_ns - base : 0;
+    }
+
+    *out_deadline = (abs_ns > now) ? abs_ns : now;
+
+    return 0;
+}
+
+DEFINE_SYSCALL6(futex, u_uaddr, u_op, u_val, u_timeout, u_uaddr2, u_val3) {
     uint64_t cmd = u_op & FUTEX_CMD_MASK;
     uintptr_t uaddr = static_cast<uintptr_t>(u_uaddr);
+    uintptr_t uaddr2 = static_cast<uintptr_t>(u_uaddr2);
+
+    if ((u_op & FUTEX_CLOCK_REALTIME) && cmd != FUTEX_OP_WAIT_BITSET &&
+        cmd != FUTEX_OP_WAIT && cmd != FUTEX_OP_LOCK_PI2) {
+        return syscall::ENOSYS;
+    }
 
     switch (cmd) {
     case FUTEX_OP_WAIT: {
@@ -71,24 +139,62 @@ DEFINE_SYSCALL6(futex, u_uaddr, u_op, u_val, u_timeout, u_uaddr2, u_val3) {
     case FUTEX_OP_WAKE:
         return sync::futex_wake(uaddr, static_cast<uint32_t>(u_val));
 
-    case FUTEX_OP_CMP_REQUEUE: {
-        uint32_t cur = 0;
+    case FUTEX_OP_WAIT_BITSET: {
+        uint64_t deadline = 0;
 
-        if (mm::uaccess::copy_from_user(
-                &cur, reinterpret_cast<const void*>(u_uaddr),
-                sizeof(cur)) != mm::uaccess::OK) {
-            return syscall::EFAULT;
+        int64_t rc = read_futex_deadline(
+            u_timeout, (u_op & FUTEX_CLOCK_REALTIME) != 0, &deadline);
+        if (rc != 0) {
+            return rc;
         }
 
-        if (cur != static_cast<uint32_t>(u_val3)) {
-            return syscall::EAGAIN;
+        return sync::futex_wait_bitset(
+            uaddr, static_cast<uint32_t>(u_val), deadline,
+            static_cast<uint32_t>(u_val3));
+    }
+
+    case FUTEX_OP_WAKE_BITSET:
+        return sync::futex_wake_bitset(
+            uaddr, static_cast<uint32_t>(u_val), static_cast<uint32_t>(u_val3));
+
+    // For these the timeout argument carries a second count
+    case FUTEX_OP_WAKE_OP:
+        return sync::futex_wake_op(
+            uaddr, uaddr2, static_cast<uint32_t>(u_val),
+            static_cast<uint32_t>(u_timeout), static_cast<uint32_t>(u_val3));
+
+    case FUTEX_OP_REQUEUE:
+        return sync::futex_requeue(
+            uaddr, uaddr2, static_cast<uint32_t>(u_val),
+            static_cast<uint32_t>(u_timeout), false, 0);
+
+    case FUTEX_OP_CMP_REQUEUE:
+        return sync::futex_requeue(
+            uaddr, uaddr2, static_cast<uint32_t>(u_val),
+            static_cast<uint32_t>(u_timeout), true,
+            static_cast<uint32_t>(u_val3));
+
+    // FUTEX_LOCK_PI always takes an absolute CLOCK_REALTIME timeout,
+    // FUTEX_LOCK_PI2 a CLOCK_MONOTONIC one unless asked otherwise
+    case FUTEX_OP_LOCK_PI:
+    case FUTEX_OP_LOCK_PI2: {
+        bool realtime = cmd == FUTEX_OP_LOCK_PI || (u_op & FUTEX_CLOCK_REALTIME);
+        uint64_t deadline = 0;
+
+        int64_t rc = read_futex_deadline(u_timeout, realtime, &deadline);
+        if (rc != 0) {
+            return rc;
         }
 
-        return sync::futex_wake_all(uaddr);
+        rc = sync::futex_lock_pi(uaddr, deadline, false);
+        return rc == syscall::EINTR ? syscall::ERESTARTSYS : rc;
     }
 
-    case FUTEX_OP_REQUEUE:
-        return sync::futex_wake_all(uaddr);
+    case FUTEX_OP_TRYLOCK_PI:
+        return sync::futex_lock_pi(uaddr, 0, true);
+
+    case FUTEX_OP_UNLOCK_PI:
+        return sync::futex_unlock_pi(uaddr);
 
     default:
         return syscall::ENOSYS;
@@ -114,3 +220,82 @@ DEFINE_SYSCALL2(futex_wake, uaddr, count) {
 DEFINE_SYSCALL1(futex_wake_all, uaddr) {
     return sync::futex_wake_all(static_cast<uintptr_t>(uaddr));
 }
+
+DEFINE_SYSCALL1(futex_lock_pi, uaddr) {
+    int64_t rc = sync::futex_lock_pi(static_cast<uintptr_t>(uaddr), 0, false);
+
+    // Retrying the acquisition from the top is always safe
+    return rc == syscall::EINTR ? syscall::ERESTARTSYS : rc;
+}
+
+DEFINE_SYSCALL1(futex_unlock_pi, uaddr) {
+    return sync::futex_unlock_pi(static_cast<uintptr_t>(uaddr));
+}
+
+// Copy and check a futex_waitv array, then wait on it
+static int64_t do_futex_waitv(uint64_t u_waiters, uint64_t nr, uint64_t deadline_ns) {
+    if (u_waiters == 0 || nr == 0 || nr > sync::FUTEX_WAITV_MAX) {
+        return syscall::EINVAL;
+    }
+
+    size_t user_size = nr * sizeof(futex_waitv_user);
+    auto* entries = static_cast<futex_waitv_user*>(
+        heap::kalloc(user_size + nr * sizeof(sync::futex_wait_key)));
+    if (!entries) {
+        return syscall::ENOMEM;
+    }
+    auto* keys = reinterpret_cast<sync::futex_wait_key*>(
+        reinterpret_cast<uint8_t*>(entries) + user_size);
+
+    int64_t rc = 0;
+    if (mm::uaccess::copy_from_user(
+            entries, reinterpret_cast<const void*>(u_waiters),
+            user_size) != mm::uaccess::OK) {
+        rc = syscall::EFAULT;
+    }
+
+    for (uint64_t i = 0; rc == 0 && i < nr; i++) {
+        const futex_waitv_user& e = entries[i];
+        if ((e.flags & ~(FUTEX2_SIZE_MASK | FUTEX2_PRIVATE)) != 0 ||
+            (e.flags & FUTEX2_SIZE_MASK) != FUTEX2_SIZE_U32 ||
+            e.reserved != 0 || e.val > 0xFFFFFFFFu) {
+            rc = syscall::EINVAL;
+            break;
+        }
+        keys[i].addr = static_cast<uintptr_t>(e.uaddr);
+        keys[i].expected = static_cast<uint32_t>(e.val);
+    }
+
+    if (rc == 0) {
+        rc = sync::futex_waitv(keys, static_cast<uint32_t>(nr), deadline_ns);
+    }
+    heap::kfree(entries);
+
+    // The deadline is absolute, so an interrupted wait restarts as is
+    return rc == syscall::EINTR ? syscall::ERESTARTSYS : rc;
+}
+
+DEFINE_SYSCALL5(futex_waitv, u_waiters, u_nr, u_flags, u_timeout, u_clockid) {
+    if (u_flags != 0) {
+        return syscall::EINVAL;
+    }
+
+    uint64_t deadline = 0;
+    if (u_timeout != 0) {
+        if (u_clockid != FUTEX_CLOCK_ID_MONOTONIC &&
+            u_clockid != FUTEX_CLOCK_ID_REALTIME) {
+            return syscall::EINVAL;
+        }
+        int64_t rc = read_futex_deadline(
+            u_timeout, u_clockid == FUTEX_CLOCK_ID_REALTIME, &deadline);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return do_futex_waitv(u_waiters, u_nr, deadline);
+}
+
+DEFINE_SYSCALL3(futex_wait_multiple, u_waiters, u_nr, deadline_ns) {
+    return do_futex_waitv(u_waiters, u_nr, deadline_ns);
+}
@@ -7,5 +7,9 @@ DECLARE_SYSCALL(futex);
 DECLARE_SYSCALL(futex_wait);
 DECLARE_SYSCALL(futex_wake);
 DECLARE_SYSCALL(futex_wake_all);
+DECLARE_SYSCALL(futex_waitv);
+DECLARE_SYSCALL(futex_wait_multiple);
+DECLARE_SYSCALL(futex_lock_pi);
+DECLARE_SYSCALL(futex_unlock_pi);
 
 #endif // STELLUX_SYSCALL_HANDLERS_SYS_FUTEX_H
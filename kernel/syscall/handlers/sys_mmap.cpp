@@ -58,6 +58,8 @@ inline int64_t mm_status_to_errno(int32_t status) {
             return syscall::EINVAL;
         case mm::MM_CTX_ERR_NOT_MAPPED:
             return syscall::ENOMEM;
+        case mm::MM_CTX_ERR_ACCESS:
+            return syscall::EACCES;
         case mm::MM_CTX_ERR_NO_MEM:
         case mm::MM_CTX_ERR_NO_VIRT:
         case mm::MM_CTX_ERR_MAP_FAILED:
@@ -7,6 +7,8 @@
 #include "sched/task.h"
 #include "sched/task_registry.h"
 #include "signals/signal.h"
+#include "sync/poll.h"
+#include "rc/rcu.h"
 #include "dynpriv/dynpriv.h"
 #include "exec/elf.h"
 #include "mm/uaccess.h"
@@ -22,8 +24,40 @@ struct process_info {
     char name[256];
     int pid;
     int cpu;
+    sched::task_rusage usage;
 };
 
+constexpr int32_t RUSAGE_SELF     = 0;
+constexpr int32_t RUSAGE_CHILDREN = -1;
+constexpr int32_t RUSAGE_THREAD   = 1;
+
+constexpr uint64_t WNOHANG    = 1;
+constexpr uint64_t WUNTRACED  = 2;
+constexpr uint64_t WCONTINUED = 8;
+
+// Linux struct rusage: two timevals, then fourteen longs
+struct linux_rusage {
+    int64_t utime_sec;
+    int64_t utime_usec;
+    int64_t stime_sec;
+    int64_t stime_usec;
+    int64_t maxrss;
+    int64_t ixrss;
+    int64_t idrss;
+    int64_t isrss;
+    int64_t minflt;
+    int64_t majflt;
+    int64_t nswap;
+    int64_t inblock;
+    int64_t oublock;
+    int64_t msgsnd;
+    int64_t msgrcv;
+    int64_t nsignals;
+    int64_t nvcsw;
+    int64_t nivcsw;
+};
+static_assert(sizeof(linux_rusage) == 144, "linux_rusage must match struct rusage");
+
 constexpr size_t MAX_PROC_ARGV_TOTAL = 3500;
 
 // One bounded user string array copied into kernel storage
@@ -110,6 +144,60 @@ __PRIVILEGED_CODE static const char* path_basename(const char* path) {
     return base;
 }
 
+int64_t copy_rusage_to_user(uint64_t u_usage, const sched::task_rusage& ru) {
+    constexpr uint64_t NS_PER_SEC  = 1000000000;
+    constexpr uint64_t NS_PER_USEC = 1000;
+
+    linux_rusage lru = {};
+    lru.utime_sec  = static_cast<int64_t>(ru.user_ns / NS_PER_SEC);
+    lru.utime_usec = static_cast<int64_t>((ru.user_ns % NS_PER_SEC) / NS_PER_USEC);
+    lru.stime_sec  = static_cast<int64_t>(ru.sys_ns / NS_PER_SEC);
+    lru.stime_usec = static_cast<int64_t>((ru.sys_ns % NS_PER_SEC) / NS_PER_USEC);
+    lru.maxrss     = static_cast<int64_t>(ru.maxrss_kb);
+    lru.minflt     = static_cast<int64_t>(ru.minflt);
+    // Linux counts block I/O in 512-byte units
+    lru.inblock    = static_cast<int64_t>(ru.read_bytes / 512);
+    lru.oublock    = static_cast<int64_t>(ru.write_bytes / 512);
+    lru.nvcsw      = static_cast<int64_t>(ru.nvcsw);
+    lru.nivcsw     = static_cast<int64_t>(ru.nivcsw);
+
+    int32_t rc = mm::uaccess::copy_to_user(
+        reinterpret_cast<void*>(u_usage), &lru, sizeof(lru));
+    return rc == mm::uaccess::OK ? 0 : syscall::EFAULT;
+}
+
+// Scans caller's PROCESS handles for the children wait4 selects: every
+// process (not thread) when pid <= 0, else the one with that pid. Each
+// candidate subscribes pt when given.
+// @return Handle of an exited candidate, or -1 with *found telling
+// whether any candidate exists.
+__PRIVILEGED_CODE static int32_t find_exited_child(
+    sched::task* caller, int64_t pid, sync::poll_table* pt, bool* found
+) {
+    *found = false;
+    for (uint32_t i = 0; i < resource::MAX_TASK_HANDLES; i++) {
+        resource::resource_object* obj = nullptr;
+        if (resource::get_handle_object(caller->handles,
+                static_cast<resource::handle_t>(i), 0, &obj) != resource::HANDLE_OK) {
+            continue;
+        }
+        auto* pr = obj->type == resource::resource_type::PROCESS
+            ? resource::proc_provider::get_proc_resource(obj) : nullptr;
+        if (!pr || pr->thread || (pid > 0 && pr->pid != static_cast<uint64_t>(pid))) {
+            resource::resource_release(obj);
+            continue;
+        }
+
+        *found = true;
+        uint32_t mask = obj->ops->poll(obj, pt);
+        resource::resource_release(obj);
+        if (mask & sync::POLL_IN) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
 __PRIVILEGED_CODE static int64_t map_elf_error(int32_t rc) {
     switch (rc) {
         case exec::ERR_FILE_OPEN:
@@ -294,22 +382,35 @@ DEFINE_SYSCALL2(proc_wait, u_handle, u_exit_code_ptr) {
         resource::resource_release(obj);
         return syscall::ERESTARTSYS;
     }
+    // Another thread's proc_wait or wait4 already reaped it
+    if (pr->reaped) {
+        sync::spin_unlock_irqrestore(pr->lock, irq);
+        resource::resource_release(obj);
+        return syscall::ECHILD;
+    }
+    pr->reaped = true;
     int32_t child_wait_status = pr->wait_status;
+    sched::task_rusage child_usage = pr->rusage;
+    sched::rusage_add(&child_usage, pr->children_rusage);
+    bool child_is_thread = pr->thread;
     sync::spin_unlock_irqrestore(pr->lock, irq);
 
+    // A joined thread already counts toward its own process
+    if (!child_is_thread && caller->group) {
+        sched::add_child_rusage(caller->group, child_usage);
+    }
+    resource::resource_release(obj);
+    resource::close(caller, handle);
+
     if (u_exit_code_ptr != 0) {
         int32_t copy_rc = mm::uaccess::copy_to_user(
             reinterpret_cast<void*>(u_exit_code_ptr),
             &child_wait_status,
             sizeof(child_wait_status));
         if (copy_rc != mm::uaccess::OK) {
-            resource::resource_release(obj);
             return syscall::EFAULT;
         }
     }
-
-    resource::resource_release(obj);
-    resource::close(caller, handle);
     return 0;
 }
 
@@ -368,18 +469,26 @@ DEFINE_SYSCALL2(proc_info, u_handle, u_info_ptr) {
     }
 
     process_info kinfo = {};
+    sync::irq_state rcu_irq = rc::rcu::read_lock();
     sync::irq_state irq = sync::spin_lock_irqsave(pr->lock);
-    if (!pr->child) {
+    sched::task* child = pr->child;
+    if (!child) {
         sync::spin_unlock_irqrestore(pr->lock, irq);
+        rc::rcu::read_unlock(rcu_irq);
         resource::resource_release(obj);
         return syscall::ESRCH;
     }
-    string::memcpy(kinfo.name, pr->child->name,
-                   string::strnlen(pr->child->name, sched::TASK_NAME_MAX - 1) + 1);
-    kinfo.pid = static_cast<int>(pr->child->tid);
-    kinfo.cpu = static_cast<int>(pr->child->exec.cpu);
+    string::memcpy(kinfo.name, child->name,
+                   string::strnlen(child->name, sched::TASK_NAME_MAX - 1) + 1);
+    kinfo.pid = static_cast<int>(child->tid);
+    kinfo.cpu = static_cast<int>(child->exec.cpu);
     sync::spin_unlock_irqrestore(pr->lock, irq);
 
+    // Group locks nest outside pr->lock, so usage is read after dropping
+    // it; RCU keeps the child readable if it exits meanwhile
+    sched::read_exit_rusage(child, &kinfo.usage);
+    rc::rcu::read_unlock(rcu_irq);
+
     int32_t copy_rc = mm::uaccess::copy_to_user(
         reinterpret_cast<void*>(u_info_ptr), &kinfo, sizeof(kinfo));
     if (copy_rc != mm::uaccess::OK) {
@@ -537,3 +646,130 @@ DEFINE_SYSCALL4(proc_create_thread, u_entry, u_arg, u_stack_top, u_name) {
     resource::resource_release(obj);
     return static_cast<int64_t>(handle);
 }
+
+DEFINE_SYSCALL2(getrusage, u_who, u_usage) {
+    sched::task* caller = sched::current();
+    if (!caller) {
+        return syscall::EIO;
+    }
+
+    sched::task_rusage ru = {};
+    switch (static_cast<int32_t>(u_who)) {
+    case RUSAGE_SELF:
+        if (caller->group) {
+            sched::read_group_rusage(caller->group, &ru);
+        } else {
+            sched::read_task_rusage(caller, &ru);
+        }
+        break;
+    case RUSAGE_THREAD:
+        sched::read_task_rusage(caller, &ru);
+        break;
+    case RUSAGE_CHILDREN:
+        if (caller->group) {
+            sched::read_children_rusage(caller->group, &ru);
+        }
+        break;
+    default:
+        return syscall::EINVAL;
+    }
+
+    return copy_rusage_to_user(u_usage, ru);
+}
+
+// Children are the processes the caller holds PROCESS handles to, and
+// reaping one closes its handle. There are no process groups, so every
+// pid <= 0 selects any child. Stopped and continued children are never
+// reported, WUNTRACED and WCONTINUED are accepted and ignored.
+DEFINE_SYSCALL4(wait4, u_pid, u_status, u_options, u_usage) {
+    sched::task* caller = sched::current();
+    if (!caller) {
+        return syscall::EIO;
+    }
+    if (u_options & ~(WNOHANG | WUNTRACED | WCONTINUED)) {
+        return syscall::EINVAL;
+    }
+
+    int64_t pid = static_cast<int32_t>(u_pid);
+    bool nohang = (u_options & WNOHANG) != 0;
+
+    for (;;) {
+        sync::poll_table pt;
+        pt.init(caller);
+
+        bool found = false;
+        int32_t handle = find_exited_child(caller, pid, nohang ? nullptr : &pt, &found);
+        if (handle < 0 && found && !nohang &&
+            !__atomic_load_n(&pt.error, __ATOMIC_ACQUIRE)) {
+            sync::poll_wait(pt, 0);
+        }
+        bool alloc_failed = __atomic_load_n(&pt.error, __ATOMIC_ACQUIRE) != 0;
+        sync::poll_cleanup(pt);
+
+        if (handle < 0) {
+            if (!found) {
+                return syscall::ECHILD;
+            }
+            if (nohang) {
+                return 0;
+            }
+            if (alloc_failed) {
+                return syscall::ENOMEM;
+            }
+            if (signals::interrupt_pending(caller)) {
+                return syscall::ERESTARTSYS;
+            }
+            continue;
+        }
+
+        resource::resource_object* obj = nullptr;
+        if (resource::get_handle_object(caller->handles, handle, 0, &obj) != resource::HANDLE_OK) {
+            continue; // reaped by another thread in between
+        }
+        auto* pr = obj->type == resource::resource_type::PROCESS
+            ? resource::proc_provider::get_proc_resource(obj) : nullptr;
+        if (!pr) {
+            resource::resource_release(obj);
+            continue;
+        }
+
+        // Claim the reap so a racing waiter in another thread skips it
+        sync::irq_state irq = sync::spin_lock_irqsave(pr->lock);
+        bool claimed = pr->exited && !pr->reaped;
+        if (claimed) {
+            pr->reaped = true;
+        }
+        uint32_t child_pid = pr->pid;
+        int32_t child_wait_status = pr->wait_status;
+        sched::task_rusage child_usage = pr->rusage;
+        sched::rusage_add(&child_usage, pr->children_rusage);
+        sync::spin_unlock_irqrestore(pr->lock, irq);
+        if (!claimed) {
+            resource::resource_release(obj);
+            continue;
+        }
+
+        // Like Linux the child is reaped even if the copies fault
+        if (caller->group) {
+            sched::add_child_rusage(caller->group, child_usage);
+        }
+        resource::resource_release(obj);
+        resource::close(caller, handle);
+
+        if (u_status != 0) {
+            int32_t copy_rc = mm::uaccess::copy_to_user(
+                reinterpret_cast<void*>(u_status),
+                &child_wait_status, sizeof(child_wait_status));
+            if (copy_rc != mm::uaccess::OK) {
+                return syscall::EFAULT;
+            }
+        }
+        if (u_usage != 0) {
+            int64_t copy_rc = copy_rusage_to_user(u_usage, child_usage);
+            if (copy_rc != 0) {
+                return copy_rc;
+            }
+        }
+        return static_cast<int64_t>(child_pid);
+    }
+}
@@ -11,5 +11,7 @@ DECLARE_SYSCALL(proc_info);
 DECLARE_SYSCALL(proc_set_handle);
 DECLARE_SYSCALL(proc_kill);
 DECLARE_SYSCALL(proc_create_thread);
+DECLARE_SYSCALL(getrusage);
+DECLARE_SYSCALL(wait4);
 
 #endif // STELLUX_SYSCALL_HANDLERS_SYS_PROC_H
@@ -4,6 +4,7 @@
 #include "sched/sched.h"
 #include "sched/task.h"
 #include "sched/task_registry.h"
+#include "rc/rcu.h"
 #include "mm/uaccess.h"
 
 // musl passes sigsetsize = _NSIG/8 = 8 (64-bit sigset)
@@ -30,8 +31,8 @@ static int64_t kill_process_group(uint32_t group_id, uint32_t sig) {
 static int64_t send_to_thread(uint32_t tgid, uint32_t tid, uint32_t sig) {
     int64_t result = syscall::ESRCH;
 
-    sync::irq_state irq = sched::g_task_registry.lock();
-    sched::task* t = sched::g_task_registry.find_locked(tid);
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::task* t = sched::g_task_registry.find_rcu(tid);
     if (t && (tgid == 0 || (t->group && t->group->pid == tgid))) {
         if (sig != 0) {
             result = map_send_error(signals::send_to_task(t, sig));
@@ -43,7 +44,7 @@ static int64_t send_to_thread(uint32_t tgid, uint32_t tid, uint32_t sig) {
             result = denied ? syscall::EPERM : 0;
         }
     }
-    sched::g_task_registry.unlock(irq);
+    rc::rcu::read_unlock(irq);
 
     return result;
 }
@@ -169,14 +170,14 @@ DEFINE_SYSCALL2(kill, u_pid, u_sig) {
         // Any thread id resolves to its containing process (kill semantics
         // on Linux), and the signal is delivered process-wide
         int64_t result = syscall::ESRCH;
-        sync::irq_state irq = sched::g_task_registry.lock();
+        sync::irq_state irq = rc::rcu::read_lock();
         sched::task* t =
-            sched::g_task_registry.find_locked(static_cast<uint32_t>(pid));
+            sched::g_task_registry.find_rcu(static_cast<uint32_t>(pid));
         if (t && t->group) {
             result = sig ? map_send_error(signals::send_to_group(t->group, sig))
                          : 0;
         }
-        sched::g_task_registry.unlock(irq);
+        rc::rcu::read_unlock(irq);
         return result;
     }
 
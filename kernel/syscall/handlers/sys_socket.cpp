@@ -378,6 +378,7 @@ DEFINE_SYSCALL6(sendto, fd, buf, len, flags, dest_addr, addrlen) {
     if (result < 0) {
         return syscall::EIO;
     }
+    __atomic_fetch_add(&task->ru.net_tx_bytes, static_cast<uint64_t>(result), __ATOMIC_RELAXED);
     return result;
 }
 
@@ -431,6 +432,8 @@ DEFINE_SYSCALL6(recvfrom, fd, buf, len, flags, src_addr, addrlen) {
         return syscall::EIO;
     }
 
+    __atomic_fetch_add(&task->ru.net_rx_bytes, static_cast<uint64_t>(result), __ATOMIC_RELAXED);
+
     // Copy data to userspace
     int32_t copy_rc = mm::uaccess::copy_to_user(
         reinterpret_cast<void*>(buf), kbuf, static_cast<size_t>(result));
@@ -2,6 +2,7 @@
 #include "sched/sched.h"
 #include "sched/task.h"
 #include "sched/task_registry.h"
+#include "rc/rcu.h"
 #include "resource/handle_table.h"
 #include "resource/resource.h"
 #include "resource/providers/proc_provider.h"
@@ -40,14 +41,14 @@ constexpr uint64_t CLONE_SUPPORTED_EXTRAS =
 static bool group_exists(uint32_t group_id) {
     bool found = false;
 
-    sync::irq_state irq = sched::g_task_registry.lock();
-    sched::g_task_registry.for_each_locked([&](sched::task& t) {
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::g_task_registry.for_each_rcu([&](sched::task& t) {
         if (t.group &&
             __atomic_load_n(&t.group->group_id, __ATOMIC_ACQUIRE) == group_id) {
             found = true;
         }
     });
-    sched::g_task_registry.unlock(irq);
+    rc::rcu::read_unlock(irq);
 
     return found;
 }
@@ -327,12 +328,12 @@ DEFINE_SYSCALL1(getpgid, u_pid) {
     }
 
     int64_t result = syscall::ESRCH;
-    sync::irq_state irq = sched::g_task_registry.lock();
-    sched::task* t = sched::g_task_registry.find_locked(static_cast<uint32_t>(pid));
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::task* t = sched::g_task_registry.find_rcu(static_cast<uint32_t>(pid));
     if (t && t->group) {
         result = __atomic_load_n(&t->group->group_id, __ATOMIC_ACQUIRE);
     }
-    sched::g_task_registry.unlock(irq);
+    rc::rcu::read_unlock(irq);
 
     return result;
 }
@@ -8,6 +8,10 @@
 #include "dynpriv/dynpriv.h"
 #include "percpu/percpu.h"
 #include "common/logging.h"
+#include "trace/trace.h"
+#include "strace/strace.h"
+#include "syscall/syscall_stats.h"
+#include "clock/clock.h"
 
 constexpr uint32_t ELEVATION_CONTEXT_MASK = sched::TASK_FLAG_ELEVATED | sched::TASK_FLAG_IN_SYSCALL;
 
@@ -38,18 +42,45 @@ extern "C" __PRIVILEGED_CODE int64_t stlx_syscall_handler(
     this_cpu(current_task_exec)->flags |= sched::TASK_FLAG_IN_SYSCALL;
     this_cpu(percpu_is_elevated) = true;
 
+    TRACE(SYSCALL_ENTER, syscall_num, arg1, arg2);
+
+    sched::task* self = sched::current();
+    bool traced = strace::traced(self);
+    uint64_t start_ns = clock::now_ns();
+
+    // Open a system time stretch, scheduler accounting charges it while
+    // the handler runs. Elevated tasks are charged all their time anyway
+    if (self && !(self->exec.flags & sched::TASK_FLAG_ELEVATED)) {
+        __atomic_store_n(&self->sys_enter_ns, start_ns, __ATOMIC_RELAXED);
+    }
+    if (traced) {
+        const uint64_t args[6] = { arg1, arg2, arg3, arg4, arg5, arg6 };
+        strace::record_enter(self->tid, syscall_num, args);
+    }
+
     int64_t result;
 
     if (syscall_num < syscall::MAX_SYSCALL_NUM && syscall::g_syscall_table[syscall_num]) {
         result = syscall::g_syscall_table[syscall_num](arg1, arg2, arg3, arg4, arg5, arg6);
     } else {
-        sched::task* caller = sched::current();
         log::warn("syscall: unimplemented nr=%lu from tid=%d",
-                  syscall_num, caller ? caller->tid : -1);
+                  syscall_num, self ? self->tid : -1);
         result = syscall::ENOSYS;
     }
 
-    sched::task* self = sched::current();
+    uint64_t end_ns = clock::now_ns();
+    uint64_t dur_ns = end_ns - start_ns;
+    if (self) {
+        uint64_t entered = __atomic_exchange_n(&self->sys_enter_ns, 0, __ATOMIC_RELAXED);
+        if (entered && end_ns > entered) {
+            __atomic_fetch_add(&self->ru.sys_ns, end_ns - entered, __ATOMIC_RELAXED);
+        }
+        __atomic_fetch_add(&self->ru.syscalls, 1, __ATOMIC_RELAXED);
+    }
+#ifdef STLX_SYSCALL_STATS
+    syscall::account(syscall_num, dur_ns);
+#endif
+
     if (self && !(self->exec.flags & sched::TASK_FLAG_KERNEL)) {
         uint32_t fsig = signals::fatal_pending(self);
         if (fsig) {
@@ -61,6 +92,12 @@ extern "C" __PRIVILEGED_CODE int64_t stlx_syscall_handler(
         result = arch::deliver_pending_signal(self, result, syscall_num);
     }
 
+    if (traced) {
+        strace::record_exit(self->tid, syscall_num, result, dur_ns);
+    }
+
+    TRACE(SYSCALL_EXIT, syscall_num, result);
+
     // Return-boundary restore: dynamic runtime elevation follows the selected
     // task mode once syscall handling and switch teardown are complete.
     this_cpu(current_task_exec)->flags &= ~sched::TASK_FLAG_IN_SYSCALL;
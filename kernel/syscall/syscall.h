@@ -10,7 +10,7 @@ constexpr int32_t ERR_INIT = -1;
 
 // Syscall numbers
 constexpr uint64_t SYS_YIELD   = 1000;
-constexpr uint64_t SYS_ELEVATE = 1001;
+constexpr uint64_t SYS_ELEVATE = 1001; // also in x86_64 syscall_entry.S (fast path)
 
 // Process management
 constexpr uint64_t SYS_PROC_CREATE          = 1010;
@@ -29,6 +29,9 @@ constexpr uint64_t SYS_PTY_CREATE = 1020;
 constexpr uint64_t SYS_FUTEX_WAIT     = 1030;
 constexpr uint64_t SYS_FUTEX_WAKE     = 1031;
 constexpr uint64_t SYS_FUTEX_WAKE_ALL = 1032;
+constexpr uint64_t SYS_FUTEX_WAITV    = 1033;
+constexpr uint64_t SYS_FUTEX_LOCK_PI   = 1034;
+constexpr uint64_t SYS_FUTEX_UNLOCK_PI = 1035;
 
 /**
  * Architecture-specific syscall initialization (MSRs on x86, etc.)
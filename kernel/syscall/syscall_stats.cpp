@@ -0,0 +1,138 @@
+#include "syscall/syscall_stats.h"
+
+#ifdef STLX_SYSCALL_STATS
+
+#include "syscall/syscall_table.h"
+#include "percpu/percpu.h"
+#include "smp/smp.h"
+#include "mm/heap.h"
+#include "common/logging.h"
+
+namespace syscall {
+
+namespace {
+
+// Counter sets handed out per CPU. Numbers get a set the first time they
+// are called; numbers that find every set taken share set 0, reported by
+// read_overflow().
+constexpr uint32_t STAT_SLOTS = 160;
+
+struct cpu_syscall_stats {
+    syscall_stat slots[STAT_SLOTS];
+};
+
+static DEFINE_PER_CPU(cpu_syscall_stats*, syscall_stats);
+
+__PRIVILEGED_BSS static uint16_t g_slot_of[MAX_SYSCALL_NUM]; // 0 = none yet
+__PRIVILEGED_BSS static uint32_t g_next_slot;
+__PRIVILEGED_BSS static uint32_t g_ready;
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint16_t slot_for(uint64_t nr) {
+    uint16_t slot = __atomic_load_n(&g_slot_of[nr], __ATOMIC_ACQUIRE);
+    if (slot) {
+        return slot;
+    }
+    // Claim only below capacity, so the counter never runs past the sets
+    // and wraps around to hand out one that is already in use
+    uint32_t next = __atomic_load_n(&g_next_slot, __ATOMIC_RELAXED);
+    do {
+        if (next + 1 >= STAT_SLOTS) {
+            return 0;
+        }
+    } while (!__atomic_compare_exchange_n(&g_next_slot, &next, next + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    next++;
+    uint16_t expected = 0;
+    if (!__atomic_compare_exchange_n(&g_slot_of[nr], &expected,
+                                     static_cast<uint16_t>(next), false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return expected; // another CPU won, its set is used and ours is wasted
+    }
+    return static_cast<uint16_t>(next);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void sum_slot(uint16_t slot, syscall_stat* out) {
+    *out = {};
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        const syscall_stat& s = per_cpu_on(syscall_stats, cpu)->slots[slot];
+        out->count += __atomic_load_n(&s.count, __ATOMIC_RELAXED);
+        out->total_ns += __atomic_load_n(&s.total_ns, __ATOMIC_RELAXED);
+        uint64_t max = __atomic_load_n(&s.max_ns, __ATOMIC_RELAXED);
+        if (max > out->max_ns) {
+            out->max_ns = max;
+        }
+        for (uint32_t b = 0; b < SYSCALL_HIST_BUCKETS; b++) {
+            out->hist[b] += __atomic_load_n(&s.hist[b], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+} // anonymous namespace
+
+__PRIVILEGED_CODE int32_t init_stats() {
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        auto* st = static_cast<cpu_syscall_stats*>(
+            heap::kzalloc(sizeof(cpu_syscall_stats)));
+        if (!st) {
+            log::error("syscall: failed to allocate stats for cpu %u", cpu);
+            return ERR_INIT;
+        }
+        per_cpu_on(syscall_stats, cpu) = st;
+    }
+    __atomic_store_n(&g_ready, 1, __ATOMIC_RELEASE);
+    return OK;
+}
+
+__PRIVILEGED_CODE void account(uint64_t nr, uint64_t dur_ns) {
+    if (!__atomic_load_n(&g_ready, __ATOMIC_ACQUIRE) || nr >= MAX_SYSCALL_NUM) {
+        return;
+    }
+
+    // Atomic updates, the task can migrate between the lookup and the add
+    syscall_stat& s = this_cpu(syscall_stats)->slots[slot_for(nr)];
+    uint32_t bucket = 0;
+    for (uint64_t v = dur_ns >> 8; v > 1 && bucket < SYSCALL_HIST_BUCKETS - 1; v >>= 1) {
+        bucket++;
+    }
+    __atomic_fetch_add(&s.count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s.total_ns, dur_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s.hist[bucket], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&s.max_ns, __ATOMIC_RELAXED);
+    while (dur_ns > max &&
+           !__atomic_compare_exchange_n(&s.max_ns, &max, dur_ns, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+__PRIVILEGED_CODE bool read_stat(uint64_t nr, syscall_stat* out) {
+    if (nr >= MAX_SYSCALL_NUM || !__atomic_load_n(&g_ready, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    uint16_t slot = __atomic_load_n(&g_slot_of[nr], __ATOMIC_ACQUIRE);
+    if (!slot) {
+        return false;
+    }
+
+    sum_slot(slot, out);
+    return out->count != 0;
+}
+
+__PRIVILEGED_CODE bool read_overflow(syscall_stat* out) {
+    if (!__atomic_load_n(&g_ready, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    sum_slot(0, out);
+    return out->count != 0;
+}
+
+} // namespace syscall
+
+#endif // STLX_SYSCALL_STATS
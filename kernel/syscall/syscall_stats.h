@@ -0,0 +1,61 @@
+#ifndef STELLUX_SYSCALL_SYSCALL_STATS_H
+#define STELLUX_SYSCALL_SYSCALL_STATS_H
+
+#include "common/types.h"
+#include "syscall/syscall.h"
+
+namespace syscall {
+
+#ifdef STLX_SYSCALL_STATS
+
+constexpr uint32_t SYSCALL_HIST_BUCKETS = 24;
+
+/**
+ * Totals of one syscall number, built with SYSCALL_STATS=1. Every CPU
+ * counts the calls that finish on it; read_stat() sums the CPUs.
+ * Durations cover the handler only, not signal delivery on the way out.
+ */
+struct syscall_stat {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    // Calls by duration: bucket b counts 256 << b up to 256 << (b + 1)
+    // ns, bucket 0 everything below 512, the last one everything above
+    uint64_t hist[SYSCALL_HIST_BUCKETS];
+};
+
+/**
+ * @brief Allocate the per-CPU counters for every registered syscall.
+ * Call after init_syscall_table() and smp::init(). Calls made before
+ * this are not counted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init_stats();
+
+/**
+ * @brief Count one finished syscall on the current CPU. Per-task counts
+ * are kept regardless of SYSCALL_STATS, see sched::task_rusage.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void account(uint64_t nr, uint64_t dur_ns);
+
+/**
+ * @brief Sum the counters of nr across CPUs.
+ * @return false if nr has never been called.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool read_stat(uint64_t nr, syscall_stat* out);
+
+/**
+ * @brief Sum the calls that found every counter set taken. They are
+ * counted together here instead of under their own numbers.
+ * @return false if no call has overflowed.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool read_overflow(syscall_stat* out);
+
+#endif // STLX_SYSCALL_STATS
+
+} // namespace syscall
+
+#endif // STELLUX_SYSCALL_SYSCALL_STATS_H
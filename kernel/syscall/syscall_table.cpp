@@ -25,10 +25,13 @@
 namespace syscall {
 
 handler_t g_syscall_table[MAX_SYSCALL_NUM];
+const char* g_syscall_names[MAX_SYSCALL_NUM];
 
 __PRIVILEGED_CODE void init_syscall_table() {
-    for (uint64_t i = 0; i < MAX_SYSCALL_NUM; i++)
+    for (uint64_t i = 0; i < MAX_SYSCALL_NUM; i++) {
         g_syscall_table[i] = nullptr;
+        g_syscall_names[i] = nullptr;
+    }
 
     REGISTER_SYSCALL(linux_nr::IOCTL,           ioctl);
     REGISTER_SYSCALL(linux_nr::READV,           readv);
@@ -78,6 +81,7 @@ __PRIVILEGED_CODE void init_syscall_table() {
     REGISTER_SYSCALL(linux_nr::SET_TID_ADDRESS, set_tid_address);
     REGISTER_SYSCALL(linux_nr::CLONE,           clone);
     REGISTER_SYSCALL(linux_nr::FUTEX,           futex);
+    REGISTER_SYSCALL(linux_nr::FUTEX_WAITV,     futex_waitv);
     REGISTER_SYSCALL(linux_nr::SCHED_YIELD,     sched_yield);
     REGISTER_SYSCALL(linux_nr::MADVISE,         madvise);
     REGISTER_SYSCALL(linux_nr::NANOSLEEP,       nanosleep);
@@ -85,6 +89,8 @@ __PRIVILEGED_CODE void init_syscall_table() {
     REGISTER_SYSCALL(linux_nr::CLOCK_GETRES,    clock_getres);
     REGISTER_SYSCALL(linux_nr::GETTIMEOFDAY,    gettimeofday);
     REGISTER_SYSCALL(linux_nr::UNAME,           uname);
+    REGISTER_SYSCALL(linux_nr::GETRUSAGE,       getrusage);
+    REGISTER_SYSCALL(linux_nr::WAIT4,           wait4);
 
     REGISTER_SYSCALL(linux_nr::SOCKET,      socket);
     REGISTER_SYSCALL(linux_nr::SOCKETPAIR,  socketpair);
@@ -137,6 +143,9 @@ __PRIVILEGED_CODE void init_syscall_table() {
     REGISTER_SYSCALL(SYS_FUTEX_WAIT,     futex_wait);
     REGISTER_SYSCALL(SYS_FUTEX_WAKE,     futex_wake);
     REGISTER_SYSCALL(SYS_FUTEX_WAKE_ALL, futex_wake_all);
+    REGISTER_SYSCALL(SYS_FUTEX_WAITV,    futex_wait_multiple);
+    REGISTER_SYSCALL(SYS_FUTEX_LOCK_PI,   futex_lock_pi);
+    REGISTER_SYSCALL(SYS_FUTEX_UNLOCK_PI, futex_unlock_pi);
 
     register_arch_syscalls();
 }
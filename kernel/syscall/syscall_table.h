@@ -15,6 +15,7 @@ constexpr int64_t ESRCH  = -3;
 constexpr int64_t EINTR  = -4;
 constexpr int64_t EIO    = -5;
 constexpr int64_t EBADF  = -9;
+constexpr int64_t ECHILD = -10;
 constexpr int64_t ENOMEM = -12;
 constexpr int64_t EACCES = -13;
 constexpr int64_t EFAULT = -14;
@@ -51,6 +52,9 @@ constexpr int64_t ERESTARTSYS = -512;
 
 extern handler_t g_syscall_table[MAX_SYSCALL_NUM];
 
+// Handler name of every registered number, nullptr elsewhere
+extern const char* g_syscall_names[MAX_SYSCALL_NUM];
+
 /**
  * @note Privilege: **required**
  */
@@ -103,7 +107,10 @@ __PRIVILEGED_CODE void register_arch_syscalls();
         uint64_t p1, uint64_t p2, uint64_t p3, \
         uint64_t p4, uint64_t p5, uint64_t p6)
 
-#define REGISTER_SYSCALL(num, name) \
-    syscall::g_syscall_table[num] = sys_##name
+#define REGISTER_SYSCALL(num, name)                 \
+    do {                                            \
+        syscall::g_syscall_table[num] = sys_##name; \
+        syscall::g_syscall_names[num] = #name;      \
+    } while (0)
 
 #endif // STELLUX_SYSCALL_SYSCALL_TABLE_H
@@ -0,0 +1,311 @@
+#include "sysstat/snapshot.h"
+#include "sysstat/sysstat.h"
+#include "fs/node.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs/devfs/devfs.h"
+#include "mm/heap.h"
+#include "mm/pmm.h"
+#include "mm/mm.h"
+#include "mm/paging.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "sched/task_registry.h"
+#include "rc/rcu.h"
+#include "smp/smp.h"
+#include "clock/clock.h"
+#include "common/logging.h"
+#include "common/string.h"
+
+namespace sysstat {
+
+namespace {
+
+// Tasks looked up per RCU read-side section
+constexpr uint32_t TASK_CHUNK = 32;
+
+// Spare tid slots for tasks created between sizing and copying
+constexpr uint32_t TID_SLACK = 64;
+
+/**
+ * Copy the tids of all registered tasks into a kernel heap array.
+ * @return The array (caller frees it), nullptr if out of memory.
+ */
+uint32_t* copy_tids(uint32_t* out_count) {
+    uint32_t cap = sched::g_task_registry.count() + TID_SLACK;
+    for (;;) {
+        auto* tids = static_cast<uint32_t*>(heap::kzalloc(cap * sizeof(uint32_t)));
+        if (!tids) {
+            return nullptr;
+        }
+        uint32_t n = sched::g_task_registry.snapshot_tids(tids, cap);
+        // A full array may have cut the walk short
+        if (n < cap) {
+            *out_count = n;
+            return tids;
+        }
+        heap::kfree(tids);
+        cap *= 2;
+    }
+}
+
+void fill_task(snapshot_task* rec, sched::task& t) {
+    rec->tid = t.tid;
+    rec->pid = t.group ? t.group->pid : 0;
+    rec->state = __atomic_load_n(&t.state, __ATOMIC_RELAXED);
+    rec->cpu = t.exec.cpu;
+    rec->run_ns = __atomic_load_n(&t.run_ns, __ATOMIC_RELAXED);
+    rec->rss_kb = t.exec.mm_ctx
+        ? __atomic_load_n(&t.exec.mm_ctx->rss_pages, __ATOMIC_RELAXED) * (pmm::PAGE_SIZE / 1024)
+        : 0;
+    sched::read_task_rusage(&t, &rec->usage);
+    size_t len = string::strnlen(t.name, SNAPSHOT_NAME_LEN - 1);
+    string::memcpy(rec->name, t.name, len);
+    rec->name[len] = '\0';
+}
+
+/**
+ * /dev/sysinfo/snapshot. Like the text nodes every open holds its own
+ * snapshot, regenerated by a read from offset zero, but the buffer is
+ * sized to the task count at capture time instead of a fixed cap.
+ */
+class snapshot_node : public fs::node {
+public:
+    explicit snapshot_node(const char* name)
+        : fs::node(fs::node_type::char_device, nullptr, name) {}
+
+    int32_t open(fs::file* f, uint32_t) override {
+        auto* snap = static_cast<snapshot*>(heap::uzalloc(sizeof(snapshot)));
+        if (!snap) {
+            return fs::ERR_NOMEM;
+        }
+        f->set_private_data(snap);
+        return fs::OK;
+    }
+
+    int32_t on_close(fs::file* f) override {
+        auto* snap = static_cast<snapshot*>(f->private_data());
+        if (snap) {
+            f->set_private_data(nullptr);
+            if (snap->data) {
+                heap::ufree(snap->data);
+            }
+            heap::ufree(snap);
+        }
+        return fs::OK;
+    }
+
+    ssize_t read(fs::file* f, void* buf, size_t count) override {
+        if (!f || !buf) {
+            return fs::ERR_BADF;
+        }
+        auto* snap = static_cast<snapshot*>(f->private_data());
+        if (!snap) {
+            return fs::ERR_BADF;
+        }
+
+        int64_t off = f->offset();
+        if (off < 0) {
+            return fs::ERR_INVAL;
+        }
+
+        if (off == 0) {
+            int32_t rc = capture(snap);
+            if (rc != fs::OK) {
+                return rc;
+            }
+        }
+
+        size_t offset = static_cast<size_t>(off);
+        if (offset >= snap->len) {
+            return 0;
+        }
+        if (offset + count > snap->len) {
+            count = snap->len - offset;
+        }
+        string::memcpy(buf, snap->data + offset, count);
+        f->set_offset(static_cast<int64_t>(offset + count));
+        return static_cast<ssize_t>(count);
+    }
+
+    // Rewinding lets a sampler keep one open and recapture each period
+    int64_t seek(fs::file* f, int64_t offset, int whence) override {
+        if (!f || whence != fs::SEEK_SET || offset < 0) {
+            return fs::ERR_INVAL;
+        }
+        f->set_offset(offset);
+        return offset;
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = 0;
+        return fs::OK;
+    }
+
+private:
+    struct snapshot {
+        uint8_t* data;
+        size_t   cap;
+        size_t   len;
+    };
+
+    static int32_t capture(snapshot* snap) {
+        uint32_t tid_count = 0;
+        uint32_t* tids = copy_tids(&tid_count);
+        if (!tids) {
+            return fs::ERR_NOMEM;
+        }
+
+        uint32_t cpu_count = smp::cpu_count();
+        size_t cpu_offset = sizeof(snapshot_header);
+        size_t task_offset = cpu_offset + cpu_count * sizeof(snapshot_cpu);
+        size_t need = task_offset + tid_count * sizeof(snapshot_task);
+
+        // Snapshots hold data on its way to userland, so they live in
+        // unprivileged memory like the text nodes' buffers
+        if (snap->cap < need) {
+            if (snap->data) {
+                heap::ufree(snap->data);
+            }
+            snap->data = static_cast<uint8_t*>(heap::uzalloc(need));
+            snap->cap = snap->data ? need : 0;
+            snap->len = 0;
+            if (!snap->data) {
+                heap::kfree(tids);
+                return fs::ERR_NOMEM;
+            }
+        }
+
+        auto* hdr = reinterpret_cast<snapshot_header*>(snap->data);
+        string::memset(hdr, 0, sizeof(*hdr));
+        hdr->magic = SNAPSHOT_MAGIC;
+        hdr->version = SNAPSHOT_VERSION;
+        hdr->header_size = sizeof(snapshot_header);
+        hdr->timestamp_ns = clock::now_ns();
+        hdr->tick_hz = sched::read_cpu_accounting_stats(0).tick_hz;
+        hdr->page_size = pmm::PAGE_SIZE;
+        hdr->total_pages = pmm::total_page_count();
+        hdr->free_pages = pmm::free_page_count();
+        hdr->cpu_count = cpu_count;
+        hdr->cpu_record_size = sizeof(snapshot_cpu);
+        hdr->cpu_offset = static_cast<uint32_t>(cpu_offset);
+        hdr->task_record_size = sizeof(snapshot_task);
+        hdr->task_offset = static_cast<uint32_t>(task_offset);
+
+        auto* cpus = reinterpret_cast<snapshot_cpu*>(snap->data + cpu_offset);
+        for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+            sched::cpu_accounting_stats stats = sched::read_cpu_accounting_stats(cpu);
+            sched::wake_stats ws = sched::read_wake_stats(cpu);
+            cpus[cpu] = {
+                stats.busy_ticks, stats.idle_ticks,
+                ws.prev_idle, ws.affine, ws.cache_hot, ws.idle_cpu,
+                ws.prev_busy, ws.migrations, ws.remote, ws.pinned,
+            };
+        }
+
+        auto* tasks = reinterpret_cast<snapshot_task*>(snap->data + task_offset);
+        uint32_t task_count = 0;
+        for (uint32_t base = 0; base < tid_count; base += TASK_CHUNK) {
+            uint32_t end = base + TASK_CHUNK < tid_count ? base + TASK_CHUNK : tid_count;
+            sync::irq_state irq = rc::rcu::read_lock();
+            for (uint32_t i = base; i < end; i++) {
+                sched::task* t = sched::g_task_registry.find_rcu(tids[i]);
+                if (t) {
+                    fill_task(&tasks[task_count++], *t);
+                }
+            }
+            rc::rcu::read_unlock(irq);
+        }
+        heap::kfree(tids);
+
+        hdr->task_count = task_count;
+        snap->len = task_offset + task_count * sizeof(snapshot_task);
+        return fs::OK;
+    }
+};
+
+/**
+ * /dev/sysinfo/cpupage. Maps sched::cpu_time_page read-only so monitors
+ * sample per-CPU time without a syscall; read() returns the same bytes
+ * for readers that cannot map it.
+ */
+class cpupage_node : public fs::node {
+public:
+    explicit cpupage_node(const char* name)
+        : fs::node(fs::node_type::char_device, nullptr, name) {
+        m_phys = sched::cpu_time_page_phys(&m_size);
+    }
+
+    ssize_t read(fs::file* f, void* buf, size_t count) override {
+        if (!f || !buf) {
+            return fs::ERR_BADF;
+        }
+        int64_t off = f->offset();
+        if (off < 0) {
+            return fs::ERR_INVAL;
+        }
+        size_t offset = static_cast<size_t>(off);
+        if (offset >= m_size) {
+            return 0;
+        }
+        if (offset + count > m_size) {
+            count = m_size - offset;
+        }
+        string::memcpy(buf, static_cast<uint8_t*>(paging::phys_to_virt(m_phys)) + offset, count);
+        f->set_offset(static_cast<int64_t>(offset + count));
+        return static_cast<ssize_t>(count);
+    }
+
+    int32_t mmap(fs::file*, mm::mm_context* mm_ctx, uintptr_t addr,
+                 size_t length, uint32_t prot, uint32_t map_flags,
+                 uint64_t offset, uintptr_t* out_addr) override {
+        size_t aligned_len = pmm::page_align_up(length);
+        if (aligned_len < length || offset != 0 || aligned_len > m_size) {
+            return mm::MM_CTX_ERR_INVALID_ARG;
+        }
+        return mm::mm_context_map_device(
+            mm_ctx, m_phys, length, prot, paging::PAGE_NORMAL,
+            map_flags, addr, out_addr, true);
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = m_size;
+        return fs::OK;
+    }
+
+private:
+    pmm::phys_addr_t m_phys;
+    size_t           m_size;
+};
+
+template <typename Node>
+__PRIVILEGED_CODE int32_t add_node(fs::node* dir, const char* name) {
+    void* mem = heap::kzalloc(sizeof(Node));
+    if (!mem) {
+        log::error("sysstat: failed to allocate /dev/sysinfo/%s", name);
+        return ERR;
+    }
+    auto* node = new (mem) Node(name);
+    if (devfs::add_char_device_at(dir, node) != devfs::OK) {
+        log::error("sysstat: failed to register /dev/sysinfo/%s", name);
+        node->~Node();
+        heap::kfree(mem);
+        return ERR;
+    }
+    return OK;
+}
+
+} // anonymous namespace
+
+__PRIVILEGED_CODE int32_t init_binary_nodes(fs::node* dir) {
+    if (add_node<snapshot_node>(dir, "snapshot") != OK) {
+        return ERR;
+    }
+    return add_node<cpupage_node>(dir, "cpupage");
+}
+
+} // namespace sysstat
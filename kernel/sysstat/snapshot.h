@@ -0,0 +1,85 @@
+#ifndef STELLUX_SYSSTAT_SNAPSHOT_H
+#define STELLUX_SYSSTAT_SNAPSHOT_H
+
+#include "common/types.h"
+#include "sched/rusage.h"
+
+namespace fs { class node; }
+
+namespace sysstat {
+
+/*
+ * Binary /dev/sysinfo/snapshot format, captured by a read from offset
+ * zero like the text nodes.
+ *
+ * A snapshot_header is followed by cpu_count CPU records and task_count
+ * task records at the offsets and strides the header gives. Within a
+ * version fields are only ever appended to the header and the records,
+ * so readers step by the sizes in the header and ignore bytes past the
+ * fields they know. Incompatible changes bump SNAPSHOT_VERSION.
+ *
+ * Tasks are captured without the registry lock and without one long
+ * read-side section: their tids are copied out first, then each chunk
+ * of tids is looked up and recorded in a short RCU section of its own.
+ * A task that exits in between is left out.
+ */
+
+constexpr uint32_t SNAPSHOT_MAGIC    = 0x50414E53; // "SNAP"
+constexpr uint16_t SNAPSHOT_VERSION  = 1;
+constexpr size_t   SNAPSHOT_NAME_LEN = 32;
+
+struct snapshot_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t timestamp_ns;     // clock::now_ns() at capture
+    uint32_t tick_hz;
+    uint32_t page_size;
+    uint64_t total_pages;
+    uint64_t free_pages;
+    uint32_t cpu_count;
+    uint32_t cpu_record_size;
+    uint32_t cpu_offset;
+    uint32_t task_count;
+    uint32_t task_record_size;
+    uint32_t task_offset;
+};
+static_assert(sizeof(snapshot_header) == 64, "snapshot_header is shared with userland");
+
+// Busy/idle time and wakeup placement counters (see sched::wake_stats)
+struct snapshot_cpu {
+    uint64_t busy_ticks;
+    uint64_t idle_ticks;
+    uint64_t wake_prev_idle;
+    uint64_t wake_affine;
+    uint64_t wake_cache_hot;
+    uint64_t wake_idle_cpu;
+    uint64_t wake_prev_busy;
+    uint64_t wake_migrations;
+    uint64_t wake_remote;
+    uint64_t wake_pinned;
+};
+static_assert(sizeof(snapshot_cpu) == 80, "snapshot_cpu is shared with userland");
+
+struct snapshot_task {
+    uint32_t           tid;
+    uint32_t           pid;   // 0 for kernel tasks
+    uint32_t           state; // sched::TASK_STATE_*
+    uint32_t           cpu;
+    uint64_t           run_ns;
+    uint64_t           rss_kb;
+    sched::task_rusage usage;
+    char               name[SNAPSHOT_NAME_LEN]; // truncated, NUL-terminated
+};
+static_assert(sizeof(snapshot_task) == 152, "snapshot_task is shared with userland");
+
+/**
+ * @brief Register the binary nodes under /dev/sysinfo: snapshot, and
+ * cpupage, the read-only mappable sched::cpu_time_page.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init_binary_nodes(fs::node* dir);
+
+} // namespace sysstat
+
+#endif // STELLUX_SYSSTAT_SNAPSHOT_H
@@ -1,17 +1,25 @@
 #include "sysstat/sysstat.h"
+#include "sysstat/snapshot.h"
 #include "fs/node.h"
 #include "fs/file.h"
 #include "fs/fs.h"
 #include "fs/devfs/devfs.h"
 #include "mm/heap.h"
 #include "mm/pmm.h"
+#include "mm/mm.h"
 #include "sched/sched.h"
 #include "sched/task.h"
 #include "sched/task_registry.h"
+#include "rc/rcu.h"
 #include "smp/smp.h"
 #include "clock/clock.h"
+#include "dynpriv/dynpriv.h"
 #include "common/logging.h"
 #include "common/string.h"
+#include "syscall/syscall_stats.h"
+#include "syscall/syscall_table.h"
+#include "sync/lockstat.h"
+#include "common/sort.h"
 
 namespace sysstat {
 
@@ -74,6 +82,26 @@ size_t generate_cpu(char* buf, size_t cap) {
     return pos;
 }
 
+size_t generate_sched(char* buf, size_t cap) {
+    size_t pos = 0;
+    uint32_t cpu_count = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+        sched::wake_stats ws = sched::read_wake_stats(cpu);
+        const uint64_t fields[] = {
+            ws.prev_idle, ws.affine, ws.cache_hot, ws.idle_cpu,
+            ws.prev_busy, ws.migrations, ws.remote, ws.pinned,
+        };
+        pos = append_str(buf, cap, pos, "cpu");
+        pos = append_u64(buf, cap, pos, cpu);
+        for (uint64_t value : fields) {
+            pos = append_str(buf, cap, pos, " ");
+            pos = append_u64(buf, cap, pos, value);
+        }
+        pos = append_str(buf, cap, pos, "\n");
+    }
+    return pos;
+}
+
 size_t generate_mem(char* buf, size_t cap) {
     uint64_t total = pmm::total_page_count();
     uint64_t free_count = pmm::free_page_count();
@@ -98,9 +126,14 @@ size_t generate_uptime(char* buf, size_t cap) {
 }
 
 size_t generate_tasks(char* buf, size_t cap) {
+    // Task CPU time is kept in nanoseconds, the ticks, utime and stime
+    // columns report it in scheduler tick units
+    uint32_t hz = sched::read_cpu_accounting_stats(0).tick_hz;
+    uint64_t tick_ns = hz ? 1000000000ULL / hz : 0;
+
     size_t pos = 0;
-    sync::irq_state irq = sched::g_task_registry.lock();
-    sched::g_task_registry.for_each_locked([&](sched::task& t) {
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::g_task_registry.for_each_rcu([&](sched::task& t) {
         pos = append_u64(buf, cap, pos, t.tid);
         pos = append_str(buf, cap, pos, " ");
         pos = append_u64(buf, cap, pos, t.group ? t.group->pid : 0);
@@ -109,15 +142,193 @@ size_t generate_tasks(char* buf, size_t cap) {
         pos = append_str(buf, cap, pos, " ");
         pos = append_u64(buf, cap, pos, t.exec.cpu);
         pos = append_str(buf, cap, pos, " ");
-        pos = append_u64(buf, cap, pos,
-                         __atomic_load_n(&t.run_ticks, __ATOMIC_RELAXED));
+        uint64_t run_ns = __atomic_load_n(&t.run_ns, __ATOMIC_RELAXED);
+        pos = append_u64(buf, cap, pos, tick_ns ? run_ns / tick_ns : 0);
+
+        sched::task_rusage ru;
+        sched::read_task_rusage(&t, &ru);
+        uint64_t rss_kb = t.exec.mm_ctx
+            ? __atomic_load_n(&t.exec.mm_ctx->rss_pages, __ATOMIC_RELAXED) * (pmm::PAGE_SIZE / 1024)
+            : 0;
+        const uint64_t fields[] = {
+            tick_ns ? ru.user_ns / tick_ns : 0, tick_ns ? ru.sys_ns / tick_ns : 0,
+            ru.minflt, ru.nvcsw, ru.nivcsw, ru.syscalls,
+            ru.read_bytes, ru.write_bytes, ru.net_rx_bytes, ru.net_tx_bytes,
+            rss_kb, ru.maxrss_kb,
+        };
+        for (uint64_t value : fields) {
+            pos = append_str(buf, cap, pos, " ");
+            pos = append_u64(buf, cap, pos, value);
+        }
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_str(buf, cap, pos, t.name);
+        pos = append_str(buf, cap, pos, "\n");
+    });
+    rc::rcu::read_unlock(irq);
+    return pos;
+}
+
+#ifdef STLX_ELEVATE_STATS
+size_t generate_elevate(char* buf, size_t cap) {
+    size_t pos = 0;
+    for (dynpriv::elevate_site* site = dynpriv::first_site(); site; site = site->next) {
+        pos = append_str(buf, cap, pos, site->file);
+        pos = append_str(buf, cap, pos, ":");
+        pos = append_u64(buf, cap, pos, site->line);
+        const uint64_t fields[] = {
+            __atomic_load_n(&site->transitions, __ATOMIC_RELAXED),
+            __atomic_load_n(&site->nested, __ATOMIC_RELAXED),
+            __atomic_load_n(&site->cycles, __ATOMIC_RELAXED),
+        };
+        for (uint64_t value : fields) {
+            pos = append_str(buf, cap, pos, " ");
+            pos = append_u64(buf, cap, pos, value);
+        }
+        for (uint32_t b = 0; b < dynpriv::ELEVATE_HIST_BUCKETS; b++) {
+            pos = append_str(buf, cap, pos, " ");
+            pos = append_u64(buf, cap, pos,
+                             __atomic_load_n(&site->hist[b], __ATOMIC_RELAXED));
+        }
+        pos = append_str(buf, cap, pos, "\n");
+    }
+    return pos;
+}
+#endif // STLX_ELEVATE_STATS
+
+#ifdef STLX_SYSCALL_STATS
+size_t append_syscall_stat(char* buf, size_t cap, size_t pos,
+                           const syscall::syscall_stat& st) {
+    const uint64_t fields[] = { st.count, st.total_ns, st.max_ns };
+    for (uint64_t value : fields) {
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_u64(buf, cap, pos, value);
+    }
+    for (uint32_t b = 0; b < syscall::SYSCALL_HIST_BUCKETS; b++) {
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_u64(buf, cap, pos, st.hist[b]);
+    }
+    return append_str(buf, cap, pos, "\n");
+}
+
+size_t generate_syscalls(char* buf, size_t cap) {
+    size_t pos = 0;
+    for (uint64_t nr = 0; nr < syscall::MAX_SYSCALL_NUM; nr++) {
+        syscall::syscall_stat st;
+        if (!syscall::read_stat(nr, &st)) {
+            continue;
+        }
+        const char* name = syscall::g_syscall_names[nr];
+        pos = append_str(buf, cap, pos, "nr ");
+        pos = append_u64(buf, cap, pos, nr);
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_str(buf, cap, pos, name ? name : "-");
+        pos = append_syscall_stat(buf, cap, pos, st);
+    }
+
+    // Calls of numbers that found every counter set taken
+    syscall::syscall_stat over;
+    if (syscall::read_overflow(&over)) {
+        pos = append_str(buf, cap, pos, "overflow");
+        pos = append_syscall_stat(buf, cap, pos, over);
+    }
+
+    sync::irq_state irq = rc::rcu::read_lock();
+    sched::g_task_registry.for_each_rcu([&](sched::task& t) {
+        uint64_t calls = __atomic_load_n(&t.ru.syscalls, __ATOMIC_RELAXED);
+        if (!calls) {
+            return;
+        }
+        pos = append_str(buf, cap, pos, "task ");
+        pos = append_u64(buf, cap, pos, t.tid);
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_u64(buf, cap, pos, t.group ? t.group->pid : 0);
+        pos = append_str(buf, cap, pos, " ");
+        pos = append_u64(buf, cap, pos, calls);
         pos = append_str(buf, cap, pos, " ");
         pos = append_str(buf, cap, pos, t.name);
         pos = append_str(buf, cap, pos, "\n");
     });
-    sched::g_task_registry.unlock(irq);
+    rc::rcu::read_unlock(irq);
+    return pos;
+}
+#endif // STLX_SYSCALL_STATS
+
+#ifdef STLX_LOCKSTAT
+size_t append_site(char* buf, size_t cap, size_t pos, const char* file, uint32_t line) {
+    pos = append_str(buf, cap, pos, file);
+    pos = append_str(buf, cap, pos, ":");
+    return append_u64(buf, cap, pos, line);
+}
+
+size_t generate_locks(char* buf, size_t cap) {
+    using sync::lockstat::class_stats;
+    using sync::lockstat::site_stats;
+
+    auto* classes = static_cast<class_stats*>(
+        heap::kzalloc(sync::lockstat::MAX_CLASSES * sizeof(class_stats)));
+    if (!classes) {
+        return 0;
+    }
+    size_t count = sync::lockstat::read_classes(classes, sync::lockstat::MAX_CLASSES);
+
+    // Most waited on first, then most held
+    sort::heap_sort(classes, count, [](const class_stats& a, const class_stats& b) {
+        if (a.wait_cycles != b.wait_cycles) {
+            return a.wait_cycles > b.wait_cycles;
+        }
+        return a.hold_cycles > b.hold_cycles;
+    });
+
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        class_stats& c = classes[i];
+        if (c.by_site) {
+            pos = append_str(buf, cap, pos, "@");
+        }
+        pos = append_site(buf, cap, pos, c.file, c.line);
+        pos = append_str(buf, cap, pos,
+                         c.kind == sync::lockstat::KIND_RWSEM ? " rwsem" :
+                         c.kind == sync::lockstat::KIND_MUTEX ? " mutex" : " spin");
+        const uint64_t fields[] = {
+            c.acquisitions, c.contended, c.wait_cycles, c.hold_cycles,
+            c.max_wait_cycles, c.max_hold_cycles,
+        };
+        for (uint64_t value : fields) {
+            pos = append_str(buf, cap, pos, " ");
+            pos = append_u64(buf, cap, pos, value);
+        }
+        pos = append_str(buf, cap, pos, "\n");
+
+        sort::heap_sort(c.sites, c.site_count, [](const site_stats& a, const site_stats& b) {
+            if (a.wait_cycles != b.wait_cycles) {
+                return a.wait_cycles > b.wait_cycles;
+            }
+            return a.acquisitions > b.acquisitions;
+        });
+        for (uint32_t j = 0; j < c.site_count; j++) {
+            const site_stats& st = c.sites[j];
+            pos = append_str(buf, cap, pos, " site ");
+            pos = append_site(buf, cap, pos, st.file, st.line);
+            const uint64_t site_fields[] = {
+                st.acquisitions, st.contended, st.wait_cycles, st.inherited,
+            };
+            for (uint64_t value : site_fields) {
+                pos = append_str(buf, cap, pos, " ");
+                pos = append_u64(buf, cap, pos, value);
+            }
+            pos = append_str(buf, cap, pos, "\n");
+        }
+        if (c.other_sites) {
+            pos = append_str(buf, cap, pos, " site other ");
+            pos = append_u64(buf, cap, pos, c.other_sites);
+            pos = append_str(buf, cap, pos, "\n");
+        }
+    }
+
+    heap::kfree(classes);
     return pos;
 }
+#endif // STLX_LOCKSTAT
 
 /**
  * A readable devfs text node. Every open holds its own snapshot buffer
@@ -128,10 +339,11 @@ size_t generate_tasks(char* buf, size_t cap) {
 class stats_node : public fs::node {
 public:
     using generator = size_t (*)(char* buf, size_t cap);
+    using resetter = void (*)();
 
-    stats_node(const char* name, generator gen, size_t cap)
+    stats_node(const char* name, generator gen, size_t cap, resetter reset)
         : fs::node(fs::node_type::char_device, nullptr, name),
-          m_generate(gen), m_cap(cap) {}
+          m_generate(gen), m_reset(reset), m_cap(cap) {}
 
     int32_t open(fs::file* f, uint32_t) override {
         // Snapshots hold formatted text on its way to userland, so
@@ -186,6 +398,15 @@ public:
         return static_cast<ssize_t>(count);
     }
 
+    // Nodes with a resetter zero their counters on any write
+    ssize_t write(fs::file*, const void*, size_t count) override {
+        if (!m_reset) {
+            return fs::ERR_NOSYS;
+        }
+        m_reset();
+        return static_cast<ssize_t>(count);
+    }
+
     int32_t getattr(fs::vattr* attr) override {
         if (!attr) return fs::ERR_INVAL;
         attr->type = fs::node_type::char_device;
@@ -200,6 +421,7 @@ private:
     };
 
     generator m_generate;
+    resetter  m_reset;
     size_t    m_cap;
 };
 
@@ -216,11 +438,22 @@ __PRIVILEGED_CODE int32_t init() {
         const char*           name;
         stats_node::generator gen;
         size_t                cap;
+        stats_node::resetter  reset;
     } nodes[] = {
-        { "cpu",    generate_cpu,    64 * MAX_CPUS },
-        { "mem",    generate_mem,    128 },
-        { "uptime", generate_uptime, 32 },
-        { "tasks",  generate_tasks,  16384 },
+        { "cpu",    generate_cpu,    64 * MAX_CPUS,  nullptr },
+        { "mem",    generate_mem,    128,            nullptr },
+        { "uptime", generate_uptime, 32,             nullptr },
+        { "tasks",  generate_tasks,  65536,          nullptr },
+        { "sched",  generate_sched,  160 * MAX_CPUS, nullptr },
+#ifdef STLX_ELEVATE_STATS
+        { "elevate", generate_elevate, 65536, nullptr },
+#endif
+#ifdef STLX_SYSCALL_STATS
+        { "syscalls", generate_syscalls, 65536, nullptr },
+#endif
+#ifdef STLX_LOCKSTAT
+        { "locks", generate_locks, 262144, sync::lockstat::reset },
+#endif
     };
 
     for (auto& n : nodes) {
@@ -229,7 +462,7 @@ __PRIVILEGED_CODE int32_t init() {
             log::error("sysstat: failed to allocate /dev/sysinfo/%s", n.name);
             return ERR;
         }
-        auto* node = new (mem) stats_node(n.name, n.gen, n.cap);
+        auto* node = new (mem) stats_node(n.name, n.gen, n.cap, n.reset);
 
         if (devfs::add_char_device_at(dir, node) != devfs::OK) {
             log::error("sysstat: failed to register /dev/sysinfo/%s", n.name);
@@ -239,7 +472,7 @@ __PRIVILEGED_CODE int32_t init() {
         }
     }
 
-    return OK;
+    return init_binary_nodes(dir);
 }
 
 } // namespace sysstat
@@ -18,7 +18,36 @@ constexpr int32_t ERR = -1;
  *   /dev/sysinfo/cpu     tick_hz, then one "cpu<N> <busy> <idle>" per CPU
  *   /dev/sysinfo/mem     page_size, total_pages, free_pages, used_pages
  *   /dev/sysinfo/uptime  monotonic nanoseconds since boot
- *   /dev/sysinfo/tasks   one "tid pid state cpu ticks name" line per task
+ *   /dev/sysinfo/tasks   one "tid pid state cpu ticks utime stime minflt
+ *                        nvcsw nivcsw syscalls read_bytes write_bytes
+ *                        net_rx net_tx rss_kb maxrss_kb name" line per
+ *                        task; times in ticks (see sched::task_rusage)
+ *   /dev/sysinfo/sched   one "cpu<N> <prev_idle> <affine> <cache_hot> <idle_cpu>
+ *                        <prev_busy> <migrations> <remote> <pinned>" line of wakeup
+ *                        placement counters per waking CPU
+ *   /dev/sysinfo/elevate one "<file>:<line> <transitions> <nested> <cycles>
+ *                        <hist0> .. <hist15>" line per RUN_ELEVATED site
+ *                        that has run, only with ELEVATE_STATS=1 (see
+ *                        dynpriv::elevate_site)
+ *   /dev/sysinfo/syscalls one "nr <nr> <name> <count> <total_ns> <max_ns>
+ *                        <hist0> .. <hist23>" line per syscall number that
+ *                        has been called, then one "task <tid> <pid>
+ *                        <syscalls> <name>" line per task that made any,
+ *                        only with SYSCALL_STATS=1 (see syscall::syscall_stat)
+ *   /dev/sysinfo/locks   one "<class> <spin|mutex> <acquisitions> <contended>
+ *                        <wait_cycles> <hold_cycles> <max_wait> <max_hold>"
+ *                        line per lock class, most waited on first, each
+ *                        followed by " site <file>:<line> <acquisitions>
+ *                        <contended> <wait_cycles>" lines for its call
+ *                        sites; writing anything zeroes the counters. Only
+ *                        with LOCKSTAT=1 (see sync/lockstat.h)
+ *
+ * Two binary nodes sit beside them for monitors that sample often:
+ *
+ *   /dev/sysinfo/snapshot a versioned capture of memory, per-CPU and
+ *                        per-task counters (see sysstat/snapshot.h)
+ *   /dev/sysinfo/cpupage the live sched::cpu_time_page, readable or
+ *                        mappable read-only
  *
  * Must be called after devfs is mounted.
  * @note Privilege: **required**
@@ -0,0 +1,77 @@
+#define STLX_TEST_TIER TIER_DS
+
+#include "stlx_bench.h"
+#include "common/hashmap.h"
+#include "common/hash.h"
+
+namespace {
+
+struct bench_item {
+    uint64_t id;
+    hashmap::node link;
+};
+
+struct bench_key_ops {
+    using key_type = uint64_t;
+    static key_type key_of(const bench_item& e) { return e.id; }
+    static uint64_t hash(const key_type& k) { return hash::u64(k); }
+    static bool equal(const key_type& a, const key_type& b) { return a == b; }
+};
+
+using bench_map = hashmap::map<bench_item, &bench_item::link, bench_key_ops>;
+
+constexpr uint32_t BENCH_ITEMS   = 1024;
+constexpr uint32_t BENCH_BUCKETS = 256;
+
+bench_item g_items[BENCH_ITEMS];
+hashmap::bucket g_buckets[BENCH_BUCKETS];
+bench_map g_map;
+
+// Four items per bucket on average, as a loaded table would have
+void fill_map() {
+    for (auto& b : g_buckets) {
+        b = {};
+    }
+    g_map.init(g_buckets, BENCH_BUCKETS);
+    for (uint32_t i = 0; i < BENCH_ITEMS; i++) {
+        g_items[i].id = i * 7919;
+        g_items[i].link = {};
+        g_map.insert(&g_items[i]);
+    }
+}
+
+} // namespace
+
+BENCH(hashmap, find_hit) {
+    fill_map();
+    uint32_t i = 0;
+    BENCH_LOOP(state) {
+        if (!g_map.find(g_items[i].id)) {
+            state.fail("lookup missed");
+            break;
+        }
+        i = (i + 1) % BENCH_ITEMS;
+    }
+}
+
+BENCH(hashmap, find_miss) {
+    fill_map();
+    uint64_t key = 1;
+    BENCH_LOOP(state) {
+        if (g_map.find(key)) {
+            state.fail("lookup hit");
+            break;
+        }
+        key += 7919;
+    }
+}
+
+BENCH(hashmap, remove_insert) {
+    fill_map();
+    uint32_t i = 0;
+    BENCH_LOOP(state) {
+        g_map.remove(g_items[i]);
+        g_map.insert(&g_items[i]);
+        i = (i + 1) % BENCH_ITEMS;
+    }
+}
@@ -0,0 +1,34 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_bench.h"
+#include "common/ring_buffer.h"
+
+namespace {
+
+void write_read(stlx_bench::state& state, size_t len) {
+    ring_buffer* rb = ring_buffer_create(RING_BUFFER_DEFAULT_CAPACITY);
+    if (!rb) {
+        state.fail("ring_buffer_create failed");
+        return;
+    }
+
+    uint8_t buf[1024] = {};
+    BENCH_LOOP(state) {
+        if (ring_buffer_write(rb, buf, len, true) != static_cast<ssize_t>(len) ||
+            ring_buffer_read(rb, buf, len, true) != static_cast<ssize_t>(len)) {
+            state.fail("short transfer");
+            break;
+        }
+    }
+    ring_buffer_destroy(rb);
+}
+
+} // namespace
+
+BENCH(ring_buffer, write_read_64) {
+    write_read(state, 64);
+}
+
+BENCH(ring_buffer, write_read_1024) {
+    write_read(state, 1024);
+}
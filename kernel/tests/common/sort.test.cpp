@@ -0,0 +1,67 @@
+#define STLX_TEST_TIER TIER_DS
+
+#include "stlx_unit_test.h"
+#include "common/sort.h"
+
+TEST_SUITE(sort);
+
+namespace {
+
+struct keyed {
+    uint32_t key;
+    uint32_t seq;
+};
+
+bool key_less(const keyed& a, const keyed& b) {
+    return a.key < b.key || (a.key == b.key && a.seq < b.seq);
+}
+
+} // namespace
+
+// --- heap_sort_orders_with_duplicates ---
+// Proves: heap_sort orders a scrambled array with repeated keys by the
+// caller's ordering, including its tie break, and leaves tiny arrays alone.
+
+TEST(sort, heap_sort_orders_with_duplicates) {
+    constexpr uint32_t N = 257;
+    keyed items[N];
+    uint32_t x = 12345;
+    for (uint32_t i = 0; i < N; i++) {
+        x = x * 1103515245u + 12345u;
+        items[i].key = (x >> 16) % 64;
+        items[i].seq = i;
+    }
+
+    sort::heap_sort(items, N, key_less);
+    for (uint32_t i = 1; i < N; i++) {
+        ASSERT_FALSE(key_less(items[i], items[i - 1]));
+    }
+
+    keyed one[1] = {};
+    one[0].key = 7;
+    sort::heap_sort(one, 1, key_less);
+    sort::heap_sort(one, 0, key_less);
+    EXPECT_EQ(one[0].key, 7u);
+}
+
+// --- upper_bound_finds_first_greater ---
+// Proves: upper_bound returns the first element greater than the key,
+// 0 below the range and count above it, so index - 1 is the floor.
+
+TEST(sort, upper_bound_finds_first_greater) {
+    const uint64_t addrs[] = { 10, 20, 20, 30, 40 };
+    constexpr size_t N = sizeof(addrs) / sizeof(addrs[0]);
+
+    auto ub = [&](uint64_t key) {
+        return sort::upper_bound(addrs, N, [key](uint64_t e) { return key < e; });
+    };
+
+    EXPECT_EQ(ub(5), 0u);
+    EXPECT_EQ(ub(10), 1u);
+    EXPECT_EQ(ub(15), 1u);
+    EXPECT_EQ(ub(20), 3u);
+    EXPECT_EQ(ub(39), 4u);
+    EXPECT_EQ(ub(40), 5u);
+    EXPECT_EQ(ub(1000), 5u);
+    EXPECT_EQ(sort::upper_bound(addrs, 0, [](uint64_t) { return true; }), 0u);
+}
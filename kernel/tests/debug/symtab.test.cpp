@@ -0,0 +1,70 @@
+#define STLX_TEST_TIER TIER_UTIL
+
+#include "stlx_unit_test.h"
+#include "debug/symtab.h"
+#include "debug/dwarf_line.h"
+#include "common/string.h"
+
+extern "C" void stlx_init();
+extern "C" void symtab_test_alias(); // symtab_test_helpers.S
+
+TEST_SUITE(symtab);
+
+// --- resolves_function_and_offset ---
+// Proves: the sorted index maps an address inside a known function to
+// that function and the byte offset, and an address below every kernel
+// function resolves to nothing.
+
+TEST(symtab, resolves_function_and_offset) {
+    uint64_t fn = reinterpret_cast<uint64_t>(&stlx_init);
+
+    symtab::resolve_result res = {};
+    ASSERT_TRUE(symtab::resolve(fn + 4, &res));
+    EXPECT_EQ(string::strcmp(res.name, "stlx_init"), 0);
+    EXPECT_EQ(res.offset, 4u);
+
+    ASSERT_TRUE(symtab::resolve(fn, &res));
+    EXPECT_EQ(res.offset, 0u);
+
+    EXPECT_FALSE(symtab::resolve(0x1000, &res));
+}
+
+// --- aliases_resolve_to_canonical_name ---
+// Proves: symbols sharing an address collapse into one index entry, and
+// an address reached through the alias resolves to the symbol first in
+// .symtab order (the local one ahead of its global alias).
+
+TEST(symtab, aliases_resolve_to_canonical_name) {
+    uint64_t fn = reinterpret_cast<uint64_t>(&symtab_test_alias);
+
+    symtab::resolve_result res = {};
+    ASSERT_TRUE(symtab::resolve(fn, &res));
+    EXPECT_STREQ(res.name, "symtab_test_canonical");
+    EXPECT_EQ(res.offset, 0u);
+}
+
+// --- line_lookup_is_consistent ---
+// Proves: the line index resolves a known kernel function to a file and
+// a non-zero line (debug builds carry DWARF), resolves consecutive
+// lookups of the same address identically, and misses unmapped ones.
+
+TEST(symtab, line_lookup_is_consistent) {
+    uint64_t fn = reinterpret_cast<uint64_t>(&stlx_init);
+
+    dwarf_line::resolve_result a = {};
+    dwarf_line::resolve_result b = {};
+    bool found_a = dwarf_line::resolve(fn, &a);
+    bool found_b = dwarf_line::resolve(fn, &b);
+    EXPECT_EQ(found_a, found_b);
+#ifdef DEBUG
+    ASSERT_TRUE(found_a);
+#endif
+    if (found_a) {
+        ASSERT_NOT_NULL(a.file);
+        EXPECT_GT(string::strlen(a.file), 0u);
+        EXPECT_EQ(a.file, b.file);
+        EXPECT_EQ(a.line, b.line);
+        EXPECT_GT(a.line, 0u);
+    }
+    EXPECT_FALSE(dwarf_line::resolve(0x1000, &a));
+}
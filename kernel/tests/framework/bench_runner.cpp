@@ -0,0 +1,117 @@
+#include "bench_runner.h"
+#include "stlx_bench.h"
+#include "common/logging.h"
+#include "clock/clock.h"
+
+extern "C" {
+extern const stlx_bench::bench_entry __stlx_bench_start[];
+extern const stlx_bench::bench_entry __stlx_bench_end[];
+}
+
+namespace stlx_bench {
+
+constexpr uint32_t CALIBRATION_ROUNDS = 256;
+
+static uint64_t g_samples[MAX_SAMPLES];
+
+static void sort_samples(uint64_t* v, uint32_t n) {
+    // Shell sort with Ciura's gaps: no allocation, fast enough for 4096
+    static constexpr uint32_t gaps[] = { 701, 301, 132, 57, 23, 10, 4, 1 };
+    for (uint32_t gap : gaps) {
+        for (uint32_t i = gap; i < n; i++) {
+            uint64_t tmp = v[i];
+            uint32_t j = i;
+            for (; j >= gap && v[j - gap] > tmp; j -= gap) {
+                v[j] = v[j - gap];
+            }
+            v[j] = tmp;
+        }
+    }
+}
+
+/**
+ * Cycles the bracketing counter reads add to every sample, subtracted
+ * before reporting.
+ */
+static uint64_t timer_overhead() {
+    uint64_t best = ~0ull;
+    for (uint32_t i = 0; i < CALIBRATION_ROUNDS; i++) {
+        uint64_t t0 = dynpriv::read_cycles();
+        uint64_t t1 = dynpriv::read_cycles();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    return best;
+}
+
+// Tenths of a nanosecond for `cycles`
+static uint64_t cycles_to_ns10(uint64_t cycles, uint64_t freq) {
+    if (freq < 1000) {
+        return 0;
+    }
+    return cycles * 10000000ull / (freq / 1000);
+}
+
+static void report(const bench_entry& e, const state& st, uint64_t overhead,
+                   uint64_t freq) {
+    uint32_t n = st.recorded();
+    for (uint32_t i = 0; i < n; i++) {
+        g_samples[i] = g_samples[i] > overhead ? g_samples[i] - overhead : 0;
+    }
+    sort_samples(g_samples, n);
+
+    // Per-iteration cycles at each percentile of per-sample time
+    uint64_t batch = st.batch();
+    uint64_t min = g_samples[0] / batch;
+    uint64_t median = g_samples[n / 2] / batch;
+    uint64_t p99 = g_samples[(n * 99) / 100] / batch;
+    uint64_t max = g_samples[n - 1] / batch;
+    uint64_t median_ns10 = cycles_to_ns10(g_samples[n / 2], freq) / batch;
+
+    log::raw("STLX_BENCH {\"suite\":\"%s\",\"name\":\"%s\",\"samples\":%u,"
+             "\"batch\":%u,\"min\":%lu,\"median\":%lu,\"p99\":%lu,\"max\":%lu,"
+             "\"median_ns\":%lu.%lu}",
+             e.suite_name, e.bench_name, n, st.batch(),
+             min, median, p99, max, median_ns10 / 10, median_ns10 % 10);
+}
+
+int32_t run_all() {
+    const auto* begin = __stlx_bench_start;
+    const auto* end = __stlx_bench_end;
+    uint64_t freq = clock::freq_hz();
+    uint64_t overhead = timer_overhead();
+
+    log::raw("STLX_BENCH_START {\"count\":%zu,\"unit\":\"cycles\",\"freq_hz\":%lu,"
+             "\"timer_overhead\":%lu}",
+             static_cast<size_t>(end - begin), freq, overhead);
+
+    int32_t failures = 0;
+    for (const auto* e = begin; e < end; e++) {
+        uint32_t samples = e->samples;
+        if (samples == 0 || samples > MAX_SAMPLES) {
+            samples = MAX_SAMPLES;
+        }
+        uint32_t batch = e->batch ? e->batch : 1;
+
+        state st(g_samples, samples, e->warmup, batch);
+        stlx_test::detail::current_failures = 0;
+        e->fn(st);
+
+        // An ASSERT in the bench returns early and leaves samples short
+        if (st.failed() || stlx_test::detail::current_failures != 0 ||
+            st.recorded() < samples) {
+            log::raw("STLX_BENCH {\"suite\":\"%s\",\"name\":\"%s\",\"failed\":\"%s\"}",
+                     e->suite_name, e->bench_name,
+                     st.reason() ? st.reason() : "incomplete");
+            failures++;
+            continue;
+        }
+        report(*e, st, overhead, freq);
+    }
+
+    log::raw("STLX_BENCH_COMPLETE %d", failures);
+    return failures;
+}
+
+} // namespace stlx_bench
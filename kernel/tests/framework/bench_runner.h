@@ -0,0 +1,18 @@
+#ifndef STELLUX_TESTS_BENCH_RUNNER_H
+#define STELLUX_TESTS_BENCH_RUNNER_H
+
+#include "common/types.h"
+
+namespace stlx_bench {
+
+/**
+ * @brief Run all registered benchmarks in tier order. Prints one
+ * "STLX_BENCH {json}" line per bench to serial, then
+ * "STLX_BENCH_COMPLETE <failures>".
+ * @return Number of benches that failed.
+ */
+int32_t run_all();
+
+} // namespace stlx_bench
+
+#endif // STELLUX_TESTS_BENCH_RUNNER_H
@@ -0,0 +1,115 @@
+#ifndef STELLUX_TESTS_FRAMEWORK_STLX_BENCH_H
+#define STELLUX_TESTS_FRAMEWORK_STLX_BENCH_H
+
+#include "stlx_unit_test.h"
+#include "dynpriv/dynpriv.h"
+
+// Microbenchmarks register like unit tests: one descriptor per BENCH in
+// a tier-ordered linker section, run by stlx_bench::run_all() instead
+// of the test runner when the kernel is built with STLX_BENCH_ENABLED.
+//
+//   BENCH(heap, kalloc_free_64) {
+//       BENCH_LOOP(state) {
+//           heap::kfree(heap::kalloc(64));
+//       }
+//   }
+//
+// Each sample times `batch` iterations of the loop body with the cycle
+// counter (TSC on x86_64, CNTVCT_EL0 on AArch64). The first `warmup`
+// samples are discarded.
+
+namespace stlx_bench {
+
+constexpr uint32_t DEFAULT_SAMPLES = 1000;
+constexpr uint32_t DEFAULT_BATCH   = 16;
+constexpr uint32_t MAX_SAMPLES     = 4096;
+
+class state {
+public:
+    state(uint64_t* samples, uint32_t count, uint32_t warmup, uint32_t batch)
+        : m_samples(samples), m_count(count), m_warmup(warmup), m_batch(batch) {}
+
+    /**
+     * Close the running sample and start the next one.
+     * @return false once every sample is taken or the bench failed.
+     */
+    bool next_sample() {
+        uint64_t now = dynpriv::read_cycles();
+        if (m_running) {
+            uint64_t elapsed = now - m_start - m_paused;
+            if (m_taken >= m_warmup) {
+                m_samples[m_taken - m_warmup] = elapsed;
+            }
+            m_taken++;
+        }
+        if (m_failed || m_taken >= m_warmup + m_count) {
+            m_running = false;
+            return false;
+        }
+        m_running = true;
+        m_paused = 0;
+        m_start = dynpriv::read_cycles();
+        return true;
+    }
+
+    // Exclude per-sample setup or teardown from the measurement
+    void pause() { m_pause_start = dynpriv::read_cycles(); }
+    void resume() { m_paused += dynpriv::read_cycles() - m_pause_start; }
+
+    // Stop the bench, it is reported as failed
+    void fail(const char* reason) { m_failed = true; m_reason = reason; }
+
+    uint32_t batch() const { return m_batch; }
+    uint32_t recorded() const { return m_taken > m_warmup ? m_taken - m_warmup : 0; }
+    bool failed() const { return m_failed; }
+    const char* reason() const { return m_reason; }
+
+private:
+    uint64_t*   m_samples;
+    uint32_t    m_count;
+    uint32_t    m_warmup;
+    uint32_t    m_batch;
+    uint32_t    m_taken = 0;
+    bool        m_running = false;
+    bool        m_failed = false;
+    const char* m_reason = nullptr;
+    uint64_t    m_start = 0;
+    uint64_t    m_paused = 0;
+    uint64_t    m_pause_start = 0;
+};
+
+struct bench_entry {
+    const char* suite_name;
+    const char* bench_name;
+    void (*fn)(state&);
+    uint32_t samples;
+    uint32_t warmup;
+    uint32_t batch;
+    uint32_t _pad;
+};
+
+static_assert(sizeof(bench_entry) % 8 == 0,
+    "bench_entry size must be a multiple of 8 for linker section alignment");
+
+} // namespace stlx_bench
+
+// Registration macros. STLX_TEST_TIER selects the tier as for TEST.
+#define BENCH_N(suite, name, samples, batch) \
+    static void stlx_bench_##suite##_##name(::stlx_bench::state& state); \
+    __attribute__((used, section(".stlx_bench." STLX_STRINGIFY(STLX_TEST_TIER) "." #suite))) \
+    static const ::stlx_bench::bench_entry stlx_bench_entry_##suite##_##name = { \
+        #suite, #name, stlx_bench_##suite##_##name, \
+        (samples), (samples) / 10, (batch), 0 \
+    }; \
+    static void stlx_bench_##suite##_##name([[maybe_unused]] ::stlx_bench::state& state)
+
+#define BENCH(suite, name) \
+    BENCH_N(suite, name, ::stlx_bench::DEFAULT_SAMPLES, ::stlx_bench::DEFAULT_BATCH)
+
+// Body runs batch() times per sample. break only ends the current
+// sample early; call state.fail() first to abandon the bench.
+#define BENCH_LOOP(st) \
+    while ((st).next_sample()) \
+        for (uint32_t stlx_bench_i_ = 0; stlx_bench_i_ < (st).batch(); stlx_bench_i_++)
+
+#endif // STELLUX_TESTS_FRAMEWORK_STLX_BENCH_H
@@ -6,6 +6,7 @@
 #include "fs/file.h"
 #include "sched/sched.h"
 #include "sched/task.h"
+#include "sysstat/snapshot.h"
 #include "smp/smp.h"
 #include "percpu/percpu.h"
 #include "common/string.h"
@@ -249,3 +250,103 @@ TEST(sysstat, snapshot_consistent_across_small_reads) {
     uint64_t value = 0;
     EXPECT_TRUE(parse_labeled_u64(buf, "total_pages", &value));
 }
+
+// --- binary_snapshot_lists_current_task ---
+// Proves: /dev/sysinfo/snapshot starts with a versioned header whose
+// record sizes and offsets describe the stream, has one CPU record per
+// CPU, its task records include the reading task, and rewinding the
+// open recaptures.
+
+TEST(sysstat, binary_snapshot_lists_current_task) {
+    uint32_t self_tid = 0;
+    uint32_t cpu_count = 0;
+    RUN_ELEVATED({
+        self_tid = sched::current()->tid;
+        cpu_count = smp::cpu_count();
+    });
+
+    fs::file* f = fs::open("/dev/sysinfo/snapshot", fs::O_RDONLY);
+    ASSERT_NOT_NULL(f);
+
+    sysstat::snapshot_header hdr = {};
+    ASSERT_EQ(fs::read(f, &hdr, sizeof(hdr)), static_cast<ssize_t>(sizeof(hdr)));
+    EXPECT_EQ(hdr.magic, sysstat::SNAPSHOT_MAGIC);
+    EXPECT_EQ(hdr.version, sysstat::SNAPSHOT_VERSION);
+    EXPECT_EQ(hdr.header_size, static_cast<uint16_t>(sizeof(hdr)));
+    EXPECT_TRUE(hdr.tick_hz > 0);
+    EXPECT_TRUE(hdr.free_pages <= hdr.total_pages);
+    EXPECT_EQ(hdr.cpu_count, cpu_count);
+    EXPECT_EQ(hdr.cpu_record_size, static_cast<uint32_t>(sizeof(sysstat::snapshot_cpu)));
+    EXPECT_EQ(hdr.cpu_offset, static_cast<uint32_t>(sizeof(hdr)));
+    EXPECT_EQ(hdr.task_record_size, static_cast<uint32_t>(sizeof(sysstat::snapshot_task)));
+    EXPECT_EQ(hdr.task_offset, hdr.cpu_offset + hdr.cpu_count * hdr.cpu_record_size);
+    EXPECT_TRUE(hdr.task_count > 0);
+
+    for (uint32_t i = 0; i < hdr.cpu_count; i++) {
+        sysstat::snapshot_cpu cpu = {};
+        ASSERT_EQ(fs::read(f, &cpu, sizeof(cpu)), static_cast<ssize_t>(sizeof(cpu)));
+    }
+
+    bool found_self = false;
+    uint32_t records = 0;
+    sysstat::snapshot_task task = {};
+    while (fs::read(f, &task, sizeof(task)) == static_cast<ssize_t>(sizeof(task))) {
+        records++;
+        if (task.tid == self_tid) {
+            found_self = true;
+            EXPECT_EQ(task.state, sched::TASK_STATE_RUNNING);
+            EXPECT_TRUE(task.name[0] != '\0');
+        }
+    }
+
+    // Rewinding the same open captures a fresh snapshot
+    EXPECT_EQ(fs::seek(f, 0, fs::SEEK_SET), static_cast<int64_t>(0));
+    sysstat::snapshot_header again = {};
+    ASSERT_EQ(fs::read(f, &again, sizeof(again)), static_cast<ssize_t>(sizeof(again)));
+    EXPECT_EQ(again.magic, sysstat::SNAPSHOT_MAGIC);
+    EXPECT_TRUE(again.timestamp_ns > hdr.timestamp_ns);
+    fs::close(f);
+
+    EXPECT_EQ(records, hdr.task_count);
+    EXPECT_TRUE(found_self);
+}
+
+// --- cpupage_time_advances ---
+// Proves: /dev/sysinfo/cpupage exposes the scheduler's per-CPU time
+// ledger with a valid header, and the charged time grows while the
+// system runs.
+
+static uint64_t cpupage_total_ns(sched::cpu_time_page* page, size_t size) {
+    uint64_t total = 0;
+    fs::file* f = fs::open("/dev/sysinfo/cpupage", fs::O_RDONLY);
+    if (!f) {
+        return 0;
+    }
+    if (fs::read(f, page, size) == static_cast<ssize_t>(size)) {
+        for (uint32_t i = 0; i < page->cpu_count; i++) {
+            total += page->cpus[i].busy_ns + page->cpus[i].idle_ns;
+        }
+    }
+    fs::close(f);
+    return total;
+}
+
+static sched::cpu_time_page g_cpupage;
+
+TEST(sysstat, cpupage_time_advances) {
+    uint32_t cpu_count = 0;
+    RUN_ELEVATED({
+        cpu_count = smp::cpu_count();
+    });
+
+    uint64_t before = cpupage_total_ns(&g_cpupage, sizeof(g_cpupage));
+    EXPECT_EQ(g_cpupage.magic, sched::CPU_TIME_PAGE_MAGIC);
+    EXPECT_EQ(g_cpupage.version, sched::CPU_TIME_PAGE_VERSION);
+    EXPECT_EQ(g_cpupage.cpu_count, cpu_count);
+    EXPECT_EQ(g_cpupage.record_size, static_cast<uint32_t>(sizeof(sched::cpu_time_record)));
+
+    RUN_ELEVATED(sched::sleep_ms(20));
+
+    uint64_t after = cpupage_total_ns(&g_cpupage, sizeof(g_cpupage));
+    EXPECT_GT(after, before);
+}
@@ -0,0 +1,115 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "kmsg/kmsg.h"
+#include "fs/fs.h"
+#include "fs/file.h"
+#include "fs/fstypes.h"
+#include "sched/sched.h"
+#include "clock/clock.h"
+#include "common/logging.h"
+#include "common/string.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(kmsg);
+
+constexpr uint64_t WAIT_NS = 2000000000ULL;
+
+// true if the record in buf ends with ";<text>\n"
+static bool record_has_text(const char* buf, size_t len, const char* text) {
+    size_t text_len = string::strlen(text);
+    if (len < text_len + 2 || buf[len - 1] != '\n') {
+        return false;
+    }
+    const char* body = buf + len - 1 - text_len;
+    return body[-1] == ';' && string::strncmp(body, text, text_len) == 0;
+}
+
+static uint64_t parse_u64(const char** p) {
+    uint64_t value = 0;
+    while (**p >= '0' && **p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(**p - '0');
+        (*p)++;
+    }
+    return value;
+}
+
+/**
+ * Read records from f until one carries text, giving klogd time to drain.
+ * Stores the record's priority and sequence number.
+ */
+static bool wait_for_record(fs::file* f, const char* text,
+                            uint64_t* prio, uint64_t* seq) {
+    char buf[kmsg::LINE_MAX + 64];
+    uint64_t deadline = clock::now_ns() + WAIT_NS;
+    while (clock::now_ns() < deadline) {
+        ssize_t rd = fs::read(f, buf, sizeof(buf));
+        if (rd <= 0) {
+            RUN_ELEVATED(sched::sleep_ms(1));
+            continue;
+        }
+        if (record_has_text(buf, static_cast<size_t>(rd), text)) {
+            const char* p = buf;
+            *prio = parse_u64(&p);
+            p++; // ','
+            *seq = parse_u64(&p);
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- logged_lines_reach_dev_kmsg ---
+// Proves: once kmsg is up, log lines are drained by klogd into /dev/kmsg
+// with their syslog priority, in the order they were logged.
+
+TEST(kmsg, logged_lines_reach_dev_kmsg) {
+    bool up = false;
+    RUN_ELEVATED(up = kmsg::ready());
+    ASSERT_TRUE(up);
+
+    fs::file* f = fs::open("/dev/kmsg", fs::O_RDONLY);
+    ASSERT_NOT_NULL(f);
+    ASSERT_EQ(fs::seek(f, 0, fs::SEEK_END), 0);
+
+    log::info("kmsg test first %u", 1u);
+    log::warn("kmsg test second %u", 2u);
+
+    uint64_t prio1 = 0, seq1 = 0, prio2 = 0, seq2 = 0;
+    EXPECT_TRUE(wait_for_record(f, "kmsg test first 1", &prio1, &seq1));
+    EXPECT_TRUE(wait_for_record(f, "kmsg test second 2", &prio2, &seq2));
+    EXPECT_EQ(prio1, 6u);
+    EXPECT_EQ(prio2, 4u);
+    EXPECT_GT(seq2, seq1);
+
+    fs::close(f);
+}
+
+// --- short_buffer_is_rejected ---
+// Proves: a read too small for the next record fails without consuming
+// it, so the record can still be read whole afterwards.
+
+TEST(kmsg, short_buffer_is_rejected) {
+    fs::file* f = fs::open("/dev/kmsg", fs::O_RDONLY);
+    ASSERT_NOT_NULL(f);
+    ASSERT_EQ(fs::seek(f, 0, fs::SEEK_END), 0);
+
+    log::info("kmsg test short buffer");
+
+    char tiny[8];
+    uint64_t deadline = clock::now_ns() + WAIT_NS;
+    ssize_t rd = 0;
+    while (rd == 0 && clock::now_ns() < deadline) {
+        rd = fs::read(f, tiny, sizeof(tiny));
+        if (rd == 0) {
+            RUN_ELEVATED(sched::sleep_ms(1));
+        }
+    }
+    EXPECT_EQ(rd, static_cast<ssize_t>(fs::ERR_INVAL));
+
+    uint64_t prio = 0, seq = 0;
+    EXPECT_TRUE(wait_for_record(f, "kmsg test short buffer", &prio, &seq));
+
+    fs::close(f);
+}
@@ -0,0 +1,43 @@
+#define STLX_TEST_TIER TIER_MM_ALLOC
+
+#include "stlx_bench.h"
+#include "mm/heap.h"
+
+namespace {
+
+void alloc_free(stlx_bench::state& state, size_t size) {
+    BENCH_LOOP(state) {
+        void* p = heap::kalloc(size);
+        if (!p) {
+            state.fail("kalloc failed");
+            break;
+        }
+        heap::kfree(p);
+    }
+}
+
+} // namespace
+
+BENCH(heap, kalloc_free_64) {
+    alloc_free(state, 64);
+}
+
+BENCH(heap, kalloc_free_1024) {
+    alloc_free(state, 1024);
+}
+
+// Past the largest size class: whole pages from the page allocator
+BENCH(heap, kalloc_free_8192) {
+    alloc_free(state, 8192);
+}
+
+BENCH(heap, kzalloc_free_256) {
+    BENCH_LOOP(state) {
+        void* p = heap::kzalloc(256);
+        if (!p) {
+            state.fail("kzalloc failed");
+            break;
+        }
+        heap::kfree(p);
+    }
+}
@@ -0,0 +1,30 @@
+#define STLX_TEST_TIER TIER_MM_CORE
+
+#include "stlx_bench.h"
+#include "mm/kva.h"
+#include "mm/paging_types.h"
+
+BENCH(kva, alloc_free_page) {
+    BENCH_LOOP(state) {
+        kva::allocation alloc = {};
+        if (kva::alloc(paging::PAGE_SIZE_4KB, paging::PAGE_SIZE_4KB, 0, 0,
+                       kva::placement::low, kva::tag::generic, 0, alloc) != kva::OK) {
+            state.fail("kva::alloc failed");
+            break;
+        }
+        kva::free(alloc.base);
+    }
+}
+
+BENCH(kva, alloc_free_guarded_16) {
+    BENCH_LOOP(state) {
+        kva::allocation alloc = {};
+        if (kva::alloc(16 * paging::PAGE_SIZE_4KB, paging::PAGE_SIZE_4KB,
+                       paging::PAGE_SIZE_4KB, paging::PAGE_SIZE_4KB,
+                       kva::placement::low, kva::tag::generic, 0, alloc) != kva::OK) {
+            state.fail("kva::alloc failed");
+            break;
+        }
+        kva::free(alloc.base);
+    }
+}
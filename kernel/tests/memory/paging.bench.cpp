@@ -0,0 +1,35 @@
+#define STLX_TEST_TIER TIER_MM_CORE
+
+#include "stlx_bench.h"
+#include "mm/paging.h"
+#include "mm/pmm.h"
+#include "mm/kva.h"
+
+// Map, unmap and invalidate one kernel page, the core of every vmm change
+BENCH(paging, map_unmap_page) {
+    pmm::phys_addr_t phys = pmm::alloc_page();
+    kva::allocation alloc = {};
+    if (!phys || kva::alloc(paging::PAGE_SIZE_4KB, paging::PAGE_SIZE_4KB, 0, 0,
+                            kva::placement::low, kva::tag::generic, 0,
+                            alloc) != kva::OK) {
+        state.fail("setup failed");
+    }
+
+    auto va = static_cast<paging::virt_addr_t>(alloc.base);
+    pmm::phys_addr_t root = paging::get_kernel_pt_root();
+    BENCH_LOOP(state) {
+        if (paging::map_page(va, phys, paging::PAGE_KERNEL_RW, root) != paging::OK) {
+            state.fail("map_page failed");
+            break;
+        }
+        paging::unmap_page(va, root);
+        paging::flush_tlb_page(va);
+    }
+
+    if (alloc.base) {
+        kva::free(alloc.base);
+    }
+    if (phys) {
+        pmm::free_page(phys);
+    }
+}
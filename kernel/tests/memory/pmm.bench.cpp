@@ -0,0 +1,26 @@
+#define STLX_TEST_TIER TIER_MM_CORE
+
+#include "stlx_bench.h"
+#include "mm/pmm.h"
+
+BENCH(pmm, alloc_free_page) {
+    BENCH_LOOP(state) {
+        pmm::phys_addr_t page = pmm::alloc_page();
+        if (!page) {
+            state.fail("alloc_page failed");
+            break;
+        }
+        pmm::free_page(page);
+    }
+}
+
+BENCH(pmm, alloc_free_order4) {
+    BENCH_LOOP(state) {
+        pmm::phys_addr_t block = pmm::alloc_pages(4);
+        if (!block) {
+            state.fail("alloc_pages failed");
+            break;
+        }
+        pmm::free_pages(block, 4);
+    }
+}
@@ -0,0 +1,92 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "smp/smp.h"
+#include "dynpriv/dynpriv.h"
+#include "mm/mm.h"
+#include "mm/paging.h"
+#include "mm/pmm.h"
+
+using test_helpers::spin_wait_ge;
+
+TEST_SUITE(smp_fault);
+
+static constexpr size_t PAGE = pmm::PAGE_SIZE;
+static constexpr uint32_t LAZY_ANON =
+    mm::MM_MAP_PRIVATE | mm::MM_MAP_ANONYMOUS | mm::MM_MAP_LAZY;
+
+// --- concurrent_faults_one_mm ---
+// Proves: page faults from every CPU into one address space run under
+// the shared mm lock without losing or double-mapping a page. Workers
+// interleave over the same page tables and each page is faulted by
+// more than one CPU.
+
+constexpr uint32_t FAULT_PAGES = 256;
+
+static mm::mm_context* g_mm;
+static uintptr_t g_base;
+static volatile uint32_t g_go;
+static volatile uint32_t g_failed;
+static volatile uint32_t g_done;
+
+static void fault_worker_fn(void* arg) {
+    uint32_t idx = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+    while (!__atomic_load_n(&g_go, __ATOMIC_ACQUIRE)) {
+        cpu::relax();
+    }
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < FAULT_PAGES; i++) {
+            uint32_t page = (i + idx * 7) % FAULT_PAGES;
+            if (!mm::handle_user_pf(g_mm, g_base + page * PAGE, mm::PF_FLAG_WRITE)) {
+                __atomic_fetch_add(&g_failed, 1, __ATOMIC_RELAXED);
+            }
+        }
+    });
+
+    __atomic_fetch_add(&g_done, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(smp_fault, concurrent_faults_one_mm) {
+    uint32_t cpus = smp::cpu_count();
+    if (cpus < 2) return;
+
+    g_go = 0;
+    g_failed = 0;
+    g_done = 0;
+
+    RUN_ELEVATED({
+        g_mm = mm::mm_context_create();
+        ASSERT_NOT_NULL(g_mm);
+        ASSERT_EQ(mm::mm_context_map_anonymous(
+            g_mm, 0, FAULT_PAGES * PAGE,
+            mm::MM_PROT_READ | mm::MM_PROT_WRITE, LAZY_ANON, &g_base
+        ), mm::MM_CTX_OK);
+
+        for (uint32_t i = 0; i < cpus; i++) {
+            sched::task* t = sched::create_kernel_task(
+                fault_worker_fn,
+                reinterpret_cast<void*>(static_cast<uintptr_t>(i)),
+                "smp_fault");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue_on(t, i);
+        }
+    });
+
+    __atomic_store_n(&g_go, 1, __ATOMIC_RELEASE);
+    ASSERT_TRUE(spin_wait_ge(&g_done, cpus));
+    EXPECT_EQ(__atomic_load_n(&g_failed, __ATOMIC_ACQUIRE), 0u);
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < FAULT_PAGES; i++) {
+            EXPECT_NE(paging::get_physical(g_base + i * PAGE, g_mm->pt_root),
+                      static_cast<pmm::phys_addr_t>(0));
+        }
+        mm::mm_context_release(g_mm);
+        g_mm = nullptr;
+    });
+}
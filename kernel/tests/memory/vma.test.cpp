@@ -205,9 +205,9 @@ TEST(vma_test, gap_search_topdown_prefers_highest_gap) {
         mm::MM_PROT_READ, mm::VMA_FLAG_PRIVATE | mm::VMA_FLAG_ELF
     ), mm::MM_CTX_OK);
 
-    sync::mutex_lock(mm_ctx->lock);
+    sync::down_read(mm_ctx->lock);
     uintptr_t gap = mm::vma_find_gap_topdown_locked(mm_ctx, 2 * PAGE);
-    sync::mutex_unlock(mm_ctx->lock);
+    sync::up_read(mm_ctx->lock);
 
     EXPECT_TRUE(gap >= second + 4 * PAGE);
     EXPECT_TRUE(gap + 2 * PAGE <= mm_ctx->mmap_end);
@@ -0,0 +1,70 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "net/napi.h"
+#include "hw/cpu.h"
+#include "sync/spinlock.h"
+#include "dynpriv/dynpriv.h"
+
+using test_helpers::spin_wait_ge;
+
+TEST_SUITE(napi);
+
+// Fake ring: the poll function consumes up to budget of g_ring_frames
+static volatile uint32_t g_ring_frames;
+static volatile uint32_t g_poll_calls;
+static volatile uint32_t g_completed;
+
+static uint32_t fake_poll(net::napi_struct* napi, uint32_t budget) {
+    uint32_t avail = __atomic_load_n(&g_ring_frames, __ATOMIC_ACQUIRE);
+    uint32_t done = avail < budget ? avail : budget;
+    __atomic_fetch_sub(&g_ring_frames, done, __ATOMIC_ACQ_REL);
+    __atomic_fetch_add(&g_poll_calls, 1, __ATOMIC_RELEASE);
+    if (done < budget) {
+        RUN_ELEVATED(net::napi_complete(napi));
+        __atomic_fetch_add(&g_completed, 1, __ATOMIC_RELEASE);
+    }
+    return done;
+}
+
+// --- budget_requeues_until_drained ---
+// Proves: a poll that uses its whole budget is run again without a new
+// schedule, the poll that drains the ring completes, and a schedule
+// while one is pending is coalesced.
+
+TEST(napi, budget_requeues_until_drained) {
+    net::napi_struct napi;
+    net::napi_init(&napi, nullptr, fake_poll, 4);
+    g_ring_frames = 10;
+    g_poll_calls = 0;
+    g_completed = 0;
+
+    bool first = false;
+    bool second = true;
+    RUN_ELEVATED({
+        sync::irq_state irq{cpu::irq_save()};
+        first = net::napi_schedule(&napi);
+        second = net::napi_schedule(&napi);
+        cpu::irq_restore(irq.flags);
+    });
+    EXPECT_TRUE(first);
+    EXPECT_FALSE(second);
+
+    ASSERT_TRUE(spin_wait_ge(&g_completed, 1u));
+    // The last poll's statistics are updated after it returns
+    RUN_ELEVATED(workqueue::flush_work(&napi.work));
+
+    // 4 + 4 + 2: two full-budget polls, then one that drains
+    EXPECT_EQ(__atomic_load_n(&g_poll_calls, __ATOMIC_ACQUIRE), 3u);
+    EXPECT_EQ(__atomic_load_n(&g_ring_frames, __ATOMIC_ACQUIRE), 0u);
+    EXPECT_EQ(napi.frames, 10u);
+    EXPECT_EQ(napi.repolls, 2u);
+    EXPECT_EQ(napi.schedules, 1u);
+    EXPECT_EQ(napi.state & net::NAPI_STATE_SCHED, 0u);
+
+    RUN_ELEVATED(net::napi_disable(&napi));
+    bool after_disable = true;
+    RUN_ELEVATED(after_disable = net::napi_schedule(&napi));
+    EXPECT_FALSE(after_disable);
+}
@@ -9,6 +9,7 @@
 #include "net/byteorder.h"
 #include "net/checksum.h"
 #include "common/string.h"
+#include "rc/rcu.h"
 #include "dynpriv/dynpriv.h"
 
 TEST_SUITE(route_test);
@@ -394,6 +395,8 @@ TEST(route_test, add_interface_routes_populates) {
     // Clean up
     net::route_del_iface(&mock);
     net::unregister_netif(&mock);
+    // mock lives on this stack frame, let lockless readers drop it
+    RUN_ELEVATED(rc::rcu::synchronize());
 }
 
 // ============================================================================
@@ -454,6 +457,7 @@ TEST(route_test, reconfigure_replaces_routes) {
     // Clean up
     net::route_del_iface(&mock);
     net::unregister_netif(&mock);
+    RUN_ELEVATED(rc::rcu::synchronize());
 }
 
 // ============================================================================
@@ -572,6 +576,7 @@ TEST(route_test, unregister_cleans_routes) {
 
     // Unregister should clean up ALL routes (including LOCAL → loopback)
     rc = net::unregister_netif(&mock);
+    RUN_ELEVATED(rc::rcu::synchronize());
     ASSERT_EQ(rc, net::OK);
     EXPECT_EQ(net::route_count(), before);
 
@@ -636,4 +641,5 @@ TEST(route_test, loopback_reconfig_preserves_other_local_routes) {
     // Clean up
     net::route_del_iface(&mock);
     net::unregister_netif(&mock);
+    RUN_ELEVATED(rc::rcu::synchronize());
 }
@@ -0,0 +1,78 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "profile/profile.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "clock/clock.h"
+#include "mm/heap.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(profile);
+
+constexpr size_t DRAIN_MAX = 256;
+
+static void spin_for_ns(uint64_t duration_ns) {
+    uint64_t deadline = clock::now_ns() + duration_ns;
+    while (clock::now_ns() < deadline) {
+    }
+}
+
+// --- samples_busy_kernel_task ---
+// Proves: a kernel task spinning while the profiler runs is sampled with
+// its tid as kernel code, stop() ends sampling, and draining empties
+// every ring.
+
+TEST(profile, samples_busy_kernel_task) {
+    auto* buf = static_cast<profile::sample*>(
+        heap::kzalloc(DRAIN_MAX * sizeof(profile::sample)));
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = profile::ERR;
+    RUN_ELEVATED({
+        profile::set_frequency(2000);
+        rc = profile::start();
+    });
+    ASSERT_EQ(rc, profile::OK);
+
+    spin_for_ns(200000000ULL);
+    RUN_ELEVATED(profile::stop());
+
+    profile::profile_stats stats = {};
+    RUN_ELEVATED(stats = profile::read_stats());
+    EXPECT_EQ(stats.running, 0u);
+    EXPECT_EQ(stats.freq_hz, 2000u);
+    EXPECT_GT(stats.samples, 0u);
+
+    uint32_t self_tid = sched::current()->tid;
+    uint64_t total = 0;
+    uint64_t own_kernel = 0;
+    bool depth_ok = true;
+    size_t got = 0;
+    do {
+        RUN_ELEVATED(got = profile::read_samples(buf, DRAIN_MAX));
+        for (size_t i = 0; i < got; i++) {
+            if (buf[i].depth > profile::SAMPLE_MAX_STACK) {
+                depth_ok = false;
+            }
+            if (buf[i].tid == self_tid && !(buf[i].flags & profile::SAMPLE_USER)) {
+                own_kernel++;
+            }
+        }
+        total += got;
+    } while (got > 0);
+
+    EXPECT_TRUE(depth_ok);
+    // A hook already past the running check may still land one late sample
+    EXPECT_GE(total, stats.samples);
+    EXPECT_GT(own_kernel, 0u);
+
+    // Stopped: nothing new is recorded
+    spin_for_ns(20000000ULL);
+    RUN_ELEVATED(got = profile::read_samples(buf, DRAIN_MAX));
+    EXPECT_EQ(got, 0u);
+
+    RUN_ELEVATED(profile::set_frequency(profile::DEFAULT_FREQ_HZ));
+    heap::kfree(buf);
+}
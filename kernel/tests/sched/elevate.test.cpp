@@ -0,0 +1,86 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "dynpriv/dynpriv.h"
+#include "percpu/percpu.h"
+#include "common/string.h"
+
+TEST_SUITE(elevate);
+
+// --- round_trip_and_nesting ---
+// Proves: repeated elevate/lower pairs (the short SYS_ELEVATE path)
+// leave the task elevated inside the block and restore the outer state, privileged per-CPU
+// data is readable there, and a nested RUN_ELEVATED does not lower.
+
+TEST(elevate, round_trip_and_nesting) {
+    const bool outer = dynpriv::is_elevated();
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        bool inside = false;
+        bool nested_inside = false;
+        uint32_t cpu = 0xFFFFFFFF;
+        RUN_ELEVATED({
+            inside = dynpriv::is_elevated();
+            cpu = percpu::current_cpu_id();
+            RUN_ELEVATED(nested_inside = dynpriv::is_elevated());
+            inside = inside && dynpriv::is_elevated();
+        });
+        ASSERT_TRUE(inside);
+        ASSERT_TRUE(nested_inside);
+        ASSERT_NE(cpu, 0xFFFFFFFFu);
+        ASSERT_EQ(dynpriv::is_elevated(), outer);
+    }
+}
+
+#ifdef STLX_ELEVATE_STATS
+
+// --- site_counts_transitions_and_nesting ---
+// Proves: a RUN_ELEVATED site registers itself once and counts outer
+// transitions and nested entries separately.
+
+static dynpriv::elevate_site* find_site(uint32_t line) {
+    for (dynpriv::elevate_site* s = dynpriv::first_site(); s; s = s->next) {
+        if (s->line == line && string::strcmp(s->file, __FILE__) == 0) {
+            return s;
+        }
+    }
+    return nullptr;
+}
+
+static uint32_t elevated_site_once() {
+    RUN_ELEVATED({ asm volatile("" ::: "memory"); });
+    return __LINE__ - 1;
+}
+
+TEST(elevate, site_counts_transitions_and_nesting) {
+    uint32_t line = elevated_site_once();
+    dynpriv::elevate_site* site = find_site(line);
+    ASSERT_NOT_NULL(site);
+    uint64_t transitions = site->transitions;
+    uint64_t nested = site->nested;
+
+    for (uint32_t i = 0; i < 10; i++) {
+        elevated_site_once();
+    }
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < 5; i++) {
+            elevated_site_once();
+        }
+    });
+
+    if (dynpriv::is_elevated()) {
+        EXPECT_EQ(site->nested - nested, 15u);
+    } else {
+        EXPECT_EQ(site->transitions - transitions, 10u);
+        EXPECT_EQ(site->nested - nested, 5u);
+    }
+
+    uint64_t hist_total = 0;
+    for (uint32_t b = 0; b < dynpriv::ELEVATE_HIST_BUCKETS; b++) {
+        hist_total += site->hist[b];
+    }
+    EXPECT_EQ(hist_total, site->transitions);
+}
+
+#endif // STLX_ELEVATE_STATS
@@ -6,6 +6,9 @@
 #include "sched/task.h"
 #include "smp/smp.h"
 #include "dynpriv/dynpriv.h"
+#ifdef __x86_64__
+#include "cpu/features.h"
+#endif
 
 using test_helpers::spin_wait;
 using test_helpers::spin_wait_ge;
@@ -16,6 +19,8 @@ extern "C" {
 #ifdef __x86_64__
 void fpu_test_write_xmm0(uint64_t value);
 uint64_t fpu_test_read_xmm0();
+void fpu_test_write_ymm0(const uint64_t* src);
+void fpu_test_read_ymm0(uint64_t* dst);
 #endif
 #ifdef __aarch64__
 void fpu_test_write_v0(uint64_t value);
@@ -135,6 +140,74 @@ TEST(fpu, fpu_context_isolation) {
     EXPECT_EQ(__atomic_load_n(&g_iso_fail_b, __ATOMIC_ACQUIRE), 0u);
 }
 
+#ifdef __x86_64__
+
+// --- fpu_ymm_isolation ---
+// Proves: two tasks on one CPU keep distinct 256-bit YMM0 values across
+// yields, so XSAVE carries the AVX upper halves, not only XMM.
+
+static volatile uint32_t g_ymm_fail = 0;
+static volatile uint32_t g_ymm_done_count = 0;
+
+static void ymm_isolation_fn(void* arg) {
+    uint64_t fingerprint = reinterpret_cast<uint64_t>(arg);
+    // A different value in every lane, so a lost upper half cannot match
+    uint64_t pattern[4];
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        pattern[lane] = fingerprint ^ (static_cast<uint64_t>(lane) << 56);
+    }
+
+    for (uint32_t i = 0; i < ISOLATION_ITERS; i++) {
+        RUN_ELEVATED({
+            fpu_test_write_ymm0(pattern);
+        });
+        sched::yield();
+        uint64_t readback[4] = {};
+        RUN_ELEVATED({
+            fpu_test_read_ymm0(readback);
+        });
+        bool match = true;
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            match = match && readback[lane] == pattern[lane];
+        }
+        if (!match) {
+            __atomic_store_n(&g_ymm_fail, 1, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    __atomic_fetch_add(&g_ymm_done_count, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(fpu, fpu_ymm_isolation) {
+    bool avx = false;
+    RUN_ELEVATED(avx = cpu::has(cpu::AVX));
+    if (!avx) return;
+
+    g_ymm_fail = 0;
+    g_ymm_done_count = 0;
+
+    RUN_ELEVATED({
+        sched::task* ta = sched::create_kernel_task(
+            ymm_isolation_fn,
+            reinterpret_cast<void*>(0x0123456789ABCDEFULL),
+            "fpu_ymm_a");
+        sched::task* tb = sched::create_kernel_task(
+            ymm_isolation_fn,
+            reinterpret_cast<void*>(0xFEDCBA9876543210ULL),
+            "fpu_ymm_b");
+        ASSERT_NOT_NULL(ta);
+        ASSERT_NOT_NULL(tb);
+        sched::enqueue_on(ta, 0);
+        sched::enqueue_on(tb, 0);
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_ymm_done_count, 2));
+    EXPECT_EQ(__atomic_load_n(&g_ymm_fail, __ATOMIC_ACQUIRE), 0u);
+}
+
+#endif // __x86_64__
+
 // --- fpu_cross_cpu ---
 // Tasks on different CPUs each write a fingerprint and verify it.
 
@@ -0,0 +1,271 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "sched/rusage.h"
+#include "syscall/handlers/sys_proc.h"
+#include "resource/handle_table.h"
+#include "resource/resource.h"
+#include "resource/providers/proc_provider.h"
+#include "mm/mm.h"
+#include "mm/pmm.h"
+#include "mm/heap.h"
+#include "dynpriv/dynpriv.h"
+#include "common/string.h"
+
+TEST_SUITE(rusage);
+
+namespace {
+
+// The task struct is large, so mock data is static
+static sched::task s_tasks[3];
+static sched::thread_group s_group;
+static mm::mm_context s_mm;
+
+static void init_mock_task(sched::task& t, uint32_t tid) {
+    string::memset(&t, 0, sizeof(sched::task));
+    t.tid = tid;
+    t.group_link = {};
+}
+
+static void init_mock_group(uint32_t pid) {
+    string::memset(&s_group, 0, sizeof(s_group));
+    s_group.lock = sync::SPINLOCK_INIT;
+    s_group.pid = pid;
+    s_group.threads.init();
+}
+
+static void init_leader_group(sched::thread_group* tg, sched::task* leader) {
+    tg->lock = sync::SPINLOCK_INIT;
+    tg->leader = leader;
+    tg->pid = leader->tid;
+    tg->group_id = leader->tid;
+    tg->threads.init();
+    tg->thread_count = 0;
+}
+
+constexpr uint64_t CHILD_FAULTS = 3;
+
+static void wait4_child_entry(void*) {
+    RUN_ELEVATED({ sched::current()->ru.minflt += CHILD_FAULTS; });
+    sched::exit(0);
+}
+
+} // namespace
+
+// --- add_sums_and_keeps_peak ---
+// Proves: rusage_add sums every counter but keeps the larger maxrss,
+// since peaks of separate address spaces do not add up.
+
+TEST(rusage, add_sums_and_keeps_peak) {
+    sched::task_rusage a = {};
+    a.user_ns = 10;
+    a.sys_ns = 20;
+    a.minflt = 3;
+    a.nvcsw = 4;
+    a.read_bytes = 100;
+    a.net_tx_bytes = 7;
+    a.maxrss_kb = 512;
+
+    sched::task_rusage b = {};
+    b.user_ns = 1;
+    b.sys_ns = 2;
+    b.minflt = 5;
+    b.nivcsw = 6;
+    b.read_bytes = 50;
+    b.net_tx_bytes = 1;
+    b.maxrss_kb = 256;
+
+    sched::rusage_add(&a, b);
+    EXPECT_EQ(a.user_ns, static_cast<uint64_t>(11));
+    EXPECT_EQ(a.sys_ns, static_cast<uint64_t>(22));
+    EXPECT_EQ(a.minflt, static_cast<uint64_t>(8));
+    EXPECT_EQ(a.nvcsw, static_cast<uint64_t>(4));
+    EXPECT_EQ(a.nivcsw, static_cast<uint64_t>(6));
+    EXPECT_EQ(a.read_bytes, static_cast<uint64_t>(150));
+    EXPECT_EQ(a.net_tx_bytes, static_cast<uint64_t>(8));
+    EXPECT_EQ(a.maxrss_kb, static_cast<uint64_t>(512));
+}
+
+// --- task_splits_user_and_system ---
+// Proves: a user task's run time splits into system time and the rest,
+// system time never exceeds run time, and maxrss follows the address
+// space peak.
+
+TEST(rusage, task_splits_user_and_system) {
+    sched::task& t = s_tasks[0];
+    init_mock_task(t, 500);
+    string::memset(&s_mm, 0, sizeof(s_mm));
+    s_mm.hiwater_rss_pages = 4;
+    t.exec.mm_ctx = &s_mm;
+    t.run_ns = 1000;
+    t.ru.sys_ns = 300;
+    t.ru.syscalls = 9;
+
+    sched::task_rusage ru = {};
+    RUN_ELEVATED(sched::read_task_rusage(&t, &ru));
+    EXPECT_EQ(ru.user_ns, static_cast<uint64_t>(700));
+    EXPECT_EQ(ru.sys_ns, static_cast<uint64_t>(300));
+    EXPECT_EQ(ru.syscalls, static_cast<uint64_t>(9));
+    EXPECT_EQ(ru.maxrss_kb, static_cast<uint64_t>(4 * (pmm::PAGE_SIZE / 1024)));
+
+    // System time charged ahead of run time is clamped
+    t.ru.sys_ns = 1500;
+    RUN_ELEVATED(sched::read_task_rusage(&t, &ru));
+    EXPECT_EQ(ru.user_ns, static_cast<uint64_t>(0));
+    EXPECT_EQ(ru.sys_ns, static_cast<uint64_t>(1000));
+}
+
+// --- kernel_task_is_all_system ---
+// Proves: a kernel task reports its whole run time as system time.
+
+TEST(rusage, kernel_task_is_all_system) {
+    sched::task& t = s_tasks[0];
+    init_mock_task(t, 501);
+    t.exec.flags = sched::TASK_FLAG_KERNEL;
+    t.run_ns = 800;
+
+    sched::task_rusage ru = {};
+    RUN_ELEVATED(sched::read_task_rusage(&t, &ru));
+    EXPECT_EQ(ru.user_ns, static_cast<uint64_t>(0));
+    EXPECT_EQ(ru.sys_ns, static_cast<uint64_t>(800));
+    EXPECT_EQ(ru.maxrss_kb, static_cast<uint64_t>(0));
+}
+
+// --- group_sums_exited_leader_and_threads ---
+// Proves: a process's usage is its exited threads' totals plus the
+// leader plus every live thread, and a folded thread moves from the
+// live set into the exited totals without being counted twice.
+
+TEST(rusage, group_sums_exited_leader_and_threads) {
+    init_mock_group(600);
+    sched::task& leader = s_tasks[0];
+    sched::task& a = s_tasks[1];
+    sched::task& b = s_tasks[2];
+    init_mock_task(leader, 600);
+    init_mock_task(a, 601);
+    init_mock_task(b, 602);
+    leader.group = a.group = b.group = &s_group;
+    leader.ru.minflt = 1;
+    a.ru.minflt = 10;
+    b.ru.minflt = 100;
+    s_group.exited_ru.minflt = 1000;
+    s_group.leader = &leader;
+    s_group.threads.push_back(&a);
+    s_group.threads.push_back(&b);
+
+    sched::task_rusage ru = {};
+    RUN_ELEVATED(sched::read_group_rusage(&s_group, &ru));
+    EXPECT_EQ(ru.minflt, static_cast<uint64_t>(1111));
+
+    RUN_ELEVATED({
+        s_group.threads.remove(&b);
+        sched::fold_exited_task_locked(&s_group, &b);
+        sched::read_group_rusage(&s_group, &ru);
+    });
+    EXPECT_EQ(ru.minflt, static_cast<uint64_t>(1111));
+    EXPECT_EQ(s_group.exited_ru.minflt, static_cast<uint64_t>(1100));
+
+    // The leader reports the whole group, a thread only itself
+    RUN_ELEVATED(sched::read_exit_rusage(&leader, &ru));
+    EXPECT_EQ(ru.minflt, static_cast<uint64_t>(1111));
+    RUN_ELEVATED(sched::read_exit_rusage(&a, &ru));
+    EXPECT_EQ(ru.minflt, static_cast<uint64_t>(10));
+}
+
+// --- sleep_counts_voluntary_switch ---
+// Proves: blocking in sleep counts a voluntary context switch for the
+// running task, and yielding to a runnable peer is not counted as one.
+
+TEST(rusage, sleep_counts_voluntary_switch) {
+    uint64_t before = 0;
+    uint64_t after = 0;
+    RUN_ELEVATED({
+        sched::task* self = sched::current();
+        before = __atomic_load_n(&self->ru.nvcsw, __ATOMIC_RELAXED);
+        sched::sleep_ms(5);
+        after = __atomic_load_n(&self->ru.nvcsw, __ATOMIC_RELAXED);
+    });
+    EXPECT_GT(after, before);
+
+    RUN_ELEVATED({
+        sched::task* self = sched::current();
+        before = __atomic_load_n(&self->ru.nvcsw, __ATOMIC_RELAXED);
+        sched::yield();
+        after = __atomic_load_n(&self->ru.nvcsw, __ATOMIC_RELAXED);
+    });
+    EXPECT_EQ(after, before);
+}
+
+// --- wait4_reaps_child_once ---
+// Proves: wait4 reaps a real child that ran and exited, returns its pid,
+// records the usage it copies out (the child's own plus the children it
+// reaped itself), adds that to the caller's RUSAGE_CHILDREN totals, and
+// a second wait4 finds no child left to reap.
+
+TEST(rusage, wait4_reaps_child_once) {
+    sched::task* self = sched::current();
+    sched::thread_group* self_tg = nullptr;
+    sched::thread_group* child_tg = nullptr;
+    sched::task* child = nullptr;
+    RUN_ELEVATED({
+        self_tg = heap::kalloc_new<sched::thread_group>();
+        child_tg = heap::kalloc_new<sched::thread_group>();
+        child = sched::create_kernel_task(wait4_child_entry, nullptr, "wait4_child");
+    });
+    ASSERT_NOT_NULL(self_tg);
+    ASSERT_NOT_NULL(child_tg);
+    ASSERT_NOT_NULL(child);
+
+    // Give both sides a process identity; the child has already reaped
+    // grandchildren of its own
+    init_leader_group(self_tg, self);
+    init_leader_group(child_tg, child);
+    child_tg->children_ru.minflt = 40;
+    child_tg->children_ru.maxrss_kb = 64;
+    child->group = child_tg;
+    self->group = self_tg;
+    uint32_t child_tid = child->tid;
+
+    resource::resource_object* obj = nullptr;
+    resource::handle_t handle = -1;
+    int32_t rc32 = -1;
+    RUN_ELEVATED({
+        rc32 = resource::proc_provider::create_proc_resource(child, &obj);
+        if (rc32 == 0) {
+            rc32 = resource::alloc_handle(
+                self->handles, obj, resource::resource_type::PROCESS, 0, &handle);
+        }
+    });
+    ASSERT_EQ(rc32, 0);
+    auto* pr = resource::proc_provider::get_proc_resource(obj);
+    ASSERT_NOT_NULL(pr);
+
+    int64_t rc = 0;
+    RUN_ELEVATED({
+        sched::enqueue(child);
+        rc = sys_wait4(child_tid, 0, 0, 0, 0, 0);
+    });
+    EXPECT_EQ(rc, static_cast<int64_t>(child_tid));
+    EXPECT_TRUE(pr->reaped);
+    EXPECT_EQ(pr->wait_status, 0);
+    EXPECT_GE(pr->rusage.minflt, CHILD_FAULTS);
+    EXPECT_EQ(pr->children_rusage.minflt, static_cast<uint64_t>(40));
+
+    sched::task_rusage totals = {};
+    RUN_ELEVATED(sched::read_children_rusage(self_tg, &totals));
+    EXPECT_EQ(totals.minflt, pr->rusage.minflt + 40);
+    EXPECT_EQ(totals.sys_ns, pr->rusage.sys_ns);
+    EXPECT_EQ(totals.maxrss_kb, static_cast<uint64_t>(64));
+
+    // The handle was closed by the reap, nothing is left to wait for
+    RUN_ELEVATED({ rc = sys_wait4(child_tid, 0, 0, 0, 0, 0); });
+    EXPECT_EQ(rc, syscall::ECHILD);
+
+    self->group = nullptr;
+    RUN_ELEVATED({
+        resource::resource_release(obj);
+        heap::kfree_delete(self_tg);
+    });
+}
@@ -39,18 +39,17 @@ static void spin_for_ns(uint64_t duration_ns) {
     }
 }
 
-// The spinner runs for a fixed duration and reports its own run_ticks
+// The spinner runs for a fixed duration and reports its own run_ns
 // before exiting, because its task struct is reaped after exit
 static volatile uint32_t g_spinner_done = 0;
-static volatile uint32_t g_spinner_ticks = 0;
+static volatile uint64_t g_spinner_run_ns = 0;
 
 static void spinner_task_fn(void*) {
     spin_for_ns(SPIN_NS);
     RUN_ELEVATED({
         sched::task* self = sched::current();
-        uint64_t ticks = __atomic_load_n(&self->run_ticks, __ATOMIC_RELAXED);
-        __atomic_store_n(&g_spinner_ticks, static_cast<uint32_t>(ticks),
-                         __ATOMIC_RELEASE);
+        uint64_t run_ns = __atomic_load_n(&self->run_ns, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_spinner_run_ns, run_ns, __ATOMIC_RELEASE);
     });
     __atomic_store_n(&g_spinner_done, 1, __ATOMIC_RELEASE);
     sched::exit(0);
@@ -79,12 +78,12 @@ TEST(tick_accounting, ticks_advance) {
 }
 
 // --- busy_task_charged ---
-// Proves: a compute-bound task accumulates run_ticks while current
+// Proves: a compute-bound task accumulates run_ns while current
 // and its CPU charges that time as busy.
 
 TEST(tick_accounting, busy_task_charged) {
     g_spinner_done = 0;
-    g_spinner_ticks = 0;
+    g_spinner_run_ns = 0;
 
     uint64_t busy_before = 0;
     RUN_ELEVATED({
@@ -113,5 +112,32 @@ TEST(tick_accounting, busy_task_charged) {
     });
 
     EXPECT_LT(busy_before, busy_after);
-    EXPECT_TRUE(g_spinner_ticks > 0);
+    EXPECT_TRUE(g_spinner_run_ns > 0);
+}
+
+// --- idle_cpu_accrues_idle_time ---
+// Proves: a CPU parked in its idle task keeps accruing idle time
+// even though its periodic tick is stopped.
+
+TEST(tick_accounting, idle_cpu_accrues_idle_time) {
+    uint32_t cpu_count = smp::cpu_count();
+    if (cpu_count < 2) {
+        return;
+    }
+
+    uint32_t other = 0;
+    uint64_t idle_before = 0;
+    RUN_ELEVATED({
+        other = (percpu::current_cpu_id() + 1) % cpu_count;
+        idle_before = sched::read_cpu_accounting_stats(other).idle_ticks;
+    });
+
+    spin_for_ns(SPIN_NS);
+
+    uint64_t idle_after = 0;
+    RUN_ELEVATED({
+        idle_after = sched::read_cpu_accounting_stats(other).idle_ticks;
+    });
+
+    EXPECT_LT(idle_before, idle_after);
 }
@@ -0,0 +1,142 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "smp/smp.h"
+#include "percpu/percpu.h"
+#include "dynpriv/dynpriv.h"
+
+using test_helpers::spin_wait;
+
+TEST_SUITE(wake_placement);
+
+static uint64_t total_decisions() {
+    uint64_t total = 0;
+    RUN_ELEVATED({
+        for (uint32_t cpu = 0; cpu < smp::cpu_count(); cpu++) {
+            sched::wake_stats ws = sched::read_wake_stats(cpu);
+            total += ws.prev_idle + ws.affine + ws.cache_hot +
+                     ws.idle_cpu + ws.prev_busy + ws.pinned;
+        }
+    });
+    return total;
+}
+
+static uint64_t total_pinned() {
+    uint64_t total = 0;
+    RUN_ELEVATED({
+        for (uint32_t cpu = 0; cpu < smp::cpu_count(); cpu++) {
+            total += sched::read_wake_stats(cpu).pinned;
+        }
+    });
+    return total;
+}
+
+// --- every_wake_is_counted ---
+// Proves: each timer wakeup of a sleeping task is recorded as exactly
+// one placement decision, and the task keeps running wherever it lands.
+
+constexpr uint32_t SLEEP_ROUNDS = 8;
+
+static volatile uint32_t g_sleeper_done = 0;
+
+static void sleeper_fn(void*) {
+    for (uint32_t i = 0; i < SLEEP_ROUNDS; i++) {
+        RUN_ELEVATED({
+            sched::sleep_ns(2000000ULL);
+        });
+    }
+    __atomic_store_n(&g_sleeper_done, 1, __ATOMIC_RELEASE);
+    sched::exit(0);
+}
+
+TEST(wake_placement, every_wake_is_counted) {
+    g_sleeper_done = 0;
+    uint64_t before = total_decisions();
+
+    RUN_ELEVATED({
+        sched::task* t = sched::create_kernel_task(
+            sleeper_fn, nullptr, "wake_sleeper");
+        ASSERT_NOT_NULL(t);
+        sched::enqueue(t);
+    });
+
+    ASSERT_TRUE(spin_wait(&g_sleeper_done));
+    EXPECT_GE(total_decisions() - before, static_cast<uint64_t>(SLEEP_ROUNDS));
+}
+
+// --- migrations_bounded_by_decisions ---
+// Proves: migration and remote counters never exceed the number of
+// placement decisions they are derived from.
+
+TEST(wake_placement, migrations_bounded_by_decisions) {
+    RUN_ELEVATED({
+        for (uint32_t cpu = 0; cpu < smp::cpu_count(); cpu++) {
+            sched::wake_stats ws = sched::read_wake_stats(cpu);
+            uint64_t decisions = ws.prev_idle + ws.affine + ws.cache_hot +
+                                 ws.idle_cpu + ws.prev_busy + ws.pinned;
+            EXPECT_LE(ws.migrations, decisions);
+            EXPECT_LE(ws.remote, decisions);
+        }
+    });
+}
+
+// --- enqueue_on_stays_pinned ---
+// Proves: a task placed with enqueue_on wakes on its own CPU every time,
+// even while a hog keeps that CPU busy and other CPUs sit idle, and each
+// of those wakeups is counted as pinned.
+
+static volatile uint32_t g_pinned_done = 0;
+static volatile uint32_t g_pinned_moved = 0;
+static volatile uint32_t g_hog_stop = 0;
+
+static void pinned_sleeper_fn(void* arg) {
+    uint32_t home = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+    for (uint32_t i = 0; i < SLEEP_ROUNDS; i++) {
+        RUN_ELEVATED({
+            sched::sleep_ns(2000000ULL);
+        });
+        if (percpu::current_cpu_id() != home) {
+            __atomic_store_n(&g_pinned_moved, 1, __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_store_n(&g_pinned_done, 1, __ATOMIC_RELEASE);
+    sched::exit(0);
+}
+
+static void hog_fn(void*) {
+    while (!__atomic_load_n(&g_hog_stop, __ATOMIC_ACQUIRE)) {
+        asm volatile("" ::: "memory");
+    }
+    sched::exit(0);
+}
+
+TEST(wake_placement, enqueue_on_stays_pinned) {
+    uint32_t cpus = smp::cpu_count();
+    if (cpus < 2) return;
+
+    uint32_t target = cpus - 1;
+    uint64_t pinned_before = total_pinned();
+    g_pinned_done = 0;
+    g_pinned_moved = 0;
+    g_hog_stop = 0;
+
+    RUN_ELEVATED({
+        sched::task* hog = sched::create_kernel_task(hog_fn, nullptr, "wake_hog");
+        ASSERT_NOT_NULL(hog);
+        sched::task* t = sched::create_kernel_task(
+            pinned_sleeper_fn, reinterpret_cast<void*>(static_cast<uintptr_t>(target)),
+            "wake_pinned");
+        ASSERT_NOT_NULL(t);
+        sched::enqueue_on(hog, target);
+        sched::enqueue_on(t, target);
+    });
+
+    bool done = spin_wait(&g_pinned_done);
+    __atomic_store_n(&g_hog_stop, 1, __ATOMIC_RELEASE);
+    ASSERT_TRUE(done);
+    EXPECT_EQ(__atomic_load_n(&g_pinned_moved, __ATOMIC_ACQUIRE), 0u);
+    EXPECT_GE(total_pinned() - pinned_before, static_cast<uint64_t>(SLEEP_ROUNDS));
+}
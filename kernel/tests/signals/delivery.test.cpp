@@ -178,6 +178,36 @@ TEST(signal_delivery, x86_sanitizes_restored_mxcsr) {
     EXPECT_EQ(mxcsr & 0x1F80U, 0x1F80U); // supported control bits survive
 }
 
+TEST(signal_delivery, x86_sanitizes_restored_xsave_header) {
+    sched::fpu_state fp;
+    uint64_t xstate_bv = 0;
+    uint64_t xcomp_bv = 0;
+    uint8_t reserved = 0;
+    uint64_t xcr0 = 0;
+
+    RUN_ELEVATED({
+        xcr0 = cpu::g_features.xcr0;
+        fpu::save_user(&fp);
+        *reinterpret_cast<uint64_t*>(&fp.xsave_header[0]) = ~0ULL;
+        *reinterpret_cast<uint64_t*>(&fp.xsave_header[8]) = fpu::XCOMP_BV_COMPACTED;
+        fp.xsave_header[63] = 0xAA;
+        fpu::sanitize_user_state(&fp);
+        xstate_bv = *reinterpret_cast<uint64_t*>(&fp.xsave_header[0]);
+        xcomp_bv = *reinterpret_cast<uint64_t*>(&fp.xsave_header[8]);
+        reserved = fp.xsave_header[63];
+        if (xcr0) {
+            // Would #GP on any of the bits above
+            fpu::restore_user(&fp);
+        }
+    });
+
+    if (xcr0) {
+        EXPECT_EQ(xstate_bv & ~xcr0, 0ULL);
+        EXPECT_EQ(xcomp_bv, 0ULL);
+        EXPECT_EQ(reserved, 0U);
+    }
+}
+
 TEST(signal_delivery, x86_full_frame_captures_scratch_registers) {
     x86::trap_frame tf{};
     tf.rax = 0x2001; tf.rcx = 0x2002; tf.r11 = 0x2003;
@@ -0,0 +1,116 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "strace/strace.h"
+#include "mm/heap.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(strace);
+
+// Owner cookies, only compared by address
+static int g_owner_a;
+static int g_owner_b;
+
+// A pid no process has, so real syscalls never land in the buffer
+constexpr uint32_t UNUSED_PID = 0xFFFFFFF0u;
+
+// --- records_enter_and_exit_in_order ---
+// Proves: enter and exit records come back oldest first with their
+// arguments, return value and duration, and detach stops tracing.
+
+TEST(strace, records_enter_and_exit_in_order) {
+    auto* buf = static_cast<strace::record*>(heap::kzalloc(8 * sizeof(strace::record)));
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = strace::ERR;
+    RUN_ELEVATED(rc = strace::attach(UNUSED_PID, &g_owner_a));
+    ASSERT_EQ(rc, strace::OK);
+
+    const uint64_t args[6] = { 1, 2, 3, 4, 5, 6 };
+    size_t got = 0;
+    strace::strace_stats stats = {};
+    RUN_ELEVATED({
+        strace::record_enter(77, 39, args);
+        strace::record_exit(77, 39, -22, 1234);
+        got = strace::read_records(buf, 8);
+        stats = strace::read_stats();
+    });
+
+    ASSERT_EQ(got, 2u);
+    EXPECT_EQ(buf[0].kind, strace::REC_ENTER);
+    EXPECT_EQ(buf[0].tid, 77u);
+    EXPECT_EQ(buf[0].nr, 39u);
+    EXPECT_EQ(buf[0].args[0], 1u);
+    EXPECT_EQ(buf[0].args[5], 6u);
+    EXPECT_EQ(buf[1].kind, strace::REC_EXIT);
+    EXPECT_EQ(buf[1].ret, -22);
+    EXPECT_EQ(buf[1].dur_ns, 1234u);
+    EXPECT_GE(buf[1].ts_ns, buf[0].ts_ns);
+    EXPECT_EQ(stats.records, 2u);
+    EXPECT_EQ(stats.pid, UNUSED_PID);
+
+    RUN_ELEVATED({
+        strace::detach(&g_owner_a);
+        stats = strace::read_stats();
+    });
+    EXPECT_EQ(stats.pid, 0u);
+
+    heap::kfree(buf);
+}
+
+// --- second_owner_is_busy ---
+// Proves: only one owner can trace at a time, and the process becomes
+// available again once that owner detaches.
+
+TEST(strace, second_owner_is_busy) {
+    int32_t rc_a = strace::ERR;
+    int32_t rc_b = strace::ERR;
+    RUN_ELEVATED({
+        rc_a = strace::attach(UNUSED_PID, &g_owner_a);
+        rc_b = strace::attach(UNUSED_PID, &g_owner_b);
+    });
+    EXPECT_EQ(rc_a, strace::OK);
+    EXPECT_EQ(rc_b, strace::ERR_BUSY);
+
+    RUN_ELEVATED({
+        strace::detach(&g_owner_b); // not the owner, no effect
+        rc_b = strace::attach(UNUSED_PID, &g_owner_b);
+    });
+    EXPECT_EQ(rc_b, strace::ERR_BUSY);
+
+    RUN_ELEVATED({
+        strace::detach(&g_owner_a);
+        rc_b = strace::attach(UNUSED_PID, &g_owner_b);
+        strace::detach(&g_owner_b);
+    });
+    EXPECT_EQ(rc_b, strace::OK);
+}
+
+// --- full_buffer_drops_new_records ---
+// Proves: once the buffer is full further records are counted as drops
+// instead of overwriting unread ones.
+
+TEST(strace, full_buffer_drops_new_records) {
+    int32_t rc = strace::ERR;
+    RUN_ELEVATED(rc = strace::attach(UNUSED_PID, &g_owner_a));
+    ASSERT_EQ(rc, strace::OK);
+
+    strace::strace_stats stats = {};
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < strace::RING_RECORDS + 10; i++) {
+            strace::record_exit(1, 0, i, 0);
+        }
+        stats = strace::read_stats();
+    });
+    EXPECT_EQ(stats.records, static_cast<uint64_t>(strace::RING_RECORDS));
+    EXPECT_EQ(stats.drops, 10u);
+
+    strace::record first = {};
+    size_t got = 0;
+    RUN_ELEVATED({
+        got = strace::read_records(&first, 1);
+        strace::detach(&g_owner_a);
+    });
+    ASSERT_EQ(got, 1u);
+    EXPECT_EQ(first.ret, 0);
+}
@@ -0,0 +1,66 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_bench.h"
+#include "sync/futex.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+
+static volatile uint32_t g_bench_word = 0;
+
+// Bucket lookup and scan with nobody to wake, the unlock fast path
+BENCH(futex, wake_no_waiters) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(&g_bench_word);
+    BENCH_LOOP(state) {
+        sync::futex_wake(addr, 1);
+    }
+}
+
+// Value already changed, so the wait returns without blocking
+BENCH(futex, wait_mismatch) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(&g_bench_word);
+    g_bench_word = 1;
+    BENCH_LOOP(state) {
+        if (sync::futex_wait(addr, 0, 0) != -11) { // EAGAIN
+            state.fail("futex_wait did not return EAGAIN");
+            break;
+        }
+    }
+    g_bench_word = 0;
+}
+
+static volatile uint32_t g_pi_bench_done = 0;
+
+static void pi_bench_task_fn(void* arg) {
+    auto& state = *static_cast<stlx_bench::state*>(arg);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(&g_bench_word);
+    RUN_ELEVATED({
+        uint32_t tid = sched::current()->tid;
+        BENCH_LOOP(state) {
+            sync::futex_lock_pi(addr, 0, false);
+            if ((g_bench_word & sync::FUTEX_TID_MASK) != tid) {
+                state.fail("futex_lock_pi did not store the owner tid");
+                break;
+            }
+            sync::futex_unlock_pi(addr);
+        }
+    });
+    __atomic_store_n(&g_pi_bench_done, 1, __ATOMIC_RELEASE);
+    sched::exit(0);
+}
+
+// Owner tid stored and cleared with no waiters. Runs in its own task:
+// the bench runner is the boot task, whose tid 0 reads as a free word.
+BENCH(futex, lock_unlock_pi_uncontended) {
+    g_bench_word = 0;
+    g_pi_bench_done = 0;
+    sched::task* t = sched::create_kernel_task(pi_bench_task_fn, &state, "futex_pi_bench");
+    if (!t) {
+        state.fail("failed to create the bench task");
+        return;
+    }
+    sched::enqueue(t);
+    while (!__atomic_load_n(&g_pi_bench_done, __ATOMIC_ACQUIRE)) {
+        sched::yield();
+    }
+    g_bench_word = 0;
+}
@@ -329,3 +329,353 @@ TEST(futex, different_addresses_independent) {
 
     EXPECT_TRUE(spin_wait(&g_ind_woken_b));
 }
+
+// --- wake_bitset selects waiters ---
+// Proves: a bitset wake only wakes waiters whose wait bitset intersects
+// it, and a plain wake matches any bitset.
+
+static volatile uint32_t g_bs_val = 0;
+static volatile uint32_t g_bs_ready = 0;
+static volatile uint32_t g_bs_woken_mask = 0;
+
+static void bitset_waiter_fn(void* arg) {
+    uint32_t bit = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+    __atomic_fetch_add(&g_bs_ready, 1, __ATOMIC_ACQ_REL);
+    RUN_ELEVATED({
+        sync::futex_wait_bitset(
+            reinterpret_cast<uintptr_t>(&g_bs_val), 0, 0, bit);
+    });
+    __atomic_fetch_or(&g_bs_woken_mask, bit, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(futex, wake_bitset_selects_waiters) {
+    g_bs_val = 0;
+    g_bs_ready = 0;
+    g_bs_woken_mask = 0;
+
+    RUN_ELEVATED({
+        for (uint32_t bit = 1; bit <= 2; bit <<= 1) {
+            sched::task* t = sched::create_kernel_task(
+                bitset_waiter_fn, reinterpret_cast<void*>(uintptr_t{bit}), "ftx_bs");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue(t);
+        }
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_bs_ready, 2u));
+    brief_delay();
+
+    int32_t woken = 0;
+    int32_t empty = 0;
+    RUN_ELEVATED({
+        empty = sync::futex_wake_bitset(
+            reinterpret_cast<uintptr_t>(&g_bs_val), 4, 0);
+        woken = sync::futex_wake_bitset(
+            reinterpret_cast<uintptr_t>(&g_bs_val), 4, 2);
+    });
+    EXPECT_EQ(empty, static_cast<int32_t>(-22)); // EINVAL
+    EXPECT_EQ(woken, static_cast<int32_t>(1));
+    ASSERT_TRUE(spin_wait_ge(&g_bs_woken_mask, 2u));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_bs_woken_mask, __ATOMIC_ACQUIRE), 2u);
+
+    RUN_ELEVATED({
+        woken = sync::futex_wake(
+            reinterpret_cast<uintptr_t>(&g_bs_val), 4);
+    });
+    EXPECT_EQ(woken, static_cast<int32_t>(1));
+    EXPECT_TRUE(spin_wait_ge(&g_bs_woken_mask, 3u));
+}
+
+// --- wake_op applies op and wakes both ---
+// Proves: FUTEX_WAKE_OP stores the new value, wakes the first futex and
+// wakes the second only when the comparison on the old value holds.
+
+static volatile uint32_t g_wo_a = 0;
+static volatile uint32_t g_wo_b = 0;
+static volatile uint32_t g_wo_ready = 0;
+static volatile uint32_t g_wo_woken = 0;
+
+static void wake_op_waiter_fn(void* arg) {
+    auto* word = static_cast<volatile uint32_t*>(arg);
+    __atomic_fetch_add(&g_wo_ready, 1, __ATOMIC_ACQ_REL);
+    RUN_ELEVATED({
+        sync::futex_wait(reinterpret_cast<uintptr_t>(word), 0, 0);
+    });
+    __atomic_fetch_add(&g_wo_woken, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+// Pack a FUTEX_WAKE_OP argument: op and cmp codes, 12-bit oparg and cmparg
+static constexpr uint32_t wake_op_encode(uint32_t op, uint32_t cmp,
+                                         uint32_t oparg, uint32_t cmparg) {
+    return (op << 28) | (cmp << 24) | ((oparg & 0xFFF) << 12) | (cmparg & 0xFFF);
+}
+
+TEST(futex, wake_op_applies_op_and_wakes_both) {
+    g_wo_a = 0;
+    g_wo_b = 0;
+    g_wo_ready = 0;
+    g_wo_woken = 0;
+
+    RUN_ELEVATED({
+        sched::task* ta = sched::create_kernel_task(
+            wake_op_waiter_fn, const_cast<uint32_t*>(&g_wo_a), "ftx_wo_a");
+        sched::task* tb = sched::create_kernel_task(
+            wake_op_waiter_fn, const_cast<uint32_t*>(&g_wo_b), "ftx_wo_b");
+        ASSERT_NOT_NULL(ta);
+        ASSERT_NOT_NULL(tb);
+        sched::enqueue(ta);
+        sched::enqueue(tb);
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_wo_ready, 2u));
+    brief_delay();
+
+    // Compare fails (old value 0 != 5): only the first futex is woken
+    int32_t woken = 0;
+    RUN_ELEVATED({
+        woken = sync::futex_wake_op(
+            reinterpret_cast<uintptr_t>(&g_wo_a),
+            reinterpret_cast<uintptr_t>(&g_wo_b), 1, 1,
+            wake_op_encode(0, 0, 7, 5));
+    });
+    EXPECT_EQ(woken, static_cast<int32_t>(1));
+    EXPECT_EQ(g_wo_b, 7u);
+    ASSERT_TRUE(spin_wait_ge(&g_wo_woken, 1u));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_wo_woken, __ATOMIC_ACQUIRE), 1u);
+
+    // ADD 1 with old value 7 == 7: the second futex is woken too
+    RUN_ELEVATED({
+        woken = sync::futex_wake_op(
+            reinterpret_cast<uintptr_t>(&g_wo_a),
+            reinterpret_cast<uintptr_t>(&g_wo_b), 1, 1,
+            wake_op_encode(1, 0, 1, 7));
+    });
+    EXPECT_EQ(woken, static_cast<int32_t>(1));
+    EXPECT_EQ(g_wo_b, 8u);
+    EXPECT_TRUE(spin_wait_ge(&g_wo_woken, 2u));
+}
+
+// --- requeue moves waiters ---
+// Proves: CMP_REQUEUE wakes nr_wake waiters, moves the rest to the
+// second futex without waking them, and fails on a value mismatch.
+
+constexpr uint32_t REQ_TASKS = 4;
+static volatile uint32_t g_rq_src = 0;
+static volatile uint32_t g_rq_dst = 0;
+static volatile uint32_t g_rq_ready = 0;
+static volatile uint32_t g_rq_woken = 0;
+
+static void requeue_waiter_fn(void*) {
+    __atomic_fetch_add(&g_rq_ready, 1, __ATOMIC_ACQ_REL);
+    RUN_ELEVATED({
+        sync::futex_wait(reinterpret_cast<uintptr_t>(&g_rq_src), 0, 0);
+    });
+    __atomic_fetch_add(&g_rq_woken, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(futex, requeue_moves_waiters) {
+    g_rq_src = 0;
+    g_rq_dst = 0;
+    g_rq_ready = 0;
+    g_rq_woken = 0;
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < REQ_TASKS; i++) {
+            sched::task* t = sched::create_kernel_task(
+                requeue_waiter_fn, nullptr, "ftx_rq");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue(t);
+        }
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_rq_ready, REQ_TASKS));
+    brief_delay();
+
+    int32_t mismatch = 0;
+    int32_t moved = 0;
+    int32_t src_left = 0;
+    RUN_ELEVATED({
+        mismatch = sync::futex_requeue(
+            reinterpret_cast<uintptr_t>(&g_rq_src),
+            reinterpret_cast<uintptr_t>(&g_rq_dst), 1, REQ_TASKS, true, 1);
+        moved = sync::futex_requeue(
+            reinterpret_cast<uintptr_t>(&g_rq_src),
+            reinterpret_cast<uintptr_t>(&g_rq_dst), 1, REQ_TASKS, true, 0);
+        src_left = sync::futex_wake_all(
+            reinterpret_cast<uintptr_t>(&g_rq_src));
+    });
+    EXPECT_EQ(mismatch, static_cast<int32_t>(-11)); // EAGAIN
+    EXPECT_EQ(moved, static_cast<int32_t>(REQ_TASKS));
+    EXPECT_EQ(src_left, static_cast<int32_t>(0));
+
+    ASSERT_TRUE(spin_wait_ge(&g_rq_woken, 1u));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_rq_woken, __ATOMIC_ACQUIRE), 1u);
+
+    int32_t rest = 0;
+    RUN_ELEVATED({
+        rest = sync::futex_wake_all(
+            reinterpret_cast<uintptr_t>(&g_rq_dst));
+    });
+    EXPECT_EQ(rest, static_cast<int32_t>(REQ_TASKS - 1));
+    EXPECT_TRUE(spin_wait_ge(&g_rq_woken, REQ_TASKS));
+}
+
+// --- waitv returns woken index ---
+// Proves: futex_waitv blocks on several words, returns the index of the
+// one that was woken, leaves no waiter behind on the others, and fails
+// with EAGAIN without blocking when a word already changed.
+
+static volatile uint32_t g_wv_words[3] = {0, 0, 0};
+static volatile uint32_t g_wv_ready = 0;
+static volatile int32_t g_wv_rc = -1;
+static volatile uint32_t g_wv_done = 0;
+
+static void waitv_waiter_fn(void*) {
+    sync::futex_wait_key keys[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        keys[i].addr = reinterpret_cast<uintptr_t>(&g_wv_words[i]);
+        keys[i].expected = 0;
+    }
+    __atomic_store_n(&g_wv_ready, 1, __ATOMIC_RELEASE);
+    int32_t rc = 0;
+    RUN_ELEVATED({
+        rc = sync::futex_waitv(keys, 3, 0);
+    });
+    __atomic_store_n(&g_wv_rc, rc, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_wv_done, 1, __ATOMIC_RELEASE);
+    sched::exit(0);
+}
+
+TEST(futex, waitv_returns_woken_index) {
+    for (uint32_t i = 0; i < 3; i++) {
+        g_wv_words[i] = 0;
+    }
+    g_wv_ready = 0;
+    g_wv_rc = -1;
+    g_wv_done = 0;
+
+    RUN_ELEVATED({
+        sched::task* t = sched::create_kernel_task(
+            waitv_waiter_fn, nullptr, "ftx_wv");
+        ASSERT_NOT_NULL(t);
+        sched::enqueue(t);
+    });
+
+    ASSERT_TRUE(spin_wait(&g_wv_ready));
+    brief_delay();
+
+    int32_t woken = 0;
+    __atomic_store_n(&g_wv_words[1], 1, __ATOMIC_RELEASE);
+    RUN_ELEVATED({
+        woken = sync::futex_wake(
+            reinterpret_cast<uintptr_t>(&g_wv_words[1]), 1);
+    });
+    EXPECT_EQ(woken, static_cast<int32_t>(1));
+    ASSERT_TRUE(spin_wait(&g_wv_done));
+    EXPECT_EQ(static_cast<int32_t>(g_wv_rc), static_cast<int32_t>(1));
+
+    sync::futex_wait_key keys[2];
+    keys[0].addr = reinterpret_cast<uintptr_t>(&g_wv_words[0]);
+    keys[0].expected = 0;
+    keys[1].addr = reinterpret_cast<uintptr_t>(&g_wv_words[1]);
+    keys[1].expected = 0;
+
+    int32_t stale = 0;
+    int32_t mismatch = 0;
+    RUN_ELEVATED({
+        stale = sync::futex_wake_all(
+            reinterpret_cast<uintptr_t>(&g_wv_words[0]));
+        mismatch = sync::futex_waitv(keys, 2, 0);
+    });
+    EXPECT_EQ(stale, static_cast<int32_t>(0));
+    EXPECT_EQ(mismatch, static_cast<int32_t>(-11)); // EAGAIN
+}
+
+// --- lock_pi_boosts_owner_and_hands_off ---
+// Proves: contenders on a PI futex set FUTEX_WAITERS and each boost the
+// owner once, unlock hands the lock straight to one waiter which
+// inherits the remaining boost, and the last unlock clears the word.
+
+constexpr uint32_t PI_TASKS = 2;
+
+static volatile uint32_t g_pi_word = 0;
+static volatile uint32_t g_pi_entered = 0;
+static volatile uint32_t g_pi_acquired = 0;
+static volatile uint32_t g_pi_release = 0;
+static volatile int32_t g_pi_rc[PI_TASKS];
+
+static void pi_locker_fn(void* arg) {
+    uint32_t idx = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+    __atomic_fetch_add(&g_pi_entered, 1, __ATOMIC_RELEASE);
+    int32_t rc = -1;
+    RUN_ELEVATED(rc = sync::futex_lock_pi(
+        reinterpret_cast<uintptr_t>(&g_pi_word), 0, false));
+    g_pi_rc[idx] = rc;
+    __atomic_fetch_add(&g_pi_acquired, 1, __ATOMIC_RELEASE);
+    spin_wait(&g_pi_release);
+    RUN_ELEVATED(sync::futex_unlock_pi(reinterpret_cast<uintptr_t>(&g_pi_word)));
+    __atomic_fetch_add(&g_pi_release, 1, __ATOMIC_RELEASE);
+}
+
+TEST(futex, lock_pi_boosts_owner_and_hands_off) {
+    g_pi_word = 0;
+    g_pi_entered = 0;
+    g_pi_acquired = 0;
+    g_pi_release = 0;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(&g_pi_word);
+    sched::task* self = sched::current();
+
+    int32_t first = -1;
+    int32_t again = 0;
+    RUN_ELEVATED({
+        first = sync::futex_lock_pi(addr, 0, false);
+        again = sync::futex_lock_pi(addr, 0, false);
+    });
+    ASSERT_EQ(first, static_cast<int32_t>(0));
+    EXPECT_EQ(again, static_cast<int32_t>(-35)); // EDEADLK
+    EXPECT_EQ(g_pi_word, self->tid);
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < PI_TASKS; i++) {
+            sched::task* t = sched::create_kernel_task(
+                pi_locker_fn, reinterpret_cast<void*>(static_cast<uintptr_t>(i)),
+                "ftx_pi");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue(t);
+        }
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_pi_entered, PI_TASKS));
+    ASSERT_TRUE(spin_wait_ge(&self->pi_boost, PI_TASKS));
+    EXPECT_NE(g_pi_word & sync::FUTEX_WAITERS, 0u);
+    EXPECT_EQ(g_pi_word & sync::FUTEX_TID_MASK, self->tid);
+
+    int32_t unlocked = -1;
+    RUN_ELEVATED(unlocked = sync::futex_unlock_pi(addr));
+    EXPECT_EQ(unlocked, static_cast<int32_t>(0));
+    EXPECT_EQ(__atomic_load_n(&self->pi_boost, __ATOMIC_ACQUIRE), 0u);
+
+    // Exactly one contender owns it now and is boosted by the other
+    ASSERT_TRUE(spin_wait_ge(&g_pi_acquired, 1u));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_pi_acquired, __ATOMIC_ACQUIRE), 1u);
+    EXPECT_NE(g_pi_word & sync::FUTEX_TID_MASK, self->tid);
+    EXPECT_NE(g_pi_word & sync::FUTEX_TID_MASK, 0u);
+
+    int32_t busy = 0;
+    RUN_ELEVATED(busy = sync::futex_unlock_pi(addr));
+    EXPECT_EQ(busy, static_cast<int32_t>(-1)); // EPERM
+
+    __atomic_store_n(&g_pi_release, 1, __ATOMIC_RELEASE);
+    ASSERT_TRUE(spin_wait_ge(&g_pi_acquired, PI_TASKS));
+    ASSERT_TRUE(spin_wait_ge(&g_pi_release, 1u + PI_TASKS));
+    EXPECT_EQ(g_pi_rc[0], static_cast<int32_t>(0));
+    EXPECT_EQ(g_pi_rc[1], static_cast<int32_t>(0));
+    EXPECT_EQ(g_pi_word, 0u);
+}
@@ -0,0 +1,177 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "sync/spinlock.h"
+#include "sync/mutex.h"
+#include "sync/rwsem.h"
+#include "sync/lockstat.h"
+#include "mm/heap.h"
+#include "common/string.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(lockstat);
+
+#ifdef STLX_LOCKSTAT
+
+namespace {
+
+using sync::lockstat::class_stats;
+
+// Copy of the class initialized at __FILE__:line, false if it has not
+// been acquired since the last reset
+bool find_class(uint32_t line, class_stats* out) {
+    auto* classes = static_cast<class_stats*>(
+        heap::kzalloc(sync::lockstat::MAX_CLASSES * sizeof(class_stats)));
+    if (!classes) {
+        return false;
+    }
+    bool found = false;
+    RUN_ELEVATED({
+        size_t count = sync::lockstat::read_classes(classes, sync::lockstat::MAX_CLASSES);
+        for (size_t i = 0; i < count && !found; i++) {
+            if (!classes[i].by_site && classes[i].line == line &&
+                string::strcmp(classes[i].file, __FILE__) == 0) {
+                *out = classes[i];
+                found = true;
+            }
+        }
+    });
+    heap::kfree(classes);
+    return found;
+}
+
+} // namespace
+
+// --- spinlock_counts_acquisitions_per_site ---
+// Proves: a spinlock is classed by its SPINLOCK_INIT line, every
+// acquisition counts against that class and its call site, and hold
+// time accumulates.
+
+TEST(lockstat, spinlock_counts_acquisitions_per_site) {
+    constexpr uint32_t ROUNDS = 16;
+    const uint32_t init_line = __LINE__ + 1;
+    sync::spinlock lock = sync::SPINLOCK_INIT;
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < ROUNDS; i++) {
+            sync::spin_lock(lock);
+            sync::spin_unlock(lock);
+        }
+    });
+
+    class_stats cls = {};
+    ASSERT_TRUE(find_class(init_line, &cls));
+    EXPECT_EQ(cls.kind, sync::lockstat::KIND_SPIN);
+    EXPECT_EQ(cls.acquisitions, static_cast<uint64_t>(ROUNDS));
+    EXPECT_EQ(cls.contended, 0u);
+    EXPECT_GT(cls.hold_cycles, 0u);
+
+    // One call site, holding every acquisition
+    ASSERT_EQ(cls.site_count, 1u);
+    EXPECT_EQ(cls.sites[0].acquisitions, static_cast<uint64_t>(ROUNDS));
+    EXPECT_EQ(string::strcmp(cls.sites[0].file, __FILE__), 0);
+}
+
+// --- mutex_classed_by_init_and_reset ---
+// Proves: a mutex is classed by its init() call, lock and trylock both
+// count, and reset() zeroes the counters so the class is no longer
+// reported.
+
+TEST(lockstat, mutex_classed_by_init_and_reset) {
+    sync::mutex m;
+    const uint32_t init_line = __LINE__ + 1;
+    m.init();
+
+    RUN_ELEVATED({
+        sync::mutex_lock(m);
+        sync::mutex_unlock(m);
+        if (sync::mutex_trylock(m)) {
+            sync::mutex_unlock(m);
+        }
+    });
+
+    class_stats cls = {};
+    ASSERT_TRUE(find_class(init_line, &cls));
+    EXPECT_EQ(cls.kind, sync::lockstat::KIND_MUTEX);
+    EXPECT_EQ(cls.acquisitions, 2u);
+    EXPECT_EQ(cls.site_count, 2u);
+
+    RUN_ELEVATED({
+        sync::lockstat::reset();
+    });
+    EXPECT_FALSE(find_class(init_line, &cls));
+}
+
+// --- rwsem_counts_readers_and_writers ---
+// Proves: an rwsem is classed by its init() call, down_read and
+// down_write count against their own call sites, and both shared and
+// exclusive holds add hold time.
+
+TEST(lockstat, rwsem_counts_readers_and_writers) {
+    sync::rwsem rw;
+    const uint32_t init_line = __LINE__ + 1;
+    rw.init();
+
+    RUN_ELEVATED({
+        sync::down_read(rw);
+        sync::down_read(rw);
+        sync::up_read(rw);
+        sync::up_read(rw);
+        sync::down_write(rw);
+        sync::up_write(rw);
+    });
+
+    class_stats cls = {};
+    ASSERT_TRUE(find_class(init_line, &cls));
+    EXPECT_EQ(cls.kind, sync::lockstat::KIND_RWSEM);
+    EXPECT_EQ(cls.acquisitions, 3u);
+    EXPECT_EQ(cls.contended, 0u);
+    EXPECT_GT(cls.hold_cycles, 0u);
+    EXPECT_EQ(cls.site_count, 3u);
+}
+
+// --- full_class_lists_late_hot_site ---
+// Proves: once SITES_PER_CLASS sites are listed, a site that first runs
+// later and is hit more often replaces the least-used one, inheriting
+// its count, and the replaced site's acquisitions move to other_sites.
+
+TEST(lockstat, full_class_lists_late_hot_site) {
+    constexpr uint32_t COLD_SITE_LINE = 100000;
+    constexpr uint32_t HOT_SITE_LINE = 200000;
+    constexpr uint32_t HOT_ROUNDS = 32;
+    const uint32_t init_line = __LINE__ + 1;
+    sync::spinlock lock = sync::SPINLOCK_INIT;
+
+    RUN_ELEVATED({
+        // Cold sites fill the list, each hit twice so the first one is
+        // the least used once it falls behind
+        for (uint32_t i = 0; i < sync::lockstat::SITES_PER_CLASS; i++) {
+            for (uint32_t round = 0; round < 2; round++) {
+                sync::spin_lock(lock, __FILE__, COLD_SITE_LINE + i);
+                sync::spin_unlock(lock);
+            }
+        }
+        for (uint32_t i = 0; i < HOT_ROUNDS; i++) {
+            sync::spin_lock(lock, __FILE__, HOT_SITE_LINE);
+            sync::spin_unlock(lock);
+        }
+    });
+
+    class_stats cls = {};
+    ASSERT_TRUE(find_class(init_line, &cls));
+    EXPECT_EQ(cls.site_count, sync::lockstat::SITES_PER_CLASS);
+    EXPECT_EQ(cls.other_sites, 2u);
+
+    bool hot_listed = false;
+    for (uint32_t i = 0; i < cls.site_count; i++) {
+        if (cls.sites[i].line == HOT_SITE_LINE) {
+            hot_listed = true;
+            EXPECT_EQ(cls.sites[i].inherited, 2u);
+            EXPECT_EQ(cls.sites[i].acquisitions - cls.sites[i].inherited,
+                      static_cast<uint64_t>(HOT_ROUNDS));
+        }
+    }
+    EXPECT_TRUE(hot_listed);
+}
+
+#endif // STLX_LOCKSTAT
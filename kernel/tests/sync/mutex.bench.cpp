@@ -0,0 +1,26 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_bench.h"
+#include "sync/mutex.h"
+
+BENCH(mutex, lock_unlock_uncontended) {
+    sync::mutex m;
+    m.init();
+    BENCH_LOOP(state) {
+        sync::mutex_lock(m);
+        sync::mutex_unlock(m);
+    }
+}
+
+BENCH(mutex, trylock_held) {
+    sync::mutex m;
+    m.init();
+    sync::mutex_lock(m);
+    BENCH_LOOP(state) {
+        if (sync::mutex_trylock(m)) {
+            state.fail("trylock took a held mutex");
+            break;
+        }
+    }
+    sync::mutex_unlock(m);
+}
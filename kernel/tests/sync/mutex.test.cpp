@@ -34,6 +34,30 @@ TEST(mutex, basic_lock_unlock) {
     EXPECT_FALSE(sync::mutex_is_locked(m));
 }
 
+// --- stats_count_uncontended ---
+// Proves: uncontended lock and trylock count as acquisitions only.
+
+TEST(mutex, stats_count_uncontended) {
+    sync::mutex m;
+    m.init();
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < 3; i++) {
+            sync::mutex_lock(m);
+            sync::mutex_unlock(m);
+        }
+        EXPECT_TRUE(sync::mutex_trylock(m));
+        EXPECT_FALSE(sync::mutex_trylock(m));
+        sync::mutex_unlock(m);
+    });
+
+    sync::mutex_stats stats = sync::mutex_read_stats(m);
+    EXPECT_EQ(stats.acquisitions, 4u);
+    EXPECT_EQ(stats.contended, 0u);
+    EXPECT_EQ(stats.spin_acquired, 0u);
+    EXPECT_EQ(stats.sleeps, 0u);
+}
+
 // --- trylock_when_free ---
 
 TEST(mutex, trylock_when_free) {
@@ -0,0 +1,154 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "dynpriv/dynpriv.h"
+#include "sync/rwsem.h"
+
+using test_helpers::spin_wait;
+using test_helpers::brief_delay;
+
+TEST_SUITE(rwsem);
+
+// --- readers_share ---
+// Proves: several shared holds coexist, and exclusive trylock fails
+// until the last of them is released.
+
+TEST(rwsem, readers_share) {
+    sync::rwsem rw;
+    rw.init();
+
+    RUN_ELEVATED({
+        sync::down_read(rw);
+        EXPECT_TRUE(sync::down_read_trylock(rw));
+        sync::down_read(rw);
+    });
+    EXPECT_EQ(sync::rwsem_reader_count(rw), 3u);
+    EXPECT_FALSE(sync::down_write_trylock(rw));
+
+    RUN_ELEVATED({
+        sync::up_read(rw);
+        sync::up_read(rw);
+        EXPECT_FALSE(sync::down_write_trylock(rw));
+        sync::up_read(rw);
+    });
+
+    EXPECT_EQ(sync::rwsem_reader_count(rw), 0u);
+    EXPECT_TRUE(sync::down_write_trylock(rw));
+    EXPECT_TRUE(sync::rwsem_is_write_locked(rw));
+    EXPECT_FALSE(sync::down_read_trylock(rw));
+
+    RUN_ELEVATED({
+        sync::up_write(rw);
+    });
+    EXPECT_FALSE(sync::rwsem_is_write_locked(rw));
+}
+
+// --- writer_waits_for_readers ---
+// Proves: down_write blocks while a reader holds the semaphore, a
+// queued writer turns new shared trylocks away, and the last up_read
+// hands the lock to the writer.
+
+static sync::rwsem g_wr_rw;
+static volatile uint32_t g_wr_started;
+static volatile uint32_t g_wr_acquired;
+
+static void writer_fn(void*) {
+    __atomic_store_n(&g_wr_started, 1, __ATOMIC_RELEASE);
+    RUN_ELEVATED({
+        sync::down_write(g_wr_rw);
+        __atomic_store_n(&g_wr_acquired, 1, __ATOMIC_RELEASE);
+        sync::up_write(g_wr_rw);
+    });
+    sched::exit(0);
+}
+
+TEST(rwsem, writer_waits_for_readers) {
+    g_wr_rw.init();
+    g_wr_started = 0;
+    g_wr_acquired = 0;
+
+    RUN_ELEVATED({
+        sync::down_read(g_wr_rw);
+        sched::task* t = sched::create_kernel_task(writer_fn, nullptr, "rwsem_writer");
+        ASSERT_NOT_NULL(t);
+        sched::enqueue(t);
+    });
+
+    ASSERT_TRUE(spin_wait(&g_wr_started));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_wr_acquired, __ATOMIC_ACQUIRE), 0u);
+    EXPECT_FALSE(sync::down_read_trylock(g_wr_rw));
+
+    RUN_ELEVATED({
+        sync::up_read(g_wr_rw);
+    });
+
+    EXPECT_TRUE(spin_wait(&g_wr_acquired));
+}
+
+// --- readers_wait_for_writer ---
+// Proves: readers block behind an exclusive holder and are all let in
+// together by up_write.
+
+constexpr uint32_t RW_READERS = 3;
+
+static sync::rwsem g_rd_rw;
+static volatile uint32_t g_rd_started;
+static volatile uint32_t g_rd_inside;
+static volatile uint32_t g_rd_release;
+static volatile uint32_t g_rd_done;
+
+static void reader_fn(void*) {
+    __atomic_fetch_add(&g_rd_started, 1, __ATOMIC_ACQ_REL);
+    RUN_ELEVATED({
+        sync::down_read(g_rd_rw);
+    });
+    __atomic_fetch_add(&g_rd_inside, 1, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&g_rd_release, __ATOMIC_ACQUIRE)) {
+        sched::yield();
+    }
+    RUN_ELEVATED({
+        sync::up_read(g_rd_rw);
+    });
+    __atomic_fetch_add(&g_rd_done, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(rwsem, readers_wait_for_writer) {
+    g_rd_rw.init();
+    g_rd_started = 0;
+    g_rd_inside = 0;
+    g_rd_release = 0;
+    g_rd_done = 0;
+
+    RUN_ELEVATED({
+        sync::down_write(g_rd_rw);
+        for (uint32_t i = 0; i < RW_READERS; i++) {
+            sched::task* t = sched::create_kernel_task(reader_fn, nullptr, "rwsem_reader");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue(t);
+        }
+    });
+
+    ASSERT_TRUE(test_helpers::spin_wait_ge(&g_rd_started, RW_READERS));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_rd_inside, __ATOMIC_ACQUIRE), 0u);
+
+    RUN_ELEVATED({
+        sync::up_write(g_rd_rw);
+    });
+
+    // All readers hold the semaphore at the same time
+    ASSERT_TRUE(test_helpers::spin_wait_ge(&g_rd_inside, RW_READERS));
+    EXPECT_EQ(sync::rwsem_reader_count(g_rd_rw), RW_READERS);
+
+    __atomic_store_n(&g_rd_release, 1, __ATOMIC_RELEASE);
+    ASSERT_TRUE(test_helpers::spin_wait_ge(&g_rd_done, RW_READERS));
+    EXPECT_TRUE(sync::down_write_trylock(g_rd_rw));
+    RUN_ELEVATED({
+        sync::up_write(g_rd_rw);
+    });
+}
@@ -116,6 +116,13 @@ TEST(smp_mutex, cross_cpu_lock_blocks) {
     });
 
     EXPECT_TRUE(spin_wait(&g_block_acquired));
+
+    // The remote contender found the mutex held and ended up either
+    // spinning on the running holder or sleeping
+    sync::mutex_stats stats = sync::mutex_read_stats(g_block_mtx);
+    EXPECT_EQ(stats.acquisitions, 2u);
+    EXPECT_EQ(stats.contended, 1u);
+    EXPECT_GE(stats.spin_acquired + stats.sleeps, 1u);
 }
 
 // --- cross_cpu_trylock ---
@@ -0,0 +1,164 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "smp/smp.h"
+#include "clock/clock.h"
+#include "common/logging.h"
+#include "dynpriv/dynpriv.h"
+#include "sync/spinlock.h"
+
+using test_helpers::spin_wait;
+using test_helpers::spin_wait_ge;
+
+TEST_SUITE(smp_spinlock);
+
+// One worker per online CPU, up to the configured maximum
+constexpr uint32_t MAX_TEST_CPUS = MAX_CPUS;
+
+// The ticket lock the queued spinlock replaced, kept here as the
+// benchmark baseline: every waiter polls now_serving.
+struct ticket_lock {
+    uint32_t next_ticket;
+    uint32_t now_serving;
+};
+
+static inline void ticket_acquire(ticket_lock& lock) {
+    uint32_t ticket = __atomic_fetch_add(&lock.next_ticket, 1, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&lock.now_serving, __ATOMIC_ACQUIRE) != ticket) {
+        cpu::relax();
+    }
+}
+
+static inline void ticket_release(ticket_lock& lock) {
+    __atomic_fetch_add(&lock.now_serving, 1, __ATOMIC_RELEASE);
+    cpu::send_event();
+}
+
+enum class lock_kind : uint32_t {
+    queued,
+    ticket,
+};
+
+constexpr uint32_t HAMMER_ITERS = 2000;
+
+static sync::spinlock g_qlock = sync::SPINLOCK_INIT;
+static ticket_lock g_tlock = {0, 0};
+static lock_kind g_kind;
+static volatile uint32_t g_counter;
+static volatile uint32_t g_in_section;
+static volatile uint32_t g_overlaps;
+static volatile uint32_t g_go;
+static volatile uint32_t g_ready;
+static volatile uint32_t g_finished;
+
+static void hammer_fn(void*) {
+    __atomic_fetch_add(&g_ready, 1, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&g_go, __ATOMIC_ACQUIRE)) {
+        cpu::relax();
+    }
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < HAMMER_ITERS; i++) {
+            sync::irq_state irq{cpu::irq_save()};
+            if (g_kind == lock_kind::queued) {
+                sync::spin_lock(g_qlock);
+            } else {
+                ticket_acquire(g_tlock);
+            }
+
+            if (__atomic_fetch_add(&g_in_section, 1, __ATOMIC_RELAXED) != 0) {
+                __atomic_fetch_add(&g_overlaps, 1, __ATOMIC_RELAXED);
+            }
+            uint32_t val = __atomic_load_n(&g_counter, __ATOMIC_RELAXED);
+            __atomic_store_n(&g_counter, val + 1, __ATOMIC_RELAXED);
+            __atomic_fetch_sub(&g_in_section, 1, __ATOMIC_RELAXED);
+
+            if (g_kind == lock_kind::queued) {
+                sync::spin_unlock(g_qlock);
+            } else {
+                ticket_release(g_tlock);
+            }
+            cpu::irq_restore(irq.flags);
+        }
+    });
+
+    __atomic_fetch_add(&g_finished, 1, __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+/**
+ * Run one hammer round on every CPU and return its duration in ns,
+ * or 0 if the workers did not all finish.
+ */
+static uint64_t run_round(lock_kind kind, uint32_t cpus) {
+    g_kind = kind;
+    g_counter = 0;
+    g_in_section = 0;
+    g_overlaps = 0;
+    g_go = 0;
+    g_ready = 0;
+    g_finished = 0;
+
+    bool created = true;
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < cpus; i++) {
+            sched::task* t = sched::create_kernel_task(hammer_fn, nullptr, "smp_spin");
+            if (!t) {
+                created = false;
+                break;
+            }
+            sched::enqueue_on(t, i);
+        }
+    });
+    if (!created) return 0;
+
+    if (!spin_wait_ge(&g_ready, cpus)) return 0;
+    uint64_t start = clock::now_ns();
+    __atomic_store_n(&g_go, 1, __ATOMIC_RELEASE);
+    if (!spin_wait_ge(&g_finished, cpus)) return 0;
+    uint64_t elapsed = clock::now_ns() - start;
+    return elapsed ? elapsed : 1;
+}
+
+// --- cross_cpu_mutual_exclusion ---
+// Proves: the queued spinlock keeps a shared counter exact with every
+// online CPU contending, no two holders overlap, and the lock word is
+// back to unlocked with an empty queue afterwards.
+
+TEST(smp_spinlock, cross_cpu_mutual_exclusion) {
+    uint32_t cpus = smp::cpu_count();
+    if (cpus < 2 || cpus > MAX_TEST_CPUS) return;
+
+    ASSERT_NE(run_round(lock_kind::queued, cpus), 0ul);
+    EXPECT_EQ(__atomic_load_n(&g_counter, __ATOMIC_ACQUIRE), cpus * HAMMER_ITERS);
+    EXPECT_EQ(__atomic_load_n(&g_overlaps, __ATOMIC_ACQUIRE), 0u);
+    EXPECT_EQ(__atomic_load_n(&g_qlock.val, __ATOMIC_ACQUIRE), 0u);
+}
+
+// --- contention_benchmark ---
+// Proves: under all-CPU contention the queued lock and the old ticket
+// lock both stay exact. Logs acquisitions per millisecond for each so
+// the two can be compared on real hardware.
+
+TEST(smp_spinlock, contention_benchmark) {
+    uint32_t cpus = smp::cpu_count();
+    if (cpus < 2 || cpus > MAX_TEST_CPUS) return;
+
+    uint64_t total = static_cast<uint64_t>(cpus) * HAMMER_ITERS;
+
+    uint64_t queued_ns = run_round(lock_kind::queued, cpus);
+    ASSERT_NE(queued_ns, 0ul);
+    EXPECT_EQ(__atomic_load_n(&g_counter, __ATOMIC_ACQUIRE), cpus * HAMMER_ITERS);
+    EXPECT_EQ(__atomic_load_n(&g_overlaps, __ATOMIC_ACQUIRE), 0u);
+
+    uint64_t ticket_ns = run_round(lock_kind::ticket, cpus);
+    ASSERT_NE(ticket_ns, 0ul);
+    EXPECT_EQ(__atomic_load_n(&g_counter, __ATOMIC_ACQUIRE), cpus * HAMMER_ITERS);
+    EXPECT_EQ(__atomic_load_n(&g_overlaps, __ATOMIC_ACQUIRE), 0u);
+
+    log::info("spinlock bench: %u cpus, queued %lu acq/ms, ticket %lu acq/ms",
+              cpus, total * 1000000ULL / queued_ns, total * 1000000ULL / ticket_ns);
+}
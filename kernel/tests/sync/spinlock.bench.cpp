@@ -0,0 +1,20 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_bench.h"
+#include "sync/spinlock.h"
+
+BENCH(spinlock, lock_unlock) {
+    sync::spinlock lock = sync::SPINLOCK_INIT;
+    BENCH_LOOP(state) {
+        sync::spin_lock(lock);
+        sync::spin_unlock(lock);
+    }
+}
+
+BENCH(spinlock, lock_irqsave_restore) {
+    sync::spinlock lock = sync::SPINLOCK_INIT;
+    BENCH_LOOP(state) {
+        sync::irq_state irq = sync::spin_lock_irqsave(lock);
+        sync::spin_unlock_irqrestore(lock, irq);
+    }
+}
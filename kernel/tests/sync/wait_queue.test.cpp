@@ -273,8 +273,8 @@ TEST(wait_queue, repeated_wait_wake) {
 }
 
 // --- wake_one_only_wakes_one ---
-// 3 tasks block. wake_one is called three times, verifying that
-// exactly one task wakes per call.
+// 3 tasks block exclusively. wake_one is called three times, verifying
+// that exactly one task wakes per call.
 
 constexpr uint32_t WAKE_ONE_TASKS = 3;
 
@@ -289,7 +289,7 @@ static void wake_one_worker_fn(void*) {
         sync::irq_state irq = sync::spin_lock_irqsave(g_wone_lock);
         __atomic_fetch_add(&g_wone_ready_count, 1, __ATOMIC_ACQ_REL);
         while (!__atomic_load_n(&g_wone_go, __ATOMIC_ACQUIRE)) {
-            irq = sync::wait(g_wone_wq, g_wone_lock, irq);
+            irq = sync::wait_exclusive(g_wone_wq, g_wone_lock, irq);
         }
         sync::spin_unlock_irqrestore(g_wone_lock, irq);
     });
@@ -407,3 +407,70 @@ TEST(wait_queue, wake_with_condition_recheck) {
     ASSERT_TRUE(spin_wait_ge(&g_recheck_done_count, 2));
     EXPECT_EQ(__atomic_load_n(&g_recheck_done_count, __ATOMIC_ACQUIRE), 2u);
 }
+
+// --- wake_nr_wakes_plain_and_n_exclusive ---
+// Proves: wake_nr wakes every plain waiter but only the requested
+// number of exclusive ones, and wake_all wakes the remainder.
+
+constexpr uint32_t NR_PLAIN = 2;
+constexpr uint32_t NR_EXCL  = 3;
+
+static sync::wait_queue g_nr_wq;
+static sync::spinlock g_nr_lock;
+static volatile uint32_t g_nr_go;
+static volatile uint32_t g_nr_ready;
+static volatile uint32_t g_nr_plain_done;
+static volatile uint32_t g_nr_excl_done;
+
+static void nr_waiter_fn(void* arg) {
+    bool exclusive = arg != nullptr;
+    RUN_ELEVATED({
+        sync::irq_state irq = sync::spin_lock_irqsave(g_nr_lock);
+        __atomic_fetch_add(&g_nr_ready, 1, __ATOMIC_ACQ_REL);
+        // Each wake lets a waiter through once, like a consumed resource
+        do {
+            irq = exclusive ? sync::wait_exclusive(g_nr_wq, g_nr_lock, irq)
+                            : sync::wait(g_nr_wq, g_nr_lock, irq);
+        } while (!__atomic_load_n(&g_nr_go, __ATOMIC_ACQUIRE));
+        sync::spin_unlock_irqrestore(g_nr_lock, irq);
+    });
+    __atomic_fetch_add(exclusive ? &g_nr_excl_done : &g_nr_plain_done, 1,
+                       __ATOMIC_ACQ_REL);
+    sched::exit(0);
+}
+
+TEST(wait_queue, wake_nr_wakes_plain_and_n_exclusive) {
+    g_nr_wq.init();
+    g_nr_lock = sync::SPINLOCK_INIT;
+    g_nr_go = 0;
+    g_nr_ready = 0;
+    g_nr_plain_done = 0;
+    g_nr_excl_done = 0;
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < NR_PLAIN + NR_EXCL; i++) {
+            void* arg = reinterpret_cast<void*>(static_cast<uintptr_t>(i >= NR_PLAIN));
+            sched::task* t = sched::create_kernel_task(nr_waiter_fn, arg, "wq_nr");
+            ASSERT_NOT_NULL(t);
+            sched::enqueue(t);
+        }
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_nr_ready, NR_PLAIN + NR_EXCL));
+    brief_delay();
+
+    RUN_ELEVATED({
+        sync::irq_state irq = sync::spin_lock_irqsave(g_nr_lock);
+        __atomic_store_n(&g_nr_go, 1, __ATOMIC_RELEASE);
+        sync::spin_unlock_irqrestore(g_nr_lock, irq);
+        sync::wake_nr(g_nr_wq, 2);
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_nr_plain_done, NR_PLAIN));
+    ASSERT_TRUE(spin_wait_ge(&g_nr_excl_done, 2u));
+    brief_delay();
+    EXPECT_EQ(__atomic_load_n(&g_nr_excl_done, __ATOMIC_ACQUIRE), 2u);
+
+    RUN_ELEVATED(sync::wake_all(g_nr_wq));
+    EXPECT_TRUE(spin_wait_ge(&g_nr_excl_done, NR_EXCL));
+}
@@ -0,0 +1,47 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "syscall/syscall_stats.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(syscall_stats);
+
+#ifdef STLX_SYSCALL_STATS
+
+// No handler is registered here, so only this test counts it
+constexpr uint64_t TEST_NR = 2040;
+
+// --- counts_calls_and_buckets_durations ---
+// Proves: accounted calls add up across CPUs, land in the log2 bucket of
+// their duration and track the maximum.
+
+TEST(syscall_stats, counts_calls_and_buckets_durations) {
+    syscall::syscall_stat before = {};
+    syscall::syscall_stat after = {};
+    RUN_ELEVATED({
+        syscall::read_stat(TEST_NR, &before);
+        syscall::account(TEST_NR, 100);    // bucket 0
+        syscall::account(TEST_NR, 1000);   // bucket 1, 512..1023
+        syscall::account(TEST_NR, 300000); // bucket 10
+        syscall::read_stat(TEST_NR, &after);
+    });
+
+    EXPECT_EQ(after.count - before.count, 3u);
+    EXPECT_EQ(after.total_ns - before.total_ns, 301100u);
+    EXPECT_GE(after.max_ns, 300000u);
+    EXPECT_EQ(after.hist[0] - before.hist[0], 1u);
+    EXPECT_EQ(after.hist[1] - before.hist[1], 1u);
+    EXPECT_EQ(after.hist[10] - before.hist[10], 1u);
+}
+
+// --- unused_number_has_no_stats ---
+// Proves: a number that has never been called reports nothing.
+
+TEST(syscall_stats, unused_number_has_no_stats) {
+    syscall::syscall_stat st = {};
+    bool found = true;
+    RUN_ELEVATED(found = syscall::read_stat(TEST_NR + 1, &st));
+    EXPECT_FALSE(found);
+}
+
+#endif // STLX_SYSCALL_STATS
@@ -0,0 +1,167 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "timer/timer.h"
+#include "clock/clock.h"
+#include "dynpriv/dynpriv.h"
+
+using test_helpers::spin_wait;
+using test_helpers::spin_wait_ge;
+
+TEST_SUITE(timer);
+
+struct fire_record {
+    timer::timer_event ev;
+    uint64_t deadline_ns;
+    volatile uint64_t fired_ns;
+    volatile uint32_t fired;
+};
+
+static volatile uint32_t g_fire_count = 0;
+
+static void record_fire(void* arg) {
+    auto* rec = static_cast<fire_record*>(arg);
+    rec->fired_ns = clock::now_ns();
+    __atomic_store_n(&rec->fired, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&g_fire_count, 1, __ATOMIC_ACQ_REL);
+}
+
+static void arm(fire_record* rec, uint64_t delay_ns, uint32_t flags) {
+    rec->fired = 0;
+    rec->fired_ns = 0;
+    rec->deadline_ns = clock::now_ns() + delay_ns;
+    timer::init_timer(&rec->ev, record_fire, rec);
+    RUN_ELEVATED({
+        timer::add_timer(&rec->ev, rec->deadline_ns, flags);
+    });
+}
+
+static void spin_for_ns(uint64_t duration_ns) {
+    uint64_t deadline = clock::now_ns() + duration_ns;
+    while (clock::now_ns() < deadline) {
+    }
+}
+
+// --- hrtimer_fires_at_deadline ---
+// Proves: a high resolution timer fires, and never before its deadline.
+
+static fire_record g_hr;
+
+TEST(timer, hrtimer_fires_at_deadline) {
+    arm(&g_hr, 20000000ULL, timer::TIMER_HIGHRES);
+    ASSERT_TRUE(spin_wait(&g_hr.fired));
+    EXPECT_GE(g_hr.fired_ns, g_hr.deadline_ns);
+    EXPECT_FALSE(timer::timer_pending(&g_hr.ev));
+}
+
+// --- wheel_timer_fires_at_deadline ---
+// Proves: a wheel timer filed beyond level 0 cascades down and fires no
+// earlier than its deadline.
+
+static fire_record g_wheel;
+
+TEST(timer, wheel_timer_fires_at_deadline) {
+    arm(&g_wheel, 150000000ULL, 0);
+    ASSERT_TRUE(spin_wait(&g_wheel.fired));
+    EXPECT_GE(g_wheel.fired_ns, g_wheel.deadline_ns);
+}
+
+// --- cancel_prevents_fire ---
+// Proves: cancel_timer reports a pending timer and its callback never
+// runs; a second cancel reports nothing pending.
+
+static fire_record g_cancel_hr;
+static fire_record g_cancel_wheel;
+
+TEST(timer, cancel_prevents_fire) {
+    arm(&g_cancel_hr, 30000000ULL, timer::TIMER_HIGHRES);
+    arm(&g_cancel_wheel, 30000000ULL, 0);
+
+    RUN_ELEVATED({
+        EXPECT_TRUE(timer::cancel_timer(&g_cancel_hr.ev));
+        EXPECT_TRUE(timer::cancel_timer(&g_cancel_wheel.ev));
+    });
+
+    spin_for_ns(80000000ULL);
+    EXPECT_EQ(g_cancel_hr.fired, 0u);
+    EXPECT_EQ(g_cancel_wheel.fired, 0u);
+
+    RUN_ELEVATED({
+        EXPECT_FALSE(timer::cancel_timer(&g_cancel_hr.ev));
+        EXPECT_FALSE(timer::cancel_timer(&g_cancel_wheel.ev));
+    });
+}
+
+// --- rearm_moves_deadline ---
+// Proves: add_timer on a pending timer replaces its deadline instead of
+// queueing it twice.
+
+static fire_record g_rearm;
+
+TEST(timer, rearm_moves_deadline) {
+    arm(&g_rearm, 500000000ULL, timer::TIMER_HIGHRES);
+    g_rearm.deadline_ns = clock::now_ns() + 10000000ULL;
+    RUN_ELEVATED({
+        timer::add_timer(&g_rearm.ev, g_rearm.deadline_ns, 0);
+    });
+
+    ASSERT_TRUE(spin_wait(&g_rearm.fired));
+    EXPECT_GE(g_rearm.fired_ns, g_rearm.deadline_ns);
+    EXPECT_FALSE(timer::timer_pending(&g_rearm.ev));
+}
+
+// --- many_timers_all_fire ---
+// Proves: a few hundred concurrent timers spread over several wheel
+// levels and the hrtimer tree each fire exactly once, on time.
+
+constexpr uint32_t MANY_TIMERS = 256;
+static fire_record g_many[MANY_TIMERS];
+
+TEST(timer, many_timers_all_fire) {
+    __atomic_store_n(&g_fire_count, 0u, __ATOMIC_RELEASE);
+
+    for (uint32_t i = 0; i < MANY_TIMERS; i++) {
+        // 1 ms .. ~300 ms, odd entries exact, even entries on the wheel
+        uint64_t delay = 1000000ULL + (static_cast<uint64_t>(i * 37 % MANY_TIMERS) * 1170000ULL);
+        arm(&g_many[i], delay, (i & 1) ? timer::TIMER_HIGHRES : 0);
+    }
+
+    ASSERT_TRUE(spin_wait_ge(&g_fire_count, MANY_TIMERS));
+    spin_for_ns(20000000ULL);
+    EXPECT_EQ(__atomic_load_n(&g_fire_count, __ATOMIC_ACQUIRE), MANY_TIMERS);
+
+    for (uint32_t i = 0; i < MANY_TIMERS; i++) {
+        EXPECT_EQ(g_many[i].fired, 1u);
+        EXPECT_GE(g_many[i].fired_ns, g_many[i].deadline_ns);
+    }
+}
+
+// --- wheel_rearm_past_deadline_from_callback ---
+// Proves: a wheel callback that re-arms itself with a deadline that is
+// already due fires again on a later pass instead of being run over and
+// over while its slot drains, which used to hang the timer interrupt.
+
+constexpr uint32_t REARM_ROUNDS = 5;
+static timer::timer_event g_self_rearm;
+static volatile uint32_t g_self_rearm_count = 0;
+
+static void self_rearm_fire(void*) {
+    uint32_t n = __atomic_add_fetch(&g_self_rearm_count, 1, __ATOMIC_ACQ_REL);
+    if (n < REARM_ROUNDS) {
+        timer::add_timer(&g_self_rearm, clock::now_ns() - 1, 0);
+    }
+}
+
+TEST(timer, wheel_rearm_past_deadline_from_callback) {
+    __atomic_store_n(&g_self_rearm_count, 0u, __ATOMIC_RELEASE);
+    timer::init_timer(&g_self_rearm, self_rearm_fire, nullptr);
+    RUN_ELEVATED({
+        timer::add_timer(&g_self_rearm, clock::now_ns() + 2000000ULL, 0);
+    });
+
+    ASSERT_TRUE(spin_wait_ge(&g_self_rearm_count, REARM_ROUNDS));
+    spin_for_ns(20000000ULL);
+    EXPECT_EQ(__atomic_load_n(&g_self_rearm_count, __ATOMIC_ACQUIRE), REARM_ROUNDS);
+    EXPECT_FALSE(timer::timer_pending(&g_self_rearm));
+}
@@ -0,0 +1,258 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "trace/trace.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "sync/futex.h"
+#include "mm/heap.h"
+#include "hw/cpu.h"
+#include "sync/spinlock.h"
+#include "dynpriv/dynpriv.h"
+
+TEST_SUITE(trace);
+
+constexpr size_t DRAIN_MAX = 256;
+
+static trace::event* alloc_buf() {
+    return static_cast<trace::event*>(heap::kzalloc(DRAIN_MAX * sizeof(trace::event)));
+}
+
+static void stop_and_clear() {
+    RUN_ELEVATED({
+        trace::set_events(0);
+        trace::clear();
+    });
+}
+
+// --- records_enabled_events_only ---
+// Proves: an enabled tracepoint records its id, arguments and task, a
+// disabled one records nothing, and draining empties every buffer.
+
+TEST(trace, records_enabled_events_only) {
+    auto* buf = alloc_buf();
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = trace::ERR;
+    RUN_ELEVATED({
+        trace::clear();
+        rc = trace::set_events(1u << trace::EV_NET_RX);
+    });
+    ASSERT_EQ(rc, trace::OK);
+
+    // Emit with IRQs off so the task cannot migrate and split the
+    // events across two CPU buffers, which would break the order check
+    RUN_ELEVATED({
+        sync::irq_state irq{cpu::irq_save()};
+        for (uint64_t i = 0; i < 8; i++) {
+            TRACE(NET_RX, 100 + i, 0x0800);
+            TRACE(NET_TX, 200 + i, 0x0800, 0);
+        }
+        cpu::irq_restore(irq.flags);
+    });
+    RUN_ELEVATED(trace::set_events(0));
+
+    uint32_t self_tid = sched::current_tid();
+    uint64_t rx = 0;
+    uint64_t tx = 0;
+    uint64_t next_len = 100;
+    bool in_order = true;
+    size_t got = 0;
+    do {
+        RUN_ELEVATED(got = trace::read_events(buf, DRAIN_MAX));
+        for (size_t i = 0; i < got; i++) {
+            if (buf[i].id == trace::EV_NET_TX) {
+                tx++;
+            }
+            if (buf[i].id == trace::EV_NET_RX && buf[i].tid == self_tid &&
+                buf[i].args[1] == 0x0800) {
+                if (buf[i].args[0] != next_len) {
+                    in_order = false;
+                }
+                next_len++;
+                rx++;
+            }
+        }
+    } while (got > 0);
+
+    EXPECT_EQ(rx, 8u);
+    EXPECT_EQ(tx, 0u);
+    EXPECT_TRUE(in_order);
+
+    trace::trace_stats stats = {};
+    RUN_ELEVATED(stats = trace::read_stats());
+    EXPECT_EQ(stats.enabled, 0u);
+    EXPECT_GE(stats.events, 8u);
+    EXPECT_GT(stats.cpus, 0u);
+
+    stop_and_clear();
+    heap::kfree(buf);
+}
+
+// --- sleep_traces_switch_away ---
+// Proves: a task that sleeps is switched out, and the switch event names
+// it as the previous task.
+
+TEST(trace, sleep_traces_switch_away) {
+    auto* buf = alloc_buf();
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = trace::ERR;
+    RUN_ELEVATED({
+        trace::clear();
+        rc = trace::set_events(1u << trace::EV_SCHED_SWITCH);
+    });
+    ASSERT_EQ(rc, trace::OK);
+
+    RUN_ELEVATED(sched::sleep_ms(5));
+    RUN_ELEVATED(trace::set_events(0));
+
+    uint32_t self_tid = sched::current_tid();
+    uint64_t switched_out = 0;
+    bool only_switches = true;
+    size_t got = 0;
+    do {
+        RUN_ELEVATED(got = trace::read_events(buf, DRAIN_MAX));
+        for (size_t i = 0; i < got; i++) {
+            if (buf[i].id != trace::EV_SCHED_SWITCH) {
+                only_switches = false;
+            } else if (buf[i].args[0] == self_tid) {
+                switched_out++;
+            }
+        }
+    } while (got > 0);
+
+    EXPECT_TRUE(only_switches);
+    EXPECT_GT(switched_out, 0u);
+
+    stop_and_clear();
+    heap::kfree(buf);
+}
+
+// --- futex_unlock_pi_traces_release ---
+// Proves: releasing an uncontended PI futex records the word and no new
+// owner, and the uncontended lock that preceded it records nothing.
+
+static volatile uint32_t g_trace_pi_word = 0;
+
+TEST(trace, futex_unlock_pi_traces_release) {
+    auto* buf = alloc_buf();
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = trace::ERR;
+    RUN_ELEVATED({
+        trace::clear();
+        rc = trace::set_events((1u << trace::EV_FUTEX_LOCK_PI) |
+                               (1u << trace::EV_FUTEX_UNLOCK_PI));
+    });
+    ASSERT_EQ(rc, trace::OK);
+
+    g_trace_pi_word = 0;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(&g_trace_pi_word);
+    int32_t locked = -1;
+    int32_t unlocked = -1;
+    RUN_ELEVATED({
+        locked = sync::futex_lock_pi(addr, 0, false);
+        unlocked = sync::futex_unlock_pi(addr);
+        trace::set_events(0);
+    });
+    EXPECT_EQ(locked, 0);
+    EXPECT_EQ(unlocked, 0);
+
+    uint32_t self_tid = sched::current_tid();
+    uint64_t lock_events = 0;
+    uint64_t releases = 0;
+    size_t got = 0;
+    do {
+        RUN_ELEVATED(got = trace::read_events(buf, DRAIN_MAX));
+        for (size_t i = 0; i < got; i++) {
+            if (buf[i].tid != self_tid) {
+                continue;
+            }
+            if (buf[i].id == trace::EV_FUTEX_LOCK_PI) {
+                lock_events++;
+            } else if (buf[i].id == trace::EV_FUTEX_UNLOCK_PI &&
+                       buf[i].args[0] == addr && buf[i].args[1] == 0) {
+                releases++;
+            }
+        }
+    } while (got > 0);
+
+    EXPECT_EQ(lock_events, 0u);
+    EXPECT_EQ(releases, 1u);
+
+    stop_and_clear();
+    heap::kfree(buf);
+}
+
+// --- lowered_tracepoint_records_tid ---
+// Proves: a tracepoint hit from lowered code records the task's tid,
+// taken from the per-CPU copy rather than the privileged task.
+
+TEST(trace, lowered_tracepoint_records_tid) {
+    auto* buf = alloc_buf();
+    ASSERT_NOT_NULL(buf);
+
+    int32_t rc = trace::ERR;
+    uint32_t task_tid = 0;
+    RUN_ELEVATED({
+        trace::clear();
+        rc = trace::set_events(1u << trace::EV_NET_RX);
+        task_tid = sched::current()->tid;
+    });
+    ASSERT_EQ(rc, trace::OK);
+    ASSERT_NE(task_tid, 0u);
+    EXPECT_EQ(sched::current_tid(), task_tid);
+
+    TRACE(NET_RX, 0x5EED, 0x88B5);
+    RUN_ELEVATED(trace::set_events(0));
+
+    bool found = false;
+    size_t got = 0;
+    do {
+        RUN_ELEVATED(got = trace::read_events(buf, DRAIN_MAX));
+        for (size_t i = 0; i < got; i++) {
+            if (buf[i].id == trace::EV_NET_RX && buf[i].args[0] == 0x5EED &&
+                buf[i].args[1] == 0x88B5) {
+                EXPECT_EQ(buf[i].tid, task_tid);
+                found = true;
+            }
+        }
+    } while (got > 0);
+    EXPECT_TRUE(found);
+
+    stop_and_clear();
+    heap::kfree(buf);
+}
+
+// --- full_buffer_drops_new_events ---
+// Proves: once a CPU buffer is full further events are counted as drops
+// instead of overwriting unread ones, and clear() resets the counters.
+
+TEST(trace, full_buffer_drops_new_events) {
+    int32_t rc = trace::ERR;
+    RUN_ELEVATED({
+        trace::clear();
+        rc = trace::set_events(1u << trace::EV_NET_RX);
+    });
+    ASSERT_EQ(rc, trace::OK);
+
+    // Enough to overflow every buffer the task may migrate across
+    for (uint32_t i = 0; i < 4 * trace::RING_EVENTS; i++) {
+        TRACE(NET_RX, i, 0);
+    }
+    RUN_ELEVATED(trace::set_events(0));
+
+    trace::trace_stats stats = {};
+    RUN_ELEVATED(stats = trace::read_stats());
+    EXPECT_GT(stats.drops, 0u);
+    EXPECT_GE(stats.events + stats.drops, 4ull * trace::RING_EVENTS);
+
+    RUN_ELEVATED({
+        trace::clear();
+        stats = trace::read_stats();
+    });
+    EXPECT_EQ(stats.events, 0u);
+    EXPECT_EQ(stats.drops, 0u);
+}
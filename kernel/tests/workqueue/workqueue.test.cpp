@@ -0,0 +1,134 @@
+#define STLX_TEST_TIER TIER_SCHED
+
+#include "stlx_unit_test.h"
+#include "helpers.h"
+#include "workqueue/workqueue.h"
+#include "sched/sched.h"
+#include "percpu/percpu.h"
+#include "hw/cpu.h"
+#include "sync/spinlock.h"
+#include "dynpriv/dynpriv.h"
+
+using test_helpers::spin_wait;
+
+TEST_SUITE(workqueue);
+
+struct test_work {
+    workqueue::work_item work;
+    uint32_t          id;
+    volatile uint32_t ran;
+    volatile uint32_t ran_cpu;
+};
+
+static volatile uint32_t g_order[8];
+static volatile uint32_t g_order_next;
+
+static void record_fn(workqueue::work_item* w) {
+    auto* tw = workqueue::work_to_entry<test_work, &test_work::work>(w);
+    RUN_ELEVATED({
+        tw->ran_cpu = percpu::current_cpu_id();
+    });
+    uint32_t slot = __atomic_fetch_add(&g_order_next, 1, __ATOMIC_ACQ_REL);
+    if (slot < 8) {
+        g_order[slot] = tw->id;
+    }
+    __atomic_fetch_add(&tw->ran, 1, __ATOMIC_RELEASE);
+}
+
+static void prep(test_work* tw, uint32_t id, workqueue::work_fn fn) {
+    workqueue::init_work(&tw->work, fn);
+    tw->id = id;
+    tw->ran = 0;
+    tw->ran_cpu = 0xFFFFFFFF;
+}
+
+// --- runs_on_local_cpu_in_order ---
+// Proves: items queued on this CPU run on this CPU in queue order, a
+// pending item cannot be queued twice, and flush_work waits for it.
+
+TEST(workqueue, runs_on_local_cpu_in_order) {
+    test_work items[4];
+    g_order_next = 0;
+    uint32_t cpu = 0;
+    bool requeued = true;
+
+    RUN_ELEVATED({
+        for (uint32_t i = 0; i < 4; i++) {
+            prep(&items[i], i, record_fn);
+        }
+        sync::irq_state irq{cpu::irq_save()};
+        cpu = percpu::current_cpu_id();
+        for (uint32_t i = 0; i < 4; i++) {
+            EXPECT_TRUE(workqueue::queue_work(&items[i].work));
+        }
+        requeued = workqueue::queue_work(&items[3].work);
+        cpu::irq_restore(irq.flags);
+
+        workqueue::flush_work(&items[3].work);
+    });
+
+    EXPECT_FALSE(requeued);
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(__atomic_load_n(&items[i].ran, __ATOMIC_ACQUIRE), 1u);
+        EXPECT_EQ(items[i].ran_cpu, cpu);
+        EXPECT_EQ(g_order[i], i);
+    }
+}
+
+// --- cancel_and_flush ---
+// Proves: cancel_work removes an item still waiting behind a blocked
+// one so it never runs, and flush_work on the blocked item returns
+// only after its function has finished.
+
+static volatile uint32_t g_block_entered;
+static volatile uint32_t g_block_release;
+
+static void blocking_fn(workqueue::work_item* w) {
+    __atomic_store_n(&g_block_entered, 1, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&g_block_release, __ATOMIC_ACQUIRE)) {
+        RUN_ELEVATED(sched::yield());
+    }
+    record_fn(w);
+}
+
+static test_work g_blocker;
+
+static void releaser_fn(void*) {
+    test_helpers::brief_delay();
+    __atomic_store_n(&g_block_release, 1, __ATOMIC_RELEASE);
+    sched::exit(0);
+}
+
+TEST(workqueue, cancel_and_flush) {
+    test_work victim;
+    g_order_next = 0;
+    g_block_entered = 0;
+    g_block_release = 0;
+
+    bool cancelled = false;
+    RUN_ELEVATED({
+        prep(&g_blocker, 0, blocking_fn);
+        prep(&victim, 1, record_fn);
+        EXPECT_TRUE(workqueue::queue_work(&g_blocker.work));
+        EXPECT_TRUE(workqueue::queue_work(&victim.work));
+    });
+    ASSERT_TRUE(spin_wait(&g_block_entered));
+
+    RUN_ELEVATED({
+        cancelled = workqueue::cancel_work(&victim.work);
+
+        sched::task* t = sched::create_kernel_task(releaser_fn, nullptr, "wq_release");
+        ASSERT_NOT_NULL(t);
+        sched::enqueue(t);
+
+        EXPECT_TRUE(workqueue::flush_work(&g_blocker.work));
+    });
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(__atomic_load_n(&g_blocker.ran, __ATOMIC_ACQUIRE), 1u);
+    EXPECT_EQ(__atomic_load_n(&victim.ran, __ATOMIC_ACQUIRE), 0u);
+
+    RUN_ELEVATED({
+        EXPECT_FALSE(workqueue::flush_work(&victim.work));
+    });
+}
@@ -0,0 +1,562 @@
+#include "timer/timer.h"
+#include "timer/timer_internal.h"
+#include "sched/task.h"
+#include "sched/sched.h"
+#include "clock/clock.h"
+#include "mm/heap.h"
+#include "hw/cpu.h"
+#include "percpu/percpu.h"
+#include "sync/spinlock.h"
+#include "common/logging.h"
+
+namespace timer {
+
+constexpr uint64_t NS_PER_SEC = 1000000000ULL;
+constexpr uint64_t NO_DEADLINE = ~0ULL;
+
+// Wheel geometry: a unit is 2^20 ns (~1.05 ms), slots of level L span
+// 64^L units. Five levels cover 2^30 units (~13 days); later deadlines
+// park in the last level and are refiled each time their slot cascades.
+constexpr uint32_t WHEEL_UNIT_SHIFT = 20;
+constexpr uint32_t WHEEL_SLOT_BITS  = 6;
+constexpr uint32_t WHEEL_SLOTS      = 1u << WHEEL_SLOT_BITS;
+constexpr uint32_t WHEEL_SLOT_MASK  = WHEEL_SLOTS - 1;
+constexpr uint32_t WHEEL_LEVELS     = 5;
+constexpr uint64_t WHEEL_RANGE      = 1ULL << (WHEEL_SLOT_BITS * WHEEL_LEVELS);
+
+// wheel_idx of a timer moved to timer_base::expiring, off the wheel
+constexpr uint16_t WHEEL_IDX_EXPIRING = 0xFFFF;
+
+struct hrtimer_less {
+    bool operator()(const timer_event& a, const timer_event& b) const {
+        if (a.deadline_ns != b.deadline_ns) {
+            return a.deadline_ns < b.deadline_ns;
+        }
+        return &a < &b;
+    }
+};
+
+using wheel_slot = list::head<timer_event, &timer_event::wheel_link>;
+using hrtimer_tree = rbt::tree<timer_event, &timer_event::tree_link, hrtimer_less>;
+
+struct timer_base {
+    sync::spinlock lock;
+    uint64_t tick_interval_ns;
+    uint64_t next_tick_ns;
+    uint64_t programmed_ns;
+    bool tick_stopped; // NOHZ idle: only timer deadlines are programmed
+
+    uint64_t wheel_clk;   // next wheel unit to process
+    uint32_t wheel_count;
+    uint64_t wheel_bitmap[WHEEL_LEVELS]; // non-empty slots of each level
+    wheel_slot wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+    wheel_slot expiring; // due timers of the unit run_wheel is firing
+
+    hrtimer_tree hrtimers;
+
+    timer_event* running; // callback in progress, polled by cancel_timer
+};
+
+// The wheel does not fit the per-CPU area, each CPU allocates its base
+static DEFINE_PER_CPU(timer_base*, cpu_timer_base);
+
+__PRIVILEGED_BSS static uint32_t g_tick_hz;
+
+inline uint32_t level_shift(uint32_t level) {
+    return level * WHEEL_SLOT_BITS;
+}
+
+inline uint64_t ns_to_unit_ceil(uint64_t ns) {
+    uint64_t unit = ns >> WHEEL_UNIT_SHIFT;
+    if (ns & ((1ULL << WHEEL_UNIT_SHIFT) - 1)) {
+        unit++;
+    }
+    return unit;
+}
+
+/**
+ * File t into the wheel slot for its deadline relative to wheel_clk:
+ * level 0 takes deltas below 64 units, level L deltas below 64^(L+1).
+ * Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void wheel_enqueue(timer_base& base, timer_event* t) {
+    uint64_t clk = base.wheel_clk;
+    uint64_t unit = ns_to_unit_ceil(t->deadline_ns);
+    if (unit < clk) {
+        unit = clk;
+    }
+    if (unit - clk >= WHEEL_RANGE) {
+        unit = clk + WHEEL_RANGE - 1;
+    }
+
+    uint64_t delta = unit - clk;
+    uint32_t level = 0;
+    while (level + 1 < WHEEL_LEVELS &&
+           delta >= (1ULL << level_shift(level + 1))) {
+        level++;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(unit >> level_shift(level)) & WHEEL_SLOT_MASK;
+    base.wheel[level][slot].push_back(t);
+    base.wheel_bitmap[level] |= 1ULL << slot;
+    base.wheel_count++;
+    t->wheel_idx = static_cast<uint16_t>(level * WHEEL_SLOTS + slot);
+}
+
+/**
+ * Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void wheel_dequeue(timer_base& base, timer_event* t) {
+    if (t->wheel_idx == WHEEL_IDX_EXPIRING) {
+        base.expiring.remove(t);
+        return;
+    }
+    uint32_t level = t->wheel_idx / WHEEL_SLOTS;
+    uint32_t slot = t->wheel_idx % WHEEL_SLOTS;
+    wheel_slot& head = base.wheel[level][slot];
+    head.remove(t);
+    if (head.empty()) {
+        base.wheel_bitmap[level] &= ~(1ULL << slot);
+    }
+    base.wheel_count--;
+}
+
+/**
+ * First wheel unit at or after wheel_clk that needs processing: a
+ * non-empty level 0 slot, or the boundary where a non-empty upper slot
+ * cascades. Upper slots report their cascade point, which is never
+ * later than the deadlines they hold. Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint64_t wheel_next_unit(const timer_base& base) {
+    if (base.wheel_count == 0) {
+        return NO_DEADLINE;
+    }
+
+    uint64_t clk = base.wheel_clk;
+    uint64_t next = NO_DEADLINE;
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        uint64_t bitmap = base.wheel_bitmap[level];
+        if (!bitmap) {
+            continue;
+        }
+
+        uint32_t shift = level_shift(level);
+        uint64_t span = 1ULL << shift;
+        uint64_t first = (clk + span - 1) & ~(span - 1);
+        uint32_t idx = static_cast<uint32_t>(first >> shift) & WHEEL_SLOT_MASK;
+        uint64_t rotated = idx ? ((bitmap >> idx) | (bitmap << (WHEEL_SLOTS - idx)))
+                               : bitmap;
+        uint64_t unit = first + (static_cast<uint64_t>(__builtin_ctzll(rotated)) << shift);
+        if (unit < next) {
+            next = unit;
+        }
+    }
+    return next;
+}
+
+/**
+ * Refile the upper-level slots whose boundary is wheel_clk, lowest level
+ * first. Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void wheel_cascade(timer_base& base) {
+    for (uint32_t level = 1; level < WHEEL_LEVELS; level++) {
+        uint32_t shift = level_shift(level);
+        if (base.wheel_clk & ((1ULL << shift) - 1)) {
+            break;
+        }
+
+        uint32_t slot = static_cast<uint32_t>(base.wheel_clk >> shift) & WHEEL_SLOT_MASK;
+        wheel_slot& head = base.wheel[level][slot];
+        while (!head.empty()) {
+            timer_event* t = head.pop_front();
+            base.wheel_count--;
+            wheel_enqueue(base, t);
+        }
+        base.wheel_bitmap[level] &= ~(1ULL << slot);
+    }
+}
+
+/**
+ * Mark t fired and run its callback with base.lock dropped. Interrupts
+ * stay disabled throughout. Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void run_callback(timer_base& base, timer_event* t) {
+    callback_fn fn = t->fn;
+    void* arg = t->arg;
+    __atomic_store_n(&base.running, t, __ATOMIC_RELAXED);
+    __atomic_store_n(&t->state, TIMER_STATE_IDLE, __ATOMIC_RELEASE);
+
+    sync::spin_unlock(base.lock);
+    if (fn) {
+        fn(arg);
+    }
+    sync::spin_lock(base.lock);
+
+    __atomic_store_n(&base.running, static_cast<timer_event*>(nullptr), __ATOMIC_RELEASE);
+}
+
+/**
+ * Caller holds base.lock.
+ * @return true if any timer fired.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool run_hrtimers(timer_base& base, uint64_t now) {
+    bool fired = false;
+    for (;;) {
+        timer_event* t = base.hrtimers.min();
+        if (!t || t->deadline_ns > now) {
+            break;
+        }
+        base.hrtimers.remove(*t);
+        run_callback(base, t);
+        fired = true;
+    }
+    return fired;
+}
+
+/**
+ * Advance the wheel to now, jumping straight between units that have
+ * work so a long tickless idle costs nothing per skipped unit.
+ * Caller holds base.lock.
+ * @return true if any timer fired.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool run_wheel(timer_base& base, uint64_t now) {
+    uint64_t now_unit = now >> WHEEL_UNIT_SHIFT;
+    bool fired = false;
+
+    for (;;) {
+        uint64_t next = wheel_next_unit(base);
+        if (next > now_unit) {
+            break;
+        }
+
+        base.wheel_clk = next;
+        wheel_cascade(base);
+
+        // Take the whole slot off the wheel and move the clock past it
+        // before any callback runs. A callback re-arming with a deadline
+        // already due files at the new wheel_clk and fires on a later
+        // pass instead of refilling the slot being drained
+        uint32_t slot = static_cast<uint32_t>(base.wheel_clk) & WHEEL_SLOT_MASK;
+        wheel_slot& head = base.wheel[0][slot];
+        while (!head.empty()) {
+            timer_event* t = head.pop_front();
+            base.wheel_count--;
+            t->wheel_idx = WHEEL_IDX_EXPIRING;
+            base.expiring.push_back(t);
+        }
+        base.wheel_bitmap[0] &= ~(1ULL << slot);
+        base.wheel_clk++;
+
+        while (!base.expiring.empty()) {
+            run_callback(base, base.expiring.pop_front());
+            fired = true;
+        }
+    }
+
+    if (base.wheel_clk <= now_unit) {
+        base.wheel_clk = now_unit + 1;
+    }
+    return fired;
+}
+
+/**
+ * Earliest hardware event: the next tick unless the tick is stopped,
+ * the first hrtimer, or the next wheel unit with work. Caller holds
+ * base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static uint64_t next_event_ns(const timer_base& base) {
+    uint64_t next_event = base.tick_stopped ? NO_DEADLINE : base.next_tick_ns;
+
+    const timer_event* hr = base.hrtimers.min();
+    if (hr && hr->deadline_ns < next_event) {
+        next_event = hr->deadline_ns;
+    }
+
+    uint64_t unit = wheel_next_unit(base);
+    if (unit < (NO_DEADLINE >> WHEEL_UNIT_SHIFT)) {
+        uint64_t wheel_ns = unit << WHEEL_UNIT_SHIFT;
+        if (wheel_ns < next_event) {
+            next_event = wheel_ns;
+        }
+    }
+    return next_event;
+}
+
+/**
+ * Program the hardware for the earliest pending event, or disarm it when
+ * there is none. Caller holds base.lock.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void program_next_event(timer_base& base) {
+    uint64_t next_event = next_event_ns(base);
+
+    base.programmed_ns = next_event;
+    if (next_event == NO_DEADLINE) {
+        arch_disarm();
+    } else {
+        uint64_t now = clock::now_ns();
+        arch_program(next_event > now ? next_event - now : 0);
+    }
+}
+
+/**
+ * Allocate and program this CPU's timer base, then unmask the timer.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static int32_t init_cpu_base(uint32_t hz) {
+    timer_base* base = heap::kalloc_new<timer_base>();
+    if (!base) {
+        log::error("timer: failed to allocate timer base");
+        return ERR;
+    }
+
+    base->lock = sync::SPINLOCK_INIT;
+    base->tick_interval_ns = NS_PER_SEC / hz;
+    base->next_tick_ns = clock::now_ns() + base->tick_interval_ns;
+    base->programmed_ns = base->next_tick_ns;
+    base->tick_stopped = false;
+    base->wheel_clk = clock::now_ns() >> WHEEL_UNIT_SHIFT;
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+            base->wheel[level][slot].init();
+        }
+    }
+    base->expiring.init();
+    this_cpu(cpu_timer_base) = base;
+
+    arch_program(base->tick_interval_ns);
+    arch_start();
+    cpu::irq_enable();
+    return OK;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init(uint32_t hz) {
+    if (arch_init(hz) != OK) {
+        return ERR;
+    }
+    g_tick_hz = hz;
+    return init_cpu_base(hz);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init_ap(uint32_t hz) {
+    if (arch_init_ap() != OK) {
+        return ERR;
+    }
+    return init_cpu_base(hz);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE uint32_t tick_hz() {
+    return g_tick_hz;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool on_interrupt() {
+    timer_base* base = this_cpu(cpu_timer_base);
+    if (!base) {
+        return false;
+    }
+    sync::irq_state irq = sync::spin_lock_irqsave(base->lock);
+
+    uint64_t now = clock::now_ns();
+
+    if (now == 0) {
+        arch_program(base->tick_interval_ns);
+        sync::spin_unlock_irqrestore(base->lock, irq);
+        return true;
+    }
+
+    bool fired = run_hrtimers(*base, now);
+    if (run_wheel(*base, now)) {
+        fired = true;
+    }
+
+    bool tick_expired = !base->tick_stopped && (now >= base->next_tick_ns);
+    if (tick_expired) {
+        base->next_tick_ns += base->tick_interval_ns;
+        if (base->next_tick_ns <= now) {
+            base->next_tick_ns = now + base->tick_interval_ns;
+        }
+    }
+
+    // With the tick stopped a fired timer is the only reason to enter
+    // the scheduler, report it so a woken task runs right now
+    bool enter_sched = tick_expired || (base->tick_stopped && fired);
+
+    program_next_event(*base);
+
+    sync::spin_unlock_irqrestore(base->lock, irq);
+
+    return enter_sched;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void tick_stop() {
+    timer_base* base = this_cpu(cpu_timer_base);
+    if (!base) {
+        return;
+    }
+    sync::irq_state irq = sync::spin_lock_irqsave(base->lock);
+    if (!base->tick_stopped) {
+        base->tick_stopped = true;
+        program_next_event(*base);
+    }
+    sync::spin_unlock_irqrestore(base->lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void tick_restart() {
+    timer_base* base = this_cpu(cpu_timer_base);
+    if (!base) {
+        return;
+    }
+    sync::irq_state irq = sync::spin_lock_irqsave(base->lock);
+    if (base->tick_stopped) {
+        base->tick_stopped = false;
+        base->next_tick_ns = clock::now_ns() + base->tick_interval_ns;
+        program_next_event(*base);
+    }
+    sync::spin_unlock_irqrestore(base->lock, irq);
+}
+
+void init_timer(timer_event* t, callback_fn fn, void* arg) {
+    *t = {};
+    t->fn = fn;
+    t->arg = arg;
+}
+
+/**
+ * Dequeue t from whichever CPU's base holds it. t->cpu only changes
+ * under the owning base lock, so it is re-checked once that is held.
+ * With wait_running set, also waits out a callback in progress on
+ * another CPU.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static bool detach_timer(timer_event* t, bool wait_running) {
+    for (;;) {
+        uint32_t owner = __atomic_load_n(&t->cpu, __ATOMIC_ACQUIRE);
+        timer_base* base = per_cpu_on(cpu_timer_base, owner);
+        if (!base) {
+            return false;
+        }
+
+        sync::irq_state irq = sync::spin_lock_irqsave(base->lock);
+        if (__atomic_load_n(&t->cpu, __ATOMIC_RELAXED) != owner) {
+            sync::spin_unlock_irqrestore(base->lock, irq);
+            continue;
+        }
+
+        bool was_pending = true;
+        if (t->state == TIMER_STATE_WHEEL) {
+            wheel_dequeue(*base, t);
+        } else if (t->state == TIMER_STATE_HIGHRES) {
+            base->hrtimers.remove(*t);
+        } else {
+            was_pending = false;
+        }
+        __atomic_store_n(&t->state, TIMER_STATE_IDLE, __ATOMIC_RELEASE);
+        sync::spin_unlock_irqrestore(base->lock, irq);
+
+        // A callback runs with interrupts off, so on this CPU it is
+        // either finished or it is the caller
+        if (wait_running && owner != percpu::current_cpu_id()) {
+            while (__atomic_load_n(&base->running, __ATOMIC_ACQUIRE) == t) {
+                cpu::relax();
+            }
+        }
+        return was_pending;
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void add_timer(timer_event* t, uint64_t deadline_ns, uint32_t flags) {
+    detach_timer(t, false);
+
+    timer_base* base = this_cpu(cpu_timer_base);
+    if (!base) {
+        return;
+    }
+    sync::irq_state irq = sync::spin_lock_irqsave(base->lock);
+
+    t->deadline_ns = deadline_ns;
+    __atomic_store_n(&t->cpu, percpu::current_cpu_id(), __ATOMIC_RELEASE);
+
+    if (flags & TIMER_HIGHRES) {
+        (void)base->hrtimers.insert(t);
+        __atomic_store_n(&t->state, TIMER_STATE_HIGHRES, __ATOMIC_RELEASE);
+    } else {
+        // An empty wheel may have gone stale across a tickless idle
+        if (base->wheel_count == 0) {
+            uint64_t now_unit = clock::now_ns() >> WHEEL_UNIT_SHIFT;
+            if (now_unit > base->wheel_clk) {
+                base->wheel_clk = now_unit;
+            }
+        }
+        wheel_enqueue(*base, t);
+        __atomic_store_n(&t->state, TIMER_STATE_WHEEL, __ATOMIC_RELEASE);
+    }
+
+    if (next_event_ns(*base) < base->programmed_ns) {
+        program_next_event(*base);
+    }
+
+    sync::spin_unlock_irqrestore(base->lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool cancel_timer(timer_event* t) {
+    return detach_timer(t, true);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void wake_sleeper(void* arg) {
+    sched::wake(static_cast<sched::task*>(arg));
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void schedule_sleep(sched::task* t, uint64_t deadline_ns) {
+    t->sleep_timer.fn = wake_sleeper;
+    t->sleep_timer.arg = t;
+    add_timer(&t->sleep_timer, deadline_ns, TIMER_HIGHRES);
+}
+
+/**
+ * The wakeup the callback performs is idempotent, so there is no need
+ * to wait for one in progress (callers may hold locks sched::wake takes).
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void cancel_sleep(sched::task* t) {
+    detach_timer(&t->sleep_timer, false);
+}
+
+} // namespace timer
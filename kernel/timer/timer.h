@@ -2,6 +2,8 @@
 #define STELLUX_TIMER_TIMER_H
 
 #include "common/types.h"
+#include "common/list.h"
+#include "common/rb_tree.h"
 
 namespace sched { struct task; }
 
@@ -10,6 +12,34 @@ namespace timer {
 constexpr int32_t OK  = 0;
 constexpr int32_t ERR = -1;
 
+using callback_fn = void (*)(void* arg);
+
+// add_timer() flags
+constexpr uint32_t TIMER_HIGHRES = (1u << 0); // exact deadline (rb-tree), else wheel granularity
+
+// timer_event::state values
+constexpr uint8_t TIMER_STATE_IDLE    = 0;
+constexpr uint8_t TIMER_STATE_WHEEL   = 1;
+constexpr uint8_t TIMER_STATE_HIGHRES = 2;
+
+/**
+ * A one-shot callback timer, embedded by its owner. Coarse timers live
+ * in a per-CPU hierarchical wheel (O(1) add and cancel, fired on the
+ * first wheel slot boundary at or after the deadline, about 1 ms), high
+ * resolution timers in a per-CPU rb-tree ordered by deadline. A zeroed
+ * timer_event is idle and valid; fields are owned by the timer code.
+ */
+struct timer_event {
+    rbt::node   tree_link;   // per-CPU hrtimer tree (TIMER_HIGHRES)
+    list::node  wheel_link;  // per-CPU wheel slot
+    uint64_t    deadline_ns;
+    callback_fn fn;
+    void*       arg;
+    uint32_t    cpu;         // CPU whose timer base holds the timer
+    uint16_t    wheel_idx;   // level * 64 + slot while on the wheel
+    uint8_t     state;       // TIMER_STATE_*
+};
+
 /**
  * @brief Initialize the timer subsystem on the BSP.
  * Calibrates hardware timer, programs first one-shot tick, enables IRQs.
@@ -43,18 +73,72 @@ __PRIVILEGED_CODE void stop();
 __PRIVILEGED_CODE uint32_t tick_hz();
 
 /**
- * @brief Timer interrupt handler. Wakes expired sleepers, advances the
- * scheduler tick, and reprograms the hardware for the next event.
+ * @brief Timer interrupt handler. Runs expired timer callbacks (which
+ * wake sleepers), advances the scheduler tick, and reprograms the
+ * hardware for the next event.
  * Called from the arch trap handler on timer interrupt.
- * @return true if a scheduler tick expired (caller should call sched::on_tick).
+ * @return true if a scheduler tick expired, or if the tick is stopped
+ *   and a timer fired (caller should call sched::on_tick).
  * @note Privilege: **required**
  */
 __PRIVILEGED_CODE bool on_interrupt();
 
+/**
+ * @brief Stop the periodic scheduler tick on this CPU (NOHZ idle).
+ * Only pending timer deadlines stay programmed, so an idle CPU takes
+ * no interrupts until a timer expires or another CPU kicks it with
+ * irq::send_resched_ipi(). Called by the scheduler when it switches
+ * to the idle task. Idempotent.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void tick_stop();
+
+/**
+ * @brief Restart the periodic scheduler tick on this CPU, the first
+ * tick lands one interval from now. Called by the scheduler when it
+ * switches away from the idle task. No-op if the tick is running.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void tick_restart();
+
+/**
+ * @brief Prepare a timer for add_timer(). Equivalent to zeroing it and
+ * setting the callback.
+ * @param fn Callback, runs on the timer's CPU in interrupt context with
+ *   no timer lock held. It may re-add its own timer.
+ */
+void init_timer(timer_event* t, callback_fn fn, void* arg);
+
+/**
+ * @brief Arm a timer on the current CPU for an absolute deadline. A
+ * timer that is already pending is re-armed with the new deadline.
+ * Reprograms the hardware timer if the new deadline is the earliest.
+ * @param deadline_ns Absolute expiry time (clock::now_ns() timebase).
+ * @param flags TIMER_HIGHRES for an exact deadline, 0 for a wheel timer.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void add_timer(timer_event* t, uint64_t deadline_ns, uint32_t flags);
+
+/**
+ * @brief Disarm a timer. Safe to call from any CPU. If the callback is
+ * running on another CPU, waits for it to return, so the caller must not
+ * hold a lock the callback takes.
+ * @return true if the timer was pending, false if it was idle or had
+ *   already fired.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool cancel_timer(timer_event* t);
+
+/**
+ * @brief true while the timer is armed and has not fired yet.
+ */
+inline bool timer_pending(const timer_event* t) {
+    return __atomic_load_n(&t->state, __ATOMIC_ACQUIRE) != TIMER_STATE_IDLE;
+}
+
 /**
  * @brief Schedule a task to be woken at the given absolute deadline.
- * Inserts the task into the per-CPU sleep queue and reprograms the
- * hardware timer if the new deadline is sooner than the current one.
+ * Arms the task's high resolution sleep timer on this CPU.
  * The task's state must already be TASK_STATE_BLOCKED before this call.
  * @param t Task to sleep (must be the current task on this CPU).
  * @param deadline_ns Absolute wakeup time in nanoseconds (clock::now_ns() timebase).
@@ -63,8 +147,8 @@ __PRIVILEGED_CODE bool on_interrupt();
 __PRIVILEGED_CODE void schedule_sleep(sched::task* t, uint64_t deadline_ns);
 
 /**
- * @brief Remove a task from its CPU's sleep queue if present.
- * No-op if the task is not on any sleep queue. Safe to call from
+ * @brief Disarm a task's sleep timer if pending.
+ * No-op if the task is not sleeping on a timer. Safe to call from
  * any CPU. Must be called from elevated/privileged context.
  * @note Privilege: **required**
  */
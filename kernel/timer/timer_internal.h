@@ -0,0 +1,47 @@
+#ifndef STELLUX_TIMER_TIMER_INTERNAL_H
+#define STELLUX_TIMER_TIMER_INTERNAL_H
+
+#include "common/types.h"
+
+namespace timer {
+
+/**
+ * Arch-specific: calibrate and configure the per-CPU one-shot timer on
+ * the BSP. The timer interrupt stays masked until arch_start().
+ * @return OK on success, ERR on failure.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t arch_init(uint32_t hz);
+
+/**
+ * Arch-specific: configure the one-shot timer on an AP, reusing the
+ * BSP calibration. The timer interrupt stays masked until arch_start().
+ * @return OK on success, ERR on failure.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t arch_init_ap();
+
+/**
+ * Arch-specific: unmask this CPU's timer interrupt.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void arch_start();
+
+/**
+ * Arch-specific: fire this CPU's one-shot timer delta_ns from now.
+ * Deltas beyond the hardware range are clamped, the interrupt then
+ * arrives early and the common code simply reprograms.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void arch_program(uint64_t delta_ns);
+
+/**
+ * Arch-specific: disarm this CPU's one-shot timer, or park it as far
+ * out as the hardware allows.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void arch_disarm();
+
+} // namespace timer
+
+#endif // STELLUX_TIMER_TIMER_INTERNAL_H
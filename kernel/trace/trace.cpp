@@ -0,0 +1,261 @@
+#include "trace/trace.h"
+#include "fs/node.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs/devfs/devfs.h"
+#include "mm/heap.h"
+#include "mm/uaccess.h"
+#include "percpu/percpu.h"
+#include "sched/sched.h"
+#include "smp/smp.h"
+#include "clock/clock.h"
+#include "sync/mutex.h"
+#include "dynpriv/dynpriv.h"
+#include "common/logging.h"
+
+namespace trace {
+
+// Read by tracepoints in lowered code, so not in a privileged section
+uint32_t g_enabled;
+
+namespace {
+
+static_assert((RING_EVENTS & (RING_EVENTS - 1)) == 0,
+              "RING_EVENTS must be a power of two");
+
+/**
+ * seq is head + 1 of the reservation that filled the slot, stored last
+ * so the reader can tell a published slot from one still being written.
+ */
+struct slot {
+    uint64_t seq;
+    event    ev;
+};
+
+/**
+ * Event buffer of one CPU. Writers reserve slots by advancing head with
+ * a compare-and-swap, so a tracepoint interrupted by another tracepoint
+ * on the same CPU, or a lowered task that migrated after looking up its
+ * buffer, still gets a slot of its own. tail is advanced only by
+ * read_events(). Lives on the unprivileged heap so lowered tracepoints
+ * can write it.
+ */
+struct cpu_trace {
+    slot*    ring;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t events;
+    uint64_t drops;
+    uint16_t cpu;
+};
+
+// Allocated on the first set_events() that enables anything
+static DEFINE_PER_CPU(cpu_trace*, cpu_buf);
+
+__PRIVILEGED_BSS static uint32_t    g_next_cpu; // first CPU the next read drains
+__PRIVILEGED_BSS static sync::mutex g_lock;     // control and readers
+
+cpu_trace* cpu_state(uint32_t cpu) {
+    return __atomic_load_n(&per_cpu_on(cpu_buf, cpu), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t alloc_cpu_states() {
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        if (cpu_state(cpu)) {
+            continue;
+        }
+        auto* ct = static_cast<cpu_trace*>(heap::uzalloc(sizeof(cpu_trace)));
+        if (!ct) {
+            return ERR;
+        }
+        ct->ring = static_cast<slot*>(heap::uzalloc(RING_EVENTS * sizeof(slot)));
+        if (!ct->ring) {
+            heap::ufree(ct);
+            return ERR;
+        }
+        ct->cpu = static_cast<uint16_t>(cpu);
+        __atomic_store_n(&per_cpu_on(cpu_buf, cpu), ct, __ATOMIC_RELEASE);
+    }
+    return OK;
+}
+
+class trace_node : public fs::node {
+public:
+    trace_node() : fs::node(fs::node_type::char_device, nullptr, "trace") {}
+
+    ssize_t read(fs::file*, void* buf, size_t count) override {
+        if (!buf || count < sizeof(event)) {
+            return fs::ERR_INVAL;
+        }
+        size_t got = 0;
+        RUN_ELEVATED(got = read_events(static_cast<event*>(buf),
+                                       count / sizeof(event)));
+        return static_cast<ssize_t>(got * sizeof(event));
+    }
+
+    int32_t ioctl(fs::file*, uint32_t cmd, uint64_t arg) override {
+        int32_t rc = fs::OK;
+        switch (cmd) {
+        case TRACE_SET_EVENTS:
+            if (arg & ~static_cast<uint64_t>(ALL_EVENTS)) {
+                return fs::ERR_INVAL;
+            }
+            RUN_ELEVATED(rc = set_events(static_cast<uint32_t>(arg)) == OK
+                              ? fs::OK : fs::ERR_NOMEM);
+            return rc;
+        case TRACE_CLEAR:
+            RUN_ELEVATED(clear());
+            return fs::OK;
+        case TRACE_GET_STATS:
+            RUN_ELEVATED({
+                trace_stats stats = read_stats();
+                if (mm::uaccess::copy_to_user(reinterpret_cast<void*>(arg),
+                                              &stats, sizeof(stats)) != mm::uaccess::OK) {
+                    rc = fs::ERR_INVAL;
+                }
+            });
+            return rc;
+        default:
+            return fs::ERR_NOSYS;
+        }
+    }
+
+    int32_t getattr(fs::vattr* attr) override {
+        if (!attr) return fs::ERR_INVAL;
+        attr->type = fs::node_type::char_device;
+        attr->size = 0;
+        return fs::OK;
+    }
+};
+
+} // anonymous namespace
+
+void emit(uint16_t id, uint64_t a0, uint64_t a1, uint64_t a2) {
+    cpu_trace* ct = __atomic_load_n(&this_cpu(cpu_buf), __ATOMIC_ACQUIRE);
+    if (!ct) {
+        return;
+    }
+
+    uint64_t head = __atomic_load_n(&ct->head, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t tail = __atomic_load_n(&ct->tail, __ATOMIC_ACQUIRE);
+        if (head - tail >= RING_EVENTS) {
+            __atomic_fetch_add(&ct->drops, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        if (__atomic_compare_exchange_n(&ct->head, &head, head + 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    slot& s = ct->ring[head & (RING_EVENTS - 1)];
+    s.ev.ts_ns = clock::now_ns();
+    s.ev.tid = sched::current_tid();
+    s.ev.id = id;
+    s.ev.cpu = ct->cpu;
+    s.ev.args[0] = a0;
+    s.ev.args[1] = a1;
+    s.ev.args[2] = a2;
+    __atomic_store_n(&s.seq, head + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ct->events, 1, __ATOMIC_RELAXED);
+}
+
+__PRIVILEGED_CODE int32_t init() {
+    g_lock.init();
+
+    auto* node = heap::kalloc_new<trace_node>();
+    if (!node) {
+        log::error("trace: failed to allocate /dev/trace");
+        return ERR;
+    }
+    if (devfs::add_char_device("trace", node) != devfs::OK) {
+        log::error("trace: failed to register /dev/trace");
+        heap::kfree_delete(node);
+        return ERR;
+    }
+    return OK;
+}
+
+__PRIVILEGED_CODE int32_t set_events(uint32_t mask) {
+    mask &= ALL_EVENTS;
+    sync::mutex_lock(g_lock);
+    if (mask && alloc_cpu_states() != OK) {
+        sync::mutex_unlock(g_lock);
+        log::error("trace: failed to allocate event buffers");
+        return ERR;
+    }
+    __atomic_store_n(&g_enabled, mask, __ATOMIC_RELEASE);
+    sync::mutex_unlock(g_lock);
+    return OK;
+}
+
+__PRIVILEGED_CODE void clear() {
+    sync::mutex_lock(g_lock);
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_trace* ct = cpu_state(cpu);
+        if (!ct) {
+            continue;
+        }
+        // Slots reserved before this point are skipped even if published later
+        __atomic_store_n(&ct->tail, __atomic_load_n(&ct->head, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELEASE);
+        __atomic_store_n(&ct->events, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&ct->drops, 0, __ATOMIC_RELAXED);
+    }
+    sync::mutex_unlock(g_lock);
+}
+
+__PRIVILEGED_CODE trace_stats read_stats() {
+    trace_stats stats = {};
+    uint32_t cpus = smp::cpu_count();
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        cpu_trace* ct = cpu_state(cpu);
+        if (ct) {
+            stats.events += __atomic_load_n(&ct->events, __ATOMIC_RELAXED);
+            stats.drops += __atomic_load_n(&ct->drops, __ATOMIC_RELAXED);
+            stats.cpus++;
+        }
+    }
+    stats.enabled = __atomic_load_n(&g_enabled, __ATOMIC_RELAXED);
+    return stats;
+}
+
+__PRIVILEGED_CODE size_t read_events(event* out, size_t max) {
+    sync::mutex_lock(g_lock);
+    uint32_t cpus = smp::cpu_count();
+    size_t got = 0;
+
+    // Rotate the starting CPU so small reads do not favour CPU 0
+    for (uint32_t i = 0; i < cpus && got < max; i++) {
+        uint32_t cpu = (g_next_cpu + i) % cpus;
+        cpu_trace* ct = cpu_state(cpu);
+        if (!ct) {
+            continue;
+        }
+        uint64_t tail = ct->tail;
+        while (got < max) {
+            slot& s = ct->ring[tail & (RING_EVENTS - 1)];
+            if (__atomic_load_n(&s.seq, __ATOMIC_ACQUIRE) != tail + 1) {
+                break;
+            }
+            out[got++] = s.ev;
+            tail++;
+        }
+        // Frees the slots for writers only after they have been copied
+        __atomic_store_n(&ct->tail, tail, __ATOMIC_RELEASE);
+    }
+    if (cpus) {
+        g_next_cpu = (g_next_cpu + 1) % cpus;
+    }
+
+    sync::mutex_unlock(g_lock);
+    return got;
+}
+
+} // namespace trace
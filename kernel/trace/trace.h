@@ -0,0 +1,163 @@
+#ifndef STELLUX_TRACE_TRACE_H
+#define STELLUX_TRACE_TRACE_H
+
+#include "common/types.h"
+
+namespace trace {
+
+constexpr int32_t OK  = 0;
+constexpr int32_t ERR = -1;
+
+/*
+ * Static tracepoints with per-CPU binary event buffers.
+ *
+ * A tracepoint is a TRACE(NAME, ...) statement compiled into the code it
+ * observes. While its event is switched off it costs one load of
+ * g_enabled and a branch predicted not taken. Once switched on it writes
+ * a timestamped event into the buffer of the CPU it runs on, without
+ * locks or interrupt masking: a slot is reserved with a compare-and-swap
+ * on the buffer head and published with a per-slot sequence number, so
+ * tracepoints are usable from interrupt context and from lowered kernel
+ * code alike. Full buffers drop new events.
+ *
+ * /dev/trace streams the buffered events as struct event records and is
+ * controlled with the TRACE_* ioctls below.
+ */
+
+// Event ids, and the meaning of args[0..2] for each
+constexpr uint16_t EV_SCHED_SWITCH    = 0;  // prev tid, next tid, prev state
+constexpr uint16_t EV_SCHED_WAKE      = 1;  // tid, target cpu
+constexpr uint16_t EV_SCHED_MIGRATE   = 2;  // tid, from cpu, to cpu
+constexpr uint16_t EV_SYSCALL_ENTER   = 3;  // nr, arg1, arg2
+constexpr uint16_t EV_SYSCALL_EXIT    = 4;  // nr, result
+constexpr uint16_t EV_IRQ_ENTER       = 5;  // vector (x86_64) or GIC interrupt id
+constexpr uint16_t EV_IRQ_EXIT        = 6;  // vector (x86_64) or GIC interrupt id
+constexpr uint16_t EV_PAGE_FAULT      = 7;  // address, pc, mm::PF_FLAG_* | PF_RESOLVED
+constexpr uint16_t EV_FUTEX_WAIT      = 8;  // uaddr, expected value
+constexpr uint16_t EV_FUTEX_WAKE      = 9;  // uaddr, tasks woken
+constexpr uint16_t EV_NET_RX          = 10; // frame length, ethertype
+constexpr uint16_t EV_NET_TX          = 11; // frame length, ethertype, driver result
+constexpr uint16_t EV_FUTEX_LOCK_PI   = 12; // uaddr, owner tid blocked on
+constexpr uint16_t EV_FUTEX_UNLOCK_PI = 13; // uaddr, new owner tid, 0 when released
+constexpr uint16_t EVENT_COUNT        = 14;
+
+constexpr uint32_t ALL_EVENTS = (1u << EVENT_COUNT) - 1;
+
+// EV_PAGE_FAULT args[2]: the fault was resolved by demand paging
+constexpr uint64_t PF_RESOLVED = (1ull << 31);
+
+struct event {
+    uint64_t ts_ns;   // clock::now_ns() at the tracepoint
+    uint32_t tid;     // current task, 0 before the scheduler runs
+    uint16_t id;      // EV_*
+    uint16_t cpu;
+    uint64_t args[3];
+};
+
+static_assert(sizeof(event) == 40, "trace::event must be 40 bytes");
+
+constexpr uint32_t RING_EVENTS = 4096; // per CPU, power of two
+
+// /dev/trace ioctls
+constexpr uint32_t TRACE_SET_EVENTS = 0x5100; // arg: mask of (1 << EV_*), 0 stops tracing
+constexpr uint32_t TRACE_CLEAR      = 0x5101; // discard buffered events, reset counters
+constexpr uint32_t TRACE_GET_STATS  = 0x5102; // arg: trace_stats*
+
+struct trace_stats {
+    uint64_t events;  // recorded since the last clear
+    uint64_t drops;   // lost to full buffers since the last clear
+    uint32_t enabled; // current event mask
+    uint32_t cpus;    // buffers allocated
+};
+
+/**
+ * Mask of enabled events, bit (1 << EV_*). Written only by set_events(),
+ * read by every tracepoint.
+ */
+extern uint32_t g_enabled;
+
+inline bool enabled(uint16_t id) {
+    return __builtin_expect(
+        (__atomic_load_n(&g_enabled, __ATOMIC_RELAXED) >> id) & 1u, 0);
+}
+
+/**
+ * @brief Record one event in the current CPU's buffer. Called through
+ * TRACE() once the event is known to be enabled; safe in any context.
+ */
+void emit(uint16_t id, uint64_t a0 = 0, uint64_t a1 = 0, uint64_t a2 = 0);
+
+/**
+ * @brief Register /dev/trace. Must be called after devfs is mounted.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init();
+
+/**
+ * @brief Replace the enabled event mask. Allocates the per-CPU buffers
+ * the first time any event is enabled.
+ * @return OK, or ERR if the buffers could not be allocated.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t set_events(uint32_t mask);
+
+/**
+ * @brief Discard buffered events and reset the counters.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void clear();
+
+/**
+ * @brief Counters and the enabled mask.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE trace_stats read_stats();
+
+/**
+ * @brief Move up to max buffered events into out, draining the CPUs in
+ * turn. Readers are serialized. A CPU's drain stops at a slot that is
+ * reserved but not yet published, it is read by a later call.
+ * @return Number of events copied, 0 once every buffer is empty.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE size_t read_events(event* out, size_t max);
+
+/**
+ * Emits EV_IRQ_ENTER on construction and EV_IRQ_EXIT on destruction,
+ * for interrupt handlers with several return paths.
+ */
+class irq_scope {
+public:
+    explicit irq_scope(uint64_t irq) : irq_(irq) {
+        if (enabled(EV_IRQ_ENTER)) {
+            emit(EV_IRQ_ENTER, irq_);
+        }
+    }
+
+    ~irq_scope() {
+        if (enabled(EV_IRQ_EXIT)) {
+            emit(EV_IRQ_EXIT, irq_);
+        }
+    }
+
+    irq_scope(const irq_scope&) = delete;
+    irq_scope& operator=(const irq_scope&) = delete;
+
+private:
+    uint64_t irq_;
+};
+
+} // namespace trace
+
+/**
+ * Tracepoint: TRACE(SCHED_WAKE, t->tid, cpu). Arguments are evaluated
+ * only while the event is enabled.
+ */
+#define TRACE(name, ...)                                  \
+    do {                                                  \
+        if (trace::enabled(trace::EV_##name)) {           \
+            trace::emit(trace::EV_##name, ##__VA_ARGS__); \
+        }                                                 \
+    } while (0)
+
+#endif // STELLUX_TRACE_TRACE_H
@@ -0,0 +1,304 @@
+#include "workqueue/workqueue.h"
+#include "sched/sched.h"
+#include "sched/task.h"
+#include "smp/smp.h"
+#include "percpu/percpu.h"
+#include "sync/spinlock.h"
+#include "sync/wait_queue.h"
+#include "mm/heap.h"
+#include "common/logging.h"
+
+namespace workqueue {
+
+namespace {
+
+struct worker_pool {
+    sync::spinlock lock;
+    list::head<work_item, &work_item::link> pending;
+    sync::wait_queue wq;       // the worker sleeps here while pending is empty
+    sched::task*     worker;
+    work_item*       running;  // compared only, the item may be freed
+    uint32_t         cpu;
+};
+
+// Queued by flush_* behind the work being waited for. It runs on the
+// pool's worker like any other item and wakes the flusher.
+struct flush_barrier {
+    work_item        work;
+    sync::spinlock   lock;
+    sync::wait_queue wq;
+    uint32_t         done;
+};
+
+__PRIVILEGED_DATA static uint32_t g_initialized = 0;
+
+static DEFINE_PER_CPU(worker_pool*, cpu_pool);
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static worker_pool* pool_on(uint32_t cpu) {
+    if (cpu >= MAX_CPUS) {
+        return nullptr;
+    }
+    return __atomic_load_n(&per_cpu_on(cpu_pool, cpu), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void barrier_fn(work_item* w) {
+    flush_barrier* b = work_to_entry<flush_barrier, &flush_barrier::work>(w);
+    sync::irq_state irq = sync::spin_lock_irqsave(b->lock);
+    __atomic_store_n(&b->done, 1, __ATOMIC_RELEASE);
+    sync::wake_all(b->wq);
+    sync::spin_unlock_irqrestore(b->lock, irq);
+}
+
+/**
+ * Queue a barrier on pool, at the head if front (it runs right after
+ * the item in flight) or at the tail, and wait for it to run.
+ * Caller must hold pool->lock with the given irq state; drops it.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void wait_barrier_locked(
+    worker_pool* pool, bool front, sync::irq_state pool_irq
+) {
+    if (pool->worker == sched::current()) {
+        // The barrier would wait for its own worker
+        sync::spin_unlock_irqrestore(pool->lock, pool_irq);
+        log::warn("workqueue: flush from worker on cpu %u ignored", pool->cpu);
+        return;
+    }
+
+    flush_barrier b;
+    init_work(&b.work, barrier_fn);
+    b.lock = sync::SPINLOCK_INIT;
+    b.wq.init();
+    b.done = 0;
+
+    b.work.state = WORK_PENDING;
+    b.work.cpu = pool->cpu;
+    if (front) {
+        pool->pending.push_front(&b.work);
+    } else {
+        pool->pending.push_back(&b.work);
+    }
+    sync::wake_one(pool->wq);
+    sync::spin_unlock_irqrestore(pool->lock, pool_irq);
+
+    sync::irq_state irq = sync::spin_lock_irqsave(b.lock);
+    while (!__atomic_load_n(&b.done, __ATOMIC_ACQUIRE)) {
+        irq = sync::wait(b.wq, b.lock, irq);
+    }
+    sync::spin_unlock_irqrestore(b.lock, irq);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE static void worker_main(void* arg) {
+    worker_pool* pool = static_cast<worker_pool*>(arg);
+
+    while (true) {
+        uint32_t ran = 0;
+        sync::irq_state irq = sync::spin_lock_irqsave(pool->lock);
+        while (pool->pending.empty()) {
+            irq = sync::wait_exclusive(pool->wq, pool->lock, irq);
+        }
+
+        while (ran < WORKQUEUE_BATCH) {
+            work_item* w = pool->pending.pop_front();
+            if (!w) {
+                break;
+            }
+            // Cleared before the call so the function may requeue itself
+            __atomic_store_n(&w->state, w->state & ~WORK_PENDING, __ATOMIC_RELEASE);
+            pool->running = w;
+            sync::spin_unlock_irqrestore(pool->lock, irq);
+
+            w->fn(w);
+            ran++;
+
+            irq = sync::spin_lock_irqsave(pool->lock);
+            pool->running = nullptr;
+        }
+        sync::spin_unlock_irqrestore(pool->lock, irq);
+
+        // Fairness: give other runnable tasks on this CPU a turn
+        sched::yield();
+    }
+}
+
+} // anonymous namespace
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init() {
+    uint32_t expected = 0;
+    if (!__atomic_compare_exchange_n(&g_initialized, &expected, 1,
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return OK;
+    }
+
+    uint32_t started = 0;
+    for (uint32_t cpu = 0; cpu < smp::cpu_count() && cpu < MAX_CPUS; cpu++) {
+        smp::cpu_info* info = smp::get_cpu_info(cpu);
+        if (cpu != 0 &&
+            (!info || __atomic_load_n(&info->state, __ATOMIC_ACQUIRE) != smp::CPU_ONLINE)) {
+            continue;
+        }
+
+        worker_pool* pool = heap::kalloc_new<worker_pool>();
+        if (!pool) {
+            return ERR_NO_MEM;
+        }
+        pool->lock = sync::SPINLOCK_INIT;
+        pool->pending.init();
+        pool->wq.init();
+        pool->running = nullptr;
+        pool->cpu = cpu;
+
+        pool->worker = sched::create_kernel_task(
+            worker_main, pool, "kworker",
+            sched::TASK_FLAG_ELEVATED | sched::TASK_FLAG_PINNED);
+        if (!pool->worker) {
+            heap::kfree_delete(pool);
+            return ERR_NO_MEM;
+        }
+
+        __atomic_store_n(&per_cpu_on(cpu_pool, cpu), pool, __ATOMIC_RELEASE);
+        sched::enqueue_on(pool->worker, cpu);
+        started++;
+    }
+
+    log::info("workqueue: %u per-cpu workers", started);
+    return OK;
+}
+
+void init_work(work_item* w, work_fn fn) {
+    w->link = {};
+    w->fn = fn;
+    w->state = 0;
+    w->cpu = 0;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool queue_work(work_item* w) {
+    return queue_work_on(percpu::current_cpu_id(), w);
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool queue_work_on(uint32_t cpu, work_item* w) {
+    if (!w || !w->fn) {
+        return false;
+    }
+
+    worker_pool* pool = pool_on(cpu);
+    if (!pool) {
+        pool = pool_on(percpu::current_cpu_id());
+    }
+    if (!pool) {
+        pool = pool_on(0);
+    }
+    if (!pool) {
+        return false;
+    }
+
+    // Keep an item that is still running behind itself on its CPU
+    worker_pool* last = pool_on(__atomic_load_n(&w->cpu, __ATOMIC_RELAXED));
+    if (last && last != pool && __atomic_load_n(&last->running, __ATOMIC_ACQUIRE) == w) {
+        pool = last;
+    }
+
+    sync::irq_state irq = sync::spin_lock_irqsave(pool->lock);
+    if (w->state & WORK_PENDING) {
+        sync::spin_unlock_irqrestore(pool->lock, irq);
+        return false;
+    }
+    __atomic_store_n(&w->state, w->state | WORK_PENDING, __ATOMIC_RELEASE);
+    __atomic_store_n(&w->cpu, pool->cpu, __ATOMIC_RELAXED);
+    pool->pending.push_back(w);
+    sync::wake_one(pool->wq);
+    sync::spin_unlock_irqrestore(pool->lock, irq);
+    return true;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool flush_work(work_item* w) {
+    if (!w) {
+        return false;
+    }
+    worker_pool* pool = pool_on(__atomic_load_n(&w->cpu, __ATOMIC_RELAXED));
+    if (!pool) {
+        return false;
+    }
+
+    sync::irq_state irq = sync::spin_lock_irqsave(pool->lock);
+    bool pending = (w->state & WORK_PENDING) != 0;
+    if (!pending && pool->running != w) {
+        sync::spin_unlock_irqrestore(pool->lock, irq);
+        return false;
+    }
+    // Only running: the next item is the barrier. Pending: queued
+    // behind it, which also covers a run already in flight.
+    wait_barrier_locked(pool, !pending, irq);
+    return true;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool cancel_work(work_item* w) {
+    if (!w) {
+        return false;
+    }
+    worker_pool* pool = pool_on(__atomic_load_n(&w->cpu, __ATOMIC_RELAXED));
+    if (!pool) {
+        return false;
+    }
+
+    sync::irq_state irq = sync::spin_lock_irqsave(pool->lock);
+    bool was_pending = (w->state & WORK_PENDING) != 0;
+    if (was_pending) {
+        pool->pending.remove(w);
+        __atomic_store_n(&w->state, w->state & ~WORK_PENDING, __ATOMIC_RELEASE);
+    }
+    if (pool->running == w) {
+        wait_barrier_locked(pool, true, irq);
+    } else {
+        sync::spin_unlock_irqrestore(pool->lock, irq);
+    }
+    return was_pending;
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void flush_all() {
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        worker_pool* pool = pool_on(cpu);
+        if (!pool) {
+            continue;
+        }
+        sync::irq_state irq = sync::spin_lock_irqsave(pool->lock);
+        wait_barrier_locked(pool, false, irq);
+    }
+}
+
+/**
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool in_worker() {
+    worker_pool* pool = this_cpu(cpu_pool);
+    return pool && pool->worker == sched::current();
+}
+
+} // namespace workqueue
@@ -0,0 +1,121 @@
+#ifndef STELLUX_WORKQUEUE_WORKQUEUE_H
+#define STELLUX_WORKQUEUE_WORKQUEUE_H
+
+#include "common/types.h"
+#include "common/list.h"
+
+/*
+ * Per-CPU workqueues.
+ *
+ * Each online CPU owns a worker pool: a FIFO of pending work items and
+ * one elevated kernel task pinned to that CPU. Interrupt handlers and
+ * protocol code queue a work item with queue_work(), which only takes
+ * the local pool lock, and the item's function later runs in task
+ * context on the same CPU, where it may block. With one worker per CPU
+ * at most one item runs per CPU at any time, items queued on a CPU run
+ * in queue order, and a worker yields after WORKQUEUE_BATCH items so a
+ * busy queue cannot starve other tasks.
+ */
+
+namespace workqueue {
+
+constexpr int32_t OK         = 0;
+constexpr int32_t ERR_NO_MEM = -1;
+
+// Items a worker runs back to back before it yields
+constexpr uint32_t WORKQUEUE_BATCH = 64;
+
+// work_item::state bits
+constexpr uint32_t WORK_PENDING = (1u << 0);
+
+struct work_item;
+using work_fn = void (*)(work_item*);
+
+/**
+ * A unit of deferred work, embedded by its owner. Prepare with
+ * init_work(). An item is queued at most once at a time; fields other
+ * than fn are owned by the workqueue code. The function may free the
+ * item, nothing touches it after the call.
+ */
+struct work_item {
+    list::node link;
+    work_fn    fn;
+    uint32_t   state; // WORK_PENDING while queued
+    uint32_t   cpu;   // pool the item was last queued on
+};
+
+/**
+ * @brief Create a worker pool and worker task for every online CPU.
+ * Call once during bring-up, after smp::init().
+ * @return OK on success, ERR_NO_MEM if a pool or worker cannot be created.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE int32_t init();
+
+/**
+ * @brief Prepare a work item. Equivalent to zeroing it and setting fn.
+ */
+void init_work(work_item* w, work_fn fn);
+
+/**
+ * @brief Queue a work item on the current CPU. Safe from IRQ context.
+ * An item still running on some CPU is queued behind itself there, so
+ * it never runs concurrently with itself.
+ * @return true if queued, false if it was already pending or the
+ *   workqueues are not up yet.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool queue_work(work_item* w);
+
+/**
+ * @brief Queue a work item on a given CPU's pool. Falls back to the
+ * current CPU if cpu has no worker. Safe from IRQ context.
+ * @return Same as queue_work().
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool queue_work_on(uint32_t cpu, work_item* w);
+
+/**
+ * @brief Wait until a work item is neither pending nor running.
+ * Task context only; must not be called from a work function.
+ * @return true if the item was pending or running and has now finished,
+ *   false if it was idle.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool flush_work(work_item* w);
+
+/**
+ * @brief Dequeue a pending work item, and wait for it to finish if its
+ * function is running. Task context only; must not be called from a
+ * work function.
+ * @return true if the item was pending and will not run.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool cancel_work(work_item* w);
+
+/**
+ * @brief Wait until every item queued on every CPU before the call has
+ * run. Task context only; must not be called from a work function.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE void flush_all();
+
+/**
+ * @brief true when called from a workqueue worker task.
+ * @note Privilege: **required**
+ */
+__PRIVILEGED_CODE bool in_worker();
+
+/**
+ * @brief Recover the object embedding a work_item, for use in work functions.
+ */
+template<typename T, work_item T::*Member>
+inline T* work_to_entry(work_item* w) {
+    const uintptr_t offset = reinterpret_cast<uintptr_t>(
+        &(static_cast<T*>(nullptr)->*Member));
+    return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(w) - offset);
+}
+
+} // namespace workqueue
+
+#endif // STELLUX_WORKQUEUE_WORKQUEUE_H
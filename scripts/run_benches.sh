@@ -0,0 +1,163 @@
+#!/bin/bash
+set -euo pipefail
+
+# Boot a STLX_BENCH_ENABLED image headless and collect the kernel
+# microbenchmark results as JSON (stdout and build/bench-<ARCH>.json).
+
+ARCH="${1:-}"
+TIMEOUT="${STLX_BENCH_TIMEOUT:-300}"
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+ROOT_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+RED='\033[0;31m'
+BOLD='\033[1m'
+NC='\033[0m'
+
+if [[ -z "$ARCH" ]]; then
+    echo "Usage: $0 <ARCH>"
+    echo "  ARCH: x86_64 or aarch64"
+    exit 1
+fi
+
+SERIAL_LOG="$(mktemp)"
+QEMU_PID=""
+
+cleanup() {
+    if [[ -n "$QEMU_PID" ]]; then
+        kill "$QEMU_PID" 2>/dev/null || true
+        wait "$QEMU_PID" 2>/dev/null || true
+    fi
+    rm -f "$SERIAL_LOG"
+}
+trap cleanup EXIT
+
+IMAGE="$ROOT_DIR/images/stellux-${ARCH}.img"
+BUILD_DIR="$ROOT_DIR/build"
+RESULT_JSON="$BUILD_DIR/bench-${ARCH}.json"
+
+if [[ ! -f "$IMAGE" ]]; then
+    echo "Error: Disk image not found: $IMAGE"
+    echo "Run: make image ARCH=$ARCH STLX_UNIT_TESTS_ENABLED=1 STLX_BENCH_ENABLED=1"
+    exit 1
+fi
+
+: > "$SERIAL_LOG"
+
+echo -e "${BOLD}=== Stellux Kernel Benchmarks (${ARCH}) ===${NC}" >&2
+
+if [[ "$ARCH" == "x86_64" ]]; then
+    OVMF_CODE=""
+    for f in /usr/share/OVMF/OVMF_CODE_4M.fd /usr/share/OVMF/OVMF_CODE.fd \
+             /usr/share/ovmf/OVMF.fd /usr/share/qemu/OVMF.fd \
+             /opt/homebrew/share/qemu/edk2-x86_64-code.fd \
+             /usr/local/share/qemu/edk2-x86_64-code.fd; do
+        if [[ -f "$f" ]]; then OVMF_CODE="$f"; break; fi
+    done
+    OVMF_VARS_SRC=""
+    for f in /usr/share/OVMF/OVMF_VARS_4M.fd /usr/share/OVMF/OVMF_VARS.fd \
+             /opt/homebrew/share/qemu/edk2-i386-vars.fd \
+             /usr/local/share/qemu/edk2-i386-vars.fd; do
+        if [[ -f "$f" ]]; then OVMF_VARS_SRC="$f"; break; fi
+    done
+
+    if [[ -z "$OVMF_CODE" || -z "$OVMF_VARS_SRC" ]]; then
+        echo -e "${RED}Error: OVMF firmware not found. Run: make deps${NC}"
+        exit 1
+    fi
+
+    OVMF_VARS="$BUILD_DIR/OVMF_VARS_BENCH.fd"
+    mkdir -p "$BUILD_DIR"
+    cp "$OVMF_VARS_SRC" "$OVMF_VARS"
+
+    qemu-system-x86_64 \
+        -machine q35 \
+        -cpu qemu64,+fsgsbase,+rdrand \
+        -m 4G \
+        -smp 4 \
+        -drive if=pflash,format=raw,readonly=on,file="$OVMF_CODE" \
+        -drive if=pflash,format=raw,file="$OVMF_VARS" \
+        -drive format=raw,file="$IMAGE" \
+        -device qemu-xhci \
+        -device usb-kbd \
+        -serial file:"$SERIAL_LOG" \
+        -display none \
+        -no-reboot \
+        -no-shutdown &
+    QEMU_PID=$!
+
+elif [[ "$ARCH" == "aarch64" ]]; then
+    QEMU_EFI=""
+    for f in /usr/share/qemu-efi-aarch64/QEMU_EFI.fd \
+             /opt/homebrew/share/qemu/edk2-aarch64-code.fd \
+             /usr/local/share/qemu/edk2-aarch64-code.fd; do
+        if [[ -f "$f" ]]; then QEMU_EFI="$f"; break; fi
+    done
+    if [[ -z "$QEMU_EFI" ]]; then
+        echo -e "${RED}Error: AArch64 EFI firmware not found. Run: make deps${NC}"
+        exit 1
+    fi
+
+    qemu-system-aarch64 \
+        -machine virt,gic-version=2 \
+        -cpu cortex-a57 \
+        -m 4G \
+        -smp 4 \
+        -bios "$QEMU_EFI" \
+        -drive format=raw,file="$IMAGE" \
+        -device qemu-xhci \
+        -device usb-kbd \
+        -serial file:"$SERIAL_LOG" \
+        -display none \
+        -no-reboot \
+        -no-shutdown &
+    QEMU_PID=$!
+else
+    echo "Error: Unknown ARCH=$ARCH"
+    exit 1
+fi
+
+SENTINEL_LINE=$(timeout "$TIMEOUT" bash -c "
+    while true; do
+        if [[ -f '$SERIAL_LOG' ]]; then
+            LINE=\$(grep -m1 'STLX_BENCH_COMPLETE' '$SERIAL_LOG' 2>/dev/null || true)
+            if [[ -n \"\$LINE\" ]]; then
+                echo \"\$LINE\"
+                exit 0
+            fi
+        fi
+        sleep 0.5
+    done
+" 2>/dev/null || true)
+
+kill "$QEMU_PID" 2>/dev/null || true
+wait "$QEMU_PID" 2>/dev/null || true
+QEMU_PID=""
+
+# Strip carriage returns from serial log (kernel outputs \r\n)
+tr -d '\r' < "$SERIAL_LOG" > "${SERIAL_LOG}.clean"
+mv "${SERIAL_LOG}.clean" "$SERIAL_LOG"
+
+if [[ -z "$SENTINEL_LINE" ]]; then
+    echo -e "${RED}TIMEOUT: Kernel did not complete benchmarks within ${TIMEOUT}s${NC}" >&2
+    echo "" >&2
+    echo "Serial log:" >&2
+    cat "$SERIAL_LOG" >&2 || true
+    exit 2
+fi
+
+FAILURES=$(echo "$SENTINEL_LINE" | tr -d '\r' | grep -oE '[0-9]+$' || echo "1")
+HEADER=$(sed -n 's/^STLX_BENCH_START //p' "$SERIAL_LOG" | head -n1)
+RESULTS=$(sed -n 's/^STLX_BENCH //p' "$SERIAL_LOG" | paste -sd, -)
+
+mkdir -p "$BUILD_DIR"
+printf '{"arch":"%s","run":%s,"benches":[%s]}\n' \
+    "$ARCH" "${HEADER:-null}" "$RESULTS" > "$RESULT_JSON"
+cat "$RESULT_JSON"
+echo "Results written to $RESULT_JSON" >&2
+
+if [[ "$FAILURES" -eq 0 ]]; then
+    exit 0
+else
+    echo -e "${RED}${FAILURES} benchmark(s) failed${NC}" >&2
+    exit 1
+fi
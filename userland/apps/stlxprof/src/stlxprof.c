@@ -0,0 +1,387 @@
+/*
+ * stlxprof - system-wide sampling profiler front end
+ *
+ * Samples every CPU through /dev/profile for a number of seconds, then
+ * prints the samples as folded stacks, one "task;frame;...;leaf count"
+ * line per distinct stack, most frequent first. Kernel frames are
+ * resolved to symbols by the kernel, user frames show as [user].
+ *
+ * Usage: stlxprof [-f hz] [-a] [seconds]
+ *   -f hz  sampling frequency (default 1000)
+ *   -a     keep the address of user samples instead of folding them
+ *   seconds  profiling duration (default 5)
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Mirrors kernel/profile/profile.h */
+#define PROFILE_START     0x5000
+#define PROFILE_STOP      0x5001
+#define PROFILE_SET_FREQ  0x5002
+#define PROFILE_GET_STATS 0x5003
+#define PROFILE_RESOLVE   0x5004
+
+#define SAMPLE_MAX_STACK  14
+#define SAMPLE_USER       0x01
+
+typedef struct {
+    uint64_t pc;
+    uint32_t tid;
+    uint16_t cpu;
+    uint8_t  flags;
+    uint8_t  depth;
+    uint64_t stack[SAMPLE_MAX_STACK];
+} profile_sample_t;
+
+typedef struct {
+    uint64_t samples;
+    uint64_t drops;
+    uint32_t freq_hz;
+    uint32_t running;
+} profile_stats_t;
+
+typedef struct {
+    uint64_t addr;
+    uint64_t offset;
+    char     name[112];
+} profile_symbol_t;
+
+#define READ_BATCH     32
+#define DRAIN_SLICE_NS 100000000ULL
+
+#define MAX_TASKS      256
+#define NAME_MAX_LEN   64
+#define SYM_SLOTS      4096   /* power of two */
+#define STACK_SLOTS    8192   /* power of two */
+#define LINE_MAX_LEN   1024
+
+typedef struct {
+    uint32_t tid;
+    char     name[NAME_MAX_LEN];
+} task_name_t;
+
+typedef struct {
+    uint64_t addr;
+    char*    name;
+} sym_entry_t;
+
+typedef struct {
+    char*    line;
+    uint64_t count;
+} stack_entry_t;
+
+static int g_fd = -1;
+static int g_keep_user_pc = 0;
+
+static task_name_t g_tasks[MAX_TASKS];
+static int g_task_count = 0;
+
+static sym_entry_t g_syms[SYM_SLOTS];
+static stack_entry_t g_stacks[STACK_SLOTS];
+static uint32_t g_stack_count = 0;
+static uint64_t g_unfolded = 0;
+
+/* ---- task names ---- */
+
+/* Remember the tid and trailing name of /dev/sysinfo/tasks lines.
+ * Called before and after profiling so short lived tasks still have a
+ * name when they appear in either snapshot. */
+static void snapshot_tasks(void) {
+    static char buf[65536];
+    int fd = open("/dev/sysinfo/tasks", O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    size_t total = 0;
+    while (total < sizeof(buf) - 1) {
+        ssize_t rd = read(fd, buf + total, sizeof(buf) - 1 - total);
+        if (rd <= 0) {
+            break;
+        }
+        total += (size_t)rd;
+    }
+    close(fd);
+    buf[total] = '\0';
+
+    const char* p = buf;
+    while (*p) {
+        char* end = NULL;
+        uint32_t tid = (uint32_t)strtoul(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        /* Skip pid, state, cpu, ticks and the twelve usage columns */
+        for (int field = 0; field < 16; field++) {
+            while (*end == ' ') end++;
+            while (*end && *end != ' ' && *end != '\n') end++;
+        }
+        while (*end == ' ') end++;
+
+        int slot = -1;
+        for (int i = 0; i < g_task_count; i++) {
+            if (g_tasks[i].tid == tid) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0 && g_task_count < MAX_TASKS) {
+            slot = g_task_count++;
+        }
+        if (slot >= 0) {
+            size_t i = 0;
+            while (*end && *end != '\n' && i < NAME_MAX_LEN - 1) {
+                g_tasks[slot].name[i++] = *end++;
+            }
+            g_tasks[slot].name[i] = '\0';
+            g_tasks[slot].tid = tid;
+        }
+
+        p = end;
+        while (*p && *p != '\n') p++;
+        if (*p) p++;
+    }
+}
+
+static const char* task_name(uint32_t tid, char* fallback, size_t cap) {
+    for (int i = 0; i < g_task_count; i++) {
+        if (g_tasks[i].tid == tid) {
+            return g_tasks[i].name;
+        }
+    }
+    snprintf(fallback, cap, "tid-%u", tid);
+    return fallback;
+}
+
+/* ---- kernel symbols ---- */
+
+static const char* symbol(uint64_t addr) {
+    uint32_t slot = (uint32_t)((addr * 0x9E3779B97F4A7C15ULL) >> 52) & (SYM_SLOTS - 1);
+    for (uint32_t probe = 0; probe < SYM_SLOTS; probe++) {
+        sym_entry_t* e = &g_syms[(slot + probe) & (SYM_SLOTS - 1)];
+        if (e->name && e->addr == addr) {
+            return e->name;
+        }
+        if (!e->name) {
+            profile_symbol_t sym;
+            memset(&sym, 0, sizeof(sym));
+            sym.addr = addr;
+            char hex[24];
+            const char* name = hex;
+            if (ioctl(g_fd, PROFILE_RESOLVE, &sym) == 0) {
+                name = sym.name;
+            } else {
+                snprintf(hex, sizeof(hex), "0x%llx", (unsigned long long)addr);
+            }
+            e->name = strdup(name);
+            if (!e->name) {
+                return "?";
+            }
+            e->addr = addr;
+            return e->name;
+        }
+    }
+    return "?";
+}
+
+/* ---- folding ---- */
+
+static uint32_t hash_str(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    }
+    return h;
+}
+
+static void count_stack(const char* line) {
+    uint32_t slot = hash_str(line) & (STACK_SLOTS - 1);
+    for (uint32_t probe = 0; probe < STACK_SLOTS; probe++) {
+        stack_entry_t* e = &g_stacks[(slot + probe) & (STACK_SLOTS - 1)];
+        if (e->line && strcmp(e->line, line) == 0) {
+            e->count++;
+            return;
+        }
+        if (!e->line) {
+            /* Keep a quarter of the table free so probes stay short */
+            if (g_stack_count >= STACK_SLOTS - STACK_SLOTS / 4) {
+                break;
+            }
+            e->line = strdup(line);
+            if (!e->line) {
+                break;
+            }
+            e->count = 1;
+            g_stack_count++;
+            return;
+        }
+    }
+    g_unfolded++;
+}
+
+static size_t append(char* line, size_t pos, const char* s) {
+    if (pos > 0 && pos < LINE_MAX_LEN - 1) {
+        line[pos++] = ';';
+    }
+    while (*s && pos < LINE_MAX_LEN - 1) {
+        line[pos++] = *s++;
+    }
+    line[pos] = '\0';
+    return pos;
+}
+
+static void fold(const profile_sample_t* s) {
+    char line[LINE_MAX_LEN];
+    char fallback[24];
+    size_t pos = 0;
+    line[0] = '\0';
+
+    pos = append(line, pos, task_name(s->tid, fallback, sizeof(fallback)));
+    if (s->flags & SAMPLE_USER) {
+        if (g_keep_user_pc) {
+            char hex[32];
+            snprintf(hex, sizeof(hex), "[user] 0x%llx", (unsigned long long)s->pc);
+            append(line, pos, hex);
+        } else {
+            append(line, pos, "[user]");
+        }
+    } else {
+        /* Outermost caller first, the sampled pc last */
+        int depth = s->depth > SAMPLE_MAX_STACK ? SAMPLE_MAX_STACK : s->depth;
+        for (int i = depth - 1; i >= 0; i--) {
+            pos = append(line, pos, symbol(s->stack[i]));
+        }
+        append(line, pos, symbol(s->pc));
+    }
+    count_stack(line);
+}
+
+static int drain(void) {
+    static profile_sample_t batch[READ_BATCH];
+    for (;;) {
+        ssize_t rd = read(g_fd, batch, sizeof(batch));
+        if (rd < 0) {
+            return -1;
+        }
+        if (rd == 0) {
+            return 0;
+        }
+        size_t n = (size_t)rd / sizeof(profile_sample_t);
+        for (size_t i = 0; i < n; i++) {
+            fold(&batch[i]);
+        }
+    }
+}
+
+static int by_count_desc(const void* a, const void* b) {
+    const stack_entry_t* x = (const stack_entry_t*)a;
+    const stack_entry_t* y = (const stack_entry_t*)b;
+    if (x->count != y->count) {
+        return x->count < y->count ? 1 : -1;
+    }
+    return strcmp(x->line, y->line);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: stlxprof [-f hz] [-a] [seconds]\n");
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long freq = 1000;
+    unsigned long seconds = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:a")) != -1) {
+        switch (opt) {
+        case 'f':
+            freq = strtoul(optarg, NULL, 10);
+            break;
+        case 'a':
+            g_keep_user_pc = 1;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        seconds = strtoul(argv[optind], NULL, 10);
+    }
+    if (freq == 0 || seconds == 0) {
+        usage();
+        return 1;
+    }
+
+    g_fd = open("/dev/profile", O_RDONLY);
+    if (g_fd < 0) {
+        fprintf(stderr, "stlxprof: cannot open /dev/profile: %s\n", strerror(errno));
+        return 1;
+    }
+    if (ioctl(g_fd, PROFILE_SET_FREQ, freq) < 0) {
+        fprintf(stderr, "stlxprof: unsupported frequency %lu Hz\n", freq);
+        return 1;
+    }
+
+    snapshot_tasks();
+    if (ioctl(g_fd, PROFILE_START, 0) < 0) {
+        fprintf(stderr, "stlxprof: start failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    /* Drain while sampling so the per-CPU rings never fill */
+    uint64_t deadline = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    while (now_ns() < deadline) {
+        struct timespec slice = { 0, (long)DRAIN_SLICE_NS };
+        nanosleep(&slice, NULL);
+        drain();
+    }
+
+    ioctl(g_fd, PROFILE_STOP, 0);
+    snapshot_tasks();
+    drain();
+
+    profile_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    ioctl(g_fd, PROFILE_GET_STATS, &stats);
+    close(g_fd);
+
+    stack_entry_t* sorted = malloc(sizeof(stack_entry_t) * (g_stack_count ? g_stack_count : 1));
+    if (!sorted) {
+        fprintf(stderr, "stlxprof: out of memory\n");
+        return 1;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < STACK_SLOTS; i++) {
+        if (g_stacks[i].line) {
+            sorted[n++] = g_stacks[i];
+        }
+    }
+    qsort(sorted, n, sizeof(stack_entry_t), by_count_desc);
+
+    for (uint32_t i = 0; i < n; i++) {
+        printf("%s %llu\n", sorted[i].line, (unsigned long long)sorted[i].count);
+    }
+    fprintf(stderr, "stlxprof: %llu samples at %u Hz, %llu dropped, %u stacks",
+            (unsigned long long)stats.samples, stats.freq_hz,
+            (unsigned long long)stats.drops, n);
+    if (g_unfolded) {
+        fprintf(stderr, ", %llu not folded (table full)", (unsigned long long)g_unfolded);
+    }
+    fprintf(stderr, "\n");
+
+    free(sorted);
+    return 0;
+}
@@ -2,7 +2,8 @@
  * stlxtop - interactive system and process monitor
  *
  * Renders per-CPU utilization bars, memory usage, and a process table
- * sorted by CPU usage, all sampled from the /dev/sysinfo text files.
+ * sorted by CPU usage with each task's system time share and resident
+ * size, all sampled from one read of the binary /dev/sysinfo/snapshot.
  * Refreshes once per second by default, tunable with -u <seconds>,
  * until q or Ctrl+C exits.
  */
@@ -19,13 +20,17 @@
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
+#include <stlx/sysinfo.h>
 
 #define MAX_CPUS      32
-#define MAX_TASKS     256
+#define MAX_TASKS     1024
 #define NAME_MAX_LEN  64
 #define STATE_MAX_LEN 12
 #define FRAME_MAX     32768
 
+/* Sized for about a hundred tasks, doubled as needed */
+#define SNAPSHOT_INITIAL 16384
+
 typedef struct {
     uint64_t busy;
     uint64_t idle;
@@ -36,6 +41,8 @@ typedef struct {
     uint32_t pid;
     uint32_t cpu;
     uint64_t ticks;
+    uint64_t stime_ticks;
+    uint64_t rss_kb;
     char     state[STATE_MAX_LEN];
     char     name[NAME_MAX_LEN];
 } task_sample_t;
@@ -56,6 +63,7 @@ typedef struct {
     uint32_t tid;
     uint64_t ticks;
     unsigned pct;
+    unsigned sys_pct;
 } task_delta_t;
 
 /* Input is polled without blocking and sleep slices pace the refresh,
@@ -68,143 +76,113 @@ static sample_t g_cur;
 static sample_t g_prev;
 static int g_have_prev = 0;
 
+static int g_snapshot_fd = -1;
+static const uint8_t* g_snapshot = NULL;
+
 static char g_frame[FRAME_MAX];
 static size_t g_frame_len = 0;
 
 static struct termios g_saved_tio;
 static int g_tio_saved = 0;
 
-/* ---- stats file reading ---- */
+/* ---- snapshot reading ---- */
 
-static ssize_t read_stats_file(const char* path, char* buf, size_t cap) {
-    int fd = open(path, O_RDONLY);
-    if (fd < 0) {
-        return -1;
-    }
-    size_t total = 0;
-    while (total < cap - 1) {
-        ssize_t rd = read(fd, buf + total, cap - 1 - total);
-        if (rd <= 0) {
-            break;
-        }
-        total += (size_t)rd;
+static const char* task_state_name(uint32_t state) {
+    switch (state) {
+    case STLX_TASK_STATE_CREATED: return "created";
+    case STLX_TASK_STATE_READY:   return "ready";
+    case STLX_TASK_STATE_RUNNING: return "running";
+    case STLX_TASK_STATE_BLOCKED: return "blocked";
+    case STLX_TASK_STATE_DEAD:    return "dead";
+    default:                      return "unknown";
     }
-    close(fd);
-    buf[total] = '\0';
-    return (ssize_t)total;
 }
 
-static uint64_t labeled_field(const char* text, const char* label) {
-    const char* p = strstr(text, label);
-    if (!p) {
-        return 0;
-    }
-    return strtoull(p + strlen(label), NULL, 10);
-}
+/* Read one whole snapshot into a buffer that grows with the task count.
+ * The fd stays open, a read from offset 0 captures a fresh snapshot */
+static ssize_t read_snapshot(int fd) {
+    static uint8_t* buf = NULL;
+    static size_t cap = 0;
 
-static int parse_cpu(sample_t* s) {
-    char buf[2048];
-    if (read_stats_file("/dev/sysinfo/cpu", buf, sizeof(buf)) <= 0) {
+    if (lseek(fd, 0, SEEK_SET) != 0) {
         return -1;
     }
-    s->tick_hz = labeled_field(buf, "tick_hz ");
-    s->cpu_count = 0;
-
-    const char* p = buf;
-    while (*p && s->cpu_count < MAX_CPUS) {
-        if (strncmp(p, "cpu", 3) == 0) {
-            char* end = NULL;
-            strtoull(p + 3, &end, 10);
-            cpu_sample_t* c = &s->cpus[s->cpu_count++];
-            c->busy = strtoull(end, &end, 10);
-            c->idle = strtoull(end, &end, 10);
+    size_t total = 0;
+    for (;;) {
+        if (total == cap) {
+            size_t new_cap = cap ? cap * 2 : SNAPSHOT_INITIAL;
+            uint8_t* grown = realloc(buf, new_cap);
+            if (!grown) {
+                return -1;
+            }
+            buf = grown;
+            cap = new_cap;
         }
-        while (*p && *p != '\n') {
-            p++;
+        ssize_t rd = read(fd, buf + total, cap - total);
+        if (rd < 0) {
+            return -1;
         }
-        if (*p) {
-            p++;
+        if (rd == 0) {
+            break;
         }
+        total += (size_t)rd;
     }
-    return s->cpu_count > 0 ? 0 : -1;
+    g_snapshot = buf;
+    return (ssize_t)total;
 }
 
-static int parse_mem(sample_t* s) {
-    char buf[512];
-    if (read_stats_file("/dev/sysinfo/mem", buf, sizeof(buf)) <= 0) {
+static int sample_all(sample_t* s) {
+    ssize_t len = read_snapshot(g_snapshot_fd);
+    if (len < (ssize_t)sizeof(stlx_snapshot_header)) {
         return -1;
     }
-    s->mem_page_size = labeled_field(buf, "page_size ");
-    s->mem_total_pages = labeled_field(buf, "total_pages ");
-    s->mem_used_pages = labeled_field(buf, "used_pages ");
-    return 0;
-}
-
-static void parse_uptime(sample_t* s) {
-    char buf[64];
-    s->uptime_ns = 0;
-    if (read_stats_file("/dev/sysinfo/uptime", buf, sizeof(buf)) > 0) {
-        s->uptime_ns = strtoull(buf, NULL, 10);
-    }
-}
-
-static int parse_tasks(sample_t* s) {
-    static char buf[16384];
-    if (read_stats_file("/dev/sysinfo/tasks", buf, sizeof(buf)) <= 0) {
+    const stlx_snapshot_header* hdr = (const stlx_snapshot_header*)g_snapshot;
+    if (hdr->magic != STLX_SNAPSHOT_MAGIC ||
+        hdr->version != STLX_SNAPSHOT_VERSION ||
+        hdr->cpu_record_size < sizeof(stlx_snapshot_cpu) ||
+        hdr->task_record_size < sizeof(stlx_snapshot_task) ||
+        hdr->cpu_offset + (uint64_t)hdr->cpu_count * hdr->cpu_record_size
+            > (uint64_t)len ||
+        hdr->task_offset + (uint64_t)hdr->task_count * hdr->task_record_size
+            > (uint64_t)len) {
         return -1;
     }
 
-    s->task_count = 0;
-    const char* p = buf;
-    while (*p && s->task_count < MAX_TASKS) {
-        task_sample_t* t = &s->tasks[s->task_count];
-        char* end = NULL;
-
-        t->tid = (uint32_t)strtoul(p, &end, 10);
-        if (end == p) {
-            break;
-        }
-        t->pid = (uint32_t)strtoul(end, &end, 10);
+    s->tick_hz = hdr->tick_hz;
+    s->mem_page_size = hdr->page_size;
+    s->mem_total_pages = hdr->total_pages;
+    s->mem_used_pages = hdr->total_pages - hdr->free_pages;
+    s->uptime_ns = hdr->timestamp_ns;
 
-        while (*end == ' ') {
-            end++;
-        }
-        size_t i = 0;
-        while (*end && *end != ' ' && i < sizeof(t->state) - 1) {
-            t->state[i++] = *end++;
-        }
-        t->state[i] = '\0';
-
-        t->cpu = (uint32_t)strtoul(end, &end, 10);
-        t->ticks = strtoull(end, &end, 10);
-
-        while (*end == ' ') {
-            end++;
-        }
-        i = 0;
-        while (*end && *end != '\n' && i < sizeof(t->name) - 1) {
-            t->name[i++] = *end++;
-        }
-        t->name[i] = '\0';
-
-        s->task_count++;
-        p = end;
-        while (*p && *p != '\n') {
-            p++;
-        }
-        if (*p) {
-            p++;
-        }
+    s->cpu_count = 0;
+    for (uint32_t i = 0; i < hdr->cpu_count && i < MAX_CPUS; i++) {
+        const stlx_snapshot_cpu* c = (const stlx_snapshot_cpu*)
+            (g_snapshot + hdr->cpu_offset + (size_t)i * hdr->cpu_record_size);
+        s->cpus[i].busy = c->busy_ticks;
+        s->cpus[i].idle = c->idle_ticks;
+        s->cpu_count++;
     }
-    return 0;
-}
 
-static int sample_all(sample_t* s) {
-    if (parse_cpu(s) != 0 || parse_mem(s) != 0 || parse_tasks(s) != 0) {
-        return -1;
+    /* Task CPU time is in nanoseconds, the table works in ticks */
+    uint64_t tick_ns = hdr->tick_hz ? 1000000000ULL / hdr->tick_hz : 0;
+
+    s->task_count = 0;
+    for (uint32_t i = 0; i < hdr->task_count && s->task_count < MAX_TASKS;
+         i++) {
+        const stlx_snapshot_task* rec = (const stlx_snapshot_task*)
+            (g_snapshot + hdr->task_offset + (size_t)i * hdr->task_record_size);
+        task_sample_t* t = &s->tasks[s->task_count++];
+        t->tid = rec->tid;
+        t->pid = rec->pid;
+        t->cpu = rec->cpu;
+        t->ticks = tick_ns ? rec->run_ns / tick_ns : 0;
+        t->stime_ticks = tick_ns ? rec->usage.sys_ns / tick_ns : 0;
+        t->rss_kb = rec->rss_kb;
+        snprintf(t->state, sizeof(t->state), "%s", task_state_name(rec->state));
+        snprintf(t->name, sizeof(t->name), "%.*s",
+                 STLX_SNAPSHOT_NAME_LEN, rec->name);
     }
-    parse_uptime(s);
-    return 0;
+    return s->cpu_count > 0 ? 0 : -1;
 }
 
 /* ---- terminal handling ---- */
@@ -312,17 +290,6 @@ static int delta_compare(const void* a, const void* b) {
     return ta->tid < tb->tid ? -1 : 1;
 }
 
-static uint64_t prev_task_ticks(uint32_t tid, int* found) {
-    for (int i = 0; i < g_prev.task_count; i++) {
-        if (g_prev.tasks[i].tid == tid) {
-            *found = 1;
-            return g_prev.tasks[i].ticks;
-        }
-    }
-    *found = 0;
-    return 0;
-}
-
 static const task_sample_t* task_by_tid(const sample_t* s, uint32_t tid) {
     for (int i = 0; i < s->task_count; i++) {
         if (s->tasks[i].tid == tid) {
@@ -332,6 +299,23 @@ static const task_sample_t* task_by_tid(const sample_t* s, uint32_t tid) {
     return NULL;
 }
 
+static unsigned interval_pct(uint64_t cur, uint64_t prev,
+                             uint64_t interval_ticks) {
+    if (cur < prev) {
+        return 0;
+    }
+    return (unsigned)(((cur - prev) * 100 + interval_ticks / 2)
+                      / interval_ticks);
+}
+
+static void format_kb(char* out, size_t size, uint64_t kb) {
+    if (kb >= 10240) {
+        snprintf(out, size, "%lluM", (unsigned long long)(kb / 1024));
+    } else {
+        snprintf(out, size, "%lluK", (unsigned long long)kb);
+    }
+}
+
 static void render(void) {
     int rows = 0;
     int cols = 0;
@@ -393,10 +377,10 @@ static void render(void) {
     emit("\033[K\r\n");
 
     /* Task table sorted by CPU usage */
-    emit("\033[7m%5s %5s %-8s %4s %5s %9s NAME\033[K\033[0m\r\n",
-         "TID", "PID", "STATE", "CPU", "CPU%", "TIME");
+    emit("\033[7m%5s %5s %-8s %4s %5s %5s %6s %9s NAME\033[K\033[0m\r\n",
+         "TID", "PID", "STATE", "CPU", "CPU%", "SYS%", "RES", "TIME");
 
-    task_delta_t deltas[MAX_TASKS];
+    static task_delta_t deltas[MAX_TASKS];
     int delta_count = 0;
     for (int i = 0; i < g_cur.task_count; i++) {
         const task_sample_t* t = &g_cur.tasks[i];
@@ -404,13 +388,13 @@ static void render(void) {
         d->tid = t->tid;
         d->ticks = t->ticks;
         d->pct = 0;
+        d->sys_pct = 0;
         if (g_have_prev && interval_ticks > 0) {
-            int found = 0;
-            uint64_t prev_ticks = prev_task_ticks(t->tid, &found);
-            if (found && t->ticks >= prev_ticks) {
-                uint64_t d_ticks = t->ticks - prev_ticks;
-                d->pct = (unsigned)((d_ticks * 100 + interval_ticks / 2)
-                                    / interval_ticks);
+            const task_sample_t* prev = task_by_tid(&g_prev, t->tid);
+            if (prev) {
+                d->pct = interval_pct(t->ticks, prev->ticks, interval_ticks);
+                d->sys_pct = interval_pct(t->stime_ticks, prev->stime_ticks,
+                                          interval_ticks);
             }
         }
     }
@@ -434,14 +418,17 @@ static void render(void) {
                      ? (unsigned long long)(t->ticks % g_cur.tick_hz)
                      : 0ULL);
 
-        int name_width = cols - 42;
+        char res_str[16];
+        format_kb(res_str, sizeof(res_str), t->rss_kb);
+
+        int name_width = cols - 55;
         if (name_width < 8) {
             name_width = 8;
         }
-        emit("%5u %5u %-8s %4u %s%4u%%\033[0m %9s %.*s\033[K\r\n",
+        emit("%5u %5u %-8s %4u %s%4u%%\033[0m %4u%% %6s %9s %.*s\033[K\r\n",
              t->tid, t->pid, t->state, t->cpu,
-             pct_color(deltas[i].pct), deltas[i].pct,
-             time_str, name_width, t->name);
+             pct_color(deltas[i].pct), deltas[i].pct, deltas[i].sys_pct,
+             res_str, time_str, name_width, t->name);
     }
 
     emit("\033[0J\033[1mq\033[0m quit");
@@ -473,8 +460,9 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (sample_all(&g_cur) != 0) {
-        fprintf(stderr, "stlxtop: cannot read /dev/sysinfo\n");
+    g_snapshot_fd = open("/dev/sysinfo/snapshot", O_RDONLY);
+    if (g_snapshot_fd < 0 || sample_all(&g_cur) != 0) {
+        fprintf(stderr, "stlxtop: cannot read /dev/sysinfo/snapshot\n");
         return 1;
     }
 
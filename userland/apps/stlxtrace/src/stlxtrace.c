@@ -0,0 +1,295 @@
+/*
+ * stlxtrace - kernel tracepoint recorder
+ *
+ * Enables the selected kernel tracepoints through /dev/trace for a
+ * number of seconds, then prints the recorded events of every CPU merged
+ * into one timeline, one line per event.
+ *
+ * Usage: stlxtrace [-e event,...] [seconds]
+ *   -e  comma separated events or groups (sched, syscall, irq, futex, net)
+ *       to enable, default all
+ *   seconds  tracing duration (default 1)
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Mirrors kernel/trace/trace.h */
+#define TRACE_SET_EVENTS 0x5100
+#define TRACE_CLEAR      0x5101
+#define TRACE_GET_STATS  0x5102
+
+#define EV_SCHED_SWITCH    0
+#define EV_SCHED_WAKE      1
+#define EV_SCHED_MIGRATE   2
+#define EV_SYSCALL_ENTER   3
+#define EV_SYSCALL_EXIT    4
+#define EV_IRQ_ENTER       5
+#define EV_IRQ_EXIT        6
+#define EV_PAGE_FAULT      7
+#define EV_FUTEX_WAIT      8
+#define EV_FUTEX_WAKE      9
+#define EV_NET_RX          10
+#define EV_NET_TX          11
+#define EV_FUTEX_LOCK_PI   12
+#define EV_FUTEX_UNLOCK_PI 13
+#define EVENT_COUNT        14
+
+#define PF_RESOLVED      (1ULL << 31)
+
+typedef struct {
+    uint64_t ts_ns;
+    uint32_t tid;
+    uint16_t id;
+    uint16_t cpu;
+    uint64_t args[3];
+} trace_event_t;
+
+typedef struct {
+    uint64_t events;
+    uint64_t drops;
+    uint32_t enabled;
+    uint32_t cpus;
+} trace_stats_t;
+
+#define READ_BATCH     128
+#define DRAIN_SLICE_NS 50000000ULL
+#define MAX_EVENTS     262144
+
+static const char* g_names[EVENT_COUNT] = {
+    "sched_switch", "sched_wake", "sched_migrate",
+    "syscall_enter", "syscall_exit",
+    "irq_enter", "irq_exit",
+    "page_fault",
+    "futex_wait", "futex_wake",
+    "net_rx", "net_tx",
+    "futex_lock_pi", "futex_unlock_pi",
+};
+
+static const struct {
+    const char* name;
+    uint32_t    mask;
+} g_groups[] = {
+    { "sched",   (1u << EV_SCHED_SWITCH) | (1u << EV_SCHED_WAKE) | (1u << EV_SCHED_MIGRATE) },
+    { "syscall", (1u << EV_SYSCALL_ENTER) | (1u << EV_SYSCALL_EXIT) },
+    { "irq",     (1u << EV_IRQ_ENTER) | (1u << EV_IRQ_EXIT) },
+    { "futex",   (1u << EV_FUTEX_WAIT) | (1u << EV_FUTEX_WAKE) |
+                 (1u << EV_FUTEX_LOCK_PI) | (1u << EV_FUTEX_UNLOCK_PI) },
+    { "net",     (1u << EV_NET_RX) | (1u << EV_NET_TX) },
+    { "all",     (1u << EVENT_COUNT) - 1 },
+};
+
+static int g_fd = -1;
+static trace_event_t* g_events;
+static size_t g_count = 0;
+static uint64_t g_overflow = 0;
+
+static int parse_events(char* list, uint32_t* mask) {
+    *mask = 0;
+    for (char* tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        uint32_t bit = 0;
+        for (size_t i = 0; i < sizeof(g_groups) / sizeof(g_groups[0]); i++) {
+            if (strcmp(tok, g_groups[i].name) == 0) {
+                bit = g_groups[i].mask;
+            }
+        }
+        for (int i = 0; i < EVENT_COUNT && !bit; i++) {
+            if (strcmp(tok, g_names[i]) == 0) {
+                bit = 1u << i;
+            }
+        }
+        if (!bit) {
+            fprintf(stderr, "stlxtrace: unknown event '%s'\n", tok);
+            return -1;
+        }
+        *mask |= bit;
+    }
+    return 0;
+}
+
+static void drain(void) {
+    static trace_event_t batch[READ_BATCH];
+    for (;;) {
+        ssize_t rd = read(g_fd, batch, sizeof(batch));
+        if (rd <= 0) {
+            return;
+        }
+        size_t n = (size_t)rd / sizeof(trace_event_t);
+        for (size_t i = 0; i < n; i++) {
+            if (g_count < MAX_EVENTS) {
+                g_events[g_count++] = batch[i];
+            } else {
+                g_overflow++;
+            }
+        }
+    }
+}
+
+static int by_time(const void* a, const void* b) {
+    const trace_event_t* x = (const trace_event_t*)a;
+    const trace_event_t* y = (const trace_event_t*)b;
+    if (x->ts_ns != y->ts_ns) {
+        return x->ts_ns < y->ts_ns ? -1 : 1;
+    }
+    return (int)x->cpu - (int)y->cpu;
+}
+
+static void print_event(const trace_event_t* e) {
+    const uint64_t* a = e->args;
+    printf("%6llu.%06llu [%u] %5u %-15s ",
+           (unsigned long long)(e->ts_ns / 1000000000ULL),
+           (unsigned long long)(e->ts_ns % 1000000000ULL / 1000),
+           e->cpu, e->tid, e->id < EVENT_COUNT ? g_names[e->id] : "?");
+
+    switch (e->id) {
+    case EV_SCHED_SWITCH:
+        printf("prev=%llu next=%llu prev_state=%llu\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (unsigned long long)a[2]);
+        break;
+    case EV_SCHED_WAKE:
+        printf("tid=%llu cpu=%llu\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_SCHED_MIGRATE:
+        printf("tid=%llu from=%llu to=%llu\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (unsigned long long)a[2]);
+        break;
+    case EV_SYSCALL_ENTER:
+        printf("nr=%llu a1=0x%llx a2=0x%llx\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (unsigned long long)a[2]);
+        break;
+    case EV_SYSCALL_EXIT:
+        printf("nr=%llu ret=%lld\n", (unsigned long long)a[0], (long long)a[1]);
+        break;
+    case EV_IRQ_ENTER:
+    case EV_IRQ_EXIT:
+        printf("irq=%llu\n", (unsigned long long)a[0]);
+        break;
+    case EV_PAGE_FAULT:
+        printf("addr=0x%llx pc=0x%llx flags=0x%llx%s\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (unsigned long long)(a[2] & ~PF_RESOLVED),
+               (a[2] & PF_RESOLVED) ? "" : " unresolved");
+        break;
+    case EV_FUTEX_WAIT:
+        printf("uaddr=0x%llx val=%llu\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_FUTEX_WAKE:
+        printf("uaddr=0x%llx woken=%llu\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_FUTEX_LOCK_PI:
+        printf("uaddr=0x%llx owner=%llu\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_FUTEX_UNLOCK_PI:
+        printf("uaddr=0x%llx next_owner=%llu\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_NET_RX:
+        printf("len=%llu type=0x%04llx\n", (unsigned long long)a[0], (unsigned long long)a[1]);
+        break;
+    case EV_NET_TX:
+        printf("len=%llu type=0x%04llx ret=%lld\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (long long)a[2]);
+        break;
+    default:
+        printf("0x%llx 0x%llx 0x%llx\n", (unsigned long long)a[0],
+               (unsigned long long)a[1], (unsigned long long)a[2]);
+        break;
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: stlxtrace [-e event,...] [seconds]\n");
+    fprintf(stderr, "groups: sched syscall irq futex net all\n");
+    fprintf(stderr, "events:");
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        fprintf(stderr, " %s", g_names[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t mask = (1u << EVENT_COUNT) - 1;
+    unsigned long seconds = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:")) != -1) {
+        switch (opt) {
+        case 'e':
+            if (parse_events(optarg, &mask) < 0) {
+                usage();
+                return 1;
+            }
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        seconds = strtoul(argv[optind], NULL, 10);
+    }
+    if (mask == 0 || seconds == 0) {
+        usage();
+        return 1;
+    }
+
+    g_events = malloc(sizeof(trace_event_t) * MAX_EVENTS);
+    if (!g_events) {
+        fprintf(stderr, "stlxtrace: out of memory\n");
+        return 1;
+    }
+
+    g_fd = open("/dev/trace", O_RDONLY);
+    if (g_fd < 0) {
+        fprintf(stderr, "stlxtrace: cannot open /dev/trace: %s\n", strerror(errno));
+        return 1;
+    }
+    ioctl(g_fd, TRACE_CLEAR, 0);
+    if (ioctl(g_fd, TRACE_SET_EVENTS, mask) < 0) {
+        fprintf(stderr, "stlxtrace: enable failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    /* Drain while tracing so the per-CPU buffers never fill */
+    uint64_t deadline = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    while (now_ns() < deadline) {
+        struct timespec slice = { 0, (long)DRAIN_SLICE_NS };
+        nanosleep(&slice, NULL);
+        drain();
+    }
+
+    ioctl(g_fd, TRACE_SET_EVENTS, 0);
+    drain();
+
+    trace_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    ioctl(g_fd, TRACE_GET_STATS, &stats);
+    close(g_fd);
+
+    qsort(g_events, g_count, sizeof(trace_event_t), by_time);
+    for (size_t i = 0; i < g_count; i++) {
+        print_event(&g_events[i]);
+    }
+    fprintf(stderr, "stlxtrace: %llu events on %u CPUs, %llu dropped",
+            (unsigned long long)stats.events, stats.cpus,
+            (unsigned long long)stats.drops);
+    if (g_overflow) {
+        fprintf(stderr, ", %llu not kept (limit %d)",
+                (unsigned long long)g_overflow, MAX_EVENTS);
+    }
+    fprintf(stderr, "\n");
+
+    free(g_events);
+    return 0;
+}
@@ -0,0 +1,396 @@
+/*
+ * strace - per-process syscall tracer
+ *
+ * Traces the syscalls of one process through /dev/strace. Either starts
+ * a command and traces it until it exits, or attaches to a running
+ * process for a number of seconds. Each finished syscall prints one
+ * line with the thread, the handler name, the arguments, the return
+ * value and the time spent in the kernel. Arguments are printed up to
+ * the last non-zero one, the kernel does not know how many a call takes.
+ *
+ * Usage: strace [-c] command [args...]
+ *        strace [-c] -p pid [seconds]
+ *   -c  print a per-syscall summary (calls, errors, time) instead
+ *   -p  attach to a running process, for seconds (default 5)
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <stlx/proc.h>
+
+/* Mirrors kernel/strace/strace.h */
+#define STRACE_ATTACH    0x5200
+#define STRACE_DETACH    0x5201
+#define STRACE_GET_STATS 0x5202
+#define STRACE_GET_NAME  0x5203
+
+#define REC_ENTER 0
+#define REC_EXIT  1
+
+typedef struct {
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+    uint64_t args[6];
+    int64_t  ret;
+    uint32_t tid;
+    uint16_t nr;
+    uint16_t kind;
+} strace_record_t;
+
+typedef struct {
+    uint64_t records;
+    uint64_t drops;
+    uint32_t pid;
+    uint32_t reserved;
+} strace_stats_t;
+
+typedef struct {
+    uint32_t nr;
+    char     name[28];
+} strace_name_t;
+
+#define MAX_NR         2048
+#define MAX_PENDING    64
+#define READ_BATCH     64
+#define DRAIN_SLICE_NS 20000000ULL
+
+typedef struct {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} summary_t;
+
+typedef struct {
+    uint32_t        tid; /* 0 = free */
+    strace_record_t enter;
+} pending_t;
+
+static int g_fd = -1;
+static int g_summary = 0;
+static uint64_t g_start_ns = 0;
+static char g_names[MAX_NR][28];
+static uint8_t g_name_known[MAX_NR];
+static summary_t g_sum[MAX_NR];
+static pending_t g_pending[MAX_PENDING];
+static volatile int g_child_done = 0;
+static int g_child_status = 0;
+
+static const char* syscall_name(uint16_t nr) {
+    if (nr >= MAX_NR) {
+        return "?";
+    }
+    if (!g_name_known[nr]) {
+        strace_name_t n;
+        memset(&n, 0, sizeof(n));
+        n.nr = nr;
+        if (ioctl(g_fd, STRACE_GET_NAME, &n) < 0 || n.name[0] == '\0') {
+            snprintf(g_names[nr], sizeof(g_names[nr]), "syscall_%u", nr);
+        } else {
+            memcpy(g_names[nr], n.name, sizeof(g_names[nr]));
+            g_names[nr][sizeof(g_names[nr]) - 1] = '\0';
+        }
+        g_name_known[nr] = 1;
+    }
+    return g_names[nr];
+}
+
+static void print_call(const strace_record_t* enter, const strace_record_t* exit_rec) {
+    uint64_t rel = enter->ts_ns - g_start_ns;
+    printf("%4llu.%06llu [%5u] %s(",
+           (unsigned long long)(rel / 1000000000ULL),
+           (unsigned long long)(rel % 1000000000ULL / 1000),
+           enter->tid, syscall_name(enter->nr));
+
+    int last = -1;
+    for (int i = 0; i < 6; i++) {
+        if (enter->args[i]) {
+            last = i;
+        }
+    }
+    for (int i = 0; i <= last; i++) {
+        printf(i ? ", 0x%llx" : "0x%llx", (unsigned long long)enter->args[i]);
+    }
+
+    if (!exit_rec) {
+        printf(") = ?\n");
+    } else if (exit_rec->ret < 0 && exit_rec->ret > -4096) {
+        printf(") = -1 (errno %lld) <%llu.%06llu>\n", (long long)-exit_rec->ret,
+               (unsigned long long)(exit_rec->dur_ns / 1000000000ULL),
+               (unsigned long long)(exit_rec->dur_ns % 1000000000ULL / 1000));
+    } else {
+        printf(") = %lld <%llu.%06llu>\n", (long long)exit_rec->ret,
+               (unsigned long long)(exit_rec->dur_ns / 1000000000ULL),
+               (unsigned long long)(exit_rec->dur_ns % 1000000000ULL / 1000));
+    }
+}
+
+static pending_t* find_pending(uint32_t tid) {
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (g_pending[i].tid == tid) {
+            return &g_pending[i];
+        }
+    }
+    return NULL;
+}
+
+static void handle_record(const strace_record_t* r) {
+    if (g_start_ns == 0) {
+        g_start_ns = r->ts_ns;
+    }
+
+    if (r->kind == REC_EXIT) {
+        if (r->nr < MAX_NR) {
+            summary_t* s = &g_sum[r->nr];
+            s->calls++;
+            s->total_ns += r->dur_ns;
+            if (r->dur_ns > s->max_ns) {
+                s->max_ns = r->dur_ns;
+            }
+            if (r->ret < 0 && r->ret > -4096) {
+                s->errors++;
+            }
+        }
+        pending_t* p = find_pending(r->tid);
+        if (p && p->enter.nr == r->nr) {
+            if (!g_summary) {
+                print_call(&p->enter, r);
+            }
+            p->tid = 0;
+        }
+        return;
+    }
+
+    /* An enter without an exit before it: that call never returned */
+    pending_t* p = find_pending(r->tid);
+    if (p) {
+        if (!g_summary) {
+            print_call(&p->enter, NULL);
+        }
+    } else {
+        p = find_pending(0);
+    }
+    if (!p) {
+        if (!g_summary) {
+            print_call(r, NULL); /* too many threads in flight */
+        }
+        return;
+    }
+    p->tid = r->tid;
+    p->enter = *r;
+}
+
+static void drain(void) {
+    static strace_record_t batch[READ_BATCH];
+    for (;;) {
+        ssize_t rd = read(g_fd, batch, sizeof(batch));
+        if (rd <= 0) {
+            return;
+        }
+        size_t n = (size_t)rd / sizeof(strace_record_t);
+        for (size_t i = 0; i < n; i++) {
+            handle_record(&batch[i]);
+        }
+        fflush(stdout);
+    }
+}
+
+static void flush_pending(void) {
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (g_pending[i].tid) {
+            if (!g_summary) {
+                print_call(&g_pending[i].enter, NULL);
+            }
+            g_pending[i].tid = 0;
+        }
+    }
+}
+
+static int by_total_time(const void* a, const void* b) {
+    const summary_t* x = &g_sum[*(const uint16_t*)a];
+    const summary_t* y = &g_sum[*(const uint16_t*)b];
+    if (x->total_ns != y->total_ns) {
+        return x->total_ns > y->total_ns ? -1 : 1;
+    }
+    return x->calls > y->calls ? -1 : (x->calls < y->calls ? 1 : 0);
+}
+
+static void print_summary(void) {
+    static uint16_t order[MAX_NR];
+    size_t count = 0;
+    uint64_t calls = 0, errors = 0, total = 0;
+    for (uint16_t nr = 0; nr < MAX_NR; nr++) {
+        if (g_sum[nr].calls) {
+            order[count++] = nr;
+            calls += g_sum[nr].calls;
+            errors += g_sum[nr].errors;
+            total += g_sum[nr].total_ns;
+        }
+    }
+    qsort(order, count, sizeof(order[0]), by_total_time);
+
+    printf("%% time     seconds  usecs/call     max usecs     calls    errors syscall\n");
+    printf("------ ----------- ----------- ------------- --------- --------- ----------------\n");
+    for (size_t i = 0; i < count; i++) {
+        const summary_t* s = &g_sum[order[i]];
+        printf("%6.2f %11.6f %11llu %13llu %9llu %9llu %s\n",
+               total ? 100.0 * (double)s->total_ns / (double)total : 0.0,
+               (double)s->total_ns / 1e9,
+               (unsigned long long)(s->total_ns / s->calls / 1000),
+               (unsigned long long)(s->max_ns / 1000),
+               (unsigned long long)s->calls, (unsigned long long)s->errors,
+               syscall_name(order[i]));
+    }
+    printf("------ ----------- ----------- ------------- --------- --------- ----------------\n");
+    printf("100.00 %11.6f %11llu %13s %9llu %9llu total\n",
+           (double)total / 1e9,
+           (unsigned long long)(calls ? total / calls / 1000 : 0), "",
+           (unsigned long long)calls, (unsigned long long)errors);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_slice(void) {
+    struct timespec slice = { 0, (long)DRAIN_SLICE_NS };
+    nanosleep(&slice, NULL);
+}
+
+static void* wait_child(void* arg) {
+    int handle = (int)(intptr_t)arg;
+    proc_wait(handle, &g_child_status);
+    __atomic_store_n(&g_child_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static int attach(uint32_t pid) {
+    if (ioctl(g_fd, STRACE_ATTACH, (unsigned long)pid) < 0) {
+        fprintf(stderr, "strace: attach to %u failed: %s\n", pid, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* Created stopped, attached, then started, so no syscall is missed */
+static int trace_command(char* argv[]) {
+    char path[256];
+    if (strchr(argv[0], '/')) {
+        snprintf(path, sizeof(path), "%s", argv[0]);
+    } else {
+        snprintf(path, sizeof(path), "/bin/%s", argv[0]);
+    }
+
+    int handle = proc_create(path, (const char**)(argv + 1));
+    if (handle < 0) {
+        fprintf(stderr, "strace: cannot run %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    process_info info;
+    if (proc_info(handle, &info) < 0 || attach((uint32_t)info.pid) < 0) {
+        proc_kill(handle);
+        proc_wait(handle, &g_child_status);
+        return -1;
+    }
+
+    pthread_t waiter;
+    if (proc_start(handle) < 0 ||
+        pthread_create(&waiter, NULL, wait_child, (void*)(intptr_t)handle) != 0) {
+        fprintf(stderr, "strace: cannot start %s\n", path);
+        proc_kill(handle);
+        proc_wait(handle, &g_child_status);
+        return -1;
+    }
+
+    while (!__atomic_load_n(&g_child_done, __ATOMIC_ACQUIRE)) {
+        sleep_slice();
+        drain();
+    }
+    pthread_join(waiter, NULL);
+    return 0;
+}
+
+static void trace_for(unsigned long seconds) {
+    uint64_t deadline = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    while (now_ns() < deadline) {
+        sleep_slice();
+        drain();
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: strace [-c] command [args...]\n");
+    fprintf(stderr, "       strace [-c] -p pid [seconds]\n");
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long pid = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "+cp:")) != -1) {
+        switch (opt) {
+        case 'c':
+            g_summary = 1;
+            break;
+        case 'p':
+            pid = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if ((pid == 0 && optind >= argc) || pid > 0xFFFFFFFFUL) {
+        usage();
+        return 1;
+    }
+
+    g_fd = open("/dev/strace", O_RDONLY);
+    if (g_fd < 0) {
+        fprintf(stderr, "strace: cannot open /dev/strace: %s\n", strerror(errno));
+        return 1;
+    }
+
+    if (pid) {
+        unsigned long seconds = optind < argc ? strtoul(argv[optind], NULL, 10) : 5;
+        if (seconds == 0 || attach((uint32_t)pid) < 0) {
+            close(g_fd);
+            return 1;
+        }
+        trace_for(seconds);
+    } else if (trace_command(argv + optind) < 0) {
+        close(g_fd);
+        return 1;
+    }
+
+    ioctl(g_fd, STRACE_DETACH, 0);
+    drain();
+    flush_pending();
+
+    strace_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    ioctl(g_fd, STRACE_GET_STATS, &stats);
+    close(g_fd);
+
+    if (g_summary) {
+        print_summary();
+    }
+    if (stats.drops) {
+        fprintf(stderr, "strace: %llu records dropped, buffer full\n",
+                (unsigned long long)stats.drops);
+    }
+    if (!pid && STLX_WIFEXITED(g_child_status)) {
+        return STLX_WEXITSTATUS(g_child_status);
+    }
+    return 0;
+}
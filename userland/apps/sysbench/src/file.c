@@ -0,0 +1,67 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "sysbench.h"
+
+/*
+ * ramfs throughput: iters 64 KiB blocks move through a 4 MiB file in
+ * /tmp, seeking back to the start whenever the end is reached, so the
+ * working set stays fixed however many iterations run.
+ */
+
+#define FILE_PATH   "/tmp/sysbench.dat"
+#define FILE_BLOCKS 64
+
+typedef ssize_t (*io_fn)(int fd, void* buf, size_t len);
+
+static ssize_t do_write(int fd, void* buf, size_t len) {
+    return write(fd, buf, len);
+}
+
+static int file_pass(int fd, char* buf, uint64_t iters, io_fn io,
+                     uint64_t* elapsed) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        if (i % FILE_BLOCKS == 0 && lseek(fd, 0, SEEK_SET) < 0) return errno;
+        ssize_t n = io(fd, buf, BW_BLOCK);
+        if (n < 0) return errno;
+        if (n != BW_BLOCK) return EIO;
+    }
+    *elapsed = now_ns() - start;
+    return 0;
+}
+
+static int file_bench(uint64_t iters, io_fn io, double* result) {
+    char* buf = malloc(BW_BLOCK);
+    if (!buf) return ENOMEM;
+    memset(buf, 0x5A, BW_BLOCK);
+
+    int fd = open(FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        int err = errno;
+        free(buf);
+        return err;
+    }
+
+    /* Populate the file untimed so both directions see the same pages */
+    uint64_t elapsed = 0;
+    int err = file_pass(fd, buf, FILE_BLOCKS, do_write, &elapsed);
+    if (err == 0) err = file_pass(fd, buf, iters, io, &elapsed);
+    if (err == 0) *result = mb_per_sec(iters * BW_BLOCK, elapsed);
+
+    close(fd);
+    unlink(FILE_PATH);
+    free(buf);
+    return err;
+}
+
+int bench_file_write(uint64_t iters, double* result) {
+    return file_bench(iters, do_write, result);
+}
+
+int bench_file_read(uint64_t iters, double* result) {
+    return file_bench(iters, read, result);
+}
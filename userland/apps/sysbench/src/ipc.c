@@ -0,0 +1,71 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "sysbench.h"
+
+struct stream_writer {
+    int      fd;
+    uint64_t blocks;
+    char*    buf;
+    int      err;
+};
+
+static void* stream_write(void* arg) {
+    struct stream_writer* w = (struct stream_writer*)arg;
+    for (uint64_t i = 0; i < w->blocks && w->err == 0; i++) {
+        w->err = write_full(w->fd, w->buf, BW_BLOCK);
+    }
+    return NULL;
+}
+
+int stream_bw(int wfd, int rfd, uint64_t blocks, double* result) {
+    char* wbuf = malloc(BW_BLOCK);
+    char* rbuf = malloc(BW_BLOCK);
+    if (!wbuf || !rbuf) {
+        close(rfd);
+        close(wfd);
+        free(wbuf);
+        free(rbuf);
+        return ENOMEM;
+    }
+    memset(wbuf, 0x5A, BW_BLOCK);
+
+    struct stream_writer w = { wfd, blocks, wbuf, 0 };
+    pthread_t writer;
+    int err = pthread_create(&writer, NULL, stream_write, &w);
+    if (err == 0) {
+        uint64_t start = now_ns();
+        for (uint64_t i = 0; i < blocks && err == 0; i++) {
+            err = read_full(rfd, rbuf, BW_BLOCK);
+        }
+        uint64_t elapsed = now_ns() - start;
+        /* Closing the read side also releases a writer left blocked */
+        close(rfd);
+        rfd = -1;
+        pthread_join(writer, NULL);
+        if (err == 0) err = w.err;
+        if (err == 0) *result = mb_per_sec(blocks * BW_BLOCK, elapsed);
+    }
+
+    if (rfd >= 0) close(rfd);
+    close(wfd);
+    free(wbuf);
+    free(rbuf);
+    return err;
+}
+
+int bench_pipe_bw(uint64_t iters, double* result) {
+    int fds[2];
+    if (pipe(fds) != 0) return errno;
+    return stream_bw(fds[1], fds[0], iters, result);
+}
+
+int bench_unix_bw(uint64_t iters, double* result) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return errno;
+    return stream_bw(fds[1], fds[0], iters, result);
+}
@@ -0,0 +1,114 @@
+/*
+ * sysbench - lmbench style system benchmarks.
+ *
+ * Runs a fixed list of kernel microbenchmarks and prints one table with
+ * a row per benchmark, in a fixed order and format, so the output of two
+ * kernel builds can be compared with diff.
+ *
+ * Usage: sysbench [-q] [name-prefix...]
+ *   -q     run a tenth of the default iterations
+ *   name   run only benchmarks whose name starts with one of the prefixes
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include "sysbench.h"
+
+static const struct bench g_benches[] = {
+    { "null_syscall",   "ns/op",    200000, bench_null_syscall  },
+    { "clock_gettime",  "ns/op",    200000, bench_clock_gettime },
+    { "ctx_switch",     "ns/sw",     20000, bench_ctx_switch    },
+    { "thread_create",  "us/op",      1000, bench_thread_create },
+    { "proc_create",    "us/op",       200, bench_proc_create   },
+    { "futex_handoff",  "ns/sw",     20000, bench_futex_handoff },
+    { "page_fault",     "ns/fault",  16384, bench_page_fault    },
+    { "mmap_munmap",    "us/op",      2000, bench_mmap_munmap   },
+    { "pipe_bw",        "MB/s",       2048, bench_pipe_bw       },
+    { "unix_bw",        "MB/s",       2048, bench_unix_bw       },
+    { "tcp_lat",        "us/rtt",     5000, bench_tcp_lat       },
+    { "tcp_bw",         "MB/s",        512, bench_tcp_bw        },
+    { "udp_lat",        "us/rtt",     5000, bench_udp_lat       },
+    { "udp_bw",         "MB/s",       8192, bench_udp_bw        },
+    { "file_write",     "MB/s",       2048, bench_file_write    },
+    { "file_read",      "MB/s",       2048, bench_file_read     },
+};
+
+#define BENCH_COUNT (sizeof(g_benches) / sizeof(g_benches[0]))
+
+int write_full(int fd, const void* buf, uint64_t len) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        p += n;
+        len -= (uint64_t)n;
+    }
+    return 0;
+}
+
+int read_full(int fd, void* buf, uint64_t len) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) return EPIPE;
+        p += n;
+        len -= (uint64_t)n;
+    }
+    return 0;
+}
+
+static int selected(const char* name, int argc, char* argv[], int first) {
+    if (first >= argc) return 1;
+    for (int i = first; i < argc; i++) {
+        if (strncmp(name, argv[i], strlen(argv[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    /* Stream benchmarks stop a blocked writer by closing the reader */
+    signal(SIGPIPE, SIG_IGN);
+
+    int first = 1;
+    uint64_t divisor = 1;
+    if (argc > 1 && strcmp(argv[1], "-q") == 0) {
+        divisor = 10;
+        first = 2;
+    }
+
+    printf("%-16s %10s %14s  %s\n", "benchmark", "iters", "result", "unit");
+
+    int failures = 0;
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        const struct bench* b = &g_benches[i];
+        if (!selected(b->name, argc, argv, first)) continue;
+
+        uint64_t iters = b->iters / divisor;
+        if (iters == 0) iters = 1;
+
+        double result = 0.0;
+        int err = b->run(iters, &result);
+        if (err != 0) {
+            printf("%-16s %10llu %14s  %s (%s)\n", b->name,
+                   (unsigned long long)iters, "FAIL", b->unit, strerror(err));
+            failures++;
+            continue;
+        }
+        printf("%-16s %10llu %14.2f  %s\n", b->name,
+               (unsigned long long)iters, result, b->unit);
+    }
+
+    return failures;
+}
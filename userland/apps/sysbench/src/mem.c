@@ -0,0 +1,54 @@
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "sysbench.h"
+
+#define FAULT_CHUNK_PAGES 256
+#define MMAP_BYTES        (1024 * 1024)
+
+/*
+ * Page faults: map anonymous memory a chunk at a time and time the first
+ * write to each page. Mapping and unmapping stay outside the timed part.
+ */
+int bench_page_fault(uint64_t iters, double* result) {
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+
+    uint64_t faults = 0;
+    uint64_t elapsed = 0;
+    while (faults < iters) {
+        uint64_t pages = iters - faults;
+        if (pages > FAULT_CHUNK_PAGES) pages = FAULT_CHUNK_PAGES;
+
+        size_t len = (size_t)pages * (size_t)page;
+        char* mem = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return errno;
+
+        uint64_t start = now_ns();
+        for (uint64_t i = 0; i < pages; i++) {
+            ((volatile char*)mem)[i * (uint64_t)page] = 1;
+        }
+        elapsed += now_ns() - start;
+
+        munmap(mem, len);
+        faults += pages;
+    }
+
+    *result = ns_per_op(elapsed, faults);
+    return 0;
+}
+
+/* Map and unmap an untouched 1 MiB anonymous region. */
+int bench_mmap_munmap(uint64_t iters, double* result) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        void* mem = mmap(NULL, MMAP_BYTES, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return errno;
+        if (munmap(mem, MMAP_BYTES) != 0) return errno;
+    }
+    *result = ns_per_op(now_ns() - start, iters) / 1000.0;
+    return 0;
+}
@@ -0,0 +1,254 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "sysbench.h"
+
+#define LOOPBACK_ADDR 0x7F000001u
+
+#define TCP_PORT       47100
+#define UDP_PORT_A     47101
+#define UDP_PORT_B     47102
+
+#define LAT_MSG        64
+#define UDP_BW_DGRAM   1024
+#define UDP_TIMEOUT_MS 1000
+
+static void loopback_addr(struct sockaddr_in* addr, uint16_t port) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    addr->sin_addr.s_addr = htonl(LOOPBACK_ADDR);
+}
+
+/* Connect a TCP client to a one-shot listener on the loopback address. */
+static int tcp_pair(int* client, int* server) {
+    struct sockaddr_in addr;
+    loopback_addr(&addr, TCP_PORT);
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0) return errno;
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    int err = 0;
+    int cfd = -1;
+    int sfd = -1;
+    if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(lfd, 1) != 0) {
+        err = errno;
+    } else if ((cfd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+        err = errno;
+    } else if (connect(cfd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        err = errno;
+    } else if ((sfd = accept(lfd, NULL, NULL)) < 0) {
+        err = errno;
+    }
+
+    close(lfd);
+    if (err != 0) {
+        if (cfd >= 0) close(cfd);
+        return err;
+    }
+    *client = cfd;
+    *server = sfd;
+    return 0;
+}
+
+static int udp_bound(uint16_t port, int* out) {
+    struct sockaddr_in addr;
+    loopback_addr(&addr, port);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return errno;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+    *out = fd;
+    return 0;
+}
+
+static int udp_send(int fd, uint16_t port, const void* buf, size_t len) {
+    struct sockaddr_in addr;
+    loopback_addr(&addr, port);
+    ssize_t n = sendto(fd, buf, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+    if (n < 0) return errno;
+    return (size_t)n == len ? 0 : EMSGSIZE;
+}
+
+/* Receive one datagram, giving up after UDP_TIMEOUT_MS so a drop cannot hang. */
+static int udp_recv(int fd, void* buf, size_t len, ssize_t* got) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int ready = poll(&pfd, 1, UDP_TIMEOUT_MS);
+    if (ready < 0) return errno;
+    if (ready == 0) return ETIMEDOUT;
+    ssize_t n = recvfrom(fd, buf, len, 0, NULL, NULL);
+    if (n < 0) return errno;
+    *got = n;
+    return 0;
+}
+
+/*
+ * Latency: the partner thread echoes iters messages back, one at a time.
+ */
+
+struct echo {
+    int      fd;
+    uint64_t iters;
+    int      udp;
+};
+
+static void* echo_loop(void* arg) {
+    struct echo* e = (struct echo*)arg;
+    char msg[LAT_MSG];
+    for (uint64_t i = 0; i < e->iters; i++) {
+        if (e->udp) {
+            ssize_t n;
+            if (udp_recv(e->fd, msg, sizeof(msg), &n) != 0) break;
+            if (udp_send(e->fd, UDP_PORT_A, msg, (size_t)n) != 0) break;
+        } else {
+            if (read_full(e->fd, msg, sizeof(msg)) != 0) break;
+            if (write_full(e->fd, msg, sizeof(msg)) != 0) break;
+        }
+    }
+    return NULL;
+}
+
+static int measure_rtt(int fd, struct echo* e, double* result) {
+    pthread_t partner;
+    int err = pthread_create(&partner, NULL, echo_loop, e);
+    if (err != 0) return err;
+
+    char msg[LAT_MSG];
+    memset(msg, 0x5A, sizeof(msg));
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < e->iters && err == 0; i++) {
+        if (e->udp) {
+            ssize_t n;
+            err = udp_send(fd, UDP_PORT_B, msg, sizeof(msg));
+            if (err == 0) err = udp_recv(fd, msg, sizeof(msg), &n);
+        } else {
+            err = write_full(fd, msg, sizeof(msg));
+            if (err == 0) err = read_full(fd, msg, sizeof(msg));
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    /* The partner exits on its own after iters echoes, or on EOF/timeout */
+    if (err != 0 && !e->udp) shutdown(fd, SHUT_RDWR);
+    pthread_join(partner, NULL);
+    if (err == 0) *result = ns_per_op(elapsed, e->iters) / 1000.0;
+    return err;
+}
+
+int bench_tcp_lat(uint64_t iters, double* result) {
+    int client, server;
+    int err = tcp_pair(&client, &server);
+    if (err != 0) return err;
+
+    struct echo e = { server, iters, 0 };
+    err = measure_rtt(client, &e, result);
+    close(client);
+    close(server);
+    return err;
+}
+
+int bench_tcp_bw(uint64_t iters, double* result) {
+    int client, server;
+    int err = tcp_pair(&client, &server);
+    if (err != 0) return err;
+    return stream_bw(client, server, iters, result);
+}
+
+int bench_udp_lat(uint64_t iters, double* result) {
+    int a, b;
+    int err = udp_bound(UDP_PORT_A, &a);
+    if (err != 0) return err;
+    err = udp_bound(UDP_PORT_B, &b);
+    if (err != 0) {
+        close(a);
+        return err;
+    }
+
+    struct echo e = { b, iters, 1 };
+    err = measure_rtt(a, &e, result);
+    close(a);
+    close(b);
+    return err;
+}
+
+/*
+ * UDP bandwidth: a sender thread fires iters datagrams followed by short
+ * end markers. Only datagrams that arrive count, so drops lower the
+ * figure rather than stalling the run.
+ */
+
+struct udp_sender {
+    int      fd;
+    uint64_t iters;
+    int      err;
+};
+
+static void* udp_send_loop(void* arg) {
+    struct udp_sender* s = (struct udp_sender*)arg;
+    char dgram[UDP_BW_DGRAM];
+    memset(dgram, 0x5A, sizeof(dgram));
+    for (uint64_t i = 0; i < s->iters && s->err == 0; i++) {
+        s->err = udp_send(s->fd, UDP_PORT_B, dgram, sizeof(dgram));
+        if (s->err == ENOBUFS || s->err == EAGAIN) s->err = 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        udp_send(s->fd, UDP_PORT_B, dgram, 1);
+    }
+    return NULL;
+}
+
+int bench_udp_bw(uint64_t iters, double* result) {
+    int a, b;
+    int err = udp_bound(UDP_PORT_A, &a);
+    if (err != 0) return err;
+    err = udp_bound(UDP_PORT_B, &b);
+    if (err != 0) {
+        close(a);
+        return err;
+    }
+
+    struct udp_sender s = { a, iters, 0 };
+    pthread_t sender;
+    err = pthread_create(&sender, NULL, udp_send_loop, &s);
+    if (err == 0) {
+        char dgram[UDP_BW_DGRAM];
+        uint64_t bytes = 0;
+        uint64_t start = now_ns();
+        uint64_t last = start;
+        for (;;) {
+            ssize_t n;
+            int rerr = udp_recv(b, dgram, sizeof(dgram), &n);
+            if (rerr == ETIMEDOUT) break;
+            if (rerr != 0) {
+                err = rerr;
+                break;
+            }
+            if (n < UDP_BW_DGRAM) break;
+            bytes += (uint64_t)n;
+            last = now_ns();
+        }
+        pthread_join(sender, NULL);
+        if (err == 0) err = s.err;
+        if (err == 0 && bytes == 0) err = ETIMEDOUT;
+        if (err == 0) *result = mb_per_sec(bytes, last - start);
+    }
+
+    close(a);
+    close(b);
+    return err;
+}
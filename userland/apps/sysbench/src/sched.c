@@ -0,0 +1,144 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stlx/proc.h>
+#include <stlx/futex.h>
+#include "sysbench.h"
+
+/*
+ * Context switch: two threads bounce one byte over a pair of pipes.
+ * There is no fork, so the partner is a thread rather than a process;
+ * each round trip costs two switches.
+ */
+
+struct pingpong {
+    int      in;
+    int      out;
+    uint64_t iters;
+};
+
+static void* pingpong_echo(void* arg) {
+    struct pingpong* pp = (struct pingpong*)arg;
+    char c;
+    for (uint64_t i = 0; i < pp->iters; i++) {
+        if (read_full(pp->in, &c, 1) != 0) break;
+        if (write_full(pp->out, &c, 1) != 0) break;
+    }
+    return NULL;
+}
+
+int bench_ctx_switch(uint64_t iters, double* result) {
+    int to_echo[2], from_echo[2];
+    if (pipe(to_echo) != 0) return errno;
+    if (pipe(from_echo) != 0) {
+        int err = errno;
+        close(to_echo[0]);
+        close(to_echo[1]);
+        return err;
+    }
+
+    struct pingpong pp = { to_echo[0], from_echo[1], iters };
+    pthread_t echo;
+    int err = pthread_create(&echo, NULL, pingpong_echo, &pp);
+    if (err == 0) {
+        char c = 'x';
+        uint64_t start = now_ns();
+        for (uint64_t i = 0; i < iters && err == 0; i++) {
+            err = write_full(to_echo[1], &c, 1);
+            if (err == 0) err = read_full(from_echo[0], &c, 1);
+        }
+        uint64_t elapsed = now_ns() - start;
+        /* EOF releases the partner if the loop stopped early */
+        close(to_echo[1]);
+        pthread_join(echo, NULL);
+        *result = ns_per_op(elapsed, iters * 2);
+    } else {
+        close(to_echo[1]);
+    }
+
+    close(to_echo[0]);
+    close(from_echo[0]);
+    close(from_echo[1]);
+    return err;
+}
+
+static void* empty_thread(void* arg) {
+    return arg;
+}
+
+int bench_thread_create(uint64_t iters, double* result) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        pthread_t t;
+        int err = pthread_create(&t, NULL, empty_thread, NULL);
+        if (err != 0) return err;
+        pthread_join(t, NULL);
+    }
+    *result = ns_per_op(now_ns() - start, iters) / 1000.0;
+    return 0;
+}
+
+int bench_proc_create(uint64_t iters, double* result) {
+    const char* argv[] = { "/bin/true", NULL };
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        int handle = proc_exec(argv[0], argv);
+        if (handle < 0) return errno;
+        int exit_code = 0;
+        if (proc_wait(handle, &exit_code) != 0) return errno;
+        if (exit_code != 0) return ECHILD;
+    }
+    *result = ns_per_op(now_ns() - start, iters) / 1000.0;
+    return 0;
+}
+
+/*
+ * Futex handoff: two threads take turns on one futex word. Each side
+ * waits for its own value, stores the other side's and wakes it.
+ */
+
+struct handoff {
+    uint32_t word;
+    uint64_t iters;
+};
+
+static void handoff_wait(uint32_t* word, uint32_t want) {
+    uint32_t cur;
+    while ((cur = __atomic_load_n(word, __ATOMIC_ACQUIRE)) != want) {
+        stlx_futex_wait(word, cur, 0);
+    }
+}
+
+static void handoff_pass(uint32_t* word, uint32_t value) {
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+    stlx_futex_wake(word, 1);
+}
+
+static void* handoff_partner(void* arg) {
+    struct handoff* h = (struct handoff*)arg;
+    for (uint64_t i = 0; i < h->iters; i++) {
+        handoff_wait(&h->word, 1);
+        handoff_pass(&h->word, 0);
+    }
+    return NULL;
+}
+
+int bench_futex_handoff(uint64_t iters, double* result) {
+    struct handoff h = { 0, iters };
+    pthread_t partner;
+    int err = pthread_create(&partner, NULL, handoff_partner, &h);
+    if (err != 0) return err;
+
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        handoff_pass(&h.word, 1);
+        handoff_wait(&h.word, 0);
+    }
+    uint64_t elapsed = now_ns() - start;
+    pthread_join(partner, NULL);
+
+    *result = ns_per_op(elapsed, iters * 2);
+    return 0;
+}
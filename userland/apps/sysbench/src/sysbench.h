@@ -0,0 +1,76 @@
+#ifndef SYSBENCH_H
+#define SYSBENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * A benchmark runs iters operations and stores one figure in *result,
+ * in the unit named by its table entry. Returns 0 on success or a
+ * positive errno on failure.
+ */
+typedef int (*bench_fn)(uint64_t iters, double* result);
+
+struct bench {
+    const char* name;
+    const char* unit;
+    uint64_t    iters;
+    bench_fn    run;
+};
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline double ns_per_op(uint64_t elapsed_ns, uint64_t ops) {
+    return ops ? (double)elapsed_ns / (double)ops : 0.0;
+}
+
+static inline double mb_per_sec(uint64_t bytes, uint64_t elapsed_ns) {
+    if (elapsed_ns == 0) elapsed_ns = 1;
+    return ((double)bytes / (1024.0 * 1024.0)) / ((double)elapsed_ns / 1e9);
+}
+
+/* Block size of the stream bandwidth benchmarks */
+#define BW_BLOCK (64 * 1024)
+
+/* Write or read exactly len bytes. Return 0 or a positive errno. */
+int write_full(int fd, const void* buf, uint64_t len);
+int read_full(int fd, void* buf, uint64_t len);
+
+/* syscall.c */
+int bench_null_syscall(uint64_t iters, double* result);
+int bench_clock_gettime(uint64_t iters, double* result);
+
+/* sched.c */
+int bench_ctx_switch(uint64_t iters, double* result);
+int bench_thread_create(uint64_t iters, double* result);
+int bench_proc_create(uint64_t iters, double* result);
+int bench_futex_handoff(uint64_t iters, double* result);
+
+/* mem.c */
+int bench_page_fault(uint64_t iters, double* result);
+int bench_mmap_munmap(uint64_t iters, double* result);
+
+/* ipc.c */
+/*
+ * Stream blocks 64 KiB blocks from a writer thread on wfd to the caller
+ * reading rfd and store the MB/s. Closes both descriptors.
+ */
+int stream_bw(int wfd, int rfd, uint64_t blocks, double* result);
+int bench_pipe_bw(uint64_t iters, double* result);
+int bench_unix_bw(uint64_t iters, double* result);
+
+/* net.c */
+int bench_tcp_lat(uint64_t iters, double* result);
+int bench_tcp_bw(uint64_t iters, double* result);
+int bench_udp_lat(uint64_t iters, double* result);
+int bench_udp_bw(uint64_t iters, double* result);
+
+/* file.c */
+int bench_file_write(uint64_t iters, double* result);
+int bench_file_read(uint64_t iters, double* result);
+
+#endif /* SYSBENCH_H */
@@ -0,0 +1,25 @@
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include "sysbench.h"
+
+/* getppid through syscall() so libc cannot answer from a cache. */
+int bench_null_syscall(uint64_t iters, double* result) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        syscall(SYS_getppid);
+    }
+    *result = ns_per_op(now_ns() - start, iters);
+    return 0;
+}
+
+int bench_clock_gettime(uint64_t iters, double* result) {
+    struct timespec ts;
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iters; i++) {
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return errno;
+    }
+    *result = ns_per_op(now_ns() - start, iters);
+    return 0;
+}
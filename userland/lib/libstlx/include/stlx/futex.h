@@ -17,6 +17,39 @@ int stlx_futex_wake(uint32_t* addr, uint32_t count);
 /* Wake all threads waiting on addr. Returns number woken. */
 int stlx_futex_wake_all(uint32_t* addr);
 
+/* Maximum number of futexes one stlx_futex_waitv() call may wait on. */
+#define STLX_FUTEX_WAITV_MAX 128
+
+/* One futex word for stlx_futex_waitv(). Same layout as Linux's
+ * struct futex_waitv; fill it with stlx_futex_waitv_set(). */
+typedef struct {
+    uint64_t val;
+    uint64_t uaddr;
+    uint32_t flags;
+    uint32_t reserved;
+} stlx_futex_waitv_t;
+
+/* Wait on addr while it holds expected. */
+static inline void stlx_futex_waitv_set(stlx_futex_waitv_t* w,
+                                        uint32_t* addr, uint32_t expected) {
+    w->val = expected;
+    w->uaddr = (uint64_t)(uintptr_t)addr;
+    w->flags = 0x82; /* FUTEX2_SIZE_U32 | FUTEX2_PRIVATE */
+    w->reserved = 0;
+}
+
+/* Block until any of the count futexes is woken. Returns immediately
+ * with -EAGAIN if any word no longer holds its expected value.
+ * timeout_ns=0 waits indefinitely. Returns the index of a woken futex,
+ * negative errno on error (-EAGAIN, -ETIMEDOUT). */
+int stlx_futex_waitv(stlx_futex_waitv_t* waiters, uint32_t count,
+                     uint64_t timeout_ns);
+
+/* stlx_futex_waitv() with an absolute CLOCK_MONOTONIC deadline in
+ * nanoseconds, 0 for none. */
+int stlx_futex_waitv_until(stlx_futex_waitv_t* waiters, uint32_t count,
+                           uint64_t deadline_ns);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,27 @@ void stlx_mutex_unlock(stlx_mutex_t* m);
 /* Returns 0 if acquired, -1 if already held. */
 int stlx_mutex_trylock(stlx_mutex_t* m);
 
+/*
+ * Priority-inheritance mutex. The state holds the owner's thread id, with
+ * bit 31 set while threads are blocked on it. Uncontended lock and unlock
+ * stay in userland; a blocked locker lends the owner its place in the
+ * scheduler until the lock is handed over.
+ */
+typedef struct { uint32_t state; } stlx_pi_mutex_t;
+
+#define STLX_PI_MUTEX_INIT { 0 }
+
+/*
+ * Returns 0 once the lock is held, -1 with errno set if the kernel
+ * refused the wait: EDEADLK if the caller already holds it, ESRCH if
+ * the owner recorded in the state does not exist, EFAULT for a bad m.
+ */
+int stlx_pi_mutex_lock(stlx_pi_mutex_t* m);
+void stlx_pi_mutex_unlock(stlx_pi_mutex_t* m);
+
+/* Returns 0 if acquired, -1 if already held. */
+int stlx_pi_mutex_trylock(stlx_pi_mutex_t* m);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,10 +13,26 @@ extern "C" {
 #define STLX_WIFSIGNALED(s)  (((s) & 0x7F) != 0)
 #define STLX_WTERMSIG(s)     ((s) & 0x7F)
 
+/* Resource usage of a process, times in nanoseconds. */
+typedef struct {
+    uint64_t user_ns;
+    uint64_t sys_ns;
+    uint64_t minflt;       /* page faults served by demand paging */
+    uint64_t nvcsw;        /* voluntary context switches */
+    uint64_t nivcsw;       /* involuntary context switches */
+    uint64_t syscalls;
+    uint64_t read_bytes;   /* read through handles other than sockets */
+    uint64_t write_bytes;  /* written through handles other than sockets */
+    uint64_t net_rx_bytes;
+    uint64_t net_tx_bytes;
+    uint64_t maxrss_kb;    /* peak resident size */
+} proc_usage;
+
 typedef struct {
     char name[256];
     int pid;
     int cpu;
+    proc_usage usage;
 } process_info;
 
 /**
@@ -61,8 +77,9 @@ int proc_detach(int handle);
 
 /**
  * Query process information. Handle must still be valid (call before
- * proc_wait/proc_detach). Returns 0 on success, -1 on failure with
- * errno set.
+ * proc_wait/proc_detach). usage covers the whole process for a process
+ * handle and the thread alone for a thread handle. Returns 0 on success,
+ * -1 on failure with errno set.
  */
 int proc_info(int handle, process_info* info);
 
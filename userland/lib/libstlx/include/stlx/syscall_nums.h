@@ -14,5 +14,8 @@
 #define SYS_FUTEX_WAIT          1030
 #define SYS_FUTEX_WAKE          1031
 #define SYS_FUTEX_WAKE_ALL      1032
+#define SYS_FUTEX_WAITV         1033
+#define SYS_FUTEX_LOCK_PI       1034
+#define SYS_FUTEX_UNLOCK_PI     1035
 
 #endif /* STLX_SYSCALL_NUMS_H */
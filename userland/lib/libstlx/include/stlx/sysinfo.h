@@ -0,0 +1,105 @@
+#ifndef STLX_SYSINFO_H
+#define STLX_SYSINFO_H
+
+#include <stdint.h>
+#include <stlx/proc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary records served by /dev/sysinfo/snapshot and /dev/sysinfo/cpupage.
+ *
+ * A snapshot is captured when the file is read from offset 0: a header,
+ * then cpu_count CPU records and task_count task records at the offsets
+ * and strides the header gives. Newer kernels only append fields within
+ * a version, so step by the record sizes rather than sizeof().
+ */
+
+#define STLX_SNAPSHOT_MAGIC    0x50414E53u /* "SNAP" */
+#define STLX_SNAPSHOT_VERSION  1
+#define STLX_SNAPSHOT_NAME_LEN 32
+
+#define STLX_TASK_STATE_CREATED 0
+#define STLX_TASK_STATE_READY   1
+#define STLX_TASK_STATE_RUNNING 2
+#define STLX_TASK_STATE_BLOCKED 3
+#define STLX_TASK_STATE_DEAD    4
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t timestamp_ns;     /* CLOCK_MONOTONIC at capture */
+    uint32_t tick_hz;
+    uint32_t page_size;
+    uint64_t total_pages;
+    uint64_t free_pages;
+    uint32_t cpu_count;
+    uint32_t cpu_record_size;
+    uint32_t cpu_offset;
+    uint32_t task_count;
+    uint32_t task_record_size;
+    uint32_t task_offset;
+} stlx_snapshot_header;
+
+/* Busy/idle ticks and wakeup placement counters of one CPU. */
+typedef struct {
+    uint64_t busy_ticks;
+    uint64_t idle_ticks;
+    uint64_t wake_prev_idle;
+    uint64_t wake_affine;
+    uint64_t wake_cache_hot;
+    uint64_t wake_idle_cpu;
+    uint64_t wake_prev_busy;
+    uint64_t wake_migrations;
+    uint64_t wake_remote;
+    uint64_t wake_pinned;
+} stlx_snapshot_cpu;
+
+typedef struct {
+    uint32_t   tid;
+    uint32_t   pid;   /* 0 for kernel tasks */
+    uint32_t   state; /* STLX_TASK_STATE_* */
+    uint32_t   cpu;
+    uint64_t   run_ns;
+    uint64_t   rss_kb;
+    proc_usage usage; /* this task alone */
+    char       name[STLX_SNAPSHOT_NAME_LEN];
+} stlx_snapshot_task;
+
+/*
+ * /dev/sysinfo/cpupage maps the kernel's per-CPU time ledger read-only
+ * (mmap with PROT_READ, offset 0). Each CPU updates its record under seq:
+ * retry while seq is odd or changes across the read. While in_idle is
+ * set the CPU has been idle since stamp_ns and the open period is not
+ * yet in idle_ns. Times are CLOCK_MONOTONIC nanoseconds.
+ */
+
+#define STLX_CPU_TIME_PAGE_MAGIC   0x454D4954u /* "TIME" */
+#define STLX_CPU_TIME_PAGE_VERSION 1
+
+typedef struct {
+    uint32_t seq;
+    uint32_t in_idle;
+    uint64_t stamp_ns;
+    uint64_t busy_ns;
+    uint64_t idle_ns;
+    uint64_t reserved[4];
+} stlx_cpu_time_record;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cpu_count;
+    uint32_t record_offset;
+    uint32_t record_size;
+    uint32_t reserved[11];
+} stlx_cpu_time_page;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STLX_SYSINFO_H */
@@ -2,6 +2,7 @@
 #include <stlx/futex.h>
 #include <stlx/syscall_nums.h>
 #include <unistd.h>
+#include <time.h>
 
 int stlx_futex_wait(uint32_t* addr, uint32_t expected, uint64_t timeout_ns) {
     return (int)syscall(SYS_FUTEX_WAIT, addr, expected, timeout_ns);
@@ -14,3 +15,20 @@ int stlx_futex_wake(uint32_t* addr, uint32_t count) {
 int stlx_futex_wake_all(uint32_t* addr) {
     return (int)syscall(SYS_FUTEX_WAKE_ALL, addr);
 }
+
+int stlx_futex_waitv(stlx_futex_waitv_t* waiters, uint32_t count,
+                     uint64_t timeout_ns) {
+    uint64_t deadline_ns = 0;
+    if (timeout_ns) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        deadline_ns = (uint64_t)now.tv_sec * 1000000000ULL
+                    + (uint64_t)now.tv_nsec + timeout_ns;
+    }
+    return stlx_futex_waitv_until(waiters, count, deadline_ns);
+}
+
+int stlx_futex_waitv_until(stlx_futex_waitv_t* waiters, uint32_t count,
+                           uint64_t deadline_ns) {
+    return (int)syscall(SYS_FUTEX_WAITV, waiters, count, deadline_ns);
+}
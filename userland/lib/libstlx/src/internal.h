@@ -0,0 +1,11 @@
+#ifndef STLX_INTERNAL_H
+#define STLX_INTERNAL_H
+
+/*
+ * Set once the process has created a thread with proc_create_thread.
+ * Such threads run on their creator's TLS, so per-thread caches kept in
+ * __thread variables can no longer be trusted.
+ */
+extern int stlx_tls_shared;
+
+#endif /* STLX_INTERNAL_H */
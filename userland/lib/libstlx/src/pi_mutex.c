@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include <stlx/mutex.h>
+#include <stlx/syscall_nums.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "internal.h"
+
+/*
+ * The owner tid is cached per thread so uncontended lock and unlock
+ * stay in userland. A forked child clears the copy it inherited. Once
+ * the process has native threads, which share their creator's TLS, the
+ * cache may hold another thread's tid and the kernel is asked instead.
+ */
+static __thread uint32_t t_tid;
+static pthread_once_t g_atfork_once = PTHREAD_ONCE_INIT;
+
+static void clear_tid_cache(void) {
+    t_tid = 0;
+}
+
+static void register_atfork(void) {
+    pthread_atfork(NULL, NULL, clear_tid_cache);
+}
+
+static uint32_t self_tid(void) {
+    if (__atomic_load_n(&stlx_tls_shared, __ATOMIC_RELAXED)) {
+        return (uint32_t)syscall(SYS_gettid);
+    }
+    uint32_t tid = t_tid;
+    if (!tid) {
+        pthread_once(&g_atfork_once, register_atfork);
+        tid = (uint32_t)syscall(SYS_gettid);
+        t_tid = tid;
+    }
+    return tid;
+}
+
+int stlx_pi_mutex_lock(stlx_pi_mutex_t* m) {
+    uint32_t c = 0;
+    if (__atomic_compare_exchange_n(&m->state, &c, self_tid(), 0,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+
+    /* The kernel hands the lock over directly; a wait cut short by a
+     * signal without being restarted simply waits again */
+    for (;;) {
+        if (syscall(SYS_FUTEX_LOCK_PI, &m->state) == 0) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+void stlx_pi_mutex_unlock(stlx_pi_mutex_t* m) {
+    uint32_t c = self_tid();
+    if (__atomic_compare_exchange_n(&m->state, &c, 0, 0,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    /* Waiters bit set: the next owner is picked by the kernel */
+    syscall(SYS_FUTEX_UNLOCK_PI, &m->state);
+}
+
+int stlx_pi_mutex_trylock(stlx_pi_mutex_t* m) {
+    uint32_t c = 0;
+    if (__atomic_compare_exchange_n(&m->state, &c, self_tid(), 0,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    return -1;
+}
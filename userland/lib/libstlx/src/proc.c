@@ -2,6 +2,9 @@
 #include <stlx/proc.h>
 #include <stlx/syscall_nums.h>
 #include <unistd.h>
+#include "internal.h"
+
+int stlx_tls_shared;
 
 int proc_create(const char* path, const char* argv[]) {
     return proc_create_with_env(path, argv, (const char**)environ);
@@ -51,5 +54,6 @@ int proc_kill(int handle) {
 
 int proc_create_thread(void (*entry)(void*), void* arg,
                        void* stack_top, const char* name) {
+    __atomic_store_n(&stlx_tls_shared, 1, __ATOMIC_RELAXED);
     return (int)syscall(SYS_PROC_THREAD_CREATE, entry, arg, stack_top, name);
 }
@@ -2,6 +2,7 @@
 #define STLXSTD_MUTEX_H
 
 #include <stlx/mutex.h>
+#include <stdlib.h>
 
 namespace stlxstd {
 
@@ -26,6 +27,26 @@ private:
     stlx_mutex_t m_;
 };
 
+class pi_mutex {
+public:
+    pi_mutex() : m_(STLX_PI_MUTEX_INIT) {}
+    ~pi_mutex() = default;
+
+    pi_mutex(const pi_mutex&) = delete;
+    pi_mutex& operator=(const pi_mutex&) = delete;
+
+    void lock() {
+        if (stlx_pi_mutex_lock(&m_) != 0) abort();
+    }
+    void unlock() { stlx_pi_mutex_unlock(&m_); }
+    bool try_lock() { return stlx_pi_mutex_trylock(&m_) == 0; }
+
+    stlx_pi_mutex_t* native() { return &m_; }
+
+private:
+    stlx_pi_mutex_t m_;
+};
+
 template<typename Mutex>
 class lock_guard {
 public: